@@ -1,1638 +1,3179 @@
-//
-// AdsbWrapper.cpp: ADSB decoding 
-//
-// Copyright (c) 2019 Bruce Clay
-
-// Portions of thei code was adapted from dump1090 and dump978
-// Copyright (c) 2017 Oliver Jowett <oliver@mutability.co.uk>
-
-// This file is free software: you may copy, redistribute and/or modify it
-// under the terms of the GNU General Public License as published by the
-// Free Software Foundation, either version 2 of the License, or (at your
-// option) any later version.
-//
-// This file is distributed in the hope that it will be useful, but
-// WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-// General Public License for more details.
-//
-
-#include <string.h>
-#include <algorithm>
-#include <time.h>
-#include <QTime>
-
-#include "AdsbWrapper.h"
-
-
-#define CRC16 0x8005
-
-uint16_t gen_crc16(const uint8_t *data, uint16_t size)
-{
-	uint16_t out = 0;
-	int bits_read = 0, bit_flag;
-
-	/* Sanity check: */
-	if (data == NULL)
-		return 0;
-
-	while (size > 0)
-	{
-		bit_flag = out >> 15;
-
-		/* Get next bit: */
-		out <<= 1;
-		out |= (*data >> bits_read) & 1; // item a) work from the least significant bits
-
-		/* Increment bit counter: */
-		bits_read++;
-		if (bits_read > 7)
-		{
-			bits_read = 0;
-			data++;
-			size--;
-		}
-
-		/* Cycle check: */
-		if (bit_flag)
-			out ^= CRC16;
-
-	}
-
-	// item b) "push out" the last 16 bits
-	int i;
-	for (i = 0; i < 16; ++i) {
-		bit_flag = out >> 15;
-		out <<= 1;
-		if (bit_flag)
-			out ^= CRC16;
-	}
-
-	// item c) reverse the bits
-	uint16_t crc = 0;
-	i = 0x8000;
-	int j = 0x0001;
-	for (; i != 0; i >>= 1, j <<= 1) {
-		if (i & out) crc |= j;
-	}
-
-	return crc;
-}
-
-/*
-std::map<int, std::string> AdsbWrapper::mFisbProductNameMap =
-{
-	0, "METAR",
-1, "TAF",
-2, "SIGMET",
-3, "Conv SIGMET",
-4, "AIRMET",
-5, "PIREP",
-6, "Severe Wx",
-7, "Winds Aloft",
-8, "NOTAM",           //"NOTAM (Including TFRs) and Service Status"; 
-9, "D-ATIS",          //"Aerodrome and Airspace  D-ATIS"; 
-10, "Terminal Wx",     //"Aerodrome and Airspace - TWIP"; 
-11, "AIRMET",          //"Aerodrome and Airspace - AIRMET"; 
-12, "SIGMET",          //"Aerodrome and Airspace - SIGMET/Convective SIGMET"; 
-13, "SUA",             //"Aerodrome and Airspace - SUA Status"; 
-20, "METAR",           //"METAR and SPECI"; 
-21, "TAF",             //"TAF and Amended TAF"; 
-22, "SIGMET",          //"SIGMET"; 
-23, "Conv SIGMET",     //"Convective SIGMET"; 
-24, "AIRMET",          //"AIRMET"; 
-25, "PIREP",           //"PIREP"; 
-26, "Severe Wx",       //"AWW"; 
-27, "Winds Aloft",     //"Winds and Temperatures Aloft"; 
-51, "NEXRAD",          //"National NEXRAD, Type 0 - 4 level"; 
-52, "NEXRAD",          //"National NEXRAD, Type 1 - 8 level (quasi 6-level VIP)"; 
-53, "NEXRAD",          //"National NEXRAD, Type 2 - 8 level"; 
-54, "NEXRAD",          //"National NEXRAD, Type 3 - 16 level"; 
-55, "NEXRAD",          //"Regional NEXRAD, Type 0 - low dynamic range"; 
-56, "NEXRAD",          //"Regional NEXRAD, Type 1 - 8 level (quasi 6-level VIP)"; 
-57, "NEXRAD",          //"Regional NEXRAD, Type 2 - 8 level"; 
-58, "NEXRAD",          //"Regional NEXRAD, Type 3 - 16 level"; 
-59, "NEXRAD",          //"Individual NEXRAD, Type 0 - low dynamic range"; 
-60, "NEXRAD",          //"Individual NEXRAD, Type 1 - 8 level (quasi 6-level VIP)"; 
-61, "NEXRAD",          //"Individual NEXRAD, Type 2 - 8 level"; 
-62, "NEXRAD",          //"Individual NEXRAD, Type 3 - 16 level"; 
-63, "NEXRAD Regional", //"Global Block Representation - Regional NEXRAD, Type 4  8 level"; 
-64, "NEXRAD CONUS",    //"Global Block Representation - CONUS NEXRAD, Type 4 - 8 level"; 
-81, "Tops",            //"Radar echo tops graphic, scheme 1,16-level"; 
-82, "Tops",            //"Radar echo tops graphic, scheme 2,8-level"; 
-83, "Tops",            //"Storm tops and velocity"; 
-101, "Lightning",       //"Lightning strike type 1 (pixel level)"; 
-102, "Lightning",       //"Lightning strike type 2 (grid element level)"; 
-151, "Lightning",       //"Point phenomena, vector format"; 
-201, "Surface",         //"Surface conditions/winter precipitation graphic"; 
-202, "Surface",         //"Surface weather systems"; 
-254, "G-AIRMET",        //"AIRMET, SIGMET,Bitmap encoding"; 
-351, "Time",            //"System Time"; 
-352, "Status",          //"Operational Status"; 
-353, "Status",          //"Ground Station Status"; 
-401, "Imagery",         //"Generic Raster Scan Data Product APDU Payload Format Type 1"; 
-402, "Text",
-403, "Vector Imagery", //"Generic Vector Data Product APDU Payload Format Type 1"; 
-404, "Symbols",
-405, "Text",
-411, "Text",    //"Generic Textual Data Product APDU Payload Format Type 1"; 
-412, "Symbols", //"Generic Symbolic Product APDU Payload Format Type 1"; 
-413, "Text"    //"Generic Textual Data Product APDU Payload Format Type 2"; 
-};
-*/
-
-AdsbWrapper::AdsbWrapper()
-{
-//	ClearAhrsData(mAhrsData);
-
-//	ClearHeartbeatInfo(mLatetestHeartbeat);
-//	ClearHeartbeatInfo(mTestHeartbeat);
-
-	mLastDataIndex = -1;
-	mLastCallsign = "none";
-
-	CrcInit();
-
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::ClearAhrsData(struct ahrsDataRec &data)
-{
-	data.msgId = 0;
-	data.subMsgId = 0;
-	data.roll = 0.0f;
-	data.pitch = 0.0f;
-	data.heading = 0.0f;
-	data.headingIsTrue = false;
-	data.indicatedAirspeed = 0.0f;
-	data.trueAirspeed = 0.0f;
-};
-
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::ClearHeartbeatInfo(struct heartbeatMsgRec &msg)
-{
-	msg.msgId = 0;;
-	msg.statusByte1.statusByte = 0;
-	msg.statusByte2.statusByte = 0;
-	msg.timestamp = 0;
-	msg.msgCounts = 0;
-	msg.crc = 0;
-
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::ClearTrafficDataList()
-{
-	QList<struct trafficReportNumRec *> ::iterator infoIter;
-
-	infoIter = mAircraftInfoList.begin();
-	while (infoIter != mAircraftInfoList.end())
-	{
-		delete *infoIter;
-		infoIter++;
-	}
-
-	mAircraftInfoList.clear();
-}
-
-///////////////////////////////////////////////////////////////////////////////
-unsigned int AdsbWrapper::GetUint32(unsigned char *dataBuf)
-{
-	return((dataBuf[0] << 24) + (dataBuf[1] << 16) + (dataBuf[2] << 8) + dataBuf[3]);
-}
-///////////////////////////////////////////////////////////////////////////////
-unsigned int AdsbWrapper::GetUint24(unsigned char *dataBuf)
-{
-	return((dataBuf[0] << 16) + (dataBuf[1] << 8) + dataBuf[0]);
-}
-///////////////////////////////////////////////////////////////////////////////
-unsigned short AdsbWrapper::GetUint16(unsigned char *dataBuf)
-{
-	return((dataBuf[0] << 8) + dataBuf[1]);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetGeodeticLocation(unsigned char *dataBuf, double &location)
-{
-	int status = -1;
-
-	unsigned int locFraction = dataBuf[0] << 16;
-
-	locFraction += dataBuf[1] << 8;
-	locFraction += dataBuf[2];
-
-	locFraction = locFraction & 0x00ffffff;  // mask off the high byte
-
-	if (locFraction > 0x7fffffff)
-	{
-		locFraction -= 0x01000000;
-	}
-
-	location = locFraction * GDL90_LAT_LONG_RES;
-
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-// if filterData is set only save the latest data for a particular aircraft
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeMessage(unsigned int msgSize, char *msgPtr, bool filterData)
-{
-	int status = -1;
-	unsigned char msgId = 0;
-	unsigned char subMsgId = 0;
-	struct trafficReportNumRec *tempDataPtr = NULL;
-	int timeOfReception = 0;
-	int reportLen = 0;
-	bool setOwnshipCallsign = false;
-
-	unsigned char *msgBuf  = (unsigned char *)msgPtr;
-
-	if (msgSize == 2)
-	{
-		status = status;
-	}
-	if (msgSize == 27)
-	{
-		status = status;
-	}
-
-	if ((msgSize > 0) && (msgBuf != 0))
-	{
-		if ((msgBuf[0] == GDL90_FLAGBYTE) && (msgBuf[msgSize - 1] == GDL90_FLAGBYTE))
-		{
-			// convert the flag bytes to zero so we can look for control escape
-
-			msgBuf[0] = 0;
-			msgBuf[msgSize - 1] = 0;
-
-			bool checkStuff = true;
-			QByteArray byteArray;
-
-			//			byteArray.remove(dataIndex, 1);
-
-			int srcIndex = 0;
-			int shiftCnt = 0;
-			int dstIndex = 0;
-
-			bool shiftRemaining = false;
-
-			while (srcIndex < msgSize)
-			{
-				if (msgBuf[srcIndex] == 0x7D)
-				{
-					shiftCnt++;
-
-					msgBuf[dstIndex] = msgBuf[srcIndex] ^ 0x20;
-
-					srcIndex++;
-
-					shiftRemaining = true;
-				}
-				else
-				{
-					if (shiftRemaining == true)
-					{
-						msgBuf[dstIndex] = msgBuf[srcIndex];
-					}
-				}
-				srcIndex++;
-				dstIndex++;
-			}
-
-			msgId = msgBuf[1];
-
-			mLastMsgType = msgId;
-
-			// watch for control-escape fields used to allow 7d or 7f to be passed as data
-
-			switch (msgId)
-			{
-			case  GDL90_ID_HEARTBEAT:
-			{
-				statusByteRec1 test;
-
-				test.statusByte = 1;
-
-				test.statusByte = 0x8;
-
-				mLatetestHeartbeat.msgId = msgBuf[1];
-				mLatetestHeartbeat.statusByte1.statusByte = msgBuf[2];
-				mLatetestHeartbeat.statusByte2.statusByte = msgBuf[3];
-
-				mLatetestHeartbeat.timestamp = (mLatetestHeartbeat.statusByte2.bits.timestamp << 16) + (msgBuf[5] << 8) + msgBuf[4];
-
-				mLatetestHeartbeat.msgCounts = (msgBuf[6] << 8) + msgBuf[7];
-
-				mLatetestHeartbeat.crc = (msgBuf[8] << 8) + msgBuf[9];
-			}
-			break;
-
-			case  GDL90_ID_INIT:
-				status = status;
-
-				break;
-
-			case  GDL90_ID_UPLINK_DATA:
-			{
-				// length expecected to be 436 bytes long
-				// possibly 24 bytes of uplink msgType, UAT Heder, then data
-
-				timeOfReception = (msgBuf[2] << 16) + (msgBuf[3] << 8) + msgBuf[4];
-
-				reportLen = msgSize - 5;  // 5 becuase of the flag byte
-
-				double latitude;
-				double longitude;
-
-				int raw_lat = (msgBuf[5] << 15) | (msgBuf[6] << 7) | (msgBuf[7] >> 1);
-				latitude = raw_lat * GDL90_LAT_LONG_RES;
-
-				int raw_lon = ((msgBuf[7] & 0x01) << 23) | (msgBuf[8] << 15) | (msgBuf[9] << 7) | (msgBuf[10] >> 1);
-				longitude = raw_lon * GDL90_LAT_LONG_RES;
-
-				latitude = (msgBuf[5] << 15) + (msgBuf[6] << 7) + ((msgBuf[7] >> 1) & 0x7f);
-				latitude *= GDL90_LAT_LONG_RES;
-
-				longitude = ((msgBuf[7] & 1) << 23) + (msgBuf[8] << 15) + (msgBuf[9] & 0xFE);
-
-
-
-				longitude *= GDL90_LAT_LONG_RES;
-
-				if (longitude > 180.0)
-				{
-					longitude = 360.0 - longitude;
-				}
-
-				bool validPos = (msgBuf[10] & 0x80) == 0x80;
-				bool utcCoupled = (msgBuf[11] & 0x01) == 0x01;
-				bool appDataValid = (msgBuf[11] & 0x04) == 0x04;
-
-				bool position_valid = (msgBuf[10] & 0x01) ? 1 : 0;
-				bool app_data_valid = (msgBuf[11] & 0x20) ? 1 : 0;
-				int slot_id = (msgBuf[11] & 0x1f);
-				int tisb_site_id = (msgBuf[12] >> 4);
-
-				unsigned char slotId = msgBuf[11] & 0x1F;
-				unsigned char tisbSiteId = (msgBuf[12] >> 4) & 0x0F;
-
-				if (app_data_valid == true)
-				{
-#ifdef LATER
-					status = ParseApplicationData(reportLen - 8, &msgBuf[13]);
-#endif // LATER
-				}
-				status = status;
-			}
-
-			break;
-
-			case  GDL90_ID_OWNSHIP:
-				setOwnshipCallsign = true;
-		// no break here fall through to GDL90_ID_TRAFFIC
-
-			case  GDL90_ID_TRAFFIC:
-			{
-				struct trafficReportNumRec trafficData;
-				unsigned int dataIndex = 0;
-
-				status = DecodeTrafficMessage(msgSize, &msgBuf[1], trafficData);
-
-				if (status == 0)
-				{
-					if (filterData == true)
-					{
-						tempDataPtr = GetAircraftInfo(trafficData.callsign, dataIndex);
-					}
-
-					if (tempDataPtr == NULL)
-					{
-						tempDataPtr = new struct trafficReportNumRec;
-
-						mAircraftInfoList.push_back(tempDataPtr);
-
-						dataIndex = mAircraftInfoList.size() - 1;
-
-						if (setOwnshipCallsign == true)
-						{
-							setOwnshipCallsign = false;
-
-							mOwnshipCallsign = trafficData.callsign;
-						}
-					}
-
-					if (tempDataPtr != NULL)
-					{
-						CopyAircraftData(trafficData, *tempDataPtr);
-
-						mLastCallsign = trafficData.callsign;
-
-						mLastDataIndex = dataIndex;
-					}
-				}
-			}
-			break;
-
-
-			case  GDL90_ID_STRATUX_HEARTBEAT0:
-			{
-				status = 0;
-
-				int gpsValid = (msgBuf[2] & 0x02) >> 1;
-				int ahrsValid = (msgBuf[2] & 0x01);
-				int protVerValid = (msgBuf[2] & 0x04) >> 2;
-
-				int protVer = msgBuf[3];
-			}
-			break;
-
-			case  GDL90_ID_STRATUX_HEARTBEAT1:
-				status = 0;
-
-				break;
-
-
-			case  GDL90_ID_STRATUX_AHRS:
-			{
-				subMsgId = msgBuf[2];
-
-				mStatuxAhrsData.roll = ((msgBuf[3] << 8) + msgBuf[4]) * 0.1f;
-				mStatuxAhrsData.pitch = ((msgBuf[5] << 8) + msgBuf[6]) * 0.1f;
-
-				mStatuxAhrsData.heading = ((msgBuf[7] << 8) + msgBuf[8]) * 0.1f;
-
-				//			mStatuxAhrsData.trueAirspeed = (msgBuf[9] << 8) + msgBuf[10];
-			//				mStatuxAhrsData.indicatedAirspeed = (msgBuf[11] << 8) + msgBuf[12];
-
-				float AHRSRoll = ((msgBuf[3] << 8) + msgBuf[4]) * 0.1f;
-				float AHRSPitch = ((msgBuf[5] << 8) + msgBuf[6]) * 0.1f;
-				float AHRSGyroHeading = ((msgBuf[7] << 8) + msgBuf[8]);
-				float AHRSMagHeading = ((msgBuf[9] << 8) + msgBuf[10]);
-				float AHRSSlipSkid = ((msgBuf[11] << 8) + msgBuf[12]);
-				float AHRSTurnRate = ((msgBuf[13] << 8) + msgBuf[14]);
-				float AHRSGLoad = ((msgBuf[5] << 8) + msgBuf[16]);
-				float AHRSGLoadMin = ((msgBuf[17] << 8) + msgBuf[18]);
-				float AHRSGLoadMax = ((msgBuf[19] << 8) + msgBuf[20]);
-
-				status = status;
-			}
-			break;
-
-			case 0x53:  // GDL90_ID_STRATUX_HEARTBEAT1  aka status message
-
-
-				if (msgBuf[2] == 0x58)
-				{
-					mLastMsgType = 0x5358;
-
-					mStratuxStatusMessage.msgVersion = msgBuf[4];
-
-					memcpy(mStratuxStatusMessage.versionBuf, &msgBuf[5], 4);
-
-					mStratuxStatusMessage.hardwareRevCode = GetUint32(&msgBuf[9]);
-
-					mStratuxStatusMessage.validAndEnableFlags = GetUint16(&msgBuf[13]);
-					mStratuxStatusMessage.connectHardwareFlags = GetUint16(&msgBuf[15]);
-
-					mStratuxStatusMessage.numSatsLocked = msgBuf[17];
-					mStratuxStatusMessage.numSatsConnected = msgBuf[18];
-
-					mStratuxStatusMessage.num978Targets = GetUint16(&msgBuf[19]);
-
-					mStratuxStatusMessage.num1090Targets = GetUint16(&msgBuf[21]);
-
-					mStratuxStatusMessage.num978MsgRate = GetUint16(&msgBuf[23]);
-
-					mStratuxStatusMessage.num1090MsgRate = GetUint16(&msgBuf[25]);
-
-					mStratuxStatusMessage.cpuTemp = (float)GetUint16(&msgBuf[27])  * 0.1f;
-
-					mStratuxStatusMessage.numAdsbTowers = msgBuf[29];
-
-					double towerLat;
-					double towerLon;
-
-					int bufIndex = 30;
-					for (int index = 0; index < mStratuxStatusMessage.numAdsbTowers; index++)
-					{
-						GetGeodeticLocation(&msgBuf[bufIndex], towerLat);
-
-						bufIndex += 3;
-
-						GetGeodeticLocation(&msgBuf[bufIndex], towerLon);
-
-						bufIndex += 3;
-					}
-
-					// adsb tower locations would follow if we ever saw any
-
-				}
-				else
-				{
-					status = status;
-				}
-			break;
-
-			case 0x65:  // ForeFront AHRS message  -- or GPS time -f 12 bytes see _messages.py _parseGpsTime
-			{
-				unsigned short tempShrt;
-
-				if (msgBuf[2] == 0x1)  // AHRS message
-				{
-					struct ahrsMsgRec ahrsMsgBuf;
-
-					//						memcpy(&ahrsMsgBuf, &msgBuf[1], sizeof(struct ahrsMsgRec));
-
-					// bad values in pitch and roll needs more debugging
-
-					tempShrt = GetUint16(&msgBuf[3]);
-					mAhrsData.roll = (float)tempShrt * 0.1f;
-
-					tempShrt = GetUint16(&msgBuf[5]);
-					mAhrsData.pitch = (float)tempShrt * 0.1f;
-
-					tempShrt = GetUint16(&msgBuf[7]);
-
-					bool useTrueHeading = false;
-
-					if (tempShrt != 0xffff)
-					{
-						mAhrsData.heading = tempShrt & 0x7ffff;
-
-
-						if ((tempShrt & 0x8000) == 0x8000)
-						{
-							useTrueHeading = true;
-						}
-					}
-					else
-					{
-						mAhrsData.heading = -99999.0;
-					}
-
-					mAhrsData.indicatedAirspeed = GetUint16(&msgBuf[9]);
-					mAhrsData.trueAirspeed = GetUint16(&msgBuf[11]);
-
-					/*
-					_swab(&msgBuf[3], &msgBuf[3], 10);
-
-
-
-					ushortPtr = (unsigned short *)&msgBuf[3];
-
-					float tempRoll =  (float)*ushortPtr * 0.1f;
-
-//						_swab(&msgBuf[1], &msgBuf[1], 2);
-						ushortPtr = (unsigned short *)&msgBuf[5];
-						mAhrsData.pitch = (float)*ushortPtr * 0.1f;
-
-						ushortPtr = (unsigned short *)&msgBuf[7];
-
-						if (*ushortPtr & 0x8000)
-						{
-							mAhrsData.headingIsTrue = false;
-						}
-						else
-						{
-							mAhrsData.headingIsTrue = true;
-						}
-
-						mAhrsData.heading = (float)(*ushortPtr & 0x7FFF) * 0.1f;
-
-						ushortPtr = (unsigned short *)&msgBuf[9];
-						mAhrsData.indicatedAirspeed = (float)*ushortPtr;
-
-						ushortPtr = (unsigned short *)&msgBuf[11];
-						mAhrsData.trueAirspeed = (float)*ushortPtr;
-*/
-				}
-				else
-				{
-					if (msgBuf[2] == 0x0)
-					{
-						status = status;
-					}
-				}
-			}
-			break;
-
-			case GDL90_ID_OWNSHIP_ALTITUDE:  // height above WGS-84 ellipsoid = MSL
-			{
-				// altitude is in increments of 5ft
-
-				short altitude = GetUint16(&msgBuf[2]) * 5;
-				short metrics = GetUint16(&msgBuf[4]);
-
-				status = status;
-
-			}
-			break;
-
-			case GDL90_ID_BASIC_REPORT:
-			{
-				// this should be 22 bytes
-
-				timeOfReception = (msgBuf[2] << 16) + (msgBuf[3] << 8) + msgBuf[4];
-
-				status = DecodePayloadHeader(&msgBuf[5]);
-
-
-	// format types  0 - 15
-	// 5 bits format type
-	// 27 bits surv & comm control
-	// 24 bits address
-
-	// format types 16 - 21
-	// 5 bits format type
-	// 27 bits surv & comm control
-	// 56 bits message field
-	// 24 bits address
-
-	// format type 22 - military use only 
-
-	// format type 24
-	// 5 bits format type
-	// 6 bits surv & comm control
-	// 80 bits message field
-	// 24 bits address
-
-
-				break;
-
-			case GDL90_ID_LONG_REPORT:
-			{
-				// this should be 38 bytes
-
-				timeOfReception = (msgBuf[2] << 16) + (msgBuf[3] << 8) + msgBuf[4];
-
-				reportLen = msgSize - 5;  // 5 because of the flag byte
-
-				status = DecodePayloadHeader(&msgBuf[5]);
-
-				unsigned char format = msgBuf[5] & 0x1F;
-
-//				DecodeAirPositionReport(&msgBuf[5]);
-
-		// format types  0 - 15
-		// 5 bits format type
-		// 27 bits surv & comm control
-		// 24 bits address
-
-		// format types 16 - 21
-		// 5 bits format type
-		// 27 bits surv & comm control
-		// 56 bits message field
-		// 24 bits address
-
-		// format type 22 - military use only 
-
-		// format type 24
-		// 5 bits format type
-		// 6 bits surv & comm control
-		// 80 bits message field
-		// 24 bits address
-
-
-			}
-			break;
-
-			default:
-				status = status;
-				break;
-			}
-
-			}
-		}
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeTrafficMessage(unsigned int msgSize,  unsigned char *msgBuf,
-									struct trafficReportNumRec &trafficData)
-{
-	int status = -1;
-
-	ClearAircraftData(trafficData);
-
-	if ((msgBuf[0] == GDL90_ID_OWNSHIP) || (msgBuf[0] == GDL90_ID_TRAFFIC))
-	{
-		trafficData.lastUpdate = mLatetestHeartbeat.timestamp;
-
-		trafficData.addressType = (msgBuf[1] & 0xF);
-		trafficData.alertStatus = (msgBuf[1] >> 4) & 0xF;
-		
-		trafficData.participantAddr = (msgBuf[2] << 16) + (msgBuf[3] << 8) + msgBuf[4];
-
-		if (trafficData.participantAddr < 0x100)
-		{
-			status = status;
-		}
-
-		double location;
-
-		GetGeodeticLocation(&msgBuf[5], trafficData.latitude);
-
-		if (trafficData.latitude > 90.0)
-		{
-			trafficData.latitude -= 90.0;
-		}
-
-		GetGeodeticLocation(&msgBuf[8], trafficData.longitude);
-
-		if (trafficData.longitude > 180.0)
-		{
-			trafficData.longitude -= 360.0;
-		}
-
-		int altitude = ((int32_t)(msgBuf[11])) << 4;
-		altitude += (msgBuf[12] & 0xF0) >> 4;
-		trafficData.altitude = (altitude * 25) - 1000;
-
-		trafficData.miscIndicators = msgBuf[12] & 0xF;
-		trafficData.integrityCode = (msgBuf[13] >> 4) & 0xF;
-		trafficData.accuracyCode = msgBuf[13] & 0xF;
-
-		int tempInt = 0;
-
-		if (msgBuf[14] > 0)
-		{
-			status = status;
-		}
-// horiz velocity
-		tempInt = ((msgBuf[14] << 4) + ((msgBuf[15] & 0xf0) >> 4));
-
-		if (tempInt == 0xfff)
-		{
-			trafficData.horzVelocity = 4094;
-		}
-		else if (tempInt == 0xffe)
-		{
-			trafficData.horzVelocity = 4095;  // max value
-		}
-		else
-		{
-			trafficData.horzVelocity = tempInt;
-		}
-
-// vertical velocity
-		tempInt = ((msgBuf[15] & 0x0f) << 8) + msgBuf[16];
-
-		if (tempInt <= 0x1FD)
-		{
-			trafficData.vertVelocity = tempInt * 64;
-		}
-		else if ((tempInt | 0x800) == 0x800)
-		{
-			if (tempInt == 0x800)
-			{
-				trafficData.vertVelocity = 0;
-			}
-			else
-			{
-				int tempInt2 = tempInt & 0x7fff;
-
-				trafficData.vertVelocity = tempInt2 * -64;
-			}
-		}
-
-		trafficData.trackHeading = msgBuf[17] * 360.0f / 256.0f;
-		trafficData.emitterCategory = msgBuf[18];
-
-		char tempBuf[9];
-		memcpy(tempBuf, &msgBuf[19], 8);
-		tempBuf[8] = 0; // add EOS
-
-		int tempIndex = 7;
-
-		while ((tempIndex > 0) && (msgBuf[tempIndex] == ' '))
-		{
-			msgBuf[tempIndex] = 0;
-			tempIndex--;
-		}
-		trafficData.callsign = tempBuf;
-
-		trafficData.emergencyPriorityCode = (msgBuf[27] & 0xf0) >> 4;
-
-		// 2 bytes CRC at end of message followed by 7E flag byte
-
-		// need to add code to test crc and other data then set status;
-
-		unsigned int msgCrc = (msgBuf[28] << 8) + msgBuf[29];
-
-		unsigned int calcCrc = CrcCompute(&msgBuf[1], 28);
-
-		unsigned int calcCrc2 = gen_crc16(&msgBuf[1], 28);
-
-		status = 0;
-	}
-
-	return(status);
-}
-
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::CopyAircraftData(struct trafficReportNumRec &srcData,
-	struct trafficReportNumRec&tgtData)
-{
-	tgtData.alertStatus = srcData.alertStatus;
-	tgtData.addressType = srcData.addressType;
-	tgtData.participantAddr = srcData.participantAddr;
-	tgtData.latitude = srcData.latitude;
-	tgtData.longitude = srcData.longitude;
-	tgtData.altitude = srcData.altitude;
-	tgtData.miscIndicators = srcData.miscIndicators;
-	tgtData.integrityCode = srcData.integrityCode;
-	tgtData.accuracyCode = srcData.accuracyCode;
-	tgtData.horzVelocity = srcData.horzVelocity;
-	tgtData.vertVelocity = srcData.vertVelocity;
-	tgtData.trackHeading = srcData.trackHeading;
-	tgtData.emitterCategory = srcData.emitterCategory;
-	tgtData.callsign = srcData.callsign;
-
-	tgtData.name = srcData.name;
-	tgtData.nNumber = srcData.nNumber;
-	tgtData.typeAircraft = srcData.typeAircraft;
-	tgtData.typeEngine = srcData.typeEngine;
-
-	tgtData.emergencyPriorityCode = srcData.emergencyPriorityCode;
-
-	tgtData.lastUpdate = time(NULL);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::ClearAircraftData(struct trafficReportNumRec &tgtData)
-{
-	tgtData.alertStatus = 0;
-	tgtData.addressType = 0;
-	tgtData.participantAddr = 0;
-	tgtData.latitude = 0.0;
-	tgtData.longitude = 0.0;
-	tgtData.miscIndicators = 0;
-	tgtData.integrityCode = 0;
-	tgtData.accuracyCode = 0;
-	tgtData.horzVelocity = 0;
-	tgtData.vertVelocity = 0;
-	tgtData.trackHeading = 0;
-	tgtData.emitterCategory = 0;
-	tgtData.callsign.erase();
-	tgtData.emergencyPriorityCode = 0;
-	tgtData.lastUpdate = 0;
-
-	tgtData.name.clear();
-	tgtData.nNumber.clear();
-	tgtData.typeAircraft = 0;
-	tgtData.typeEngine = 0;
-
-}
-
-///////////////////////////////////////////////////////////////////////////////
-struct AdsbWrapper::trafficReportNumRec *AdsbWrapper::GetAircraftInfo(
-	std::string callsign, unsigned int &dataIndex)
-{
-	struct trafficReportNumRec *reportPtr = NULL;
-	QList<struct trafficReportNumRec *> ::iterator infoIter;
-	bool found = false;
-	int tempIndex = 0;
-
-	dataIndex = 0;
-	infoIter = mAircraftInfoList.begin();
-	while ((found != true) && (infoIter != mAircraftInfoList.end()))
-	{
-		if ((*infoIter)->callsign == callsign)
-		{
-			found = true;
-
-			reportPtr = *infoIter;
-
-			dataIndex = tempIndex;
-		}
-		else
-		{
-			infoIter++;
-
-			tempIndex++;
-		}
-	}
-	return(reportPtr);
-}
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::CrcInit(void)
-{
-	unsigned short i, bitctr, crc;
-	for (i = 0; i < 256; i++)
-	{
-		crc = (i << 8);
-		for (bitctr = 0; bitctr < 8; bitctr++)
-		{
-			crc = (crc << 1) ^ ((crc & 0x8000) ? 0x1021 : 0);
-		}
-		mCrc16Table[i] = crc;
-	}
-}
-///////////////////////////////////////////////////////////////////////////////
-unsigned int AdsbWrapper::CrcCompute( // Return  CRC of the block
-	unsigned char *block, // i  Starting address of message
-	unsigned int length // i  Length of message
-	)
-{
-	unsigned int i;
-	unsigned short crc = 0;
-
-	for (i = 0; i < length; i++)
-	{
-		crc = mCrc16Table[crc >> 8] ^ (crc << 8) ^ block[i];
-	}
-	return crc;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::SerializeTrafficData(unsigned int dataIndex, char delimiter,
-	std::string &serializedData)
-{
-	int status = -1;
-
-	if (dataIndex < mAircraftInfoList.size())
-	{
-		struct trafficReportNumRec *dataPtr = mAircraftInfoList.at(dataIndex);
-
-		if (dataPtr != NULL)
-		{
-			status = SerializeTrafficData(dataPtr, delimiter, serializedData);
-		}
-	}
-
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::SerializeTrafficData(struct AdsbWrapper::trafficReportNumRec *dataPtr,
-	char delimiter, std::string &serializedData)
-{
-	int status = -1;
-	char dataBuf[512];
-
-	if (dataPtr != NULL)
-	{
-		sprintf(dataBuf,
-			"%d%c"  // timestamp
-			"%s%c" // callsign
-			"%d%c" // address type
-			"%x%c" // participant address 
-			"%s%c" // n number
-			"%3.12lf%c" // latitude
-			"%3.12lf%c" // longitude
-			"%d%c"  // altitude
-			"%d%c" // alert status 
-			"%d%c" // misc indicator
-			"%d%c" // integrity code
-			"%d%c" // accuracy
-			"%d%c" // horiz vel
-			"%d%c" // vert velocity
-			"%f%c" // track heading
-			"%d%c" // emitter category
-			"%d%c" // prioity code
-			"%f%c" // range
-			"%f\n",  // bearing
-			mLatetestHeartbeat.timestamp, delimiter,
-			dataPtr->callsign.c_str(), delimiter,
-			dataPtr->addressType, delimiter,
-			dataPtr->participantAddr, delimiter,
-			dataPtr->nNumber.c_str(), delimiter,
-			dataPtr->latitude, delimiter,
-			dataPtr->longitude, delimiter,
-			dataPtr->altitude, delimiter,
-			dataPtr->alertStatus, delimiter,
-			dataPtr->miscIndicators, delimiter,
-			dataPtr->integrityCode, delimiter,
-			dataPtr->accuracyCode, delimiter,
-			dataPtr->horzVelocity, delimiter,
-			dataPtr->vertVelocity, delimiter,
-			dataPtr->trackHeading, delimiter,
-			dataPtr->emitterCategory, delimiter,
-			dataPtr->emergencyPriorityCode, delimiter,
-			dataPtr->range, delimiter,
-			dataPtr->bearing
-		);
-
-		serializedData = dataBuf;
-
-		status = 0;
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetNumTrafficReports()
-{
-	return(mAircraftInfoList.size());
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetLastMsgType()
-{
-	return(mLastMsgType);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::GetSatelliteCnt(int &numConnected, int &numLocked)
-{
-	numLocked = mStratuxStatusMessage.numSatsLocked;
-	numConnected  = mStratuxStatusMessage.numSatsConnected;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::GetTargetCnt(int &num978Targets, int &num1090Targets)
-{
-	num978Targets = mStratuxStatusMessage.num978Targets;
-
-	num1090Targets = mStratuxStatusMessage.num1090Targets;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::GetTowerCnt(int &numTowers)
-{
-	numTowers = mStratuxStatusMessage.numAdsbTowers;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::GetLastCallsign(std::string &callsign)
-{
-	callsign = mLastCallsign;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetLastDataIndex()
-{
-	return(mLastDataIndex);
-}
-///////////////////////////////////////////////////////////////////////////////
-struct AdsbWrapper::trafficReportNumRec *AdsbWrapper::GetTrafficInfo(
-							std::string callsign, unsigned int &dataIndex)
-{
-	bool found = false;
-	struct trafficReportNumRec *acInfoPtr = NULL;
-	QList<struct trafficReportNumRec *> ::iterator acIter;
-	int tempIndex = 0;
-
-	dataIndex = 0;
-
-	acIter = mAircraftInfoList.begin();
-	while ((found != true) && (acIter != mAircraftInfoList.end()))
-	{
-		if ((*acIter)->callsign == callsign)
-		{
-			found = true;
-
-			acInfoPtr = *acIter;
-
-			dataIndex = tempIndex;
-		}
-		else
-		{
-			acIter++;
-
-			tempIndex++;
-		}
-	}
-
-	return(acInfoPtr);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetParticipantAddress(std::string callsign, unsigned char &addrType,
-										unsigned int &address)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		addrType = infoPtr->addressType;
-		address = infoPtr->participantAddr;
-
-		status = 0;
-	}
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetLastUpdate(std::string callsign, unsigned int &updateTime)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		updateTime = infoPtr->lastUpdate;
-
-		status = 0;
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetLocation(std::string callsign,
-	double &latitude, double &longitude, double &altitude)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		latitude = infoPtr->latitude;
-		longitude = infoPtr->longitude;
-		altitude = infoPtr->altitude;
-		status = 0;
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetHeading(std::string callsign, float &heading)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		heading = infoPtr->trackHeading;
-
-		status = 0;
-	}
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetHorzVelocity(std::string callsign, float& velocity)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		velocity = infoPtr->horzVelocity;
-
-		status = 0;
-	}
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetVertVelocity(std::string callsign, float &velocity)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		velocity = infoPtr->vertVelocity;
-
-		status = 0;
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetAircraftOwnerInfo(std::string callsign, unsigned int &address,
-	std::string &nNumber, std::string &name, int &typeAircraft, int &typeEngine)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		address = infoPtr->address;
-		nNumber = infoPtr->nNumber;
-		name = infoPtr->name;
-		typeAircraft = infoPtr->typeAircraft;
-		typeEngine = infoPtr->typeEngine;
-
-		status = 0;
-	}
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::SetAircraftOwnerInfo(std::string callsign, unsigned int address,
-	std::string nNumber, std::string name, int typeAircraft, int typeEngine)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		infoPtr->address = address;
-		infoPtr->nNumber = nNumber;
-		infoPtr->name = name;
-		infoPtr->typeAircraft = typeAircraft;
-		infoPtr->typeEngine = typeEngine;
-
-		status = 0;
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::SetRangeValues(std::string callsign, float range, float bearing)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		infoPtr->range = range;
-		infoPtr->bearing = bearing;
-
-		status = 0;
-	}
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::GetRangeValues(std::string callsign, float &range, float &bearing)
-{
-	int status = -1;
-	struct trafficReportNumRec *infoPtr;
-	unsigned int dataIndex = 0;
-
-	infoPtr = GetTrafficInfo(callsign, dataIndex);
-
-	if (infoPtr != NULL)
-	{
-		range = infoPtr->range;
-		bearing = infoPtr->bearing;
-
-		status = 0;
-
-	}
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::ParseApplicationData(int appDataLen, unsigned char *msgBuf)
-{
-	int status = -1;
-	int dataIndex = 0;
-
-	FILE *fdes;
-	char filename[60];
-
-	sprintf(filename, "appDataDump_%Id.txt", time(NULL));
-
-	fdes = fopen(filename, "wb");
-
-if (fdes != NULL)
-{
-	fwrite(msgBuf, 1, appDataLen, fdes);
-
-	fclose(fdes);
-}
-
-	if ((appDataLen > 0) && (msgBuf != NULL))
-	{
-		int iFrameLen = (msgBuf[dataIndex] << 1) + ((msgBuf[dataIndex + 1] >> 7) & 0x01);
-		int frameType = msgBuf[dataIndex + 1] & 0x0F;
-
-		while ((dataIndex < appDataLen))
-		{
-			if ((msgBuf[dataIndex] == 0xff) && (msgBuf[dataIndex + 1] == 0xfe))
-			{
-				status = status;
-			}
-			dataIndex += iFrameLen;
-			
-			iFrameLen = (msgBuf[dataIndex] << 1) + ((msgBuf[dataIndex + 1] >> 7) & 0x01);
-			frameType = msgBuf[dataIndex + 1] & 0x0F;
-
-//			dataIndex++;
-		}
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-unsigned int AdsbWrapper::GetLatestTimestamp()
-{
-	return(mLatetestHeartbeat.timestamp);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void AdsbWrapper::GetOwnshipCallsign(std::string &callsign)
-{
-	callsign = mOwnshipCallsign;
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeAirPositionReport(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	unsigned char survStatus = (msgBuf[0] >> 5) & 0x03;
-	unsigned char nicSup = (msgBuf[0] >> 7) & 0x01;
-	int alt = (msgBuf[1] << 4) + ((msgBuf[2] >> 4) & 0x0F);
-	unsigned char timeVal = (msgBuf[2] >> 5) & 0x01;
-	unsigned char cprOdd = (msgBuf[2] >> 6) & 0x01;
-	unsigned int latCpr = (((msgBuf[2] >> 7) & 0x03) << 17) + (msgBuf[3] << 16) + ((msgBuf[4] >> 1) & 0x7f);
-	unsigned int lonCpr = (((msgBuf[4] >> 7) & 0x01) << 17) + (msgBuf[5] << 16) + (msgBuf[6] << 8) + msgBuf[7];
-
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-
-static char base40_alphabet[40] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeCallsign(unsigned char *msgBuf,
-			unsigned char &emitterCategory, std::string &callsign)
-{
-	int status = 0;
-
-	if (msgBuf != NULL)
-	{
-	char localBuf[9];
-
-	unsigned short value = (msgBuf[0] << 8) | (msgBuf[1]);
-
-	emitterCategory = (value / 1600) % 40;
-
-	localBuf[0] = base40_alphabet[(value / 40) % 40];
-	localBuf[1] = base40_alphabet[value % 40];
-	
-	value = (msgBuf[2] << 8) | (msgBuf[3]);
-	localBuf[2] = base40_alphabet[(value / 1600) % 40];
-	localBuf[3] = base40_alphabet[(value / 40) % 40];
-	localBuf[4] = base40_alphabet[value % 40];
-	
-	value = (msgBuf[4] << 8) | (msgBuf[5]);
-	localBuf[5] = base40_alphabet[(value / 1600) % 40];
-	localBuf[6] = base40_alphabet[(value / 40) % 40];
-	localBuf[7] = base40_alphabet[value % 40];
-	localBuf[8] = 0;
-
-	callsign = localBuf;
-
-	}
-
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodePayloadHeader(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	if (msgBuf != NULL)
-	{
-		int addressQualifier = msgBuf[0] & 0x07;
-
-		if (addressQualifier != 0)
-		{
-			switch (addressQualifier)
-			{
-				
-				case 0:
-					// 0 ADS - B target with ICAO 24 - bit address 3.2.1.5.1.3.1				
-
-					status = status;
-				break;
-			
-				case 1:
-					// 1 ADS - B target with self - assigned temporary address 3.2.1.5.1.3.2
-
-					status = status;
-				break;
-			
-				case 2:
-					//2 TIS - B target with ICAO 24 - bit address 3.2.1.5.1.3.3
-					status = status;
-				break;
-			
-				case 3:
-					// 3 TIS - B target with track file identifier 3.2.1.5.1.3.4
-					status = status;
-				break;
-
-				case 4:
-					// 4 Surface Vehicle 3.2.1.5.1.3.5
-					status = status;
-				break;
-			
-				case 5:
-					// 5 Fixed ADS - B Beacon 3.2.1.5.1.3.6
-					status = status;
-				break;
-
-				case 6:
-				case 7:
-					// 6 (Reserved)
-					// 7 (Reserved)
-				break;
-
-				default:
-					status = status;
-				break;
-			}
-		}
-
-		int payloadTypeCode = (msgBuf[0] >> 3) & 0x1f;
-
-		unsigned int address = (msgBuf[1] << 16) + (msgBuf[2] << 8) + msgBuf[3];
-
-		if ((payloadTypeCode <= 10) && ((addressQualifier == 0) ||
-			(addressQualifier == 1) || (addressQualifier == 4) || (addressQualifier == 5)))
-		{
-			status = DecodeStateVector(&msgBuf[4]);
-		}
-		else
-		{
-			status = status;
-		}
-
-		if ((payloadTypeCode == 1) || (payloadTypeCode == 3))
-		{
-			// decode Mode State message and Aux SV message -- refer to table 2-8 for rest of the payload types
-
-			DecodeModeStatus(&msgBuf[17]);
-		}
-
-		if ((payloadTypeCode == 1) || (payloadTypeCode == 2) || (payloadTypeCode == 5) || (payloadTypeCode == 6))
-		{
-			DecodeAuxiliaryStateVector(&msgBuf[29]);
-		}
-
-		if ((payloadTypeCode == 3) || (payloadTypeCode == 4))
-		{
-			DecodeTargetState(&msgBuf[29]);
-		}
-
-		if (payloadTypeCode == 6)
-		{
-			DecodeTargetState(&msgBuf[24]);
-		}
-
-		status = status;
-
-	}
-
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-// used the following doc to decode this
-// UAT-SWG02-WP04 - Draft Tech Manual V0-1.pdf
-// and libmodes-master\src\mode-s.c
-// UAT State vector
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeStateVector(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	if (msgBuf != NULL)
-	{
-		unsigned int latValue = (msgBuf[0] << 15) + (msgBuf[1] << 7) + ((msgBuf[2] >> 1) & 0x7F);
-		double latitude = latValue * GDL90_LAT_LONG_RES;
-
-		if (latitude > 90.0)
-		{
-			latitude -= 90.0;
-		}
-
-		unsigned lonValue = ((msgBuf[2] & 0x01) << 23) + (msgBuf[3] << 15) + (msgBuf[4] << 7) + ((msgBuf[5] >> 1) & 0x7f);
-		double longitude = lonValue * GDL90_LAT_LONG_RES;
-
-		if (longitude > 180.0f)
-		{
-			longitude -= 360.0;
-		}
-
-		unsigned char altType = msgBuf[5] & 0x01;  // 0 = Barametric Preasure Alt, 1 = geometric Alt.
-
-// altitude based on 12 bit code
-		unsigned int altValue = (msgBuf[6] << 4) + ((msgBuf[7] >> 4) & 0x0f);
-
-		unsigned int altitude = (altValue * 25) - 1000;
-
-		unsigned char nic = msgBuf[7] & 0x0f;
-
-	// agState - 00 airborne subsonic, 01 = airborne supersonic,  10 on ground, 11 reserved
-		unsigned char agState = (msgBuf[8] >> 6) & 0x03;
-
-		bool southVelocity = false;
-
-		int northHorzVel = ((msgBuf[8] & 0x1F) << 6) + (msgBuf[9] >> 2);
-
-		if (((northHorzVel >> 11) & 0x01) == 0x01)
-		{
-			southVelocity = true;
-		}
-
-		int eastHorzVel = ((msgBuf[9] & 0x03) << 9) + (msgBuf[10] << 1) + ((msgBuf[11] >> 7) & 0x01);
-
-		bool westVelocity = false;
-
-		if (((eastHorzVel >> 11) & 0x01) == 0x01)
-		{
-			westVelocity = true;
-		}
-
-		int vertVel = ((msgBuf[11] & 0x7F) << 4) + ((msgBuf[12] >> 4) & 0x0F);
-
-		unsigned char utc = (msgBuf[12] >> 3) & 0x01;
-
-		status = status;
-	}
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeModeStatus(unsigned char *msgBuf)
-{
-	int status = -1;
-	std::string callsign;
-	unsigned char emitterCategory;
-
-	// callsign uses bytes 0 -> 5
-
-	DecodeCallsign(msgBuf, emitterCategory, callsign);
-
-	unsigned char priorityStatus = (msgBuf[6] >> 5) & 0x07;  // 3 MSB bits
-	unsigned char mopsVersion = ((msgBuf[6] >> 2) & 0x07);  // next 3 bits
-	unsigned char sil = msgBuf[6] & 0x03;  // the 2 LSBs
-
-	unsigned char transmitMso = (msgBuf[7] >> 2) & 0x3F;  // high 6 bits
-
-	unsigned char nacp = (msgBuf[8] >> 4) & 0x0F;  // 4 MSBs
-	unsigned char nacv = (msgBuf[8] >> 1) & 0x07;
-	unsigned char nicBaro = msgBuf[8] & 0x01;
-
-	unsigned char capabilityCodes = (msgBuf[9] >> 6) & 0x03; // 2 MSBs
-	unsigned char opModes = (msgBuf[9] >> 3) & 0x07;  // next 3 bits
-	unsigned char trueMag = (msgBuf[9] >> 2) & 0x01;
-	unsigned char csid = (msgBuf[9] >> 1) & 0x01;
-	// last bit is reserved
-
-	// last 2 bytes are reserved
-
-
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeCapabilityCodes(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeAuxiliaryStateVector(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	if (msgBuf != NULL)
-	{
-		unsigned int altValue = (msgBuf[0] << 4) + ((msgBuf[1] >> 4) & 0x0F);
-
-		unsigned int altitude = (altValue * 25) - 1000;
-
-		status = 0;
-	}
-
-	return(status);
-}
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeTargetState(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	return(status);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-int AdsbWrapper::DecodeTrajectoryChange(unsigned char *msgBuf)
-{
-	int status = -1;
-
-	return(status);
-}
+//
+// AdsbWrapper.cpp: ADSB decoding 
+//
+// Copyright (c) 2019 Bruce Clay
+
+// Portions of thei code was adapted from dump1090 and dump978
+// Copyright (c) 2017 Oliver Jowett <oliver@mutability.co.uk>
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include <stddef.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <time.h>
+#include <charconv>
+#include <chrono>
+#include <QTime>
+
+#include "AdsbWrapper.h"
+#include "AircraftJson.h"
+#include "CaptureWriter.h"
+#include "FisbDecoder.h"
+#include "Gdl90Crc.h"
+#include "Gdl90Encoder.h"
+#include "Gdl90Fields.h"
+#include "Gdl90Unstuff.h"
+#include "TrafficRecordWriter.h"
+
+AdsbWrapper::AdsbWrapper()
+{
+	ClearAhrsData(mAhrsData);
+	ClearAhrsData(mStatuxAhrsData);
+
+	ClearHeartbeatInfo(mLatetestHeartbeat);
+	ClearHeartbeatInfo(mTestHeartbeat);
+
+	mLastSlotId = -1;
+	mLastCallsign = "none";
+
+	mNumCrcErrors = 0;
+	mNumShortFrames = 0;
+
+	mClockTime = 0;
+
+	for (int addrType = 0; addrType < ADSB_NUM_ADDRESS_TYPES; addrType++)
+	{
+		mTimeToLive[addrType] = ADSB_DEFAULT_TIME_TO_LIVE;
+	}
+	mTimeToLive[tisbWithIcaoAddress] = ADSB_DEFAULT_TISB_TIME_TO_LIVE;
+	mTimeToLive[tisbWithTrackFileId] = ADSB_DEFAULT_TISB_TIME_TO_LIVE;
+	mTimeToLive[surfaceVehicle] = ADSB_DEFAULT_SURFACE_TIME_TO_LIVE;
+
+	mHistoryHead = 0;
+	mHistoryCount = 0;
+	mHistoryRing.assign(ADSB_DEFAULT_HISTORY_LIMIT, -1);
+
+	mSnapshotInterval = 0;
+	mLastSnapshotTime = 0;
+	mTrafficCapacity = 0;
+
+	mChangeVersion = 0;
+
+	mRemovedHead = 0;
+	mRemovedCount = 0;
+	mRemovedLostVersion = 0;
+
+	SetTrafficCapacity(ADSB_DEFAULT_TRAFFIC_CAPACITY);
+
+	mUplinkCallback = NULL;
+	mUplinkContext = NULL;
+	mUplinkDataValid = false;
+	mUplinkCapture = NULL;
+	mFisbDecoder = NULL;
+
+	mStreamFilterData = true;
+	mFramer.SetFrameCallback(StreamFrameCallback, this);
+	mBatchFramer.SetFrameCallback(BatchFrameCallback, this);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::ClearAhrsData(struct ahrsDataRec &data)
+{
+	data.msgId = 0;
+	data.subMsgId = 0;
+	data.roll = 0.0f;
+	data.pitch = 0.0f;
+	data.heading = 0.0f;
+	data.headingIsTrue = false;
+	data.indicatedAirspeed = 0.0f;
+	data.trueAirspeed = 0.0f;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::ClearHeartbeatInfo(struct heartbeatMsgRec &msg)
+{
+	msg.msgId = 0;;
+	msg.statusByte1.statusByte = 0;
+	msg.statusByte2.statusByte = 0;
+	msg.timestamp = 0;
+	msg.msgCounts = 0;
+	msg.crc = 0;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::ClearTrafficDataList()
+{
+	if (mTrafficFeed.IsWanted(trafficChangeExpired) == true)
+	{
+		struct trafficChangeRec change;
+
+		for (unsigned int dataIndex = 0; dataIndex < mTrafficStore.GetCount(); dataIndex++)
+		{
+			GetTrafficReport(dataIndex, change.report);
+
+			change.slotId = mTrafficStore.GetSlotId(dataIndex);
+			change.changedFields = TRAFFIC_FIELD_ALL;
+			change.kind = trafficChangeExpired;
+			change.reserved = 0;
+
+			mTrafficFeed.Publish(change);
+		}
+	}
+
+	for (unsigned int dataIndex = 0; dataIndex < mTrafficStore.GetCount(); dataIndex++)
+	{
+		AddRemovedTarget(mTrafficStore.addressType[dataIndex],
+			mTrafficStore.participantAddr[dataIndex]);
+	}
+
+	mTrafficStore.Clear();
+	mTrafficGrid.Clear();
+
+	mExpiryWheel.Clear();
+
+	mHistoryRing.assign(mHistoryRing.size(), -1);
+	mHistorySlotPos.clear();
+	mHistoryHead = 0;
+	mHistoryCount = 0;
+
+	mLastSlotId = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// seconds a target of the given address type is kept after its last report,
+// 0 keeps it until ClearTrafficDataList
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetTrafficTimeToLive(unsigned char addressType, unsigned int seconds)
+{
+	if (addressType < ADSB_NUM_ADDRESS_TYPES)
+	{
+		mTimeToLive[addressType] = seconds;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetTrafficTimeToLive(unsigned char addressType)
+{
+	unsigned int seconds = 0;
+
+	if (addressType < ADSB_NUM_ADDRESS_TYPES)
+	{
+		seconds = mTimeToLive[addressType];
+	}
+	return(seconds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// targets are stamped and expired on time(NULL) unless a clock time is set,
+// replaying a capture sets it from each record so the result doesn't depend
+// on the replay speed.  0 goes back to time(NULL).  the expiry wheel never
+// runs backwards, set it before the first frame is decoded
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetClockTime(time_t now)
+{
+	mClockTime = now;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+time_t AdsbWrapper::GetClockTime()
+{
+	return((mClockTime != 0) ? mClockTime : time(NULL));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// drop every target whose time to live has run out, DecodeFrame calls this
+// on its own but an idle feed needs the caller to call it now and then.
+// returns the number of targets removed
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ExpireTraffic(time_t now)
+{
+	int numExpired = 0;
+
+	mExpiredSlots.clear();
+
+	if (mExpiryWheel.Advance(now, mExpiredSlots) > 0)
+	{
+		for (unsigned int index = 0; index < mExpiredSlots.size(); index++)
+		{
+			int dataIndex = mTrafficStore.GetDataIndex(mExpiredSlots[index]);
+
+			if (dataIndex >= 0)
+			{
+				RemoveTraffic(dataIndex);
+
+				numExpired++;
+			}
+		}
+	}
+	return(numExpired);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// with filterData off each report is kept as its own entry, this caps how
+// many of those entries are kept with the oldest going first.  0 takes the
+// cap off.  the snapshot grows to fit, call before any thread reads it
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetHistoryLimit(unsigned int maxReports)
+{
+	std::vector<int> historySlots;
+
+	while (mHistoryCount > 0)
+	{
+		int slotId = mHistoryRing[mHistoryHead];
+
+		if (slotId >= 0)
+		{
+			historySlots.push_back(slotId);
+
+			mHistorySlotPos[slotId] = -1;
+		}
+
+		mHistoryHead = (mHistoryHead + 1) % mHistoryRing.size();
+		mHistoryCount--;
+	}
+
+	mHistoryRing.assign(maxReports, -1);
+	mHistoryHead = 0;
+
+	if (maxReports > 0)
+	{
+		for (unsigned int index = 0; index < historySlots.size(); index++)
+		{
+			AddHistoryEntry(historySlots[index]);
+		}
+	}
+
+	SizeTrafficSnapshot();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// preallocate the traffic table and the per target bookkeeping so that once
+// maxTargets targets have been seen decoding a traffic report doesn't touch
+// the heap.  more targets than this still work, the tables just grow.  the
+// snapshot holds the larger of maxTargets and the history limit, anything
+// past that is left out and counted, see GetNumSnapshotTruncated.  call
+// before any thread reads the snapshot
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetTrafficCapacity(unsigned int maxTargets)
+{
+	mTrafficCapacity = maxTargets;
+
+	mTrafficStore.Reserve(maxTargets);
+	mTrafficGrid.Reserve(maxTargets);
+	mExpiryWheel.Reserve(maxTargets);
+
+	mExpiredSlots.reserve(maxTargets);
+	mHistorySlotPos.reserve(maxTargets);
+
+	SizeTrafficSnapshot();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// with filterData off the table can hold a whole history's worth of
+// entries, the snapshot has room for that or the traffic capacity.  so does
+// the ring of removed targets
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SizeTrafficSnapshot()
+{
+	unsigned int capacity = mTrafficCapacity;
+
+	if (mHistoryRing.size() > capacity)
+	{
+		capacity = (unsigned int)mHistoryRing.size();
+	}
+
+	if (capacity != mTrafficSnapshot.GetCapacity())
+	{
+		mTrafficSnapshot.SetCapacity(capacity);
+	}
+	mSnapshotRecords.reserve(capacity);
+
+	SizeRemovedRing(capacity);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the newest removals are kept if the ring shrinks
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SizeRemovedRing(unsigned int capacity)
+{
+	if (capacity == mRemovedRing.size())
+	{
+		return;
+	}
+
+	std::vector<struct removedTargetRec> removedTargets;
+
+	while (mRemovedCount > 0)
+	{
+		removedTargets.push_back(mRemovedRing[mRemovedHead]);
+
+		mRemovedHead = (mRemovedHead + 1) % mRemovedRing.size();
+		mRemovedCount--;
+	}
+
+	mRemovedRing.resize(capacity);
+	mRemovedHead = 0;
+
+	unsigned int firstKept = 0;
+
+	if (removedTargets.size() > capacity)
+	{
+		firstKept = (unsigned int)removedTargets.size() - capacity;
+
+		mRemovedLostVersion = removedTargets[firstKept - 1].changeVersion;
+	}
+
+	for (unsigned int index = firstKept; index < removedTargets.size(); index++)
+	{
+		mRemovedRing[mRemovedCount] = removedTargets[index];
+		mRemovedCount++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the target is stamped with a change version of its own like any other
+// change, when the ring is full the oldest removal is lost
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::AddRemovedTarget(unsigned char addressType, unsigned int participantAddr)
+{
+	unsigned long long changeVersion = ++mChangeVersion;
+
+	if (mRemovedRing.empty() == true)
+	{
+		mRemovedLostVersion = changeVersion;
+		return;
+	}
+
+	if (mRemovedCount == mRemovedRing.size())
+	{
+		mRemovedLostVersion = mRemovedRing[mRemovedHead].changeVersion;
+
+		mRemovedHead = (mRemovedHead + 1) % mRemovedRing.size();
+		mRemovedCount--;
+	}
+
+	struct removedTargetRec &removedTarget =
+		mRemovedRing[(mRemovedHead + mRemovedCount) % mRemovedRing.size()];
+
+	removedTarget.changeVersion = changeVersion;
+	removedTarget.participantAddr = participantAddr;
+	removedTarget.addressType = addressType;
+
+	mRemovedCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::AddHistoryEntry(int slotId)
+{
+	if (mHistoryRing.empty() == true)
+	{
+		return;
+	}
+
+	if (mHistoryCount == mHistoryRing.size())
+	{
+		// full, the oldest entry makes room unless it has already expired
+
+		int oldSlotId = mHistoryRing[mHistoryHead];
+
+		mHistoryHead = (mHistoryHead + 1) % mHistoryRing.size();
+		mHistoryCount--;
+
+		if (oldSlotId >= 0)
+		{
+			mHistorySlotPos[oldSlotId] = -1;
+
+			int dataIndex = mTrafficStore.GetDataIndex(oldSlotId);
+
+			if (dataIndex >= 0)
+			{
+				RemoveTraffic(dataIndex);
+			}
+		}
+	}
+
+	unsigned int ringPos = (mHistoryHead + mHistoryCount) % mHistoryRing.size();
+
+	if (slotId >= (int)mHistorySlotPos.size())
+	{
+		mHistorySlotPos.resize(slotId + 1, -1);
+	}
+
+	mHistoryRing[ringPos] = slotId;
+	mHistorySlotPos[slotId] = ringPos;
+
+	mHistoryCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::RemoveTraffic(unsigned int dataIndex)
+{
+	int slotId = mTrafficStore.GetSlotId(dataIndex);
+
+	if (slotId < 0)
+	{
+		return;
+	}
+
+	if (mTrafficFeed.IsWanted(trafficChangeExpired) == true)
+	{
+		struct trafficChangeRec change;
+
+		GetTrafficReport(dataIndex, change.report);
+
+		change.slotId = slotId;
+		change.changedFields = TRAFFIC_FIELD_ALL;
+		change.kind = trafficChangeExpired;
+		change.reserved = 0;
+
+		mTrafficFeed.Publish(change);
+	}
+
+	mExpiryWheel.Cancel(slotId);
+	mTrafficGrid.Remove(slotId);
+
+	// leave a hole in the history ring, it is skipped when it comes round
+
+	if ((slotId < (int)mHistorySlotPos.size()) && (mHistorySlotPos[slotId] >= 0))
+	{
+		mHistoryRing[mHistorySlotPos[slotId]] = -1;
+		mHistorySlotPos[slotId] = -1;
+	}
+
+	if (slotId == mLastSlotId)
+	{
+		mLastSlotId = -1;
+	}
+
+	AddRemovedTarget(mTrafficStore.addressType[dataIndex],
+		mTrafficStore.participantAddr[dataIndex]);
+
+	mTrafficStore.Remove(dataIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetUint32(unsigned char *dataBuf)
+{
+	return((unsigned int)Gdl90LoadBits<4>(dataBuf));
+}
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetUint24(unsigned char *dataBuf)
+{
+	return((unsigned int)Gdl90LoadBits<3>(dataBuf));
+}
+///////////////////////////////////////////////////////////////////////////////
+unsigned short AdsbWrapper::GetUint16(unsigned char *dataBuf)
+{
+	return((unsigned short)Gdl90LoadBits<2>(dataBuf));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetGeodeticLocation(const unsigned char *dataBuf, double &location)
+{
+	int status = -1;
+
+	// 24 bit two's complement, done in double so every value comes back
+	// exactly
+
+	location = Gdl90Field<0, 24, true, gdl90LatLongScale>::GetValue(dataBuf);
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// if filterData is set only save the latest data for a particular aircraft
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeMessage(unsigned int msgSize, char *msgPtr, bool filterData)
+{
+	int status = -1;
+
+	unsigned char *msgBuf  = (unsigned char *)msgPtr;
+
+	if (msgSize == 2)
+	{
+		status = status;
+	}
+	if (msgSize == 27)
+	{
+		status = status;
+	}
+
+	if ((msgSize > 1) && (msgBuf != 0))
+	{
+		if ((msgBuf[0] == GDL90_FLAGBYTE) && (msgBuf[msgSize - 1] == GDL90_FLAGBYTE))
+		{
+			// convert the flag bytes to zero and remove the control-escapes
+			// from the body in place, the frame only shrinks
+
+			msgBuf[0] = 0;
+
+			unsigned int frameSize = Gdl90Unstuff(&msgBuf[1], &msgBuf[1], msgSize - 2) + 2;
+
+			msgBuf[frameSize - 1] = 0;
+
+			status = DecodeFrame(frameSize, msgBuf, filterData);
+		}
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// feed raw bytes exactly as they were read from the socket or serial port,
+// frames may be split across calls and several frames may arrive in one call.
+// returns the number of complete frames found
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeStream(unsigned int dataLen, const char *dataPtr, bool filterData)
+{
+	mStreamFilterData = filterData;
+
+	return(mFramer.Feed((const unsigned char *)dataPtr, dataLen));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::StreamFrameCallback(void *context, unsigned char *frameBuf,
+	unsigned int frameSize)
+{
+	AdsbWrapper *wrapperPtr = (AdsbWrapper *)context;
+
+	wrapperPtr->DecodeFrame(frameSize, frameBuf, wrapperPtr->mStreamFilterData);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned char GetDecodeResultKind(unsigned char msgId)
+{
+	unsigned char kind = decodeResultOther;
+
+	switch (msgId)
+	{
+	case GDL90_ID_OWNSHIP:
+	case GDL90_ID_TRAFFIC:
+		kind = decodeResultTraffic;
+		break;
+
+	case GDL90_ID_HEARTBEAT:
+	case GDL90_ID_STRATUX_HEARTBEAT0:
+		kind = decodeResultHeartbeat;
+		break;
+
+	case GDL90_ID_STRATUX_AHRS:
+	case FOREFRONT_AHRS:
+		kind = decodeResultAhrs;
+		break;
+
+	case 0x53:  // stratux status message
+		kind = decodeResultStatus;
+		break;
+
+	default:
+		break;
+	}
+	return(kind);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode every frame in a buffer of raw stream bytes, for catching up after a
+// stall or replaying a capture.  results gets one entry per complete frame.
+//
+// the frames are decoded a kind at a time in decodeResultKinds order, and in
+// arrival order within a kind, so results is grouped the same way with
+// frameIndex giving each frame's place in the batch.  traffic expiry runs
+// once per batch and the last message type and callsign are only updated at
+// the end.  a frame split across the end of the buffer is finished by the
+// next call.  returns the number of results
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeBatch(unsigned int dataLen, const char *dataPtr,
+	std::vector<struct decodeResultRec> &results, bool filterData)
+{
+	unsigned int kindStart[numDecodeResultKinds + 1];
+
+	results.clear();
+
+	mBatchFrameData.clear();
+	mBatchFrames.clear();
+
+	mBatchFramer.Feed((const unsigned char *)dataPtr, dataLen);
+
+	unsigned int numFrames = (unsigned int)mBatchFrames.size();
+
+	if (numFrames == 0)
+	{
+		return(0);
+	}
+
+	ExpireTraffic(GetClockTime());
+
+	// counting sort on the kind keeps the arrival order within each kind
+
+	memset(kindStart, 0, sizeof(kindStart));
+
+	for (unsigned int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		kindStart[mBatchFrames[frameIndex].kind + 1]++;
+	}
+
+	for (int kind = 0; kind < numDecodeResultKinds; kind++)
+	{
+		kindStart[kind + 1] += kindStart[kind];
+	}
+
+	mBatchOrder.resize(numFrames);
+	mBatchTargetKeys.resize(numFrames);
+	results.resize(numFrames);
+
+	unsigned int kindNext[numDecodeResultKinds];
+
+	memcpy(kindNext, kindStart, sizeof(kindNext));
+
+	for (unsigned int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		unsigned int resultIndex = kindNext[mBatchFrames[frameIndex].kind]++;
+
+		mBatchOrder[resultIndex] = frameIndex;
+
+		results[resultIndex].frameIndex = frameIndex;
+		results[resultIndex].dataIndex = -1;
+		results[resultIndex].status = -1;
+		results[resultIndex].msgId = mBatchFrames[frameIndex].msgId;
+		results[resultIndex].kind = mBatchFrames[frameIndex].kind;
+	}
+
+	// traffic, dataIndex holds the slot id until the whole batch is in.
+	// removing a target moves another one's data index and a freed slot
+	// can go to a new target within the batch, so the target's address is
+	// kept to check against at the end
+
+	int lastTrafficSlotId = -1;
+	unsigned long long lastTrafficKey = 0;
+
+	for (unsigned int resultIndex = kindStart[decodeResultTraffic];
+		resultIndex < kindStart[decodeResultTraffic + 1]; resultIndex++)
+	{
+		struct batchFrameRec &frame = mBatchFrames[mBatchOrder[resultIndex]];
+
+		int status = DecodeTrafficMessage(frame.size, &mBatchFrameData[frame.offset + 1],
+			mTrafficReport);
+
+		if (status == 0)
+		{
+			lastTrafficSlotId = UpsertTraffic(mTrafficReport, filterData);
+			lastTrafficKey = TrafficIndex::MakeAddressKey(mTrafficReport.addressType,
+				mTrafficReport.participantAddr);
+
+			results[resultIndex].dataIndex = lastTrafficSlotId;
+			mBatchTargetKeys[resultIndex] = lastTrafficKey;
+		}
+		results[resultIndex].status = status;
+	}
+
+	// everything else goes through the same switch as DecodeFrame, UAT
+	// reports are stored there and leave their slot in mLastSlotId
+
+	for (unsigned int resultIndex = kindStart[decodeResultHeartbeat];
+		resultIndex < kindStart[decodeResultCrcError]; resultIndex++)
+	{
+		struct batchFrameRec &frame = mBatchFrames[mBatchOrder[resultIndex]];
+		bool uatReport = ((frame.msgId == GDL90_ID_BASIC_REPORT) ||
+			(frame.msgId == GDL90_ID_LONG_REPORT));
+		int lastSlotId = mLastSlotId;
+
+		if (uatReport == true)
+		{
+			mLastSlotId = -1;
+		}
+
+		results[resultIndex].status = DispatchFrame(frame.size,
+			&mBatchFrameData[frame.offset], filterData);
+
+		if (uatReport == false)
+		{
+			continue;
+		}
+
+		if ((results[resultIndex].status == 0) && (mLastSlotId >= 0))
+		{
+			results[resultIndex].dataIndex = mLastSlotId;
+			mBatchTargetKeys[resultIndex] = TrafficIndex::MakeAddressKey(
+				mTrafficReport.addressType, mTrafficReport.participantAddr);
+		}
+		else
+		{
+			mLastSlotId = lastSlotId;
+		}
+	}
+
+	for (unsigned int resultIndex = 0; resultIndex < numFrames; resultIndex++)
+	{
+		if (results[resultIndex].dataIndex >= 0)
+		{
+			results[resultIndex].dataIndex = GetBatchDataIndex(results[resultIndex].dataIndex,
+				mBatchTargetKeys[resultIndex]);
+		}
+	}
+
+	if (lastTrafficSlotId >= 0)
+	{
+		int dataIndex = GetBatchDataIndex(lastTrafficSlotId, lastTrafficKey);
+
+		mLastSlotId = (dataIndex >= 0) ? lastTrafficSlotId : -1;
+
+		if (dataIndex >= 0)
+		{
+			mLastCallsign = mTrafficStore.cold[dataIndex].callsign;
+		}
+	}
+
+	for (unsigned int frameIndex = numFrames; frameIndex > 0; frameIndex--)
+	{
+		if (mBatchFrames[frameIndex - 1].kind != decodeResultCrcError)
+		{
+			mLastMsgType = mBatchFrames[frameIndex - 1].msgId;
+			break;
+		}
+	}
+
+	CheckSnapshotInterval();
+
+	return((int)numFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the data index of a slot DecodeBatch stored a report in, -1 if the slot
+// has since been freed or has gone to a different target
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetBatchDataIndex(int slotId, unsigned long long targetKey)
+{
+	int dataIndex = mTrafficStore.GetDataIndex(slotId);
+
+	if ((dataIndex >= 0) && (TrafficIndex::MakeAddressKey(mTrafficStore.addressType[dataIndex],
+		mTrafficStore.participantAddr[dataIndex]) != targetKey))
+	{
+		dataIndex = -1;
+	}
+	return(dataIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames for DecodeBatch are checked and copied out, they are decoded once
+// the whole buffer has been framed
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::BatchFrameCallback(void *context, unsigned char *frameBuf,
+	unsigned int frameSize)
+{
+	AdsbWrapper *wrapperPtr = (AdsbWrapper *)context;
+	struct batchFrameRec frame;
+
+	frame.offset = (uint32_t)wrapperPtr->mBatchFrameData.size();
+	frame.size = (uint16_t)frameSize;
+	frame.msgId = 0;
+	frame.kind = decodeResultCrcError;
+
+	// short frames are rejected along with the corrupt ones
+
+	if (Gdl90CrcCheck(frameBuf, frameSize) != 0)
+	{
+		wrapperPtr->mNumCrcErrors++;
+	}
+	else if (Gdl90LengthCheck(frameBuf, frameSize) != 0)
+	{
+		wrapperPtr->mNumShortFrames++;
+	}
+	else
+	{
+		frame.msgId = frameBuf[1];
+		frame.kind = GetDecodeResultKind(frame.msgId);
+	}
+
+	wrapperPtr->mBatchFrameData.insert(wrapperPtr->mBatchFrameData.end(),
+		frameBuf, frameBuf + frameSize);
+	wrapperPtr->mBatchFrames.push_back(frame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode a single frame that has already had the flag bytes located and the
+// control-escapes removed, msgBuf[1] holds the message id
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeFrame(unsigned int msgSize, unsigned char *msgBuf, bool filterData)
+{
+	int status = -1;
+
+	// reject short and corrupt frames before looking at any of the fields
+
+	if (Gdl90CrcCheck(msgBuf, msgSize) != 0)
+	{
+		mNumCrcErrors++;
+
+		return(status);
+	}
+
+	if (Gdl90LengthCheck(msgBuf, msgSize) != 0)
+	{
+		mNumShortFrames++;
+
+		return(status);
+	}
+
+	ExpireTraffic(GetClockTime());
+
+	status = DispatchFrame(msgSize, msgBuf, filterData);
+
+	CheckSnapshotInterval();
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode a frame whose crc has already been checked
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DispatchFrame(unsigned int msgSize, unsigned char *msgBuf, bool filterData)
+{
+	int status = -1;
+	unsigned char msgId = 0;
+	unsigned char subMsgId = 0;
+
+	msgId = msgBuf[1];
+
+	mLastMsgType = msgId;
+
+	// watch for control-escape fields used to allow 7d or 7f to be passed as data
+
+	switch (msgId)
+	{
+	case  GDL90_ID_HEARTBEAT:
+	{
+		statusByteRec1 test;
+
+		test.statusByte = 1;
+
+		test.statusByte = 0x8;
+
+		mLatetestHeartbeat.msgId = msgBuf[1];
+		mLatetestHeartbeat.statusByte1.statusByte = msgBuf[2];
+		mLatetestHeartbeat.statusByte2.statusByte = msgBuf[3];
+
+		mLatetestHeartbeat.timestamp = (mLatetestHeartbeat.statusByte2.bits.timestamp << 16) + (msgBuf[5] << 8) + msgBuf[4];
+
+		mLatetestHeartbeat.msgCounts = (msgBuf[6] << 8) + msgBuf[7];
+
+		mLatetestHeartbeat.crc = (msgBuf[8] << 8) + msgBuf[9];
+	}
+	break;
+
+	case  GDL90_ID_INIT:
+		status = status;
+
+		break;
+
+	case  GDL90_ID_UPLINK_DATA:
+	{
+		// capturing only queues a copy, the capture writer's thread does
+		// the file work
+
+		if ((mUplinkCapture != NULL) && (msgSize > UPLINK_FRAME_OVERHEAD))
+		{
+			mUplinkCapture->Write(msgSize - UPLINK_FRAME_OVERHEAD,
+				(const char *)&msgBuf[UPLINK_FRAME_APP_DATA_OFFSET]);
+		}
+
+		// uplinks are the largest frames by far, with a callback set they
+		// are decoded elsewhere so traffic behind them isn't held up
+
+		if (mUplinkCallback != NULL)
+		{
+			mUplinkCallback(mUplinkContext, msgBuf, msgSize);
+
+			status = 0;
+		}
+		else
+		{
+			status = DecodeUplinkData(msgSize, &msgBuf[1], mUplinkData);
+
+			mUplinkDataValid = (status == 0);
+
+			if ((mUplinkDataValid == true) && (mFisbDecoder != NULL))
+			{
+				mFisbDecoder->Decode(mUplinkData, GetClockTime());
+			}
+		}
+	}
+
+	break;
+
+	case  GDL90_ID_OWNSHIP:
+	case  GDL90_ID_TRAFFIC:
+	{
+		struct trafficReportRec &trafficData = mTrafficReport;
+
+		status = DecodeTrafficMessage(msgSize, &msgBuf[1], trafficData);
+
+		if (status == 0)
+		{
+			mLastSlotId = UpsertTraffic(trafficData, filterData);
+
+			mLastCallsign.assign(trafficData.callsign, TrafficReportCallsignLength(trafficData));
+		}
+	}
+	break;
+
+
+	case  GDL90_ID_STRATUX_HEARTBEAT0:
+	{
+		status = 0;
+
+		int gpsValid = (msgBuf[2] & 0x02) >> 1;
+		int ahrsValid = (msgBuf[2] & 0x01);
+		int protVerValid = (msgBuf[2] & 0x04) >> 2;
+
+		int protVer = msgBuf[3];
+	}
+	break;
+
+	case  GDL90_ID_STRATUX_HEARTBEAT1:
+		status = 0;
+
+		break;
+
+
+	case  GDL90_ID_STRATUX_AHRS:
+	{
+		subMsgId = msgBuf[2];
+
+		mStatuxAhrsData.msgId = msgBuf[1];
+		mStatuxAhrsData.subMsgId = subMsgId;
+		mStatuxAhrsData.roll = ((msgBuf[3] << 8) + msgBuf[4]) * 0.1f;
+		mStatuxAhrsData.pitch = ((msgBuf[5] << 8) + msgBuf[6]) * 0.1f;
+
+		mStatuxAhrsData.heading = ((msgBuf[7] << 8) + msgBuf[8]) * 0.1f;
+
+		//			mStatuxAhrsData.trueAirspeed = (msgBuf[9] << 8) + msgBuf[10];
+	//				mStatuxAhrsData.indicatedAirspeed = (msgBuf[11] << 8) + msgBuf[12];
+
+		float AHRSRoll = ((msgBuf[3] << 8) + msgBuf[4]) * 0.1f;
+		float AHRSPitch = ((msgBuf[5] << 8) + msgBuf[6]) * 0.1f;
+		float AHRSGyroHeading = ((msgBuf[7] << 8) + msgBuf[8]);
+		float AHRSMagHeading = ((msgBuf[9] << 8) + msgBuf[10]);
+		float AHRSSlipSkid = ((msgBuf[11] << 8) + msgBuf[12]);
+		float AHRSTurnRate = ((msgBuf[13] << 8) + msgBuf[14]);
+		float AHRSGLoad = ((msgBuf[5] << 8) + msgBuf[16]);
+		float AHRSGLoadMin = ((msgBuf[17] << 8) + msgBuf[18]);
+		float AHRSGLoadMax = ((msgBuf[19] << 8) + msgBuf[20]);
+
+		status = status;
+	}
+	break;
+
+	case 0x53:  // GDL90_ID_STRATUX_HEARTBEAT1  aka status message
+
+
+		if (msgBuf[2] == 0x58)
+		{
+			mLastMsgType = 0x5358;
+
+			mStratuxStatusMessage.msgVersion = msgBuf[4];
+
+			memcpy(mStratuxStatusMessage.versionBuf, &msgBuf[5], 4);
+
+			mStratuxStatusMessage.hardwareRevCode = GetUint32(&msgBuf[9]);
+
+			mStratuxStatusMessage.validAndEnableFlags = GetUint16(&msgBuf[13]);
+			mStratuxStatusMessage.connectHardwareFlags = GetUint16(&msgBuf[15]);
+
+			mStratuxStatusMessage.numSatsLocked = msgBuf[17];
+			mStratuxStatusMessage.numSatsConnected = msgBuf[18];
+
+			mStratuxStatusMessage.num978Targets = GetUint16(&msgBuf[19]);
+
+			mStratuxStatusMessage.num1090Targets = GetUint16(&msgBuf[21]);
+
+			mStratuxStatusMessage.num978MsgRate = GetUint16(&msgBuf[23]);
+
+			mStratuxStatusMessage.num1090MsgRate = GetUint16(&msgBuf[25]);
+
+			mStratuxStatusMessage.cpuTemp = (float)GetUint16(&msgBuf[27])  * 0.1f;
+
+			mStratuxStatusMessage.numAdsbTowers = msgBuf[29];
+
+			double towerLat;
+			double towerLon;
+
+			// the tower list is variable length, stop at the crc
+
+			unsigned int bufIndex = 30;
+			for (int index = 0; (index < mStratuxStatusMessage.numAdsbTowers) &&
+				(bufIndex + 6 + 3 <= msgSize); index++)
+			{
+				GetGeodeticLocation(&msgBuf[bufIndex], towerLat);
+
+				bufIndex += 3;
+
+				GetGeodeticLocation(&msgBuf[bufIndex], towerLon);
+
+				bufIndex += 3;
+			}
+
+			// adsb tower locations would follow if we ever saw any
+
+		}
+		else
+		{
+			status = status;
+		}
+	break;
+
+	case 0x65:  // ForeFront AHRS message  -- or GPS time -f 12 bytes see _messages.py _parseGpsTime
+	{
+		unsigned short tempShrt;
+
+		if (msgBuf[2] == 0x1)  // AHRS message
+		{
+			struct ahrsMsgRec ahrsMsgBuf;
+
+			//						memcpy(&ahrsMsgBuf, &msgBuf[1], sizeof(struct ahrsMsgRec));
+
+			// bad values in pitch and roll needs more debugging
+
+			mAhrsData.msgId = msgBuf[1];
+			mAhrsData.subMsgId = msgBuf[2];
+
+			tempShrt = GetUint16(&msgBuf[3]);
+			mAhrsData.roll = (float)tempShrt * 0.1f;
+
+			tempShrt = GetUint16(&msgBuf[5]);
+			mAhrsData.pitch = (float)tempShrt * 0.1f;
+
+			tempShrt = GetUint16(&msgBuf[7]);
+
+			bool useTrueHeading = false;
+
+			if (tempShrt != 0xffff)
+			{
+				mAhrsData.heading = tempShrt & 0x7ffff;
+
+
+				if ((tempShrt & 0x8000) == 0x8000)
+				{
+					useTrueHeading = true;
+				}
+			}
+			else
+			{
+				mAhrsData.heading = -99999.0;
+			}
+
+			mAhrsData.headingIsTrue = useTrueHeading;
+
+			mAhrsData.indicatedAirspeed = GetUint16(&msgBuf[9]);
+			mAhrsData.trueAirspeed = GetUint16(&msgBuf[11]);
+
+			/*
+			_swab(&msgBuf[3], &msgBuf[3], 10);
+
+
+
+			ushortPtr = (unsigned short *)&msgBuf[3];
+
+			float tempRoll =  (float)*ushortPtr * 0.1f;
+
+//						_swab(&msgBuf[1], &msgBuf[1], 2);
+				ushortPtr = (unsigned short *)&msgBuf[5];
+				mAhrsData.pitch = (float)*ushortPtr * 0.1f;
+
+				ushortPtr = (unsigned short *)&msgBuf[7];
+
+				if (*ushortPtr & 0x8000)
+				{
+					mAhrsData.headingIsTrue = false;
+				}
+				else
+				{
+					mAhrsData.headingIsTrue = true;
+				}
+
+				mAhrsData.heading = (float)(*ushortPtr & 0x7FFF) * 0.1f;
+
+				ushortPtr = (unsigned short *)&msgBuf[9];
+				mAhrsData.indicatedAirspeed = (float)*ushortPtr;
+
+				ushortPtr = (unsigned short *)&msgBuf[11];
+				mAhrsData.trueAirspeed = (float)*ushortPtr;
+*/
+		}
+		else
+		{
+			if (msgBuf[2] == 0x0)
+			{
+				status = status;
+			}
+		}
+	}
+	break;
+
+	case GDL90_ID_OWNSHIP_ALTITUDE:  // height above WGS-84 ellipsoid = MSL
+	{
+		// altitude is in increments of 5ft
+
+		short altitude = GetUint16(&msgBuf[2]) * 5;
+		short metrics = GetUint16(&msgBuf[4]);
+
+		status = status;
+
+	}
+	break;
+
+	case GDL90_ID_BASIC_REPORT:
+	case GDL90_ID_LONG_REPORT:
+	{
+		// a UAT report only fills in what its payload carries, the rest
+		// stays as the target's earlier reports left it
+
+		struct trafficReportRec &trafficData = mTrafficReport;
+		unsigned int presentFields = 0;
+
+		status = DecodeUatReport(msgSize, &msgBuf[1], trafficData, presentFields);
+
+		if (status == 0)
+		{
+			MergeTrafficFields(trafficData, presentFields);
+
+			mLastSlotId = UpsertTraffic(trafficData, filterData);
+
+			mLastCallsign.assign(trafficData.callsign, TrafficReportCallsignLength(trafficData));
+		}
+	}
+	break;
+
+	default:
+		status = status;
+		break;
+	}
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// store a report that was decoded somewhere else, DecodePipeline's workers
+// for one.  does what DecodeFrame does for an ownship or traffic frame apart
+// from expiring traffic, returns the data index of the target
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::StoreTrafficReport(const struct trafficReportRec &trafficData, bool filterData)
+{
+	mLastMsgType = trafficData.msgId;
+
+	mLastSlotId = UpsertTraffic(trafficData, filterData);
+
+	mLastCallsign.assign(trafficData.callsign, TrafficReportCallsignLength(trafficData));
+
+	CheckSnapshotInterval();
+
+	return(mTrafficStore.GetDataIndex(mLastSlotId));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// add or update the target for a decoded report, returns its slot id
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::UpsertTraffic(const struct trafficReportRec &trafficData, bool filterData)
+{
+	int dataIndex = -1;
+
+	if (filterData == true)
+	{
+		dataIndex = mTrafficStore.FindAddress(trafficData.addressType,
+			trafficData.participantAddr);
+	}
+
+	bool newEntry = (dataIndex < 0);
+
+	if (newEntry == true)
+	{
+		dataIndex = mTrafficStore.Insert(trafficData.addressType,
+			trafficData.participantAddr);
+
+		if (trafficData.msgId == GDL90_ID_OWNSHIP)
+		{
+			mOwnshipCallsign.assign(trafficData.callsign,
+				TrafficReportCallsignLength(trafficData));
+		}
+	}
+
+	// only worth comparing against the old report if someone is listening
+
+	unsigned int changedFields = TRAFFIC_FIELD_ALL;
+	unsigned int changeKind = (newEntry == true) ? trafficChangeAdded : trafficChangeUpdated;
+
+	if ((newEntry == false) && (mTrafficFeed.IsWanted(changeKind) == true))
+	{
+		changedFields = GetChangedFields(trafficData, dataIndex);
+	}
+
+	StoreAircraftData(trafficData, dataIndex);
+	MarkChanged(dataIndex);
+
+	// with filterData off the address and callsign always find the
+	// newest report for the target
+
+	mTrafficStore.SetAddressIndex(dataIndex);
+
+	if (filterData == false)
+	{
+		mTrafficStore.SetCallsignIndex(dataIndex);
+	}
+
+	int slotId = mTrafficStore.GetSlotId(dataIndex);
+
+	mTrafficGrid.Update(slotId, trafficData.latitude, trafficData.longitude);
+
+	unsigned int timeToLive = GetTrafficTimeToLive(trafficData.addressType);
+
+	if (timeToLive > 0)
+	{
+		mExpiryWheel.Schedule(slotId, mTrafficStore.lastUpdate[dataIndex] + timeToLive);
+	}
+	else
+	{
+		mExpiryWheel.Cancel(slotId);
+	}
+
+	// making room in the history may move this entry
+
+	if ((filterData == false) && (newEntry == true))
+	{
+		AddHistoryEntry(slotId);
+	}
+
+	// a report that repeats the target exactly isn't a change
+
+	if ((changedFields != 0) && (mTrafficFeed.IsWanted(changeKind) == true))
+	{
+		struct trafficChangeRec change;
+
+		change.report = trafficData;
+		change.report.lastUpdate = mTrafficStore.lastUpdate[mTrafficStore.GetDataIndex(slotId)];
+		change.slotId = slotId;
+		change.changedFields = (uint16_t)changedFields;
+		change.kind = (uint8_t)changeKind;
+		change.reserved = 0;
+
+		mTrafficFeed.Publish(change);
+	}
+
+	return(slotId);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// msgBuf points at the message id, the report is filled in directly with no
+// allocation
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeTrafficMessage(unsigned int msgSize,  unsigned char *msgBuf,
+									struct trafficReportRec &trafficData)
+{
+	int status = DecodeTrafficReport(msgSize, msgBuf, trafficData);
+
+	if (status == 0)
+	{
+		trafficData.lastUpdate = mLatetestHeartbeat.timestamp;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the part of DecodeTrafficMessage that doesn't depend on any decoder state,
+// safe to call from any thread.  msgBuf points at the message id and msgSize
+// counts both flag positions, a frame too short to hold the whole report is
+// rejected.  lastUpdate is left at 0
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeTrafficReport(unsigned int msgSize, const unsigned char *msgBuf,
+	struct trafficReportRec &trafficData)
+{
+	int status = -1;
+
+	memset(&trafficData, 0, sizeof(trafficData));
+
+	if (msgSize < (GDL90_ID_TRAFFIC_LENGTH + GDL90_FRAME_OVERHEAD))
+	{
+		return(status);
+	}
+
+	if ((msgBuf[0] == GDL90_ID_OWNSHIP) || (msgBuf[0] == GDL90_ID_TRAFFIC))
+	{
+		trafficData.msgId = msgBuf[0];
+
+		trafficData.addressType = (uint8_t)gdl90TrafficLayout::addressType::Get(msgBuf);
+		trafficData.alertStatus = (uint8_t)gdl90TrafficLayout::alertStatus::Get(msgBuf);
+		trafficData.participantAddr = gdl90TrafficLayout::participantAddr::Get(msgBuf);
+
+		trafficData.latitude = gdl90TrafficLayout::latitude::GetValue(msgBuf);
+		trafficData.longitude = gdl90TrafficLayout::longitude::GetValue(msgBuf);
+
+		trafficData.altitude = ((int)gdl90TrafficLayout::altitude::Get(msgBuf) * 25) - 1000;
+
+		trafficData.miscIndicators = (uint8_t)gdl90TrafficLayout::miscIndicators::Get(msgBuf);
+		trafficData.integrityCode = (uint8_t)gdl90TrafficLayout::integrityCode::Get(msgBuf);
+		trafficData.accuracyCode = (uint8_t)gdl90TrafficLayout::accuracyCode::Get(msgBuf);
+
+// horiz velocity
+		int tempInt = (int)gdl90TrafficLayout::horzVelocity::Get(msgBuf);
+
+		if (tempInt == 0xfff)
+		{
+			trafficData.horzVelocity = 4094;
+		}
+		else if (tempInt == 0xffe)
+		{
+			trafficData.horzVelocity = 4095;  // max value
+		}
+		else
+		{
+			trafficData.horzVelocity = tempInt;
+		}
+
+// vertical velocity, 12 bit two's complement.  0x800 is no value and 0x1fe
+// and 0xe02 (+-510 steps) are off scale, all of them are left at 0
+		tempInt = gdl90TrafficLayout::vertVelocity::Get(msgBuf);
+
+		if ((tempInt >= -509) && (tempInt <= 509))
+		{
+			trafficData.vertVelocity = tempInt * 64;
+		}
+
+		trafficData.trackHeading = (float)gdl90TrafficLayout::trackHeading::GetValue(msgBuf);
+		trafficData.emitterCategory = (uint8_t)gdl90TrafficLayout::emitterCategory::Get(msgBuf);
+
+		// the callsign is space padded, the padding becomes 0
+
+		memcpy(trafficData.callsign, &msgBuf[gdl90TrafficLayout::callsignOffset],
+			TRAFFIC_REPORT_CALLSIGN_SIZE);
+
+		int tempIndex = TRAFFIC_REPORT_CALLSIGN_SIZE - 1;
+
+		while ((tempIndex >= 0) && (trafficData.callsign[tempIndex] == ' '))
+		{
+			trafficData.callsign[tempIndex] = 0;
+			tempIndex--;
+		}
+
+		trafficData.emergencyPriorityCode = (uint8_t)gdl90TrafficLayout::emergencyPriorityCode::Get(msgBuf);
+
+		// the crc has already been checked by DecodeFrame
+
+		status = 0;
+	}
+
+	return(status);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::CopyAircraftData(struct trafficReportNumRec &srcData,
+	struct trafficReportNumRec&tgtData)
+{
+	tgtData.alertStatus = srcData.alertStatus;
+	tgtData.addressType = srcData.addressType;
+	tgtData.participantAddr = srcData.participantAddr;
+	tgtData.latitude = srcData.latitude;
+	tgtData.longitude = srcData.longitude;
+	tgtData.altitude = srcData.altitude;
+	tgtData.miscIndicators = srcData.miscIndicators;
+	tgtData.integrityCode = srcData.integrityCode;
+	tgtData.accuracyCode = srcData.accuracyCode;
+	tgtData.horzVelocity = srcData.horzVelocity;
+	tgtData.vertVelocity = srcData.vertVelocity;
+	tgtData.trackHeading = srcData.trackHeading;
+	tgtData.emitterCategory = srcData.emitterCategory;
+	tgtData.callsign = srcData.callsign;
+
+	tgtData.name = srcData.name;
+	tgtData.nNumber = srcData.nNumber;
+	tgtData.typeAircraft = srcData.typeAircraft;
+	tgtData.typeEngine = srcData.typeEngine;
+
+	tgtData.emergencyPriorityCode = srcData.emergencyPriorityCode;
+
+	tgtData.lastUpdate = GetClockTime();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// store a decoded report in the traffic table, the owner info and range
+// values are set separately and are left alone
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::StoreAircraftData(const struct trafficReportRec &srcData,
+	unsigned int dataIndex)
+{
+	mTrafficStore.msgId[dataIndex] = srcData.msgId;
+	mTrafficStore.alertStatus[dataIndex] = srcData.alertStatus;
+	mTrafficStore.addressType[dataIndex] = srcData.addressType;
+	mTrafficStore.participantAddr[dataIndex] = srcData.participantAddr;
+	mTrafficStore.latitude[dataIndex] = srcData.latitude;
+	mTrafficStore.longitude[dataIndex] = srcData.longitude;
+	mTrafficStore.altitude[dataIndex] = srcData.altitude;
+	mTrafficStore.miscIndicators[dataIndex] = srcData.miscIndicators;
+	mTrafficStore.integrityCode[dataIndex] = srcData.integrityCode;
+	mTrafficStore.accuracyCode[dataIndex] = srcData.accuracyCode;
+	mTrafficStore.horzVelocity[dataIndex] = srcData.horzVelocity;
+	mTrafficStore.vertVelocity[dataIndex] = srcData.vertVelocity;
+	mTrafficStore.trackHeading[dataIndex] = srcData.trackHeading;
+	mTrafficStore.emitterCategory[dataIndex] = srcData.emitterCategory;
+	mTrafficStore.emergencyPriorityCode[dataIndex] = srcData.emergencyPriorityCode;
+
+	mTrafficStore.SetCallsign(dataIndex, srcData.callsign, TrafficReportCallsignLength(srcData));
+
+	mTrafficStore.lastUpdate[dataIndex] = GetClockTime();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::ClearAircraftData(struct trafficReportNumRec &tgtData)
+{
+	tgtData.alertStatus = 0;
+	tgtData.addressType = 0;
+	tgtData.participantAddr = 0;
+	tgtData.latitude = 0.0;
+	tgtData.longitude = 0.0;
+	tgtData.miscIndicators = 0;
+	tgtData.integrityCode = 0;
+	tgtData.accuracyCode = 0;
+	tgtData.horzVelocity = 0;
+	tgtData.vertVelocity = 0;
+	tgtData.trackHeading = 0;
+	tgtData.emitterCategory = 0;
+	tgtData.callsign.erase();
+	tgtData.emergencyPriorityCode = 0;
+	tgtData.lastUpdate = 0;
+
+	tgtData.name.clear();
+	tgtData.nNumber.clear();
+	tgtData.typeAircraft = 0;
+	tgtData.typeEngine = 0;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::CrcInit(void)
+{
+	// nothing to do, the crc tables are shared and built at compile time
+}
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::CrcCompute( // Return  CRC of the block
+	unsigned char *block, // i  Starting address of message
+	unsigned int length // i  Length of message
+	)
+{
+	return(Gdl90CrcCompute(block, length));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// crc of a complete unstuffed frame, msgBuf[1] is the message id and the
+// last three bytes are the crc and the closing flag position
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::CalculateCrc(unsigned char *msgBuf, int msgSize)
+{
+	unsigned int crc = 0;
+
+	if ((msgBuf != NULL) && (msgSize >= GDL90_MIN_FRAME_SIZE))
+	{
+		crc = Gdl90CrcCompute(&msgBuf[1], msgSize - 4);
+	}
+	return(crc);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetNumCrcErrors()
+{
+	return(mNumCrcErrors);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames whose crc matched but that are too short for their message id
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetNumShortFrames()
+{
+	return(mNumShortFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// field layout shared by both SerializeTrafficData versions
+///////////////////////////////////////////////////////////////////////////////
+static const char *sTrafficDataFormat =
+	"%d%c"  // timestamp
+	"%s%c" // callsign
+	"%d%c" // address type
+	"%x%c" // participant address 
+	"%s%c" // n number
+	"%3.12lf%c" // latitude
+	"%3.12lf%c" // longitude
+	"%d%c"  // altitude
+	"%d%c" // alert status 
+	"%d%c" // misc indicator
+	"%d%c" // integrity code
+	"%d%c" // accuracy
+	"%d%c" // horiz vel
+	"%d%c" // vert velocity
+	"%f%c" // track heading
+	"%d%c" // emitter category
+	"%d%c" // prioity code
+	"%f%c" // range
+	"%f\n";  // bearing
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SerializeTrafficData(unsigned int dataIndex, char delimiter,
+	std::string &serializedData)
+{
+	int status = -1;
+	char dataBuf[512];
+
+	if (dataIndex < mTrafficStore.GetCount())
+	{
+		sprintf(dataBuf, sTrafficDataFormat,
+			mLatetestHeartbeat.timestamp, delimiter,
+			mTrafficStore.cold[dataIndex].callsign.c_str(), delimiter,
+			mTrafficStore.addressType[dataIndex], delimiter,
+			mTrafficStore.participantAddr[dataIndex], delimiter,
+			mTrafficStore.cold[dataIndex].nNumber.c_str(), delimiter,
+			mTrafficStore.latitude[dataIndex], delimiter,
+			mTrafficStore.longitude[dataIndex], delimiter,
+			mTrafficStore.altitude[dataIndex], delimiter,
+			mTrafficStore.alertStatus[dataIndex], delimiter,
+			mTrafficStore.miscIndicators[dataIndex], delimiter,
+			mTrafficStore.integrityCode[dataIndex], delimiter,
+			mTrafficStore.accuracyCode[dataIndex], delimiter,
+			mTrafficStore.horzVelocity[dataIndex], delimiter,
+			mTrafficStore.vertVelocity[dataIndex], delimiter,
+			mTrafficStore.trackHeading[dataIndex], delimiter,
+			mTrafficStore.emitterCategory[dataIndex], delimiter,
+			mTrafficStore.emergencyPriorityCode[dataIndex], delimiter,
+			mTrafficStore.range[dataIndex], delimiter,
+			mTrafficStore.bearing[dataIndex]
+		);
+
+		serializedData = dataBuf;
+
+		status = 0;
+	}
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SerializeTrafficData(struct AdsbWrapper::trafficReportNumRec *dataPtr,
+	char delimiter, std::string &serializedData)
+{
+	int status = -1;
+	char dataBuf[512];
+
+	if (dataPtr != NULL)
+	{
+		sprintf(dataBuf, sTrafficDataFormat,
+			mLatetestHeartbeat.timestamp, delimiter,
+			dataPtr->callsign.c_str(), delimiter,
+			dataPtr->addressType, delimiter,
+			dataPtr->participantAddr, delimiter,
+			dataPtr->nNumber.c_str(), delimiter,
+			dataPtr->latitude, delimiter,
+			dataPtr->longitude, delimiter,
+			dataPtr->altitude, delimiter,
+			dataPtr->alertStatus, delimiter,
+			dataPtr->miscIndicators, delimiter,
+			dataPtr->integrityCode, delimiter,
+			dataPtr->accuracyCode, delimiter,
+			dataPtr->horzVelocity, delimiter,
+			dataPtr->vertVelocity, delimiter,
+			dataPtr->trackHeading, delimiter,
+			dataPtr->emitterCategory, delimiter,
+			dataPtr->emergencyPriorityCode, delimiter,
+			dataPtr->range, delimiter,
+			dataPtr->bearing
+		);
+
+		serializedData = dataBuf;
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// what SerializeTrafficData writes
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetDefaultSerializeOptions(struct serializeOptionsRec &options)
+{
+	options.delimiter = ',';
+	options.latLonDigits = ADSB_SERIALIZE_LAT_LON_DIGITS;
+	options.floatDigits = ADSB_SERIALIZE_FLOAT_DIGITS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the append helpers for SerializeTrafficTable write at dataPtr and return
+// the end of what they wrote, or NULL if it wouldn't fit before endPtr.  a
+// NULL dataPtr passes straight through so the checks can wait until the end
+// of a record
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> static char *AppendNumber(char *dataPtr, char *endPtr, T value,
+	char delimiter)
+{
+	if (dataPtr == NULL)
+	{
+		return(NULL);
+	}
+
+	std::to_chars_result result = std::to_chars(dataPtr, endPtr, value);
+
+	if ((result.ec != std::errc()) || (result.ptr == endPtr))
+	{
+		return(NULL);
+	}
+
+	*result.ptr = delimiter;
+
+	return(result.ptr + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static char *AppendHex(char *dataPtr, char *endPtr, unsigned int value, char delimiter)
+{
+	if (dataPtr == NULL)
+	{
+		return(NULL);
+	}
+
+	std::to_chars_result result = std::to_chars(dataPtr, endPtr, value, 16);
+
+	if ((result.ec != std::errc()) || (result.ptr == endPtr))
+	{
+		return(NULL);
+	}
+
+	*result.ptr = delimiter;
+
+	return(result.ptr + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> static char *AppendFixed(char *dataPtr, char *endPtr, T value,
+	int precision, char delimiter)
+{
+	if (dataPtr == NULL)
+	{
+		return(NULL);
+	}
+
+	std::to_chars_result result = std::to_chars(dataPtr, endPtr, value,
+		std::chars_format::fixed, precision);
+
+	if ((result.ec != std::errc()) || (result.ptr == endPtr))
+	{
+		return(NULL);
+	}
+
+	*result.ptr = delimiter;
+
+	return(result.ptr + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static char *AppendString(char *dataPtr, char *endPtr, const std::string &value,
+	char delimiter)
+{
+	if ((dataPtr == NULL) || ((size_t)(endPtr - dataPtr) <= value.size()))
+	{
+		return(NULL);
+	}
+
+	memcpy(dataPtr, value.data(), value.size());
+
+	dataPtr += value.size();
+	*dataPtr = delimiter;
+
+	return(dataPtr + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write a line per target into dataBuf the way SerializeTrafficData does,
+// with no allocation and no printf.  with changeVersion set only targets
+// changed since *changeVersion are written and *changeVersion is moved on
+// to now, start it at 0.  changed only lines are adds and updates, a target
+// that expires or is removed simply stops appearing, so a caller keeping
+// a table from them must take a whole export now and then and drop what
+// isn't in it, or follow ExportRecords, which does send removals.  returns
+// the number of bytes written, or -1 if they didn't all fit, in which case
+// *changeVersion is left alone so the next call writes them again.
+// GetSerializeBufferSize is always enough
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SerializeTrafficTable(char *dataBuf, unsigned int bufSize,
+	const struct serializeOptionsRec &options, unsigned long long *changeVersion)
+{
+	char *dataPtr = dataBuf;
+	char *endPtr = dataBuf + bufSize;
+	char delimiter = options.delimiter;
+	unsigned long long sinceVersion = (changeVersion != NULL) ? *changeVersion : 0;
+
+	if (dataBuf == NULL)
+	{
+		return(-1);
+	}
+
+	for (unsigned int dataIndex = 0; dataIndex < mTrafficStore.GetCount(); dataIndex++)
+	{
+		if ((changeVersion != NULL) && (mTrafficStore.changeVersion[dataIndex] <= sinceVersion))
+		{
+			continue;
+		}
+
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mLatetestHeartbeat.timestamp, delimiter);
+		dataPtr = AppendString(dataPtr, endPtr, mTrafficStore.cold[dataIndex].callsign, delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.addressType[dataIndex], delimiter);
+		dataPtr = AppendHex(dataPtr, endPtr, mTrafficStore.participantAddr[dataIndex], delimiter);
+		dataPtr = AppendString(dataPtr, endPtr, mTrafficStore.cold[dataIndex].nNumber, delimiter);
+		dataPtr = AppendFixed(dataPtr, endPtr, mTrafficStore.latitude[dataIndex],
+			options.latLonDigits, delimiter);
+		dataPtr = AppendFixed(dataPtr, endPtr, mTrafficStore.longitude[dataIndex],
+			options.latLonDigits, delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, mTrafficStore.altitude[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.alertStatus[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.miscIndicators[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.integrityCode[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.accuracyCode[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, mTrafficStore.horzVelocity[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, mTrafficStore.vertVelocity[dataIndex], delimiter);
+		dataPtr = AppendFixed(dataPtr, endPtr, mTrafficStore.trackHeading[dataIndex],
+			options.floatDigits, delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.emitterCategory[dataIndex], delimiter);
+		dataPtr = AppendNumber(dataPtr, endPtr, (int)mTrafficStore.emergencyPriorityCode[dataIndex],
+			delimiter);
+		dataPtr = AppendFixed(dataPtr, endPtr, mTrafficStore.range[dataIndex],
+			options.floatDigits, delimiter);
+		dataPtr = AppendFixed(dataPtr, endPtr, mTrafficStore.bearing[dataIndex],
+			options.floatDigits, '\n');
+
+		if (dataPtr == NULL)
+		{
+			return(-1);
+		}
+	}
+
+	if (changeVersion != NULL)
+	{
+		*changeVersion = mChangeVersion;
+	}
+	return((int)(dataPtr - dataBuf));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a buffer this big holds every target SerializeTrafficTable could write
+// right now
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetSerializeBufferSize(const struct serializeOptionsRec &options)
+{
+	// 17 fields and their delimiters, integers at most 11 characters, a
+	// fixed float can run to 39 digits before the point
+
+	unsigned int maxRecordSize = (13 * 12) + (3 * (40 + options.floatDigits + 1)) +
+		(2 * (5 + options.latLonDigits + 1));
+	unsigned int bufSize = 0;
+
+	for (unsigned int dataIndex = 0; dataIndex < mTrafficStore.GetCount(); dataIndex++)
+	{
+		bufSize += maxRecordSize + (unsigned int)mTrafficStore.cold[dataIndex].callsign.size() +
+			(unsigned int)mTrafficStore.cold[dataIndex].nNumber.size() + 2;
+	}
+	return(bufSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write the latest heartbeat, each AHRS that has reported and the traffic
+// table as binary records, see TrafficRecord.h.  changeVersion works the
+// same as for SerializeTrafficTable, and a removed record goes out for
+// every target that has gone since.  if more have gone than the table
+// holds, so some of them are no longer known, a stream header goes out
+// first and then every target as if *changeVersion were 0.  returns the
+// number of records written, or -1 if the writer ran out of room, the
+// buffer still only holds whole records but not all of them
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ExportRecords(TrafficRecordWriter &writer, unsigned long long *changeVersion)
+{
+	struct heartbeatRecordRec heartbeat;
+	struct ahrsDataRec *ahrsSources[2] = { &mAhrsData, &mStatuxAhrsData };
+	struct trafficRecordRec traffic;
+	unsigned long long sinceVersion = (changeVersion != NULL) ? *changeVersion : 0;
+	int numRecords = 0;
+
+	if ((changeVersion != NULL) && (sinceVersion < mRemovedLostVersion))
+	{
+		if (writer.WriteStreamHeader() != 0)
+		{
+			return(-1);
+		}
+		numRecords++;
+
+		sinceVersion = 0;
+	}
+
+	heartbeat.timestamp = mLatetestHeartbeat.timestamp;
+	heartbeat.msgCounts = mLatetestHeartbeat.msgCounts;
+	heartbeat.statusByte1 = mLatetestHeartbeat.statusByte1.statusByte;
+	heartbeat.statusByte2 = mLatetestHeartbeat.statusByte2.statusByte;
+
+	if (writer.WriteHeartbeat(heartbeat) != 0)
+	{
+		return(-1);
+	}
+	numRecords++;
+
+	for (int source = 0; source < 2; source++)
+	{
+		struct ahrsDataRec *ahrsData = ahrsSources[source];
+		struct ahrsRecordRec ahrs;
+
+		if (ahrsData->msgId == 0)
+		{
+			continue;
+		}
+
+		ahrs.roll = ahrsData->roll;
+		ahrs.pitch = ahrsData->pitch;
+		ahrs.heading = ahrsData->heading;
+		ahrs.indicatedAirspeed = ahrsData->indicatedAirspeed;
+		ahrs.trueAirspeed = ahrsData->trueAirspeed;
+		ahrs.msgId = ahrsData->msgId;
+		ahrs.subMsgId = ahrsData->subMsgId;
+		ahrs.headingIsTrue = (ahrsData->headingIsTrue == true) ? 1 : 0;
+
+		if (writer.WriteAhrs(ahrs) != 0)
+		{
+			return(-1);
+		}
+		numRecords++;
+	}
+
+	// removals first, a target that went and came back is then left there
+
+	for (unsigned int index = 0; (changeVersion != NULL) && (sinceVersion > 0) &&
+		(index < mRemovedCount); index++)
+	{
+		const struct removedTargetRec &removedTarget =
+			mRemovedRing[(mRemovedHead + index) % mRemovedRing.size()];
+
+		if (removedTarget.changeVersion <= sinceVersion)
+		{
+			continue;
+		}
+
+		if (writer.WriteRemoved(removedTarget.addressType, removedTarget.participantAddr) != 0)
+		{
+			return(-1);
+		}
+		numRecords++;
+	}
+
+	for (unsigned int dataIndex = 0; dataIndex < mTrafficStore.GetCount(); dataIndex++)
+	{
+		if ((changeVersion != NULL) && (mTrafficStore.changeVersion[dataIndex] <= sinceVersion))
+		{
+			continue;
+		}
+
+		GetTrafficReport(dataIndex, traffic.report);
+
+		traffic.range = mTrafficStore.range[dataIndex];
+		traffic.bearing = mTrafficStore.bearing[dataIndex];
+		traffic.slotId = mTrafficStore.GetSlotId(dataIndex);
+
+		if (writer.WriteTraffic(traffic) != 0)
+		{
+			return(-1);
+		}
+		numRecords++;
+	}
+
+	if (changeVersion != NULL)
+	{
+		*changeVersion = mChangeVersion;
+	}
+	return(numRecords);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a writer with this much room holds everything ExportRecords could write
+// right now
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetExportBufferSize()
+{
+	return(TRAFFIC_RECORD_STREAM_HEADER_SIZE + TRAFFIC_RECORD_HEARTBEAT_SIZE +
+		(2 * TRAFFIC_RECORD_AHRS_SIZE) + (mRemovedCount * TRAFFIC_RECORD_REMOVED_SIZE) +
+		(mTrafficStore.GetCount() * TRAFFIC_RECORD_TRAFFIC_SIZE));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// build one second's worth of GDL90 for an EFB into encoder: the latest
+// heartbeat, ownship if there is one and a traffic report for every other
+// target.  with no ownship passed in, targets the receiver reported with
+// ownship frames go out as ownship again.  returns the number of frames,
+// or -1 if the encoder ran out of room, what it holds is still whole frames
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::EncodeTrafficBurst(Gdl90Encoder &encoder, const struct trafficReportRec *ownship)
+{
+	struct heartbeatRecordRec heartbeat;
+	struct trafficReportRec report;
+	int numFrames = 0;
+
+	heartbeat.timestamp = mLatetestHeartbeat.timestamp;
+	heartbeat.msgCounts = mLatetestHeartbeat.msgCounts;
+	heartbeat.statusByte1 = mLatetestHeartbeat.statusByte1.statusByte;
+	heartbeat.statusByte2 = mLatetestHeartbeat.statusByte2.statusByte;
+
+	if (encoder.AddHeartbeat(heartbeat) != 0)
+	{
+		return(-1);
+	}
+	numFrames++;
+
+	if (ownship != NULL)
+	{
+		if (encoder.AddOwnship(*ownship) != 0)
+		{
+			return(-1);
+		}
+		numFrames++;
+	}
+
+	for (unsigned int dataIndex = 0; dataIndex < mTrafficStore.GetCount(); dataIndex++)
+	{
+		// the EFB would show ownship as traffic on top of itself
+
+		bool isOwnship = (mTrafficStore.msgId[dataIndex] == GDL90_ID_OWNSHIP);
+
+		if ((ownship != NULL) && ((isOwnship == true) ||
+			((mTrafficStore.participantAddr[dataIndex] == ownship->participantAddr) &&
+			(mTrafficStore.addressType[dataIndex] == ownship->addressType))))
+		{
+			continue;
+		}
+
+		GetTrafficReport(dataIndex, report);
+
+		int status = (isOwnship == true) ? encoder.AddOwnship(report) : encoder.AddTraffic(report);
+
+		if (status != 0)
+		{
+			return(-1);
+		}
+		numFrames++;
+	}
+	return(numFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// an encoder with this much room takes everything EncodeTrafficBurst could
+// write right now
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetBurstBufferSize()
+{
+	return(GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_HEARTBEAT_SIZE) +
+		((mTrafficStore.GetCount() + 1) * GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the traffic table as dump1090's aircraft.json, aircraftJson keeps the
+// rendered targets between calls.  returns the number of aircraft
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ExportAircraftJson(AircraftJson &aircraftJson, std::string &jsonData)
+{
+	// the same clock the targets were stamped with, a replay's included
+
+	return(aircraftJson.Export(mTrafficStore, (double)GetClockTime(), jsonData));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetNumTrafficReports()
+{
+	return(mTrafficStore.GetCount());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetLastMsgType()
+{
+	return(mLastMsgType);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetSatelliteCnt(int &numConnected, int &numLocked)
+{
+	numLocked = mStratuxStatusMessage.numSatsLocked;
+	numConnected  = mStratuxStatusMessage.numSatsConnected;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetTargetCnt(int &num978Targets, int &num1090Targets)
+{
+	num978Targets = mStratuxStatusMessage.num978Targets;
+
+	num1090Targets = mStratuxStatusMessage.num1090Targets;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetTowerCnt(int &numTowers)
+{
+	numTowers = mStratuxStatusMessage.numAdsbTowers;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetLastCallsign(std::string &callsign)
+{
+	callsign = mLastCallsign;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a box with minLongitude > maxLongitude crosses the 180 degree meridian
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetTrafficInBox(double minLatitude, double minLongitude,
+	double maxLatitude, double maxLongitude, std::vector<int> &dataIndexes)
+{
+	dataIndexes.clear();
+
+	mTrafficGrid.QueryBox(minLatitude, minLongitude, maxLatitude, maxLongitude, dataIndexes);
+
+	return(SlotsToDataIndexes(dataIndexes));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetTrafficInRadius(double latitude, double longitude, double radiusNm,
+	std::vector<int> &dataIndexes)
+{
+	dataIndexes.clear();
+
+	mTrafficGrid.QueryRadius(latitude, longitude, radiusNm, dataIndexes);
+
+	return(SlotsToDataIndexes(dataIndexes));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// nearest first
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetNearestTraffic(double latitude, double longitude, unsigned int maxTargets,
+	std::vector<int> &dataIndexes)
+{
+	dataIndexes.clear();
+
+	mTrafficGrid.QueryNearest(latitude, longitude, maxTargets, dataIndexes);
+
+	return(SlotsToDataIndexes(dataIndexes));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the grid works in slot ids, convert them in place
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SlotsToDataIndexes(std::vector<int> &slotIds)
+{
+	for (unsigned int index = 0; index < slotIds.size(); index++)
+	{
+		slotIds[index] = mTrafficStore.GetDataIndex(slotIds[index]);
+	}
+	return((int)slotIds.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// publish a snapshot every so many milliseconds as frames are decoded, 0
+// leaves it to PublishTrafficSnapshot
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetSnapshotInterval(unsigned int milliseconds)
+{
+	mSnapshotInterval = milliseconds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decoding thread only, copy the traffic table out for the readers
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::PublishTrafficSnapshot()
+{
+	unsigned int numTargets = mTrafficStore.GetCount();
+	unsigned int numRecords = numTargets;
+
+	// only copy what the snapshot can hold so the records never grow past
+	// their reservation, Publish counts the rest as truncated
+
+	if (numRecords > mTrafficSnapshot.GetCapacity())
+	{
+		numRecords = mTrafficSnapshot.GetCapacity();
+	}
+
+	mSnapshotRecords.resize(numRecords);
+
+	for (unsigned int dataIndex = 0; dataIndex < numRecords; dataIndex++)
+	{
+		struct trafficSnapshotRec &record = mSnapshotRecords[dataIndex];
+
+		memset(&record, 0, sizeof(record));
+
+		GetTrafficReport(dataIndex, record.report);
+
+		record.range = mTrafficStore.range[dataIndex];
+		record.bearing = mTrafficStore.bearing[dataIndex];
+		record.slotId = mTrafficStore.GetSlotId(dataIndex);
+	}
+
+	mTrafficSnapshot.Publish(mSnapshotRecords.data(), numTargets);
+
+	mLastSnapshotTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// safe from any thread.  fills snapshot with every target as of the last
+// publish and returns how many there are, never blocks the decoding thread
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ReadTrafficSnapshot(std::vector<struct trafficSnapshotRec> &snapshot)
+{
+	return(mTrafficSnapshot.Read(snapshot));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// targets left out of published snapshots because there wasn't room for them
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetNumSnapshotTruncated()
+{
+	return(mTrafficSnapshot.GetNumTruncated());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// copy a target out of the traffic table, msgId is the id of the frame that
+// last updated it
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetTrafficReport(unsigned int dataIndex, struct trafficReportRec &report)
+{
+	const std::string &callsign = mTrafficStore.cold[dataIndex].callsign;
+
+	memset(&report, 0, sizeof(report));
+
+	report.latitude = mTrafficStore.latitude[dataIndex];
+	report.longitude = mTrafficStore.longitude[dataIndex];
+	report.lastUpdate = mTrafficStore.lastUpdate[dataIndex];
+	report.participantAddr = mTrafficStore.participantAddr[dataIndex];
+	report.altitude = mTrafficStore.altitude[dataIndex];
+	report.horzVelocity = mTrafficStore.horzVelocity[dataIndex];
+	report.vertVelocity = mTrafficStore.vertVelocity[dataIndex];
+	report.trackHeading = mTrafficStore.trackHeading[dataIndex];
+	report.msgId = mTrafficStore.msgId[dataIndex];
+	report.addressType = mTrafficStore.addressType[dataIndex];
+	report.alertStatus = mTrafficStore.alertStatus[dataIndex];
+	report.miscIndicators = mTrafficStore.miscIndicators[dataIndex];
+	report.integrityCode = mTrafficStore.integrityCode[dataIndex];
+	report.accuracyCode = mTrafficStore.accuracyCode[dataIndex];
+	report.emitterCategory = mTrafficStore.emitterCategory[dataIndex];
+	report.emergencyPriorityCode = mTrafficStore.emergencyPriorityCode[dataIndex];
+
+	memcpy(report.callsign, callsign.c_str(),
+		std::min(callsign.size(), (size_t)TRAFFIC_REPORT_CALLSIGN_SIZE));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// TRAFFIC_FIELD_ bits for where trafficData differs from the stored target
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetChangedFields(const struct trafficReportRec &trafficData,
+	unsigned int dataIndex)
+{
+	unsigned int changedFields = 0;
+
+	if ((trafficData.latitude != mTrafficStore.latitude[dataIndex]) ||
+		(trafficData.longitude != mTrafficStore.longitude[dataIndex]))
+	{
+		changedFields |= TRAFFIC_FIELD_POSITION;
+	}
+	if (trafficData.altitude != mTrafficStore.altitude[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_ALTITUDE;
+	}
+	if (trafficData.horzVelocity != mTrafficStore.horzVelocity[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_HORZ_VELOCITY;
+	}
+	if (trafficData.vertVelocity != mTrafficStore.vertVelocity[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_VERT_VELOCITY;
+	}
+	if (trafficData.trackHeading != mTrafficStore.trackHeading[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_TRACK_HEADING;
+	}
+	if (mTrafficStore.cold[dataIndex].callsign.compare(0, std::string::npos,
+		trafficData.callsign, TrafficReportCallsignLength(trafficData)) != 0)
+	{
+		changedFields |= TRAFFIC_FIELD_CALLSIGN;
+	}
+	if (trafficData.alertStatus != mTrafficStore.alertStatus[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_ALERT_STATUS;
+	}
+	if (trafficData.miscIndicators != mTrafficStore.miscIndicators[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_MISC_INDICATORS;
+	}
+	if (trafficData.integrityCode != mTrafficStore.integrityCode[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_INTEGRITY_CODE;
+	}
+	if (trafficData.accuracyCode != mTrafficStore.accuracyCode[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_ACCURACY_CODE;
+	}
+	if (trafficData.emitterCategory != mTrafficStore.emitterCategory[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_EMITTER_CATEGORY;
+	}
+	if (trafficData.emergencyPriorityCode != mTrafficStore.emergencyPriorityCode[dataIndex])
+	{
+		changedFields |= TRAFFIC_FIELD_EMERGENCY_CODE;
+	}
+	return(changedFields);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a report that only carries some of the fields, a UAT basic report has no
+// callsign for one, takes the rest from the target's last report
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::MergeTrafficFields(struct trafficReportRec &trafficData,
+	unsigned int presentFields)
+{
+	int dataIndex = mTrafficStore.FindAddress(trafficData.addressType,
+		trafficData.participantAddr);
+
+	if ((dataIndex < 0) || ((presentFields & TRAFFIC_FIELD_ALL) == TRAFFIC_FIELD_ALL))
+	{
+		return;
+	}
+
+	if ((presentFields & TRAFFIC_FIELD_POSITION) == 0)
+	{
+		trafficData.latitude = mTrafficStore.latitude[dataIndex];
+		trafficData.longitude = mTrafficStore.longitude[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_ALTITUDE) == 0)
+	{
+		trafficData.altitude = mTrafficStore.altitude[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_HORZ_VELOCITY) == 0)
+	{
+		trafficData.horzVelocity = mTrafficStore.horzVelocity[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_VERT_VELOCITY) == 0)
+	{
+		trafficData.vertVelocity = mTrafficStore.vertVelocity[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_TRACK_HEADING) == 0)
+	{
+		trafficData.trackHeading = mTrafficStore.trackHeading[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_CALLSIGN) == 0)
+	{
+		const std::string &callsign = mTrafficStore.cold[dataIndex].callsign;
+
+		memset(trafficData.callsign, 0, TRAFFIC_REPORT_CALLSIGN_SIZE);
+		memcpy(trafficData.callsign, callsign.c_str(),
+			std::min(callsign.size(), (size_t)TRAFFIC_REPORT_CALLSIGN_SIZE));
+	}
+	if ((presentFields & TRAFFIC_FIELD_ALERT_STATUS) == 0)
+	{
+		trafficData.alertStatus = mTrafficStore.alertStatus[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_MISC_INDICATORS) == 0)
+	{
+		trafficData.miscIndicators = mTrafficStore.miscIndicators[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_INTEGRITY_CODE) == 0)
+	{
+		trafficData.integrityCode = mTrafficStore.integrityCode[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_ACCURACY_CODE) == 0)
+	{
+		trafficData.accuracyCode = mTrafficStore.accuracyCode[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_EMITTER_CATEGORY) == 0)
+	{
+		trafficData.emitterCategory = mTrafficStore.emitterCategory[dataIndex];
+	}
+	if ((presentFields & TRAFFIC_FIELD_EMERGENCY_CODE) == 0)
+	{
+		trafficData.emergencyPriorityCode = mTrafficStore.emergencyPriorityCode[dataIndex];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stamp the target with a new change version for SerializeTrafficTable
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::MarkChanged(unsigned int dataIndex)
+{
+	mTrafficStore.changeVersion[dataIndex] = ++mChangeVersion;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// call callback on the decoding thread for each wanted change, returns the
+// subscriber id or -1 if there are already TRAFFIC_FEED_MAX_SUBSCRIBERS
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SubscribeTrafficChanges(TrafficFeed::ChangeCallback callback, void *context,
+	unsigned int kindMask, unsigned int fieldMask)
+{
+	return(mTrafficFeed.Subscribe(callback, context, kindMask, fieldMask));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// queue up to queueSize wanted changes for ReadTrafficChanges, which one
+// other thread may call
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SubscribeTrafficChanges(unsigned int queueSize,
+	unsigned int kindMask, unsigned int fieldMask)
+{
+	return(mTrafficFeed.Subscribe(queueSize, kindMask, fieldMask));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::UnsubscribeTrafficChanges(int subscriberId)
+{
+	return(mTrafficFeed.Unsubscribe(subscriberId));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ReadTrafficChanges(int subscriberId,
+	std::vector<struct trafficChangeRec> &changes, unsigned int maxChanges)
+{
+	return(mTrafficFeed.Read(subscriberId, changes, maxChanges));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetNumDroppedTrafficChanges(int subscriberId)
+{
+	return(mTrafficFeed.GetNumDropped(subscriberId));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::CheckSnapshotInterval()
+{
+	if (mSnapshotInterval == 0)
+	{
+		return;
+	}
+
+	long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	if ((now - mLastSnapshotTime) >= mSnapshotInterval)
+	{
+		PublishTrafficSnapshot();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetLastDataIndex()
+{
+	return(mTrafficStore.GetDataIndex(mLastSlotId));
+}
+///////////////////////////////////////////////////////////////////////////////
+// returns the data index for use with SerializeTrafficData or -1
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetDataIndex(unsigned char addressType, unsigned int participantAddr)
+{
+	return(mTrafficStore.FindAddress(addressType, participantAddr));
+}
+///////////////////////////////////////////////////////////////////////////////
+// the slot id stays the same for as long as the target is in the table,
+// unlike the data index.  -1 if dataIndex is out of range
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetSlotId(unsigned int dataIndex)
+{
+	return(mTrafficStore.GetSlotId(dataIndex));
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetParticipantAddress(std::string callsign, unsigned char &addrType,
+										unsigned int &address)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		addrType = mTrafficStore.addressType[dataIndex];
+		address = mTrafficStore.participantAddr[dataIndex];
+
+		status = 0;
+	}
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetLastUpdate(std::string callsign, unsigned int &updateTime)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		updateTime = mTrafficStore.lastUpdate[dataIndex];
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetLocation(std::string callsign,
+	double &latitude, double &longitude, double &altitude)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		latitude = mTrafficStore.latitude[dataIndex];
+		longitude = mTrafficStore.longitude[dataIndex];
+		altitude = mTrafficStore.altitude[dataIndex];
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetHeading(std::string callsign, float &heading)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		heading = mTrafficStore.trackHeading[dataIndex];
+
+		status = 0;
+	}
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetHorzVelocity(std::string callsign, float& velocity)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		velocity = mTrafficStore.horzVelocity[dataIndex];
+
+		status = 0;
+	}
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetVertVelocity(std::string callsign, float &velocity)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		velocity = mTrafficStore.vertVelocity[dataIndex];
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetAircraftOwnerInfo(std::string callsign, unsigned int &address,
+	std::string &nNumber, std::string &name, int &typeAircraft, int &typeEngine)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		address = mTrafficStore.cold[dataIndex].address;
+		nNumber = mTrafficStore.cold[dataIndex].nNumber;
+		name = mTrafficStore.cold[dataIndex].name;
+		typeAircraft = mTrafficStore.cold[dataIndex].typeAircraft;
+		typeEngine = mTrafficStore.cold[dataIndex].typeEngine;
+
+		status = 0;
+	}
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SetAircraftOwnerInfo(std::string callsign, unsigned int address,
+	std::string nNumber, std::string name, int typeAircraft, int typeEngine)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		mTrafficStore.cold[dataIndex].address = address;
+		mTrafficStore.cold[dataIndex].nNumber = nNumber;
+		mTrafficStore.cold[dataIndex].name = name;
+		mTrafficStore.cold[dataIndex].typeAircraft = typeAircraft;
+		mTrafficStore.cold[dataIndex].typeEngine = typeEngine;
+
+		MarkChanged(dataIndex);
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::SetRangeValues(std::string callsign, float range, float bearing)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		mTrafficStore.range[dataIndex] = range;
+		mTrafficStore.bearing[dataIndex] = bearing;
+
+		MarkChanged(dataIndex);
+
+		status = 0;
+	}
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetRangeValues(std::string callsign, float &range, float &bearing)
+{
+	int status = -1;
+	int dataIndex = mTrafficStore.FindCallsign(callsign);
+
+	if (dataIndex >= 0)
+	{
+		range = mTrafficStore.range[dataIndex];
+		bearing = mTrafficStore.bearing[dataIndex];
+
+		status = 0;
+
+	}
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+// hand uplink frames to callback instead of decoding them, the frame is only
+// valid during the call.  NULL goes back to decoding them inline
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetUplinkCallback(UplinkCallback callback, void *context)
+{
+	mUplinkCallback = callback;
+	mUplinkContext = context;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// record the application data of every uplink, the way the old
+// appDataDump files did, NULL stops recording.  the writer must be started
+// and outlive the wrapper's use of it
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetUplinkCapture(CaptureWriter *captureWriter)
+{
+	mUplinkCapture = captureWriter;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// hand the FIS-B products of every uplink decoded inline to fisbDecoder,
+// NULL stops it.  with an uplink callback set the uplinks are decoded
+// elsewhere, give what UplinkDecoder::Poll returns to the decoder instead
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::SetFisbDecoder(FisbDecoder *fisbDecoder)
+{
+	mFisbDecoder = fisbDecoder;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the last uplink decoded inline, -1 if there hasn't been one
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::GetLastUplinkData(struct uplinkDataRec &uplinkData)
+{
+	int status = -1;
+
+	if (mUplinkDataValid == true)
+	{
+		uplinkData = mUplinkData;
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// msgBuf points at the message id of an unstuffed uplink frame of msgSize
+// bytes counting both flag positions, the same as DecodeTrafficReport.
+// touches nothing but uplinkData so any thread may call it
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeUplinkData(unsigned int msgSize, const unsigned char *msgBuf,
+	struct uplinkDataRec &uplinkData)
+{
+	int status = -1;
+
+	memset(&uplinkData, 0, offsetof(struct uplinkDataRec, infoFrames));
+
+	if ((msgBuf[0] != GDL90_ID_UPLINK_DATA) || (msgSize < UPLINK_FRAME_OVERHEAD))
+	{
+		return(status);
+	}
+
+	uplinkData.timeOfReception = (msgBuf[1] << 16) | (msgBuf[2] << 8) | msgBuf[3];
+
+	const unsigned char *headerBuf = &msgBuf[4];
+
+	unsigned int rawLatitude = (headerBuf[0] << 15) | (headerBuf[1] << 7) | (headerBuf[2] >> 1);
+	unsigned int rawLongitude = ((headerBuf[2] & 0x01) << 23) | (headerBuf[3] << 15) |
+		(headerBuf[4] << 7) | (headerBuf[5] >> 1);
+
+	uplinkData.latitude = rawLatitude * GDL90_LAT_LONG_RES;
+	uplinkData.longitude = rawLongitude * GDL90_LAT_LONG_RES;
+
+	if (uplinkData.latitude > 90.0)
+	{
+		uplinkData.latitude -= 180.0;
+	}
+
+	if (uplinkData.longitude > 180.0)
+	{
+		uplinkData.longitude -= 360.0;
+	}
+
+	uplinkData.positionValid = headerBuf[5] & 0x01;
+	uplinkData.utcCoupled = (headerBuf[6] >> 7) & 0x01;
+	uplinkData.appDataValid = (headerBuf[6] >> 5) & 0x01;
+	uplinkData.slotId = headerBuf[6] & 0x1f;
+	uplinkData.tisbSiteId = (headerBuf[7] >> 4) & 0x0f;
+
+	status = 0;
+
+	if (uplinkData.appDataValid != 0)
+	{
+		status = ParseApplicationData(msgSize - UPLINK_FRAME_OVERHEAD, &headerBuf[UPLINK_HEADER_SIZE],
+			uplinkData);
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// copy the application data into uplinkData and split it into information
+// frames, each a 9 bit length and a 4 bit type followed by the data.  a zero
+// length APDU frame is padding and ends the list.  returns -1 if the frames
+// run past the end of the data
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ParseApplicationData(int appDataLen, const unsigned char *appData,
+	struct uplinkDataRec &uplinkData)
+{
+	int status = 0;
+	unsigned int dataIndex = 0;
+
+	if ((appDataLen < 0) || (appData == NULL))
+	{
+		return(-1);
+	}
+
+	if (appDataLen > UPLINK_APP_DATA_SIZE)
+	{
+		appDataLen = UPLINK_APP_DATA_SIZE;
+	}
+
+	memcpy(uplinkData.appData, appData, appDataLen);
+
+	uplinkData.appDataLen = (uint16_t)appDataLen;
+	uplinkData.numInfoFrames = 0;
+
+	while (((dataIndex + 2) <= (unsigned int)appDataLen) &&
+		(uplinkData.numInfoFrames < UPLINK_MAX_INFO_FRAMES))
+	{
+		unsigned int iFrameLen = uplinkInfoFrameLayout::length::Get(&appData[dataIndex]);
+		unsigned char frameType = (unsigned char)uplinkInfoFrameLayout::frameType::Get(&appData[dataIndex]);
+
+		if ((iFrameLen == 0) && (frameType == UPLINK_INFO_FRAME_APDU))
+		{
+			break;
+		}
+
+		if ((dataIndex + 2 + iFrameLen) > (unsigned int)appDataLen)
+		{
+			status = -1;
+			break;
+		}
+
+		struct uplinkInfoFrameRec &infoFrame = uplinkData.infoFrames[uplinkData.numInfoFrames];
+
+		infoFrame.offset = (uint16_t)(dataIndex + 2);
+		infoFrame.length = (uint16_t)iFrameLen;
+		infoFrame.type = frameType;
+		infoFrame.reserved = 0;
+
+		uplinkData.numInfoFrames++;
+
+		dataIndex += iFrameLen + 2;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// appData is the application data of an uplink with the ground station's
+// header already removed, the frames end up in GetLastUplinkData
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::ParseApplicationData(int appDataLen, unsigned char *msgBuf)
+{
+	if ((mUplinkCapture != NULL) && (appDataLen > 0))
+	{
+		mUplinkCapture->Write(appDataLen, (const char *)msgBuf);
+	}
+
+	memset(&mUplinkData, 0, offsetof(struct uplinkDataRec, infoFrames));
+
+	int status = ParseApplicationData(appDataLen, msgBuf, mUplinkData);
+
+	mUplinkDataValid = (status == 0);
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AdsbWrapper::GetLatestTimestamp()
+{
+	return(mLatetestHeartbeat.timestamp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the latest heartbeat in the form the record stream and encoder use
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetLatestHeartbeat(struct heartbeatRecordRec &heartbeat)
+{
+	heartbeat.timestamp = mLatetestHeartbeat.timestamp;
+	heartbeat.msgCounts = mLatetestHeartbeat.msgCounts;
+	heartbeat.statusByte1 = mLatetestHeartbeat.statusByte1.statusByte;
+	heartbeat.statusByte2 = mLatetestHeartbeat.statusByte2.statusByte;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AdsbWrapper::GetOwnshipCallsign(std::string &callsign)
+{
+	callsign = mOwnshipCallsign;
+}
+///////////////////////////////////////////////////////////////////////////////
+// the 1090ES airborne position ME field.  the altitude is only decoded
+// when it is in 25 ft steps, a Gray coded (Q bit clear) altitude comes back
+// with altitudeValid false.  the CPR values still need an even and odd pair
+// or a reference position to become a location
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeAirPositionReport(const unsigned char *msgBuf,
+	struct airPositionRec &position)
+{
+	int status = -1;
+
+	memset(&position, 0, sizeof(position));
+
+	if (msgBuf != NULL)
+	{
+		position.typeCode = (unsigned char)esAirPositionLayout::typeCode::Get(msgBuf);
+		position.survStatus = (unsigned char)esAirPositionLayout::survStatus::Get(msgBuf);
+		position.nicSupplement = (unsigned char)esAirPositionLayout::nicSupplement::Get(msgBuf);
+		position.timeFlag = (unsigned char)esAirPositionLayout::timeFlag::Get(msgBuf);
+		position.cprOdd = (unsigned char)esAirPositionLayout::cprOdd::Get(msgBuf);
+		position.latCpr = esAirPositionLayout::latCpr::Get(msgBuf);
+		position.lonCpr = esAirPositionLayout::lonCpr::Get(msgBuf);
+
+		unsigned int altValue = esAirPositionLayout::altitude::Get(msgBuf);
+
+		if ((altValue & 0x10) != 0)
+		{
+			// drop the Q bit to get 11 bits of 25 ft steps
+
+			altValue = ((altValue & 0xfe0) >> 1) | (altValue & 0x0f);
+
+			position.altitude = ((int)altValue * 25) - 1000;
+			position.altitudeValid = true;
+		}
+
+		status = 0;
+	}
+
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+static const char base40_alphabet[41] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ  ..";
+///////////////////////////////////////////////////////////////////////////////
+// the base 40 callsign in the first 6 bytes of mode status into
+// callsign[TRAFFIC_REPORT_CALLSIGN_SIZE], trailing spaces become 0 the way
+// they do for a traffic report
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeCallsign(const unsigned char *msgBuf,
+	unsigned char &emitterCategory, char *callsign)
+{
+	int status = -1;
+
+	if ((msgBuf != NULL) && (callsign != NULL))
+	{
+		unsigned short value = (unsigned short)uatModeStatusLayout::callsignWord0::Get(msgBuf);
+
+		emitterCategory = (value / 1600) % 40;
+
+		callsign[0] = base40_alphabet[(value / 40) % 40];
+		callsign[1] = base40_alphabet[value % 40];
+
+		value = (unsigned short)uatModeStatusLayout::callsignWord1::Get(msgBuf);
+		callsign[2] = base40_alphabet[(value / 1600) % 40];
+		callsign[3] = base40_alphabet[(value / 40) % 40];
+		callsign[4] = base40_alphabet[value % 40];
+
+		value = (unsigned short)uatModeStatusLayout::callsignWord2::Get(msgBuf);
+		callsign[5] = base40_alphabet[(value / 1600) % 40];
+		callsign[6] = base40_alphabet[(value / 40) % 40];
+		callsign[7] = base40_alphabet[value % 40];
+
+		int tempIndex = TRAFFIC_REPORT_CALLSIGN_SIZE - 1;
+
+		while ((tempIndex >= 0) && (callsign[tempIndex] == ' '))
+		{
+			callsign[tempIndex] = 0;
+			tempIndex--;
+		}
+
+		status = 0;
+	}
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a basic (0x1E) or long (0x1F) UAT report straight out of the frame, msgBuf
+// points at the message id and msgSize counts both flag positions, the same
+// as DecodeTrafficReport.  presentFields gets the TRAFFIC_FIELD_ bits for
+// what the report actually carried, everything else in trafficData is 0.
+// safe to call from any thread
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeUatReport(unsigned int msgSize, const unsigned char *msgBuf,
+	struct trafficReportRec &trafficData, unsigned int &presentFields)
+{
+	int status = -1;
+
+	memset(&trafficData, 0, sizeof(trafficData));
+	presentFields = 0;
+
+	// flag, id, time of reception, payload, crc, flag
+
+	if (((msgBuf[0] == GDL90_ID_BASIC_REPORT) || (msgBuf[0] == GDL90_ID_LONG_REPORT)) &&
+		(msgSize >= (GDL90_UAT_BASIC_PAYLOAD_SIZE + 8)))
+	{
+		trafficData.msgId = msgBuf[0];
+
+		status = DecodePayloadHeader(&msgBuf[4], msgSize - 8, trafficData, presentFields);
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// msgBuf is the UAT payload, payloadLen long.  the payload type picks which
+// parts follow the header and state vector, see DO-282B table 2-10 and
+// dump978's uat_decode.c
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodePayloadHeader(const unsigned char *msgBuf, unsigned int payloadLen,
+	struct trafficReportRec &trafficData, unsigned int &presentFields)
+{
+	int status = -1;
+
+	if ((msgBuf != NULL) && (payloadLen >= GDL90_UAT_BASIC_PAYLOAD_SIZE))
+	{
+		// the address qualifier numbers the same address types as a GDL90
+		// traffic report:
+		// 0 ADS - B target with ICAO 24 - bit address 3.2.1.5.1.3.1
+		// 1 ADS - B target with self - assigned temporary address 3.2.1.5.1.3.2
+		// 2 TIS - B target with ICAO 24 - bit address 3.2.1.5.1.3.3
+		// 3 TIS - B target with track file identifier 3.2.1.5.1.3.4
+		// 4 Surface Vehicle 3.2.1.5.1.3.5
+		// 5 Fixed ADS - B Beacon 3.2.1.5.1.3.6
+		// 6 (Reserved)
+		// 7 (Reserved)
+
+		int addressQualifier = (int)uatHeaderLayout::addressQualifier::Get(msgBuf);
+		int payloadTypeCode = (int)uatHeaderLayout::payloadTypeCode::Get(msgBuf);
+
+		trafficData.addressType = (uint8_t)addressQualifier;
+		trafficData.participantAddr = uatHeaderLayout::participantAddr::Get(msgBuf);
+
+		// types 11 and up carry no state vector
+
+		if (payloadTypeCode <= 10)
+		{
+			status = DecodeStateVector(&msgBuf[4], trafficData, presentFields);
+		}
+
+		bool longPayload = (payloadLen >= GDL90_UAT_LONG_PAYLOAD_SIZE);
+
+		if (((payloadTypeCode == 1) || (payloadTypeCode == 3)) && (longPayload == true))
+		{
+			// decode Mode State message and Aux SV message -- refer to table 2-8 for rest of the payload types
+
+			DecodeModeStatus(&msgBuf[17], trafficData, presentFields);
+		}
+
+		if (((payloadTypeCode == 1) || (payloadTypeCode == 2) || (payloadTypeCode == 5) ||
+			(payloadTypeCode == 6)) && (longPayload == true))
+		{
+			// when the state vector altitude is geometric the auxiliary
+			// one is barometric, which is what a traffic report carries
+
+			int secondaryAltitude;
+
+			if ((DecodeAuxiliaryStateVector(&msgBuf[29], secondaryAltitude) == 0) &&
+				((uatStateVectorLayout::altitudeType::Get(&msgBuf[4]) == 1) ||
+				((presentFields & TRAFFIC_FIELD_ALTITUDE) == 0)))
+			{
+				trafficData.altitude = secondaryAltitude;
+				presentFields |= TRAFFIC_FIELD_ALTITUDE;
+			}
+		}
+
+		// target state (types 3, 4 and 6) isn't decoded yet
+	}
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// used the following doc to decode this
+// UAT-SWG02-WP04 - Draft Tech Manual V0-1.pdf
+// and libmodes-master\src\mode-s.c
+// UAT State vector, msgBuf is payload byte 4
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeStateVector(const unsigned char *msgBuf,
+	struct trafficReportRec &trafficData, unsigned int &presentFields)
+{
+	int status = -1;
+
+	if (msgBuf != NULL)
+	{
+		unsigned int latValue = uatStateVectorLayout::latitude::Get(msgBuf);
+		unsigned int lonValue = uatStateVectorLayout::longitude::Get(msgBuf);
+
+		unsigned char nic = (unsigned char)uatStateVectorLayout::integrityCode::Get(msgBuf);
+
+		trafficData.integrityCode = nic;
+		presentFields |= TRAFFIC_FIELD_INTEGRITY_CODE;
+
+		// no nic and a zero position means no position at all.  latitude is
+		// 23 bits covering 0 to 180 degrees with the south above 90
+
+		if ((nic != 0) || (latValue != 0) || (lonValue != 0))
+		{
+			trafficData.latitude = uatStateVectorLayout::latitude::GetValue(msgBuf);
+
+			if (trafficData.latitude > 90.0)
+			{
+				trafficData.latitude -= 180.0;
+			}
+
+			trafficData.longitude = uatStateVectorLayout::longitude::GetValue(msgBuf);
+
+			if (trafficData.longitude > 180.0)
+			{
+				trafficData.longitude -= 360.0;
+			}
+
+			presentFields |= TRAFFIC_FIELD_POSITION;
+		}
+
+// altitude based on 12 bit code, 0 means no altitude
+		unsigned int altValue = uatStateVectorLayout::altitude::Get(msgBuf);
+
+		if (altValue != 0)
+		{
+			trafficData.altitude = ((int)altValue - 1) * 25 - 1000;
+			presentFields |= TRAFFIC_FIELD_ALTITUDE;
+		}
+
+	// agState - 00 airborne subsonic, 01 = airborne supersonic,  10 on ground, 11 reserved
+		unsigned char agState = (unsigned char)uatStateVectorLayout::airGroundState::Get(msgBuf);
+
+		// misc indicators as a traffic report has them, bit 3 airborne and
+		// bits 0-1 what the track is: 1 true track, 2 magnetic heading, 3
+		// true heading
+
+		unsigned char trackType = 0;
+
+		if (agState <= 1)
+		{
+			// each velocity is 10 bits of knots plus one with a sign bit
+			// above them, 0 means no velocity.  supersonic is in 4 knot steps
+
+			int northVel = (int)uatStateVectorLayout::northVelocity::Get(msgBuf);
+			int eastVel = (int)uatStateVectorLayout::eastVelocity::Get(msgBuf);
+
+			if ((northVel != 0) && (eastVel != 0))
+			{
+				northVel--;
+				eastVel--;
+
+				if (uatStateVectorLayout::northSign::Get(msgBuf) != 0)
+				{
+					northVel = -northVel;
+				}
+				if (uatStateVectorLayout::eastSign::Get(msgBuf) != 0)
+				{
+					eastVel = -eastVel;
+				}
+				if (agState == 1)
+				{
+					northVel *= 4;
+					eastVel *= 4;
+				}
+
+				trafficData.horzVelocity = (int)lround(sqrt((double)(northVel * northVel) +
+					(double)(eastVel * eastVel)));
+				presentFields |= TRAFFIC_FIELD_HORZ_VELOCITY;
+
+				if ((northVel != 0) || (eastVel != 0))
+				{
+					double trackHeading = atan2((double)eastVel, (double)northVel) * 180.0 / M_PI;
+
+					trafficData.trackHeading = (float)((trackHeading < 0.0) ?
+						(trackHeading + 360.0) : trackHeading);
+					presentFields |= TRAFFIC_FIELD_TRACK_HEADING;
+
+					trackType = 1;
+				}
+			}
+
+			// 9 bits of 64 fpm steps plus one, sign bit above them
+
+			int vertVel = (int)uatStateVectorLayout::vertVelocity::Get(msgBuf);
+
+			if (vertVel != 0)
+			{
+				trafficData.vertVelocity = (vertVel - 1) * 64;
+
+				if (uatStateVectorLayout::vertSign::Get(msgBuf) != 0)
+				{
+					trafficData.vertVelocity = -trafficData.vertVelocity;
+				}
+				presentFields |= TRAFFIC_FIELD_VERT_VELOCITY;
+			}
+
+			trafficData.miscIndicators = 0x08;
+		}
+		else if (agState == 2)
+		{
+			// on the ground it is ground speed and a track or heading
+
+			int groundSpeed = (int)uatStateVectorLayout::groundSpeed::Get(msgBuf);
+
+			if (groundSpeed != 0)
+			{
+				trafficData.horzVelocity = groundSpeed - 1;
+				presentFields |= TRAFFIC_FIELD_HORZ_VELOCITY;
+			}
+
+			trackType = (unsigned char)uatStateVectorLayout::trackType::Get(msgBuf);
+
+			if (trackType != 0)
+			{
+				trafficData.trackHeading = (float)uatStateVectorLayout::groundTrack::GetValue(msgBuf);
+				presentFields |= TRAFFIC_FIELD_TRACK_HEADING;
+			}
+
+			trafficData.vertVelocity = 0;
+			presentFields |= TRAFFIC_FIELD_VERT_VELOCITY;
+		}
+
+		if (agState != 3)
+		{
+			trafficData.miscIndicators |= trackType;
+			presentFields |= TRAFFIC_FIELD_MISC_INDICATORS;
+		}
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// msgBuf is payload byte 17
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeModeStatus(const unsigned char *msgBuf,
+	struct trafficReportRec &trafficData, unsigned int &presentFields)
+{
+	int status = -1;
+	char callsign[TRAFFIC_REPORT_CALLSIGN_SIZE];
+	unsigned char emitterCategory;
+
+	// callsign uses bytes 0 -> 5
+
+	DecodeCallsign(msgBuf, emitterCategory, callsign);
+
+	// the rest of the fields are in uatModeStatusLayout, only these go in a
+	// traffic report
+
+	unsigned char priorityStatus = (unsigned char)uatModeStatusLayout::emergencyPriorityCode::Get(msgBuf);
+	unsigned char nacp = (unsigned char)uatModeStatusLayout::accuracyCode::Get(msgBuf);
+	unsigned char csid = (unsigned char)uatModeStatusLayout::callsignId::Get(msgBuf);
+
+	trafficData.emitterCategory = emitterCategory;
+	trafficData.emergencyPriorityCode = priorityStatus;
+	trafficData.accuracyCode = nacp;
+
+	presentFields |= TRAFFIC_FIELD_EMITTER_CATEGORY | TRAFFIC_FIELD_EMERGENCY_CODE |
+		TRAFFIC_FIELD_ACCURACY_CODE;
+
+	// with csid clear the field holds the squawk code, not a callsign
+
+	if (csid == 1)
+	{
+		memcpy(trafficData.callsign, callsign, TRAFFIC_REPORT_CALLSIGN_SIZE);
+		presentFields |= TRAFFIC_FIELD_CALLSIGN;
+	}
+
+	status = 0;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeCapabilityCodes(unsigned char *msgBuf)
+{
+	int status = -1;
+
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+// the secondary altitude, msgBuf is payload byte 29.  returns -1 when it
+// isn't there
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeAuxiliaryStateVector(const unsigned char *msgBuf, int &altitude)
+{
+	int status = -1;
+
+	if (msgBuf != NULL)
+	{
+		unsigned int altValue = uatAuxStateVectorLayout::altitude::Get(msgBuf);
+
+		if (altValue != 0)
+		{
+			altitude = ((int)altValue - 1) * 25 - 1000;
+
+			status = 0;
+		}
+	}
+
+	return(status);
+}
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeTargetState(unsigned char *msgBuf)
+{
+	int status = -1;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AdsbWrapper::DecodeTrajectoryChange(unsigned char *msgBuf)
+{
+	int status = -1;
+
+	return(status);
+}
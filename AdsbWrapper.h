@@ -1,365 +1,586 @@
-//
-// AdsbWrapper.h: ADSB decoding 
-//
-// Copyright (c) 2019 Bruce Clay
-
-// Portions of thei code was adapted from dump1090 and dump978
-// Copyright (c) 2017 Oliver Jowett <oliver@mutability.co.uk>
-
-// This file is free software: you may copy, redistribute and/or modify it
-// under the terms of the GNU General Public License as published by the
-// Free Software Foundation, either version 2 of the License, or (at your
-// option) any later version.
-//
-// This file is distributed in the hope that it will be useful, but
-// WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-// General Public License for more details.
-//
-
-#ifndef _ADSB_WRAPPER_H_
-#define _ADSB_WRAPPER_H_
-
-#include <qlist.h>
-#include <map>
-
-#define GDL90_FLAGBYTE 0x7E
-#define GDL90_ESCAPEBYTE 0x7D
-
-#define GDL90_ID_HEARTBEAT 0x00
-#define GDL90_ID_HEARTBEAT_SIZE 0x09
-
-#define GDL90_ID_INIT 0x02
-#define GDL90_ID_INIT_SIZE 0x03
-
-#define GDL90_ID_UPLINK_DATA 0x07
-#define GDL90_ID_UPLINK_DATA_SIZE 0x01B6 /* 438 bytes */
-
-#define GDL90_ID_HEIGHT_AGL 0x09
-
-#define GDL90_ID_OWNSHIP 0x0A  // decimal 10
-#define GDL90_ID_OWNSHIP_SIZE 0x1E /* 30 bytes */  // spec states 28 bytes
-
-#define GDL90_ID_OWNSHIP_ALTITUDE 0x0B  // decimal 11
-
-#define GDL90_ID_BASIC_REPORT 0x1E // Basic UAT report
-#define GDL90_ID_LONG_REPORT 0x1F // Long report
-
-#define GDL90_ID_TRAFFIC 0x14  // decimal 20
-#define GDL90_ID_TRAFFIC_SIZE 0x1E /* 30 bytes */ // spec states 28 bytes
-
-#define GDL90_ID_BASIC_REPORT 0x1E
-#define GDL90_ID_LONG_REPORT 0x1F
-
-#define GDL90_ID_STRATUX_HEARTBEAT0 0xCC
-#define GDL90_ID_STRATUX_HEARTBEAT1 0x5358
-
-#define GDL90_ID_STRATUX_AHRS 0x4C
-#define GDL90_ID_STRATUX_AHRS_SIZE 0x1A /* 26 bytes */
-
-#define GDL90_ID_GPS_TIME 0x65 // 101 decimal
-#define FOREFRONT_AHRS 0x65 // 101 decimal
-
-class AdsbWrapper
-{
-
-#define GDL90_LAT_LONG_RES (180.0f / 8388608.0f)
-	/*
-	message types
-	  heartbeat
-	  initialization
-	  uplink data
-	  ownship report
-	  traffic report
-	  pass through report
-	  height above terrain
-	  ownship geometric altitude
-	*/
-
-	enum emergencyOrPriorityCodeKinds
-	{
-		noEmergency,
-		generalEmergency,
-		medicalEmergency,
-		minimumFuel,
-		noCommunication,
-		unlawfulInterference,
-		downedAircraft
-	};
-
-	enum addressKinds
-	{
-		adsbWithIcaoAddress,
-		adsbWithSelfAssignedAddress,
-		tisbWithIcaoAddress,
-		tisbWithTrackFileId,
-		surfaceVehicle,
-		groundStationBeacon
-	};
-
-	struct statusBitsRec1
-	{
-		unsigned uatInitialized : 1;
-		unsigned reserved : 1;
-		unsigned statRatcs : 1;
-		unsigned statGpsBattLow : 1;
-		unsigned stataddrType : 1;
-		unsigned statIdent : 1;
-		unsigned statMaintReqd : 1;
-		unsigned statGpsPosValid : 1;
-	};
-
-	enum emitterCategoryKinds
-	{
-		noAircraftTypeInformation = 0,
-
-		// ICAO < 15,500 lbs
-		light = 1,
-
-		// [15000 lbs, 75000 lbs]
-		small = 2,
-
-		// [75000 lbs, 300000 lbs]
-		large = 3,
-
-		// Aircraft such as a B757
-		highVortexLarge = 4,
-
-		// > 300,000 lbs
-		heavy = 5,
-
-		// > 5g acceleration and high speed
-		highlyManeuverable = 6,
-
-		rotorcraft = 7,
-		gliderOrSailplane = 9,
-		lighterThanAir = 10,
-		parachutistOrSkyDiver = 11,
-		ultraLightOrHangGliderOrParaGlider = 12,
-		uav = 14,
-		space = 15,
-		surfaceEmergencyVehicle = 17,
-		surfaceServiceVehicle = 18,
-		pointObstacle = 19,
-		clusterObstacle = 20,
-		lineObstacle = 21
-	};
-
-	enum trafficAlertStatusKind
-	{
-		noAlert,
-		trafficAlert
-	};
-
-	union statusByteRec1
-	{
-		struct statusBitsRec1 bits;
-		unsigned char statusByte;
-	};
-
-	struct statusBitsRec2
-	{
-		unsigned utcOk : 1;
-		unsigned reserved4 : 1;
-		unsigned reserved3 : 1;
-		unsigned reserved2 : 1;
-		unsigned reserved1 : 1;
-		unsigned csaNotAvail : 1;
-		unsigned csaRequested : 1;
-		unsigned timestamp : 1;
-	};
-
-	union statusByteRec2
-	{
-		struct statusBitsRec2 bits;
-		unsigned char statusByte;
-	};
-
-	struct heartbeatMsgRec
-	{
-		unsigned char msgId;
-		statusByteRec1 statusByte1;
-		statusByteRec2 statusByte2;
-		unsigned int timestamp;
-		unsigned short msgCounts;
-		unsigned short crc;
-	};
-
-	struct trafficReportNumRec
-	{
-		unsigned char alertStatus;
-		unsigned char addressType;
-		unsigned int participantAddr;
-		double latitude;
-		double longitude;
-		int altitude;
-		unsigned char miscIndicators;
-		unsigned char integrityCode;
-		unsigned char accuracyCode;
-		int horzVelocity;
-		int vertVelocity;
-		float trackHeading;
-		unsigned char emitterCategory;  // what size
-		std::string callsign;
-		unsigned char emergencyPriorityCode;  // what size
-		unsigned char crc[2];
-
-		int address;
-		std::string nNumber;
-		std::string name;
-		int typeAircraft;
-		int typeEngine;
-
-		float range;
-		float bearing;
-		time_t lastUpdate;
-	};
-
-
-	struct ahrsMsgRec
-	{
-		unsigned char msgId;
-		unsigned char subMsgId;
-		unsigned char roll[2];
-		unsigned char pitch[2];
-		unsigned char heading[2];
-		unsigned char indicatedAirspeed[2];
-		unsigned char trueAirspeed[2];
-	};
-	struct ahrsDataRec
-	{
-		unsigned char msgId;
-		unsigned char subMsgId;
-		float roll;
-		float pitch;
-		float heading;
-		bool headingIsTrue;
-		unsigned short indicatedAirspeed;
-		unsigned short trueAirspeed;
-	};
-
-	struct stratuxStatusMsgRec
-	{
-		unsigned char msgVersion;
-		unsigned char versionBuf[4];
-		unsigned int hardwareRevCode;
-		unsigned short validAndEnableFlags;
-		unsigned short connectHardwareFlags;
-		unsigned char numSatsLocked;
-		unsigned char numSatsConnected;
-		unsigned short num978Targets;
-		unsigned short num1090Targets;
-		unsigned short num978MsgRate;
-		unsigned short num1090MsgRate;
-		float cpuTemp;
-		unsigned char numAdsbTowers;
-	};
-
-public:
-	AdsbWrapper();
-
-	void CrcInit(void);
-	unsigned int CrcCompute(unsigned char *block, unsigned int length);
-	unsigned int CalculateCrc(unsigned char *msgBuf, int msgSize);
-
-	void ClearAhrsData(struct ahrsDataRec &data);
-	void ClearAircraftData(struct trafficReportNumRec &srcData);
-	void ClearHeartbeatInfo(struct heartbeatMsgRec &msg);
-	void ClearTrafficDataList();
-
-	void CopyAircraftData(struct trafficReportNumRec &srcData, struct trafficReportNumRec&tgtData);
-
-	unsigned int GetUint32(unsigned char *dataBuf);
-	unsigned int GetUint24(unsigned char *dataBuf);
-	unsigned short GetUint16(unsigned char *dataBuf);
-
-	int DecodeMessage(unsigned int msgSize, char *msgBuf, bool filterData = true);
-	int GetGeodeticLocation(unsigned char *dataBuf, double &location);
-
-	int DecodeTrafficMessage(unsigned int msgSize, unsigned char *msgBuf, struct trafficReportNumRec &trafficData);
-	
-	int DecodeAirPositionReport(unsigned char *msgBuf);
-	int DecodeCallsign(unsigned char *msgBuf, 
-					unsigned char &emitterCategory, std::string &callsign);
-
-	int DecodePayloadHeader(unsigned char *msgBuf);
-	int DecodeStateVector(unsigned char *msgBuf);
-
-	int DecodeModeStatus(unsigned char *msgBuf);
-	int DecodeCapabilityCodes(unsigned char *msgBuf);
-	int DecodeAuxiliaryStateVector(unsigned char *msgBuf);
-	int DecodeTargetState(unsigned char *msgBuf);
-	int DecodeTrajectoryChange(unsigned char *msgBuf);
-
-	int GetLastMsgType();
-	void GetLastCallsign(std::string &callsign);
-
-	int GetNumTrafficReports();
-
-	int GetLocation(std:: string callsign,
-		double &latitude, double &longitude, double &altitude);
-
-	int GetHeading(std::string callsign, float &heading);
-	int GetHorzVelocity(std::string callsign, float &velocity);
-	int GetVertVelocity(std::string callsign, float &velocity);
-
-	int GetAircraftOwnerInfo(std::string callsign, unsigned int &address,
-		std::string &nNumber, std::string &name, int &typeAircraft, int &typeEngine);
-
-	int SetAircraftOwnerInfo(std::string callsign, unsigned int address,
-		std::string nNumber, std::string name, int typeAircraft, int typeEngine);
-
-	int GetLastUpdate(std::string callsign, unsigned int &updateTime);
-
-	int GetParticipantAddress(std::string callsign, unsigned char &addrType,
-		unsigned int &address);
-
-	int GetLastDataIndex();
-	unsigned int GetLatestTimestamp();
-
-	void GetSatelliteCnt(int &numConnected, int &numLocked);
-	void GetTargetCnt(int &num978Targets, int &num1090Targets);
-	void GetTowerCnt(int &numTowers);
-
-	void GetOwnshipCallsign(std::string &callsign);
-
-	int ParseApplicationData(int appDataLen, unsigned char *appData);
-
-	int SerializeTrafficData(unsigned int dataIndex, char delimiter,
-		std::string &serializedData);
-
-	int SerializeTrafficData(struct trafficReportNumRec *dataPtr,
-		char delimiter, std::string &serializedData);
-
-	int SetRangeValues(std::string callsign, float range, float bearing);
-	int GetRangeValues(std::string callsign, float &range, float &bearing);
-
-protected:
-	struct trafficReportNumRec *GetAircraftInfo(std::string callsign, unsigned int &dataIndex);
-	struct trafficReportNumRec *GetTrafficInfo(std::string callsign, unsigned int &dataIndex);
-
-
-private:
-	struct heartbeatMsgRec mLatetestHeartbeat;
-	struct heartbeatMsgRec mTestHeartbeat;
-
-	struct ahrsDataRec mAhrsData;
-	struct ahrsDataRec mStatuxAhrsData;
-
-	struct trafficReportNumRec mOwnshipData;
-
-	QList<struct trafficReportNumRec *> mAircraftInfoList;
-
-	struct stratuxStatusMsgRec mStratuxStatusMessage;
-
-	int mLastMsgType;
-	std::string mLastCallsign;
-
-	unsigned short mCrc16Table[256];
-
-	int mLastDataIndex;
-
-	std::string mOwnshipCallsign;
-};
-
+//
+// AdsbWrapper.h: ADSB decoding 
+//
+// Copyright (c) 2019 Bruce Clay
+
+// Portions of thei code was adapted from dump1090 and dump978
+// Copyright (c) 2017 Oliver Jowett <oliver@mutability.co.uk>
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _ADSB_WRAPPER_H_
+#define _ADSB_WRAPPER_H_
+
+#include <map>
+#include <string>
+
+#include "Gdl90Defs.h"
+#include "Gdl90Framer.h"
+#include "TimerWheel.h"
+#include "TrafficFeed.h"
+#include "TrafficGrid.h"
+#include "TrafficRecord.h"
+#include "TrafficReport.h"
+#include "TrafficSnapshot.h"
+#include "TrafficStore.h"
+#include "UplinkData.h"
+
+class AircraftJson;
+class CaptureWriter;
+class FisbDecoder;
+class Gdl90Encoder;
+class TrafficRecordWriter;
+
+// address types are 4 bits, each one has its own time to live in seconds
+
+#define ADSB_NUM_ADDRESS_TYPES 16
+#define ADSB_DEFAULT_TIME_TO_LIVE 60
+#define ADSB_DEFAULT_TISB_TIME_TO_LIVE 30
+#define ADSB_DEFAULT_SURFACE_TIME_TO_LIVE 30
+
+// reports kept when DecodeMessage is called with filterData off
+
+#define ADSB_DEFAULT_HISTORY_LIMIT 4096
+
+// targets the traffic table is preallocated for
+
+#define ADSB_DEFAULT_TRAFFIC_CAPACITY 1024
+
+// DecodeBatch decodes the frames of one kind together, in this order
+
+enum decodeResultKinds
+{
+	decodeResultTraffic,
+	decodeResultHeartbeat,
+	decodeResultAhrs,
+	decodeResultStatus,
+	decodeResultOther,
+	decodeResultCrcError,  // crc errors and frames too short for their id
+	numDecodeResultKinds
+};
+
+// SerializeTrafficTable writes the same fields as SerializeTrafficData, the
+// default precision matches it too
+
+#define ADSB_SERIALIZE_LAT_LON_DIGITS 12
+#define ADSB_SERIALIZE_FLOAT_DIGITS 6
+
+struct serializeOptionsRec
+{
+	char delimiter;
+	uint8_t latLonDigits;  // after the decimal point
+	uint8_t floatDigits;   // track heading, range and bearing
+};
+
+struct decodeResultRec
+{
+	uint32_t frameIndex;  // position of the frame in the batch
+	int32_t dataIndex;    // target the report was stored in, -1 for none or if it
+	                      // was removed again later in the batch
+	int16_t status;       // what DecodeMessage returns for the frame
+	uint8_t msgId;
+	uint8_t kind;         // decodeResultKinds
+};
+
+class AdsbWrapper
+{
+
+#define GDL90_LAT_LONG_RES (180.0f / 8388608.0f)
+	/*
+	message types
+	  heartbeat
+	  initialization
+	  uplink data
+	  ownship report
+	  traffic report
+	  pass through report
+	  height above terrain
+	  ownship geometric altitude
+	*/
+
+	enum emergencyOrPriorityCodeKinds
+	{
+		noEmergency,
+		generalEmergency,
+		medicalEmergency,
+		minimumFuel,
+		noCommunication,
+		unlawfulInterference,
+		downedAircraft
+	};
+
+	enum addressKinds
+	{
+		adsbWithIcaoAddress,
+		adsbWithSelfAssignedAddress,
+		tisbWithIcaoAddress,
+		tisbWithTrackFileId,
+		surfaceVehicle,
+		groundStationBeacon
+	};
+
+	struct statusBitsRec1
+	{
+		unsigned uatInitialized : 1;
+		unsigned reserved : 1;
+		unsigned statRatcs : 1;
+		unsigned statGpsBattLow : 1;
+		unsigned stataddrType : 1;
+		unsigned statIdent : 1;
+		unsigned statMaintReqd : 1;
+		unsigned statGpsPosValid : 1;
+	};
+
+	enum emitterCategoryKinds
+	{
+		noAircraftTypeInformation = 0,
+
+		// ICAO < 15,500 lbs
+		light = 1,
+
+		// [15000 lbs, 75000 lbs]
+		small = 2,
+
+		// [75000 lbs, 300000 lbs]
+		large = 3,
+
+		// Aircraft such as a B757
+		highVortexLarge = 4,
+
+		// > 300,000 lbs
+		heavy = 5,
+
+		// > 5g acceleration and high speed
+		highlyManeuverable = 6,
+
+		rotorcraft = 7,
+		gliderOrSailplane = 9,
+		lighterThanAir = 10,
+		parachutistOrSkyDiver = 11,
+		ultraLightOrHangGliderOrParaGlider = 12,
+		uav = 14,
+		space = 15,
+		surfaceEmergencyVehicle = 17,
+		surfaceServiceVehicle = 18,
+		pointObstacle = 19,
+		clusterObstacle = 20,
+		lineObstacle = 21
+	};
+
+	enum trafficAlertStatusKind
+	{
+		noAlert,
+		trafficAlert
+	};
+
+	union statusByteRec1
+	{
+		struct statusBitsRec1 bits;
+		unsigned char statusByte;
+	};
+
+	struct statusBitsRec2
+	{
+		unsigned utcOk : 1;
+		unsigned reserved4 : 1;
+		unsigned reserved3 : 1;
+		unsigned reserved2 : 1;
+		unsigned reserved1 : 1;
+		unsigned csaNotAvail : 1;
+		unsigned csaRequested : 1;
+		unsigned timestamp : 1;
+	};
+
+	union statusByteRec2
+	{
+		struct statusBitsRec2 bits;
+		unsigned char statusByte;
+	};
+
+	struct heartbeatMsgRec
+	{
+		unsigned char msgId;
+		statusByteRec1 statusByte1;
+		statusByteRec2 statusByte2;
+		unsigned int timestamp;
+		unsigned short msgCounts;
+		unsigned short crc;
+	};
+
+	struct trafficReportNumRec
+	{
+		unsigned char alertStatus;
+		unsigned char addressType;
+		unsigned int participantAddr;
+		double latitude;
+		double longitude;
+		int altitude;
+		unsigned char miscIndicators;
+		unsigned char integrityCode;
+		unsigned char accuracyCode;
+		int horzVelocity;
+		int vertVelocity;
+		float trackHeading;
+		unsigned char emitterCategory;  // what size
+		std::string callsign;
+		unsigned char emergencyPriorityCode;  // what size
+		unsigned char crc[2];
+
+		int address;
+		std::string nNumber;
+		std::string name;
+		int typeAircraft;
+		int typeEngine;
+
+		float range;
+		float bearing;
+		time_t lastUpdate;
+	};
+
+
+	struct ahrsMsgRec
+	{
+		unsigned char msgId;
+		unsigned char subMsgId;
+		unsigned char roll[2];
+		unsigned char pitch[2];
+		unsigned char heading[2];
+		unsigned char indicatedAirspeed[2];
+		unsigned char trueAirspeed[2];
+	};
+	struct ahrsDataRec
+	{
+		unsigned char msgId;
+		unsigned char subMsgId;
+		float roll;
+		float pitch;
+		float heading;
+		bool headingIsTrue;
+		unsigned short indicatedAirspeed;
+		unsigned short trueAirspeed;
+	};
+
+	struct stratuxStatusMsgRec
+	{
+		unsigned char msgVersion;
+		unsigned char versionBuf[4];
+		unsigned int hardwareRevCode;
+		unsigned short validAndEnableFlags;
+		unsigned short connectHardwareFlags;
+		unsigned char numSatsLocked;
+		unsigned char numSatsConnected;
+		unsigned short num978Targets;
+		unsigned short num1090Targets;
+		unsigned short num978MsgRate;
+		unsigned short num1090MsgRate;
+		float cpuTemp;
+		unsigned char numAdsbTowers;
+	};
+
+public:
+	// DecodeAirPositionReport
+
+	struct airPositionRec
+	{
+		unsigned char typeCode;
+		unsigned char survStatus;
+		unsigned char nicSupplement;
+		unsigned char timeFlag;
+		unsigned char cprOdd;
+		bool altitudeValid;
+		int altitude;
+		unsigned int latCpr;
+		unsigned int lonCpr;
+	};
+
+	typedef void (*UplinkCallback)(void *context, const unsigned char *frameBuf,
+		unsigned int frameSize);
+
+	AdsbWrapper();
+
+	void CrcInit(void);
+	unsigned int CrcCompute(unsigned char *block, unsigned int length);
+	unsigned int CalculateCrc(unsigned char *msgBuf, int msgSize);
+	unsigned int GetNumCrcErrors();
+	unsigned int GetNumShortFrames();
+
+	void ClearAhrsData(struct ahrsDataRec &data);
+	void ClearAircraftData(struct trafficReportNumRec &srcData);
+	void ClearHeartbeatInfo(struct heartbeatMsgRec &msg);
+	void ClearTrafficDataList();
+
+	void SetTrafficTimeToLive(unsigned char addressType, unsigned int seconds);
+	unsigned int GetTrafficTimeToLive(unsigned char addressType);
+	int ExpireTraffic(time_t now);
+
+	void SetClockTime(time_t now);
+	time_t GetClockTime();
+
+	void SetHistoryLimit(unsigned int maxReports);
+	void SetTrafficCapacity(unsigned int maxTargets);
+
+	void CopyAircraftData(struct trafficReportNumRec &srcData, struct trafficReportNumRec&tgtData);
+
+	unsigned int GetUint32(unsigned char *dataBuf);
+	unsigned int GetUint24(unsigned char *dataBuf);
+	unsigned short GetUint16(unsigned char *dataBuf);
+
+	int DecodeMessage(unsigned int msgSize, char *msgBuf, bool filterData = true);
+	int DecodeStream(unsigned int dataLen, const char *dataPtr, bool filterData = true);
+	int DecodeFrame(unsigned int msgSize, unsigned char *msgBuf, bool filterData = true);
+	int DecodeBatch(unsigned int dataLen, const char *dataPtr,
+		std::vector<struct decodeResultRec> &results, bool filterData = true);
+	static int GetGeodeticLocation(const unsigned char *dataBuf, double &location);
+
+	int DecodeTrafficMessage(unsigned int msgSize, unsigned char *msgBuf, struct trafficReportRec &trafficData);
+	static int DecodeTrafficReport(unsigned int msgSize, const unsigned char *msgBuf,
+		struct trafficReportRec &trafficData);
+	int StoreTrafficReport(const struct trafficReportRec &trafficData, bool filterData = true);
+	
+	static int DecodeAirPositionReport(const unsigned char *msgBuf,
+		struct airPositionRec &position);
+	static int DecodeCallsign(const unsigned char *msgBuf,
+					unsigned char &emitterCategory, char *callsign);
+
+	static int DecodeUatReport(unsigned int msgSize, const unsigned char *msgBuf,
+		struct trafficReportRec &trafficData, unsigned int &presentFields);
+	static int DecodePayloadHeader(const unsigned char *msgBuf, unsigned int payloadLen,
+		struct trafficReportRec &trafficData, unsigned int &presentFields);
+	static int DecodeStateVector(const unsigned char *msgBuf,
+		struct trafficReportRec &trafficData, unsigned int &presentFields);
+
+	static int DecodeModeStatus(const unsigned char *msgBuf,
+		struct trafficReportRec &trafficData, unsigned int &presentFields);
+	int DecodeCapabilityCodes(unsigned char *msgBuf);
+	static int DecodeAuxiliaryStateVector(const unsigned char *msgBuf, int &altitude);
+	int DecodeTargetState(unsigned char *msgBuf);
+	int DecodeTrajectoryChange(unsigned char *msgBuf);
+
+	int GetLastMsgType();
+	void GetLastCallsign(std::string &callsign);
+
+	int GetNumTrafficReports();
+
+	int GetLocation(std:: string callsign,
+		double &latitude, double &longitude, double &altitude);
+
+	int GetHeading(std::string callsign, float &heading);
+	int GetHorzVelocity(std::string callsign, float &velocity);
+	int GetVertVelocity(std::string callsign, float &velocity);
+
+	int GetAircraftOwnerInfo(std::string callsign, unsigned int &address,
+		std::string &nNumber, std::string &name, int &typeAircraft, int &typeEngine);
+
+	int SetAircraftOwnerInfo(std::string callsign, unsigned int address,
+		std::string nNumber, std::string name, int typeAircraft, int typeEngine);
+
+	int GetLastUpdate(std::string callsign, unsigned int &updateTime);
+
+	int GetParticipantAddress(std::string callsign, unsigned char &addrType,
+		unsigned int &address);
+
+	// area queries fill dataIndexes with data indexes for use with
+	// SerializeTrafficData and return how many were found
+
+	int GetTrafficInBox(double minLatitude, double minLongitude,
+		double maxLatitude, double maxLongitude, std::vector<int> &dataIndexes);
+	int GetTrafficInRadius(double latitude, double longitude, double radiusNm,
+		std::vector<int> &dataIndexes);
+	int GetNearestTraffic(double latitude, double longitude, unsigned int maxTargets,
+		std::vector<int> &dataIndexes);
+
+	// the snapshot is the only part of the traffic table that may be read
+	// from a thread other than the one decoding
+
+	void SetSnapshotInterval(unsigned int milliseconds);
+	void PublishTrafficSnapshot();
+	int ReadTrafficSnapshot(std::vector<struct trafficSnapshotRec> &snapshot);
+	unsigned int GetNumSnapshotTruncated();
+
+	// targets added, updated and expired as they happen, see TrafficFeed
+
+	int SubscribeTrafficChanges(TrafficFeed::ChangeCallback callback, void *context,
+		unsigned int kindMask = TRAFFIC_CHANGE_ALL, unsigned int fieldMask = TRAFFIC_FIELD_ALL);
+	int SubscribeTrafficChanges(unsigned int queueSize,
+		unsigned int kindMask = TRAFFIC_CHANGE_ALL, unsigned int fieldMask = TRAFFIC_FIELD_ALL);
+	int UnsubscribeTrafficChanges(int subscriberId);
+	int ReadTrafficChanges(int subscriberId, std::vector<struct trafficChangeRec> &changes,
+		unsigned int maxChanges = 0);
+	unsigned int GetNumDroppedTrafficChanges(int subscriberId);
+
+	int GetLastDataIndex();
+	int GetDataIndex(unsigned char addressType, unsigned int participantAddr);
+	int GetSlotId(unsigned int dataIndex);
+	unsigned int GetLatestTimestamp();
+	void GetLatestHeartbeat(struct heartbeatRecordRec &heartbeat);
+
+	void GetSatelliteCnt(int &numConnected, int &numLocked);
+	void GetTargetCnt(int &num978Targets, int &num1090Targets);
+	void GetTowerCnt(int &numTowers);
+
+	void GetOwnshipCallsign(std::string &callsign);
+
+	// uplink (FIS-B) frames are decoded inline unless an uplink callback
+	// takes them, see UplinkDecoder
+
+	void SetUplinkCallback(UplinkCallback callback, void *context);
+	void SetUplinkCapture(CaptureWriter *captureWriter);
+	void SetFisbDecoder(FisbDecoder *fisbDecoder);
+	int GetLastUplinkData(struct uplinkDataRec &uplinkData);
+
+	static int DecodeUplinkData(unsigned int msgSize, const unsigned char *msgBuf,
+		struct uplinkDataRec &uplinkData);
+	static int ParseApplicationData(int appDataLen, const unsigned char *appData,
+		struct uplinkDataRec &uplinkData);
+	int ParseApplicationData(int appDataLen, unsigned char *appData);
+
+	int SerializeTrafficData(unsigned int dataIndex, char delimiter,
+		std::string &serializedData);
+
+	int SerializeTrafficData(struct trafficReportNumRec *dataPtr,
+		char delimiter, std::string &serializedData);
+
+	static void GetDefaultSerializeOptions(struct serializeOptionsRec &options);
+	int SerializeTrafficTable(char *dataBuf, unsigned int bufSize,
+		const struct serializeOptionsRec &options, unsigned long long *changeVersion = NULL);
+	unsigned int GetSerializeBufferSize(const struct serializeOptionsRec &options);
+
+	int ExportRecords(TrafficRecordWriter &writer, unsigned long long *changeVersion = NULL);
+	unsigned int GetExportBufferSize();
+
+	int EncodeTrafficBurst(Gdl90Encoder &encoder, const struct trafficReportRec *ownship = NULL);
+	unsigned int GetBurstBufferSize();
+
+	int ExportAircraftJson(AircraftJson &aircraftJson, std::string &jsonData);
+
+	int SetRangeValues(std::string callsign, float range, float bearing);
+	int GetRangeValues(std::string callsign, float &range, float &bearing);
+
+protected:
+	static void StreamFrameCallback(void *context, unsigned char *frameBuf,
+		unsigned int frameSize);
+	static void BatchFrameCallback(void *context, unsigned char *frameBuf,
+		unsigned int frameSize);
+
+	int DispatchFrame(unsigned int msgSize, unsigned char *msgBuf, bool filterData);
+	int UpsertTraffic(const struct trafficReportRec &trafficData, bool filterData);
+
+	void StoreAircraftData(const struct trafficReportRec &srcData, unsigned int dataIndex);
+	void RemoveTraffic(unsigned int dataIndex);
+	void AddHistoryEntry(int slotId);
+	int SlotsToDataIndexes(std::vector<int> &slotIds);
+	int GetBatchDataIndex(int slotId, unsigned long long targetKey);
+	void CheckSnapshotInterval();
+	void SizeTrafficSnapshot();
+	void SizeRemovedRing(unsigned int capacity);
+	void AddRemovedTarget(unsigned char addressType, unsigned int participantAddr);
+	void GetTrafficReport(unsigned int dataIndex, struct trafficReportRec &report);
+	unsigned int GetChangedFields(const struct trafficReportRec &trafficData,
+		unsigned int dataIndex);
+	void MarkChanged(unsigned int dataIndex);
+	void MergeTrafficFields(struct trafficReportRec &trafficData, unsigned int presentFields);
+
+private:
+	struct heartbeatMsgRec mLatetestHeartbeat;
+	struct heartbeatMsgRec mTestHeartbeat;
+
+	struct ahrsDataRec mAhrsData;
+	struct ahrsDataRec mStatuxAhrsData;
+
+	struct trafficReportNumRec mOwnshipData;
+
+	struct trafficReportRec mTrafficReport;
+
+	TrafficStore mTrafficStore;
+	TrafficGrid mTrafficGrid;
+
+	TimerWheel mExpiryWheel;
+	unsigned int mTimeToLive[ADSB_NUM_ADDRESS_TYPES];
+	std::vector<int> mExpiredSlots;
+
+	// ring of slot ids for the filterData off entries, oldest at the head,
+	// -1 where an entry expired before it reached the head
+
+	std::vector<int> mHistoryRing;
+	std::vector<int> mHistorySlotPos;
+	unsigned int mHistoryHead;
+	unsigned int mHistoryCount;
+
+	TrafficSnapshot mTrafficSnapshot;
+	std::vector<struct trafficSnapshotRec> mSnapshotRecords;
+	unsigned int mSnapshotInterval;  // milliseconds, 0 for only on request
+	long long mLastSnapshotTime;
+	unsigned int mTrafficCapacity;
+
+	TrafficFeed mTrafficFeed;
+
+	unsigned long long mChangeVersion;
+
+	// targets that have gone, oldest at the head, so a changed only export
+	// can say so.  once one is pushed out mRemovedLostVersion is its change
+	// version, an export from before that has to start over
+
+	struct removedTargetRec
+	{
+		unsigned long long changeVersion;
+		unsigned int participantAddr;
+		unsigned char addressType;
+	};
+
+	std::vector<struct removedTargetRec> mRemovedRing;
+	unsigned int mRemovedHead;
+	unsigned int mRemovedCount;
+	unsigned long long mRemovedLostVersion;
+
+	UplinkCallback mUplinkCallback;
+	void *mUplinkContext;
+	struct uplinkDataRec mUplinkData;
+	bool mUplinkDataValid;
+	CaptureWriter *mUplinkCapture;
+	FisbDecoder *mFisbDecoder;
+
+	struct stratuxStatusMsgRec mStratuxStatusMessage;
+
+	int mLastMsgType;
+	std::string mLastCallsign;
+
+	unsigned int mNumCrcErrors;
+	unsigned int mNumShortFrames;
+
+	time_t mClockTime;  // 0 for time(NULL)
+
+	int mLastSlotId;
+
+	std::string mOwnshipCallsign;
+
+	Gdl90Framer mFramer;
+	bool mStreamFilterData;
+
+	// DecodeBatch collects the unstuffed frames back to back in
+	// mBatchFrameData before decoding any of them
+
+	struct batchFrameRec
+	{
+		uint32_t offset;
+		uint16_t size;
+		uint8_t msgId;
+		uint8_t kind;
+	};
+
+	Gdl90Framer mBatchFramer;
+	std::vector<unsigned char> mBatchFrameData;
+	std::vector<struct batchFrameRec> mBatchFrames;
+	std::vector<unsigned int> mBatchOrder;
+	std::vector<unsigned long long> mBatchTargetKeys;  // by result, for traffic
+};
+
 #endif // _ADSB_WRAPPER_H_
\ No newline at end of file
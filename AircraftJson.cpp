@@ -0,0 +1,253 @@
+//
+// AircraftJson.cpp: dump1090 style aircraft.json from the traffic table
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include <charconv>
+
+#include "AircraftJson.h"
+
+// dump1090's names for the GDL90 address types and emergency codes
+
+static const char *sAddressTypeNames[] =
+{
+	"adsb_icao",
+	"adsb_other",
+	"tisb_icao",
+	"tisb_trackfile"
+};
+
+static const char *sEmergencyNames[] =
+{
+	"none",
+	"general",
+	"lifeguard",
+	"minfuel",
+	"nordo",
+	"unlawful",
+	"downed"
+};
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> static void AppendNumber(std::string &json, T value)
+{
+	char numberBuf[32];
+	std::to_chars_result result = std::to_chars(numberBuf, numberBuf + sizeof(numberBuf), value);
+
+	json.append(numberBuf, result.ptr - numberBuf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void AppendFixed(std::string &json, double value, int precision)
+{
+	char numberBuf[64];
+	std::to_chars_result result = std::to_chars(numberBuf, numberBuf + sizeof(numberBuf), value,
+		std::chars_format::fixed, precision);
+
+	json.append(numberBuf, result.ptr - numberBuf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// callsigns are meant to be letters, digits and spaces but they come off
+// the air so anything else is dropped rather than trusted inside a string
+///////////////////////////////////////////////////////////////////////////////
+static void AppendCallsign(std::string &json, const std::string &callsign)
+{
+	for (unsigned int index = 0; index < callsign.size(); index++)
+	{
+		char callsignChar = callsign[index];
+
+		if ((callsignChar >= ' ') && (callsignChar <= '~') &&
+			(callsignChar != '"') && (callsignChar != '\\'))
+		{
+			json += callsignChar;
+		}
+	}
+}
+
+AircraftJson::AircraftJson()
+{
+	mNumRendered = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// replace jsonData with the whole document, now is seconds since 1970.
+// jsonData keeps its capacity from one export to the next if the caller
+// keeps it.  returns the number of aircraft
+///////////////////////////////////////////////////////////////////////////////
+int AircraftJson::Export(TrafficStore &trafficStore, double now, std::string &jsonData)
+{
+	unsigned int numTargets = trafficStore.GetCount();
+
+	mNumRendered = 0;
+
+	jsonData.clear();
+	jsonData += "{ \"now\" : ";
+	AppendFixed(jsonData, now, 1);
+	jsonData += ",\n  \"aircraft\" : [";
+
+	for (unsigned int dataIndex = 0; dataIndex < numTargets; dataIndex++)
+	{
+		int slotId = trafficStore.GetSlotId(dataIndex);
+
+		if (slotId >= (int)mFragments.size())
+		{
+			struct fragmentRec emptyFragment;
+
+			emptyFragment.changeVersion = 0;
+
+			mFragments.resize(slotId + 1, emptyFragment);
+		}
+
+		struct fragmentRec &fragment = mFragments[slotId];
+
+		// a reused slot id always comes with a newer change version
+
+		if ((fragment.json.empty() == true) ||
+			(fragment.changeVersion != trafficStore.changeVersion[dataIndex]))
+		{
+			RenderTarget(trafficStore, dataIndex, fragment.json);
+
+			fragment.changeVersion = trafficStore.changeVersion[dataIndex];
+
+			mNumRendered++;
+		}
+
+		double seen = now - (double)trafficStore.lastUpdate[dataIndex];
+
+		jsonData += (dataIndex == 0) ? "\n    " : ",\n    ";
+		jsonData += fragment.json;
+		jsonData += "\"seen\":";
+		AppendFixed(jsonData, (seen > 0.0) ? seen : 0.0, 1);
+		jsonData += '}';
+	}
+
+	jsonData += "\n  ]\n}\n";
+
+	return((int)numTargets);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// forget every cached fragment
+///////////////////////////////////////////////////////////////////////////////
+void AircraftJson::Clear()
+{
+	mFragments.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// targets rendered by the last export, the rest came from the cache
+///////////////////////////////////////////////////////////////////////////////
+unsigned int AircraftJson::GetNumRendered()
+{
+	return(mNumRendered);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// everything in the target's object up to seen, which Export adds
+///////////////////////////////////////////////////////////////////////////////
+void AircraftJson::RenderTarget(TrafficStore &trafficStore, unsigned int dataIndex,
+	std::string &fragment)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	unsigned int addressType = trafficStore.addressType[dataIndex];
+	unsigned int participantAddr = trafficStore.participantAddr[dataIndex];
+	const std::string &callsign = trafficStore.cold[dataIndex].callsign;
+
+	fragment.clear();
+
+	// dump1090 marks addresses that aren't ICAO with a ~
+
+	fragment += "{\"hex\":\"";
+
+	if ((addressType != 0) && (addressType != 2))
+	{
+		fragment += '~';
+	}
+
+	for (int shift = 20; shift >= 0; shift -= 4)
+	{
+		fragment += hexDigits[(participantAddr >> shift) & 0xf];
+	}
+
+	fragment += "\",\"type\":\"";
+	fragment += (addressType < 4) ? sAddressTypeNames[addressType] : "unknown";
+	fragment += '"';
+
+	if (callsign.find_first_not_of(' ') != std::string::npos)
+	{
+		fragment += ",\"flight\":\"";
+		AppendCallsign(fragment, callsign);
+		fragment += '"';
+	}
+
+	// misc indicator bit 3 is set when airborne
+
+	fragment += ",\"alt_baro\":";
+
+	if ((trafficStore.miscIndicators[dataIndex] & 0x08) == 0)
+	{
+		fragment += "\"ground\"";
+	}
+	else
+	{
+		AppendNumber(fragment, trafficStore.altitude[dataIndex]);
+	}
+
+	fragment += ",\"baro_rate\":";
+	AppendNumber(fragment, trafficStore.vertVelocity[dataIndex]);
+	fragment += ",\"gs\":";
+	AppendNumber(fragment, trafficStore.horzVelocity[dataIndex]);
+	fragment += ",\"track\":";
+	AppendFixed(fragment, trafficStore.trackHeading[dataIndex], 1);
+
+	// a NIC of 0 with a zero position is a target that hasn't got one
+
+	if ((trafficStore.integrityCode[dataIndex] != 0) || (trafficStore.latitude[dataIndex] != 0.0) ||
+		(trafficStore.longitude[dataIndex] != 0.0))
+	{
+		fragment += ",\"lat\":";
+		AppendFixed(fragment, trafficStore.latitude[dataIndex], 6);
+		fragment += ",\"lon\":";
+		AppendFixed(fragment, trafficStore.longitude[dataIndex], 6);
+		fragment += ",\"nic\":";
+		AppendNumber(fragment, (int)trafficStore.integrityCode[dataIndex]);
+		fragment += ",\"nac_p\":";
+		AppendNumber(fragment, (int)trafficStore.accuracyCode[dataIndex]);
+	}
+
+	// emitter categories run A0-A7, B0-B7 and so on in blocks of 8
+
+	unsigned int emitterCategory = trafficStore.emitterCategory[dataIndex];
+
+	if ((emitterCategory != 0) && (emitterCategory < 32))
+	{
+		fragment += ",\"category\":\"";
+		fragment += (char)('A' + (emitterCategory / 8));
+		fragment += (char)('0' + (emitterCategory % 8));
+		fragment += '"';
+	}
+
+	unsigned int emergencyCode = trafficStore.emergencyPriorityCode[dataIndex];
+
+	if (emergencyCode < 7)
+	{
+		fragment += ",\"emergency\":\"";
+		fragment += sEmergencyNames[emergencyCode];
+		fragment += '"';
+	}
+
+	fragment += ',';
+}
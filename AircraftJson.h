@@ -0,0 +1,60 @@
+//
+// AircraftJson.h: dump1090 style aircraft.json from the traffic table
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _AIRCRAFT_JSON_H_
+#define _AIRCRAFT_JSON_H_
+
+#include <string>
+#include <vector>
+
+#include "TrafficStore.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// AircraftJson writes the traffic table in the layout of dump1090's
+// aircraft.json so web maps built for dump1090 can show it.
+//
+// each target's object is rendered once and kept per slot id along with the
+// store's change version it was rendered from, an export only re-renders
+// targets that have changed since and copies the rest.  seen is the one
+// field that moves on its own so it is added as the fragments are copied
+// rather than kept in them
+///////////////////////////////////////////////////////////////////////////////
+class AircraftJson
+{
+public:
+	AircraftJson();
+
+	int Export(TrafficStore &trafficStore, double now, std::string &jsonData);
+	void Clear();
+
+	unsigned int GetNumRendered();
+
+private:
+	void RenderTarget(TrafficStore &trafficStore, unsigned int dataIndex,
+		std::string &fragment);
+
+	struct fragmentRec
+	{
+		unsigned long long changeVersion;
+		std::string json;  // the object without seen and the closing brace
+	};
+
+	std::vector<struct fragmentRec> mFragments;  // by slot id
+
+	unsigned int mNumRendered;
+};
+
+#endif // _AIRCRAFT_JSON_H_
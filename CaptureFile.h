@@ -0,0 +1,115 @@
+//
+// CaptureFile.h: GDL90 capture file layout
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _CAPTURE_FILE_H_
+#define _CAPTURE_FILE_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// a capture file holds the GDL90 bytes exactly as they were received with
+// the time each chunk arrived, everything little endian:
+//
+//   file header   32 bytes
+//     0   char[8]   CAPTURE_FILE_MAGIC
+//     8   uint16    CAPTURE_FILE_VERSION
+//     10  uint16    file header size
+//     12  uint32    index interval, microseconds
+//     16  int64     time the capture started, microseconds since 1970
+//     24  uint64    reserved
+//
+//   records       12 bytes each plus the data, back to back
+//     0   int64     receive time, microseconds since 1970
+//     8   uint16    data length
+//     10  uint8     source id
+//     11  uint8     reserved
+//     12  data
+//
+//   index         written by Close after the last record
+//     one entry for the first record of every index interval
+//     0   int64     record time
+//     8   uint64    file offset of the record
+//
+//   footer        16 bytes, the last thing in the file
+//     0   char[4]   CAPTURE_INDEX_MAGIC
+//     4   uint32    number of index entries
+//     8   uint64    file offset of the index
+//
+// the records are only ever appended so a capture cut short by a crash is
+// still good up to its last whole record, it just has no index and the
+// replayer rebuilds one by walking the records
+///////////////////////////////////////////////////////////////////////////////
+
+#define CAPTURE_FILE_MAGIC "GDL90CAP"
+#define CAPTURE_FILE_VERSION 1
+#define CAPTURE_FILE_HEADER_SIZE 32
+
+#define CAPTURE_RECORD_HEADER_SIZE 12
+#define CAPTURE_RECORD_MAX_DATA_SIZE 0xffff
+
+#define CAPTURE_INDEX_MAGIC "GIDX"
+#define CAPTURE_INDEX_ENTRY_SIZE 16
+#define CAPTURE_FOOTER_SIZE 16
+
+#define CAPTURE_DEFAULT_INDEX_INTERVAL 1000000  // one second
+
+struct captureIndexRec
+{
+	int64_t timestamp;
+	uint64_t fileOffset;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+inline void CapturePutUint16(unsigned char *dataBuf, uint16_t value)
+{
+	dataBuf[0] = (unsigned char)value;
+	dataBuf[1] = (unsigned char)(value >> 8);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline void CapturePutUint32(unsigned char *dataBuf, uint32_t value)
+{
+	CapturePutUint16(dataBuf, (uint16_t)value);
+	CapturePutUint16(&dataBuf[2], (uint16_t)(value >> 16));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline void CapturePutUint64(unsigned char *dataBuf, uint64_t value)
+{
+	CapturePutUint32(dataBuf, (uint32_t)value);
+	CapturePutUint32(&dataBuf[4], (uint32_t)(value >> 32));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline uint16_t CaptureGetUint16(const unsigned char *dataBuf)
+{
+	return((uint16_t)(dataBuf[0] | (dataBuf[1] << 8)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline uint32_t CaptureGetUint32(const unsigned char *dataBuf)
+{
+	return(CaptureGetUint16(dataBuf) | ((uint32_t)CaptureGetUint16(&dataBuf[2]) << 16));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline uint64_t CaptureGetUint64(const unsigned char *dataBuf)
+{
+	return(CaptureGetUint32(dataBuf) | ((uint64_t)CaptureGetUint32(&dataBuf[4]) << 32));
+}
+
+#endif // _CAPTURE_FILE_H_
@@ -0,0 +1,215 @@
+//
+// CaptureRecorder.cpp: append GDL90 traffic to a capture file
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <string.h>
+#include <chrono>
+
+#include "CaptureRecorder.h"
+
+CaptureRecorder::CaptureRecorder()
+{
+	mFile = NULL;
+
+	mIndexInterval = CAPTURE_DEFAULT_INDEX_INTERVAL;
+
+	mNumRecords = 0;
+	mFileSize = 0;
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+	Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start a new capture, an existing file is replaced.  indexInterval is in
+// microseconds
+///////////////////////////////////////////////////////////////////////////////
+int CaptureRecorder::Open(const char *filename, unsigned int indexInterval)
+{
+	unsigned char headerBuf[CAPTURE_FILE_HEADER_SIZE];
+
+	Close();
+
+	mFile = fopen(filename, "wb");
+
+	if (mFile == NULL)
+	{
+		return(-1);
+	}
+
+	setvbuf(mFile, NULL, _IOFBF, CAPTURE_RECORDER_BUFFER_SIZE);
+
+	mIndexInterval = (indexInterval > 0) ? indexInterval : CAPTURE_DEFAULT_INDEX_INTERVAL;
+	mIndex.clear();
+
+	mNumRecords = 0;
+
+	memset(headerBuf, 0, sizeof(headerBuf));
+	memcpy(headerBuf, CAPTURE_FILE_MAGIC, 8);
+
+	CapturePutUint16(&headerBuf[8], CAPTURE_FILE_VERSION);
+	CapturePutUint16(&headerBuf[10], CAPTURE_FILE_HEADER_SIZE);
+	CapturePutUint32(&headerBuf[12], mIndexInterval);
+	CapturePutUint64(&headerBuf[16], (uint64_t)GetNow());
+
+	if (fwrite(headerBuf, 1, sizeof(headerBuf), mFile) != sizeof(headerBuf))
+	{
+		fclose(mFile);
+		mFile = NULL;
+
+		return(-1);
+	}
+
+	mFileSize = sizeof(headerBuf);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write the index and footer and close the file
+///////////////////////////////////////////////////////////////////////////////
+int CaptureRecorder::Close()
+{
+	int status = -1;
+	unsigned char entryBuf[CAPTURE_INDEX_ENTRY_SIZE];
+	unsigned char footerBuf[CAPTURE_FOOTER_SIZE];
+
+	if (mFile == NULL)
+	{
+		return(status);
+	}
+
+	uint64_t indexOffset = mFileSize;
+
+	status = 0;
+
+	for (unsigned int index = 0; index < mIndex.size(); index++)
+	{
+		CapturePutUint64(entryBuf, (uint64_t)mIndex[index].timestamp);
+		CapturePutUint64(&entryBuf[8], mIndex[index].fileOffset);
+
+		if (fwrite(entryBuf, 1, sizeof(entryBuf), mFile) != sizeof(entryBuf))
+		{
+			status = -1;
+		}
+	}
+
+	memcpy(footerBuf, CAPTURE_INDEX_MAGIC, 4);
+
+	CapturePutUint32(&footerBuf[4], (uint32_t)mIndex.size());
+	CapturePutUint64(&footerBuf[8], indexOffset);
+
+	if (fwrite(footerBuf, 1, sizeof(footerBuf), mFile) != sizeof(footerBuf))
+	{
+		status = -1;
+	}
+
+	if (fclose(mFile) != 0)
+	{
+		status = -1;
+	}
+	mFile = NULL;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// push buffered records out to the file, they are already a valid capture
+///////////////////////////////////////////////////////////////////////////////
+int CaptureRecorder::Flush()
+{
+	int status = -1;
+
+	if ((mFile != NULL) && (fflush(mFile) == 0))
+	{
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append one chunk of received bytes, timestamp in microseconds since 1970
+// or 0 for now.  timestamps are expected to go forward
+///////////////////////////////////////////////////////////////////////////////
+int CaptureRecorder::Record(unsigned int dataLen, const char *dataPtr, int64_t timestamp,
+	unsigned char sourceId)
+{
+	unsigned char recordBuf[CAPTURE_RECORD_HEADER_SIZE];
+
+	if ((mFile == NULL) || (dataLen > CAPTURE_RECORD_MAX_DATA_SIZE))
+	{
+		return(-1);
+	}
+
+	if (timestamp == 0)
+	{
+		timestamp = GetNow();
+	}
+
+	// the first record of each interval goes in the index
+
+	if ((mIndex.empty() == true) ||
+		((timestamp - mIndex.back().timestamp) >= (int64_t)mIndexInterval))
+	{
+		struct captureIndexRec entry;
+
+		entry.timestamp = timestamp;
+		entry.fileOffset = mFileSize;
+
+		mIndex.push_back(entry);
+	}
+
+	CapturePutUint64(recordBuf, (uint64_t)timestamp);
+	CapturePutUint16(&recordBuf[8], (uint16_t)dataLen);
+	recordBuf[10] = sourceId;
+	recordBuf[11] = 0;
+
+	if ((fwrite(recordBuf, 1, sizeof(recordBuf), mFile) != sizeof(recordBuf)) ||
+		(fwrite(dataPtr, 1, dataLen, mFile) != dataLen))
+	{
+		return(-1);
+	}
+
+	mFileSize += sizeof(recordBuf) + dataLen;
+	mNumRecords++;
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int CaptureRecorder::GetNumRecords()
+{
+	return(mNumRecords);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bytes written so far, not counting the index
+///////////////////////////////////////////////////////////////////////////////
+unsigned long long CaptureRecorder::GetFileSize()
+{
+	return(mFileSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// microseconds since 1970
+///////////////////////////////////////////////////////////////////////////////
+int64_t CaptureRecorder::GetNow()
+{
+	return(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+}
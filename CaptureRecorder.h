@@ -0,0 +1,63 @@
+//
+// CaptureRecorder.h: append GDL90 traffic to a capture file
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _CAPTURE_RECORDER_H_
+#define _CAPTURE_RECORDER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "CaptureFile.h"
+
+#define CAPTURE_RECORDER_BUFFER_SIZE (256 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////
+// CaptureRecorder appends what a receiver sent, datagram by datagram or
+// frame by frame, to a capture file along with when it arrived.  the index
+// is kept in memory, one entry per index interval, and written out by Close,
+// see CaptureFile.h for the layout
+///////////////////////////////////////////////////////////////////////////////
+class CaptureRecorder
+{
+public:
+	CaptureRecorder();
+	~CaptureRecorder();
+
+	int Open(const char *filename, unsigned int indexInterval = CAPTURE_DEFAULT_INDEX_INTERVAL);
+	int Close();
+	int Flush();
+
+	int Record(unsigned int dataLen, const char *dataPtr, int64_t timestamp = 0,
+		unsigned char sourceId = 0);
+
+	unsigned int GetNumRecords();
+	unsigned long long GetFileSize();
+
+	static int64_t GetNow();
+
+private:
+	FILE *mFile;
+
+	std::vector<struct captureIndexRec> mIndex;
+	unsigned int mIndexInterval;
+
+	unsigned int mNumRecords;
+	unsigned long long mFileSize;
+};
+
+#endif // _CAPTURE_RECORDER_H_
@@ -0,0 +1,470 @@
+//
+// CaptureReplayer.cpp: play a capture file back through the decoder
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CAPTURE_REPLAYER_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "CaptureReplayer.h"
+
+CaptureReplayer::CaptureReplayer()
+{
+	mFileData = NULL;
+	mFileSize = 0;
+	mRecordsEnd = 0;
+
+	mIndexInterval = CAPTURE_DEFAULT_INDEX_INTERVAL;
+	mHasIndex = false;
+
+	mOffset = 0;
+	mSpeed = 1.0;
+
+	mWrapper = NULL;
+	mFilterData = true;
+	mSourceId = -1;
+}
+
+CaptureReplayer::~CaptureReplayer()
+{
+	Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// map the capture and load its index, ready to replay from the start
+///////////////////////////////////////////////////////////////////////////////
+int CaptureReplayer::Open(const char *filename)
+{
+	Close();
+
+#ifdef CAPTURE_REPLAYER_MMAP
+	int fd = open(filename, O_RDONLY);
+	struct stat fileStat;
+
+	if (fd < 0)
+	{
+		return(-1);
+	}
+
+	if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size < CAPTURE_FILE_HEADER_SIZE))
+	{
+		close(fd);
+
+		return(-1);
+	}
+
+	void *mapping = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+	{
+		return(-1);
+	}
+
+	// replay reads front to back
+
+	madvise(mapping, fileStat.st_size, MADV_SEQUENTIAL);
+
+	mFileData = (const unsigned char *)mapping;
+	mFileSize = fileStat.st_size;
+#else
+	FILE *file = fopen(filename, "rb");
+
+	if (file == NULL)
+	{
+		return(-1);
+	}
+
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if (fileSize < CAPTURE_FILE_HEADER_SIZE)
+	{
+		fclose(file);
+
+		return(-1);
+	}
+
+	mFileCopy.resize(fileSize);
+
+	size_t numRead = fread(&mFileCopy[0], 1, fileSize, file);
+
+	fclose(file);
+
+	if (numRead != (size_t)fileSize)
+	{
+		mFileCopy.clear();
+
+		return(-1);
+	}
+
+	mFileData = &mFileCopy[0];
+	mFileSize = fileSize;
+#endif
+
+	if ((memcmp(mFileData, CAPTURE_FILE_MAGIC, 8) != 0) ||
+		(CaptureGetUint16(&mFileData[8]) != CAPTURE_FILE_VERSION))
+	{
+		Close();
+
+		return(-1);
+	}
+
+	mIndexInterval = CaptureGetUint32(&mFileData[12]);
+
+	if (ReadIndex() != 0)
+	{
+		BuildIndex();
+	}
+
+	Rewind();
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CaptureReplayer::Close()
+{
+#ifdef CAPTURE_REPLAYER_MMAP
+	if (mFileData != NULL)
+	{
+		munmap((void *)mFileData, mFileSize);
+	}
+#endif
+
+	mFileCopy.clear();
+	mIndex.clear();
+
+	mFileData = NULL;
+	mFileSize = 0;
+	mRecordsEnd = 0;
+	mHasIndex = false;
+	mOffset = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the next record, dataPtr points into the file and stays valid until
+// Close.  returns -1 at the end of the capture
+///////////////////////////////////////////////////////////////////////////////
+int CaptureReplayer::Next(const char *&dataPtr, unsigned int &dataLen, int64_t &timestamp,
+	unsigned char &sourceId)
+{
+	if ((mFileData == NULL) || ((mOffset + CAPTURE_RECORD_HEADER_SIZE) > mRecordsEnd))
+	{
+		return(-1);
+	}
+
+	const unsigned char *recordBuf = &mFileData[mOffset];
+
+	dataLen = CaptureGetUint16(&recordBuf[8]);
+
+	if ((mOffset + CAPTURE_RECORD_HEADER_SIZE + dataLen) > mRecordsEnd)
+	{
+		return(-1);
+	}
+
+	timestamp = (int64_t)CaptureGetUint64(recordBuf);
+	sourceId = recordBuf[10];
+	dataPtr = (const char *)&recordBuf[CAPTURE_RECORD_HEADER_SIZE];
+
+	mOffset += CAPTURE_RECORD_HEADER_SIZE + dataLen;
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// move to the first record at or after timestamp, returns -1 if every record
+// is before it
+///////////////////////////////////////////////////////////////////////////////
+int CaptureReplayer::Seek(int64_t timestamp)
+{
+	const char *dataPtr;
+	unsigned int dataLen;
+	int64_t recordTime;
+	unsigned char sourceId;
+
+	Rewind();
+
+	// the last index entry at or before timestamp, then walk from there
+
+	unsigned int low = 0;
+	unsigned int high = (unsigned int)mIndex.size();
+
+	while (low < high)
+	{
+		unsigned int middle = (low + high) / 2;
+
+		if (mIndex[middle].timestamp <= timestamp)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if (low > 0)
+	{
+		mOffset = mIndex[low - 1].fileOffset;
+	}
+
+	unsigned long long recordOffset = mOffset;
+
+	while (Next(dataPtr, dataLen, recordTime, sourceId) == 0)
+	{
+		if (recordTime >= timestamp)
+		{
+			mOffset = recordOffset;
+
+			return(0);
+		}
+		recordOffset = mOffset;
+	}
+	return(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CaptureReplayer::Rewind()
+{
+	mOffset = CAPTURE_FILE_HEADER_SIZE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 1 replays in real time, 10 ten times faster, 0 as fast as possible
+///////////////////////////////////////////////////////////////////////////////
+void CaptureReplayer::SetSpeed(double speed)
+{
+	mSpeed = (speed > 0.0) ? speed : 0.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// hand up to maxRecords records, 0 for the rest of the capture, to callback
+// on the calling thread at the replay speed.  returns the number replayed
+///////////////////////////////////////////////////////////////////////////////
+int CaptureReplayer::Replay(RecordCallback callback, void *context, unsigned int maxRecords)
+{
+	const char *dataPtr;
+	unsigned int dataLen;
+	int64_t timestamp;
+	unsigned char sourceId;
+	unsigned int numRecords = 0;
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	int64_t firstTimestamp = 0;
+
+	while (((maxRecords == 0) || (numRecords < maxRecords)) &&
+		(Next(dataPtr, dataLen, timestamp, sourceId) == 0))
+	{
+		if (numRecords == 0)
+		{
+			firstTimestamp = timestamp;
+		}
+		else if ((mSpeed > 0.0) && (timestamp > firstTimestamp))
+		{
+			std::this_thread::sleep_until(startTime + std::chrono::microseconds(
+				(long long)((timestamp - firstTimestamp) / mSpeed)));
+		}
+
+		callback(context, dataPtr, dataLen, timestamp, sourceId);
+
+		numRecords++;
+	}
+	return((int)numRecords);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// replay straight into wrapper's DecodeStream on the capture clock, each
+// record sets the wrapper's clock time to when it was received so targets
+// age and expire the same way at any speed.  the wrapper is left on the
+// capture clock, SetClockTime(0) puts it back on time(NULL).  sourceId picks
+// the records of one receiver, -1 for all of them
+///////////////////////////////////////////////////////////////////////////////
+int CaptureReplayer::Replay(AdsbWrapper &wrapper, bool filterData, unsigned int maxRecords,
+	int sourceId)
+{
+	mWrapper = &wrapper;
+	mFilterData = filterData;
+	mSourceId = sourceId;
+
+	return(Replay(WrapperCallback, this, maxRecords));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// time of the first record, 0 for an empty capture
+///////////////////////////////////////////////////////////////////////////////
+int64_t CaptureReplayer::GetStartTime()
+{
+	int64_t timestamp = 0;
+
+	if ((mFileData != NULL) && ((CAPTURE_FILE_HEADER_SIZE + CAPTURE_RECORD_HEADER_SIZE) <= mRecordsEnd))
+	{
+		timestamp = (int64_t)CaptureGetUint64(&mFileData[CAPTURE_FILE_HEADER_SIZE]);
+	}
+	return(timestamp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// time of the last record, found from the last index entry
+///////////////////////////////////////////////////////////////////////////////
+int64_t CaptureReplayer::GetEndTime()
+{
+	const char *dataPtr;
+	unsigned int dataLen;
+	int64_t timestamp = 0;
+	unsigned char sourceId;
+
+	if (mIndex.empty() == true)
+	{
+		return(0);
+	}
+
+	unsigned long long savedOffset = mOffset;
+	int64_t endTime = 0;
+
+	mOffset = mIndex.back().fileOffset;
+
+	while (Next(dataPtr, dataLen, timestamp, sourceId) == 0)
+	{
+		endTime = timestamp;
+	}
+
+	mOffset = savedOffset;
+
+	return(endTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// false when the capture wasn't closed and the index was rebuilt
+///////////////////////////////////////////////////////////////////////////////
+bool CaptureReplayer::HasIndex()
+{
+	return(mHasIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CaptureReplayer::WrapperCallback(void *context, const char *dataPtr, unsigned int dataLen,
+	int64_t timestamp, unsigned char sourceId)
+{
+	CaptureReplayer *replayerPtr = (CaptureReplayer *)context;
+
+	if ((replayerPtr->mSourceId >= 0) && (sourceId != replayerPtr->mSourceId))
+	{
+		return;
+	}
+
+	replayerPtr->mWrapper->SetClockTime((time_t)(timestamp / 1000000));
+	replayerPtr->mWrapper->DecodeStream(dataLen, dataPtr, replayerPtr->mFilterData);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// load the index Close wrote, -1 if there isn't a sound one
+///////////////////////////////////////////////////////////////////////////////
+int CaptureReplayer::ReadIndex()
+{
+	if (mFileSize < (CAPTURE_FILE_HEADER_SIZE + CAPTURE_FOOTER_SIZE))
+	{
+		return(-1);
+	}
+
+	const unsigned char *footerBuf = &mFileData[mFileSize - CAPTURE_FOOTER_SIZE];
+
+	if (memcmp(footerBuf, CAPTURE_INDEX_MAGIC, 4) != 0)
+	{
+		return(-1);
+	}
+
+	unsigned long long numEntries = CaptureGetUint32(&footerBuf[4]);
+	unsigned long long indexOffset = CaptureGetUint64(&footerBuf[8]);
+
+	if ((indexOffset < CAPTURE_FILE_HEADER_SIZE) ||
+		((indexOffset + (numEntries * CAPTURE_INDEX_ENTRY_SIZE)) !=
+		(mFileSize - CAPTURE_FOOTER_SIZE)))
+	{
+		return(-1);
+	}
+
+	mIndex.resize((size_t)numEntries);
+
+	for (unsigned int index = 0; index < numEntries; index++)
+	{
+		const unsigned char *entryBuf = &mFileData[indexOffset + (index * CAPTURE_INDEX_ENTRY_SIZE)];
+
+		mIndex[index].timestamp = (int64_t)CaptureGetUint64(entryBuf);
+		mIndex[index].fileOffset = CaptureGetUint64(&entryBuf[8]);
+
+		if (mIndex[index].fileOffset >= indexOffset)
+		{
+			mIndex.clear();
+
+			return(-1);
+		}
+	}
+
+	mRecordsEnd = indexOffset;
+	mHasIndex = true;
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// walk the records of a capture that was cut short, stopping at the first
+// record that runs off the end of the file
+///////////////////////////////////////////////////////////////////////////////
+void CaptureReplayer::BuildIndex()
+{
+	unsigned long long offset = CAPTURE_FILE_HEADER_SIZE;
+
+	mIndex.clear();
+	mHasIndex = false;
+
+	while ((offset + CAPTURE_RECORD_HEADER_SIZE) <= mFileSize)
+	{
+		int64_t timestamp = (int64_t)CaptureGetUint64(&mFileData[offset]);
+		unsigned int dataLen = CaptureGetUint16(&mFileData[offset + 8]);
+
+		if ((offset + CAPTURE_RECORD_HEADER_SIZE + dataLen) > mFileSize)
+		{
+			break;
+		}
+
+		if ((mIndex.empty() == true) ||
+			((timestamp - mIndex.back().timestamp) >= (int64_t)mIndexInterval))
+		{
+			struct captureIndexRec entry;
+
+			entry.timestamp = timestamp;
+			entry.fileOffset = offset;
+
+			mIndex.push_back(entry);
+		}
+
+		offset += CAPTURE_RECORD_HEADER_SIZE + dataLen;
+	}
+
+	mRecordsEnd = offset;
+}
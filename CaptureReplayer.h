@@ -0,0 +1,94 @@
+//
+// CaptureReplayer.h: play a capture file back through the decoder
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _CAPTURE_REPLAYER_H_
+#define _CAPTURE_REPLAYER_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "AdsbWrapper.h"
+#include "CaptureFile.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// CaptureReplayer maps a capture file into memory and hands its records back
+// in order, each one a pointer straight into the mapping so nothing is
+// copied.
+//
+// Replay paces the records by their receive times, at the speed they were
+// captured, some multiple of it, or as fast as the callback takes them with
+// a speed of 0, which makes a capture a repeatable throughput benchmark.
+// Replaying into an AdsbWrapper runs the wrapper on the capture's clock, so
+// the traffic table comes out the same at every speed.
+// Seek moves to the first record at or after a time using the index, or an
+// index rebuilt from the records for a capture that was never closed.
+//
+// files are mapped with mmap, elsewhere they are read into memory
+///////////////////////////////////////////////////////////////////////////////
+class CaptureReplayer
+{
+public:
+	typedef void (*RecordCallback)(void *context, const char *dataPtr, unsigned int dataLen,
+		int64_t timestamp, unsigned char sourceId);
+
+	CaptureReplayer();
+	~CaptureReplayer();
+
+	int Open(const char *filename);
+	void Close();
+
+	int Next(const char *&dataPtr, unsigned int &dataLen, int64_t &timestamp,
+		unsigned char &sourceId);
+	int Seek(int64_t timestamp);
+	void Rewind();
+
+	void SetSpeed(double speed);
+
+	int Replay(RecordCallback callback, void *context, unsigned int maxRecords = 0);
+	int Replay(AdsbWrapper &wrapper, bool filterData = true, unsigned int maxRecords = 0,
+		int sourceId = -1);
+
+	int64_t GetStartTime();
+	int64_t GetEndTime();
+	bool HasIndex();
+
+private:
+	static void WrapperCallback(void *context, const char *dataPtr, unsigned int dataLen,
+		int64_t timestamp, unsigned char sourceId);
+
+	int ReadIndex();
+	void BuildIndex();
+
+	const unsigned char *mFileData;
+	unsigned long long mFileSize;
+	unsigned long long mRecordsEnd;  // offset just past the last whole record
+
+	std::vector<unsigned char> mFileCopy;  // when there is no mmap
+
+	std::vector<struct captureIndexRec> mIndex;
+	unsigned int mIndexInterval;
+	bool mHasIndex;
+
+	unsigned long long mOffset;
+	double mSpeed;
+
+	AdsbWrapper *mWrapper;
+	bool mFilterData;
+	int mSourceId;
+};
+
+#endif // _CAPTURE_REPLAYER_H_
@@ -0,0 +1,233 @@
+//
+// CaptureWriter.cpp: background capture to rotated segment files
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "CaptureWriter.h"
+
+// how long the writer sleeps when there is nothing to write
+
+#define CAPTURE_WRITER_IDLE_SLEEP_US 1000
+
+CaptureWriter::CaptureWriter(unsigned int queueSize) :
+	mQueue(queueSize)
+{
+	mRunning.store(false);
+
+	mSegmentSize = CAPTURE_WRITER_DEFAULT_SEGMENT_SIZE;
+	mSegmentSeconds = 0;
+	mSegmentStartTime = 0;
+
+	mNumWritten.store(0);
+	mNumDropped.store(0);
+	mNumSegments.store(0);
+	mNumWriteErrors.store(0);
+}
+
+CaptureWriter::~CaptureWriter()
+{
+	Stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// open the first segment and start the writer thread.  segmentSize is in
+// bytes and segmentSeconds in seconds, 0 for no limit
+///////////////////////////////////////////////////////////////////////////////
+int CaptureWriter::Start(const char *pathPrefix, unsigned long long segmentSize,
+	unsigned int segmentSeconds)
+{
+	if (mRunning.load() == true)
+	{
+		return(-1);
+	}
+
+	mPathPrefix = pathPrefix;
+	mSegmentSize = segmentSize;
+	mSegmentSeconds = segmentSeconds;
+
+	mNumSegments.store(0);
+
+	if (OpenSegment() != 0)
+	{
+		return(-1);
+	}
+
+	mRunning.store(true);
+
+	mThread = std::thread(&CaptureWriter::WriterLoop, this);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write out whatever is queued and close the last segment
+///////////////////////////////////////////////////////////////////////////////
+void CaptureWriter::Stop()
+{
+	if (mRunning.load() == false)
+	{
+		return;
+	}
+
+	mRunning.store(false);
+
+	mThread.join();
+
+	mRecorder.Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// any thread, never blocks.  returns -1 if the data was dropped because the
+// queue was full, the writer isn't running or the data is too long
+///////////////////////////////////////////////////////////////////////////////
+int CaptureWriter::Write(unsigned int dataLen, const char *dataPtr, unsigned char sourceId)
+{
+	struct captureDataRec captureData;
+
+	if ((mRunning.load(std::memory_order_relaxed) == false) ||
+		(dataLen > sizeof(captureData.dataBuf)))
+	{
+		mNumDropped.fetch_add(1, std::memory_order_relaxed);
+
+		return(-1);
+	}
+
+	captureData.timestamp = CaptureRecorder::GetNow();
+	captureData.dataLen = (uint16_t)dataLen;
+	captureData.sourceId = sourceId;
+	captureData.reserved = 0;
+
+	memcpy(captureData.dataBuf, dataPtr, dataLen);
+
+	if (mQueue.Push(captureData) == false)
+	{
+		mNumDropped.fetch_add(1, std::memory_order_relaxed);
+
+		return(-1);
+	}
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int CaptureWriter::GetNumWritten()
+{
+	return(mNumWritten.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int CaptureWriter::GetNumDropped()
+{
+	return(mNumDropped.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int CaptureWriter::GetNumSegments()
+{
+	return(mNumSegments.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// records the disk refused, the writer carries on with the next one
+///////////////////////////////////////////////////////////////////////////////
+unsigned int CaptureWriter::GetNumWriteErrors()
+{
+	return(mNumWriteErrors.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CaptureWriter::WriterLoop()
+{
+	struct captureDataRec captureData;
+	bool needsFlush = false;
+
+	while (true)
+	{
+		if (mQueue.Pop(captureData) == false)
+		{
+			if (needsFlush == true)
+			{
+				mRecorder.Flush();
+
+				needsFlush = false;
+			}
+
+			// anything queued before Stop has been written by now
+
+			if (mRunning.load(std::memory_order_acquire) == false)
+			{
+				if (mQueue.Pop(captureData) == false)
+				{
+					break;
+				}
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(CAPTURE_WRITER_IDLE_SLEEP_US));
+
+				continue;
+			}
+		}
+
+		bool segmentFull = ((mSegmentSize > 0) && (mRecorder.GetFileSize() >= mSegmentSize));
+		bool segmentOld = ((mSegmentSeconds > 0) &&
+			((captureData.timestamp - mSegmentStartTime) >= (mSegmentSeconds * 1000000LL)));
+
+		if ((segmentFull == true) || (segmentOld == true))
+		{
+			mRecorder.Close();
+
+			if (OpenSegment() != 0)
+			{
+				mNumWriteErrors.fetch_add(1, std::memory_order_relaxed);
+
+				continue;
+			}
+		}
+
+		if (mRecorder.Record(captureData.dataLen, (const char *)captureData.dataBuf,
+			captureData.timestamp, captureData.sourceId) == 0)
+		{
+			mNumWritten.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			mNumWriteErrors.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		needsFlush = true;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int CaptureWriter::OpenSegment()
+{
+	char filename[32];
+
+	snprintf(filename, sizeof(filename), "_%06u.cap", mNumSegments.load());
+
+	if (mRecorder.Open((mPathPrefix + filename).c_str()) != 0)
+	{
+		return(-1);
+	}
+
+	mSegmentStartTime = CaptureRecorder::GetNow();
+	mNumSegments.fetch_add(1, std::memory_order_relaxed);
+
+	return(0);
+}
@@ -0,0 +1,95 @@
+//
+// CaptureWriter.h: background capture to rotated segment files
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _CAPTURE_WRITER_H_
+#define _CAPTURE_WRITER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "CaptureRecorder.h"
+#include "Gdl90Defs.h"
+#include "MpscRing.h"
+
+#define CAPTURE_WRITER_QUEUE_SIZE 1024
+#define CAPTURE_WRITER_DEFAULT_SEGMENT_SIZE (64 * 1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////
+// CaptureWriter records data from the decoding threads without ever making
+// them wait on the disk.  Write copies the data into a bounded MpscRing and
+// returns, data that finds the ring full is dropped and counted.  a single
+// writer thread drains the ring into CaptureRecorder segment files, letting
+// the recorder's buffer batch the writes and flushing whenever the ring runs
+// dry.
+//
+// segments are named <prefix>_000000.cap, <prefix>_000001.cap and so on, a
+// new one is started once a segment reaches its size or age limit.  each
+// segment is a complete capture that CaptureReplayer can open
+///////////////////////////////////////////////////////////////////////////////
+class CaptureWriter
+{
+public:
+	CaptureWriter(unsigned int queueSize = CAPTURE_WRITER_QUEUE_SIZE);
+	~CaptureWriter();
+
+	int Start(const char *pathPrefix,
+		unsigned long long segmentSize = CAPTURE_WRITER_DEFAULT_SEGMENT_SIZE,
+		unsigned int segmentSeconds = 0);
+	void Stop();
+
+	int Write(unsigned int dataLen, const char *dataPtr, unsigned char sourceId = 0);
+
+	unsigned int GetNumWritten();
+	unsigned int GetNumDropped();
+	unsigned int GetNumSegments();
+	unsigned int GetNumWriteErrors();
+
+private:
+	struct captureDataRec
+	{
+		int64_t timestamp;
+		uint16_t dataLen;
+		uint8_t sourceId;
+		uint8_t reserved;
+		unsigned char dataBuf[GDL90_MAX_FRAME_SIZE];
+	};
+
+	void WriterLoop();
+	int OpenSegment();
+
+	MpscRing<struct captureDataRec> mQueue;
+
+	std::thread mThread;
+	std::atomic<bool> mRunning;
+
+	// writer thread
+
+	CaptureRecorder mRecorder;
+	std::string mPathPrefix;
+	unsigned long long mSegmentSize;
+	unsigned int mSegmentSeconds;
+	int64_t mSegmentStartTime;
+
+	std::atomic<unsigned int> mNumWritten;
+	std::atomic<unsigned int> mNumDropped;
+	std::atomic<unsigned int> mNumSegments;
+	std::atomic<unsigned int> mNumWriteErrors;
+};
+
+#endif // _CAPTURE_WRITER_H_
@@ -0,0 +1,328 @@
+//
+// DecodePipeline.cpp: multi-threaded GDL90 decode pipeline
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <string.h>
+#include <time.h>
+#include <chrono>
+
+#include "DecodePipeline.h"
+#include "Gdl90Crc.h"
+#include "TrafficIndex.h"
+
+// empty polls before an idle worker starts sleeping between polls
+
+#define DECODE_PIPELINE_SPIN_LIMIT 64
+#define DECODE_PIPELINE_IDLE_SLEEP_US 50
+
+DecodePipeline::workerRec::workerRec() :
+	frames(DECODE_PIPELINE_WORKER_RING_SIZE),
+	reports(DECODE_PIPELINE_WORKER_RING_SIZE)
+{
+	numCrcErrors.store(0);
+}
+
+DecodePipeline::DecodePipeline(AdsbWrapper &wrapper, unsigned int numWorkers) :
+	mWrapper(wrapper),
+	mOtherFrames(DECODE_PIPELINE_OTHER_RING_SIZE)
+{
+	if (numWorkers == 0)
+	{
+		numWorkers = 1;
+	}
+	else if (numWorkers > DECODE_PIPELINE_MAX_WORKERS)
+	{
+		numWorkers = DECODE_PIPELINE_MAX_WORKERS;
+	}
+
+	for (unsigned int index = 0; index < numWorkers; index++)
+	{
+		mWorkers.push_back(new workerRec);
+	}
+
+	mFilterData = true;
+	mWaitWhenFull = false;
+	mRunning.store(false);
+	mNumDroppedFrames = 0;
+
+	mFramer.SetFrameCallback(IngestFrameCallback, this);
+}
+
+DecodePipeline::~DecodePipeline()
+{
+	Stop();
+
+	for (unsigned int index = 0; index < mWorkers.size(); index++)
+	{
+		delete mWorkers[index];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start the worker threads, returns -1 if they are already running
+///////////////////////////////////////////////////////////////////////////////
+int DecodePipeline::Start(bool filterData, bool waitWhenFull)
+{
+	int status = -1;
+
+	if (mRunning.load() == false)
+	{
+		mFilterData = filterData;
+		mWaitWhenFull = waitWhenFull;
+
+		mRunning.store(true);
+
+		for (unsigned int index = 0; index < mWorkers.size(); index++)
+		{
+			mWorkers[index]->thread = std::thread(&DecodePipeline::WorkerLoop, this,
+				mWorkers[index]);
+		}
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the workers finish what is already queued before they exit, call Poll
+// afterwards to store the last of the results
+///////////////////////////////////////////////////////////////////////////////
+void DecodePipeline::Stop()
+{
+	if (mRunning.load() == false)
+	{
+		return;
+	}
+
+	mRunning.store(false);
+
+	for (unsigned int index = 0; index < mWorkers.size(); index++)
+	{
+		// a worker stuck on a full result ring needs room to finish.  once
+		// its result ring is empty whatever is left in its frame ring fits,
+		// the two rings are the same size
+
+		while (mWorkers[index]->thread.joinable() == true)
+		{
+			if (mWorkers[index]->reports.IsEmpty() == true)
+			{
+				mWorkers[index]->thread.join();
+			}
+			else
+			{
+				Poll();
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ingest thread only.  returns the number of complete frames found
+///////////////////////////////////////////////////////////////////////////////
+int DecodePipeline::Feed(unsigned int dataLen, const char *dataPtr)
+{
+	return(mFramer.Feed((const unsigned char *)dataPtr, dataLen));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// merge thread only.  store up to maxResults decoded reports and other
+// frames, 0 for everything that is ready.  returns the number handled
+///////////////////////////////////////////////////////////////////////////////
+int DecodePipeline::Poll(unsigned int maxResults)
+{
+	unsigned int numResults = 0;
+	bool foundResult = true;
+	struct trafficReportRec report;
+
+	if (maxResults == 0)
+	{
+		maxResults = 0xffffffff;
+	}
+
+	mWrapper.ExpireTraffic(mWrapper.GetClockTime());
+
+	// a report at a time from each worker so no worker gets too far ahead
+
+	while ((foundResult == true) && (numResults < maxResults))
+	{
+		foundResult = false;
+
+		for (unsigned int index = 0; (index < mWorkers.size()) && (numResults < maxResults); index++)
+		{
+			if (mWorkers[index]->reports.Pop(report) == true)
+			{
+				mWrapper.StoreTrafficReport(report, mFilterData);
+
+				numResults++;
+				foundResult = true;
+			}
+		}
+
+		if ((numResults < maxResults) && (mOtherFrames.Pop(mOtherFrame) == true))
+		{
+			mWrapper.DecodeFrame(mOtherFrame.frameSize, mOtherFrame.frameBuf, mFilterData);
+
+			numResults++;
+			foundResult = true;
+		}
+	}
+
+	return((int)numResults);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int DecodePipeline::GetNumWorkers()
+{
+	return((unsigned int)mWorkers.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// traffic frames the workers rejected, the other frames are counted by the
+// AdsbWrapper
+///////////////////////////////////////////////////////////////////////////////
+unsigned int DecodePipeline::GetNumCrcErrors()
+{
+	unsigned int numCrcErrors = 0;
+
+	for (unsigned int index = 0; index < mWorkers.size(); index++)
+	{
+		numCrcErrors += mWorkers[index]->numCrcErrors.load(std::memory_order_relaxed);
+	}
+	return(numCrcErrors);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames Feed couldn't queue because a ring was full
+///////////////////////////////////////////////////////////////////////////////
+unsigned int DecodePipeline::GetNumDroppedFrames()
+{
+	return(mNumDroppedFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void DecodePipeline::IngestFrameCallback(void *context, unsigned char *frameBuf,
+	unsigned int frameSize)
+{
+	DecodePipeline *pipelinePtr = (DecodePipeline *)context;
+
+	pipelinePtr->RouteFrame(frameBuf, frameSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// traffic frames are sharded on (address type, participant address) which
+// are in the clear ahead of the crc check, the worker rejects bad frames.
+// only full length traffic frames go to the workers, a short one is left for
+// DecodeFrame to reject
+///////////////////////////////////////////////////////////////////////////////
+void DecodePipeline::RouteFrame(unsigned char *frameBuf, unsigned int frameSize)
+{
+	bool queued = false;
+
+	if (frameSize < GDL90_MIN_FRAME_SIZE)
+	{
+		return;
+	}
+
+	unsigned char msgId = frameBuf[1];
+
+	if (((msgId == GDL90_ID_OWNSHIP) || (msgId == GDL90_ID_TRAFFIC)) &&
+		(frameSize == DECODE_PIPELINE_TRAFFIC_FRAME_SIZE))
+	{
+		struct trafficFrameRec trafficFrame;
+
+		unsigned long long key = TrafficIndex::MakeAddressKey(frameBuf[2] & 0x0f,
+			(frameBuf[3] << 16) | (frameBuf[4] << 8) | frameBuf[5]);
+		unsigned int workerIndex = (unsigned int)(((key * 0x9E3779B97F4A7C15ULL) >> 32) %
+			mWorkers.size());
+
+		trafficFrame.frameSize = (unsigned char)frameSize;
+		memcpy(trafficFrame.frameBuf, frameBuf, frameSize);
+
+		while (((queued = mWorkers[workerIndex]->frames.Push(trafficFrame)) == false) &&
+			(mWaitWhenFull == true))
+		{
+			std::this_thread::yield();
+		}
+	}
+	else
+	{
+		struct otherFrameRec otherFrame;
+
+		otherFrame.frameSize = (unsigned short)frameSize;
+		memcpy(otherFrame.frameBuf, frameBuf, frameSize);
+
+		while (((queued = mOtherFrames.Push(otherFrame)) == false) &&
+			(mWaitWhenFull == true))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	if (queued == false)
+	{
+		mNumDroppedFrames++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void DecodePipeline::WorkerLoop(struct workerRec *workerPtr)
+{
+	struct trafficFrameRec trafficFrame;
+	struct trafficReportRec report;
+	unsigned int numIdlePolls = 0;
+
+	while (true)
+	{
+		if (workerPtr->frames.Pop(trafficFrame) == false)
+		{
+			if (mRunning.load(std::memory_order_acquire) == false)
+			{
+				break;
+			}
+
+			if (numIdlePolls < DECODE_PIPELINE_SPIN_LIMIT)
+			{
+				numIdlePolls++;
+
+				std::this_thread::yield();
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(DECODE_PIPELINE_IDLE_SLEEP_US));
+			}
+			continue;
+		}
+
+		numIdlePolls = 0;
+
+		if (Gdl90CrcCheck(trafficFrame.frameBuf, trafficFrame.frameSize) != 0)
+		{
+			workerPtr->numCrcErrors.fetch_add(1, std::memory_order_relaxed);
+
+			continue;
+		}
+
+		if (AdsbWrapper::DecodeTrafficReport(trafficFrame.frameSize, &trafficFrame.frameBuf[1],
+			report) != 0)
+		{
+			continue;
+		}
+
+		while (workerPtr->reports.Push(report) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
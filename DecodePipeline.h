@@ -0,0 +1,120 @@
+//
+// DecodePipeline.h: multi-threaded GDL90 decode pipeline
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _DECODE_PIPELINE_H_
+#define _DECODE_PIPELINE_H_
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "AdsbWrapper.h"
+#include "Gdl90Framer.h"
+#include "SpscRing.h"
+#include "TrafficReport.h"
+
+#define DECODE_PIPELINE_MAX_WORKERS 64
+#define DECODE_PIPELINE_WORKER_RING_SIZE 4096
+#define DECODE_PIPELINE_OTHER_RING_SIZE 256
+
+// an unstuffed ownship or traffic frame including both flag positions
+
+#define DECODE_PIPELINE_TRAFFIC_FRAME_SIZE (GDL90_ID_TRAFFIC_LENGTH + GDL90_FRAME_OVERHEAD)
+
+///////////////////////////////////////////////////////////////////////////////
+// DecodePipeline spreads the decoding for one AdsbWrapper across threads.
+//
+//   ingest   the thread calling Feed frames the raw bytes and sends each
+//            ownship and traffic frame to a worker chosen by its participant
+//            address, so every report for a target goes through the same
+//            worker in order.  anything else goes to the merge side as is
+//   workers  check the crc and decode traffic frames into trafficReportRec
+//   merge    the thread calling Poll stores the decoded reports and runs the
+//            other frames through AdsbWrapper::DecodeFrame
+//
+// every hop is an SpscRing so there are no locks.  the AdsbWrapper is only
+// touched from the thread calling Poll, read it and call Stop from that
+// thread.  Feed and Poll may be the same thread.
+//
+// by default Feed never blocks, a frame that finds its ring full is dropped
+// and counted.  started with waitWhenFull set Feed waits for room instead,
+// which is what replaying a capture wants, but then Poll has to be running
+// on another thread.  a worker that finds its result ring full waits for Poll
+///////////////////////////////////////////////////////////////////////////////
+class DecodePipeline
+{
+public:
+	DecodePipeline(AdsbWrapper &wrapper, unsigned int numWorkers);
+	~DecodePipeline();
+
+	int Start(bool filterData = true, bool waitWhenFull = false);
+	void Stop();
+
+	int Feed(unsigned int dataLen, const char *dataPtr);
+	int Poll(unsigned int maxResults = 0);
+
+	unsigned int GetNumWorkers();
+	unsigned int GetNumCrcErrors();
+	unsigned int GetNumDroppedFrames();
+
+private:
+	struct trafficFrameRec
+	{
+		unsigned char frameSize;
+		unsigned char frameBuf[DECODE_PIPELINE_TRAFFIC_FRAME_SIZE];
+	};
+
+	struct otherFrameRec
+	{
+		unsigned short frameSize;
+		unsigned char frameBuf[GDL90_MAX_FRAME_SIZE];
+	};
+
+	struct workerRec
+	{
+		workerRec();
+
+		SpscRing<struct trafficFrameRec> frames;
+		SpscRing<struct trafficReportRec> reports;
+
+		std::thread thread;
+		std::atomic<unsigned int> numCrcErrors;
+	};
+
+	static void IngestFrameCallback(void *context, unsigned char *frameBuf,
+		unsigned int frameSize);
+	void RouteFrame(unsigned char *frameBuf, unsigned int frameSize);
+
+	void WorkerLoop(struct workerRec *workerPtr);
+
+	AdsbWrapper &mWrapper;
+	bool mFilterData;
+	bool mWaitWhenFull;
+
+	Gdl90Framer mFramer;
+
+	std::vector<struct workerRec *> mWorkers;
+	SpscRing<struct otherFrameRec> mOtherFrames;
+
+	std::atomic<bool> mRunning;
+
+	unsigned int mNumDroppedFrames;
+
+	struct otherFrameRec mOtherFrame;
+};
+
+#endif // _DECODE_PIPELINE_H_
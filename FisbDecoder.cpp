@@ -0,0 +1,945 @@
+//
+// FisbDecoder.cpp: FIS-B product decoding and caches
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FisbDecoder.h"
+#include "Gdl90Fields.h"
+
+std::map<int, std::string> FisbDecoder::mProductNameMap =
+{
+	{ 0, "METAR" },
+	{ 1, "TAF" },
+	{ 2, "SIGMET" },
+	{ 3, "Conv SIGMET" },
+	{ 4, "AIRMET" },
+	{ 5, "PIREP" },
+	{ 6, "Severe Wx" },
+	{ 7, "Winds Aloft" },
+	{ 8, "NOTAM" },                // NOTAM (Including TFRs) and Service Status
+	{ 9, "D-ATIS" },               // Aerodrome and Airspace - D-ATIS
+	{ 10, "Terminal Wx" },         // Aerodrome and Airspace - TWIP
+	{ 11, "AIRMET" },              // Aerodrome and Airspace - AIRMET
+	{ 12, "SIGMET" },              // Aerodrome and Airspace - SIGMET/Convective SIGMET
+	{ 13, "SUA" },                 // Aerodrome and Airspace - SUA Status
+	{ 20, "METAR" },               // METAR and SPECI
+	{ 21, "TAF" },                 // TAF and Amended TAF
+	{ 22, "SIGMET" },              // SIGMET
+	{ 23, "Conv SIGMET" },         // Convective SIGMET
+	{ 24, "AIRMET" },              // AIRMET
+	{ 25, "PIREP" },               // PIREP
+	{ 26, "Severe Wx" },           // AWW
+	{ 27, "Winds Aloft" },         // Winds and Temperatures Aloft
+	{ 51, "NEXRAD" },              // National NEXRAD, Type 0 - 4 level
+	{ 52, "NEXRAD" },              // National NEXRAD, Type 1 - 8 level (quasi 6-level VIP)
+	{ 53, "NEXRAD" },              // National NEXRAD, Type 2 - 8 level
+	{ 54, "NEXRAD" },              // National NEXRAD, Type 3 - 16 level
+	{ 55, "NEXRAD" },              // Regional NEXRAD, Type 0 - low dynamic range
+	{ 56, "NEXRAD" },              // Regional NEXRAD, Type 1 - 8 level (quasi 6-level VIP)
+	{ 57, "NEXRAD" },              // Regional NEXRAD, Type 2 - 8 level
+	{ 58, "NEXRAD" },              // Regional NEXRAD, Type 3 - 16 level
+	{ 59, "NEXRAD" },              // Individual NEXRAD, Type 0 - low dynamic range
+	{ 60, "NEXRAD" },              // Individual NEXRAD, Type 1 - 8 level (quasi 6-level VIP)
+	{ 61, "NEXRAD" },              // Individual NEXRAD, Type 2 - 8 level
+	{ 62, "NEXRAD" },              // Individual NEXRAD, Type 3 - 16 level
+	{ 63, "NEXRAD Regional" },     // Global Block Representation - Regional NEXRAD, Type 4 - 8 level
+	{ 64, "NEXRAD CONUS" },        // Global Block Representation - CONUS NEXRAD, Type 4 - 8 level
+	{ 81, "Tops" },                // Radar echo tops graphic, scheme 1,16-level
+	{ 82, "Tops" },                // Radar echo tops graphic, scheme 2,8-level
+	{ 83, "Tops" },                // Storm tops and velocity
+	{ 101, "Lightning" },          // Lightning strike type 1 (pixel level)
+	{ 102, "Lightning" },          // Lightning strike type 2 (grid element level)
+	{ 151, "Lightning" },          // Point phenomena, vector format
+	{ 201, "Surface" },            // Surface conditions/winter precipitation graphic
+	{ 202, "Surface" },            // Surface weather systems
+	{ 254, "G-AIRMET" },           // AIRMET, SIGMET,Bitmap encoding
+	{ 351, "Time" },               // System Time
+	{ 352, "Status" },             // Operational Status
+	{ 353, "Status" },             // Ground Station Status
+	{ 401, "Imagery" },            // Generic Raster Scan Data Product APDU Payload Format Type 1
+	{ 402, "Text" },
+	{ 403, "Vector Imagery" },     // Generic Vector Data Product APDU Payload Format Type 1
+	{ 404, "Symbols" },
+	{ 405, "Text" },
+	{ 411, "Text" },               // Generic Textual Data Product APDU Payload Format Type 1
+	{ 412, "Symbols" },            // Generic Symbolic Product APDU Payload Format Type 1
+	{ 413, "Text" }                // Generic Textual Data Product APDU Payload Format Type 2
+};
+
+// DLAC is 6 bit characters, 4 to every 3 bytes.  0 is the end of the text,
+// a tab is followed by the number of spaces it stands for and 0x1e separates
+// reports
+
+static const char dlac_alphabet[65] =
+	"\x03" "ABCDEFGHIJKLMNOPQRSTUVWXYZ\x1a\t\x1e\n| !\"#$%&'()*+,-./0123456789:;<=>?";
+
+#define FISB_DLAC_END 0x03
+#define FISB_DLAC_IGNORED 0x1a
+#define FISB_DLAC_RECORD_SEPARATOR 0x1e
+
+// global block NEXRAD rows are 450 blocks around, empty block bitmaps stay
+// within the row of the block they start from
+
+#define FISB_NEXRAD_BLOCKS_PER_ROW 450
+
+///////////////////////////////////////////////////////////////////////////////
+// FNV-1a, a byte at a time with nothing to set up
+///////////////////////////////////////////////////////////////////////////////
+static unsigned long long Fnv1aHash(const unsigned char *dataBuf, unsigned int dataLen)
+{
+	unsigned long long hash = 14695981039346656037ull;
+
+	for (unsigned int index = 0; index < dataLen; index++)
+	{
+		hash ^= dataBuf[index];
+		hash *= 1099511628211ull;
+	}
+	return(hash);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned long long MakeProductKey(const std::string &key)
+{
+	return(Fnv1aHash((const unsigned char *)key.c_str(), (unsigned int)key.size()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the words of a text report up to the first count of them
+///////////////////////////////////////////////////////////////////////////////
+static void GetLeadingWords(const std::string &text, unsigned int numWords, std::string &words)
+{
+	size_t wordEnd = 0;
+
+	for (unsigned int index = 0; (index < numWords) && (wordEnd != std::string::npos); index++)
+	{
+		size_t wordStart = text.find_first_not_of(' ', wordEnd);
+
+		if (wordStart == std::string::npos)
+		{
+			break;
+		}
+		wordEnd = text.find_first_of(" \n", wordStart);
+	}
+
+	words.assign(text, 0, (wordEnd == std::string::npos) ? text.size() : wordEnd);
+}
+
+FisbDecoder::FisbDecoder()
+{
+	mChangeVersion = 0;
+
+	mNumApdus = 0;
+	mNumDuplicates = 0;
+	mNumSegmented = 0;
+	mNumErrors = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode every APDU information frame of an uplink, returns the number of
+// APDUs that were new or -1 if the uplink has no application data
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::Decode(const struct uplinkDataRec &uplinkData, time_t now)
+{
+	int numDecoded = 0;
+
+	if (uplinkData.appDataValid == 0)
+	{
+		return(-1);
+	}
+
+	for (unsigned int index = 0; index < uplinkData.numInfoFrames; index++)
+	{
+		const struct uplinkInfoFrameRec &infoFrame = uplinkData.infoFrames[index];
+
+		if ((infoFrame.type == UPLINK_INFO_FRAME_APDU) &&
+			((infoFrame.offset + infoFrame.length) <= uplinkData.appDataLen))
+		{
+			unsigned int numDuplicates = mNumDuplicates;
+
+			if ((DecodeApdu(&uplinkData.appData[infoFrame.offset], infoFrame.length, now) == 0) &&
+				(mNumDuplicates == numDuplicates))
+			{
+				numDecoded++;
+			}
+		}
+	}
+	return(numDecoded);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one APDU, apduBuf is the data of its information frame.  a repeat of an
+// APDU that has been seen is only noted as heard again
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeApdu(const unsigned char *apduBuf, unsigned int apduLen, time_t now)
+{
+	int status = -1;
+	struct fisbApduRec apdu;
+
+	mNumApdus++;
+
+	if (DecodeApduHeader(apduBuf, apduLen, apdu) != 0)
+	{
+		mNumErrors++;
+
+		return(status);
+	}
+
+	struct productCacheRec &cache = GetCache(apdu.productId);
+
+	unsigned long long apduHash = HashApdu(apduBuf, apduLen);
+	int seenIndex = cache.hashIndex.Find(apduHash);
+
+	if (seenIndex >= 0)
+	{
+		cache.seen[seenIndex].lastReceived = now;
+
+		mNumDuplicates++;
+
+		return(0);
+	}
+
+	if (cache.seenFreeList.empty() == false)
+	{
+		seenIndex = cache.seenFreeList.back();
+		cache.seenFreeList.pop_back();
+	}
+	else
+	{
+		seenIndex = (int)cache.seen.size();
+		cache.seen.push_back(apduSeenRec());
+	}
+
+	cache.seen[seenIndex].apduHash = apduHash;
+	cache.seen[seenIndex].lastReceived = now;
+
+	cache.hashIndex.Insert(apduHash, seenIndex);
+
+	if (apdu.sFlag != 0)
+	{
+		mNumSegmented++;
+
+		return(0);
+	}
+
+	switch (apdu.productId)
+	{
+	case FISB_PRODUCT_TEXT:
+		status = DecodeTextProduct(cache, apdu, apduHash, now);
+		break;
+
+	case FISB_PRODUCT_NEXRAD_REGIONAL:
+	case FISB_PRODUCT_NEXRAD_CONUS:
+		status = DecodeNexradProduct(cache, apdu, apduHash, now);
+		break;
+
+	default:
+		status = DecodeOtherProduct(cache, apdu, apduHash, now);
+		break;
+	}
+
+	if (status != 0)
+	{
+		mNumErrors++;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// drop products and APDU hashes that haven't been heard for their time to
+// live, returns the number of products dropped
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::ExpireProducts(time_t now)
+{
+	int numExpired = 0;
+
+	for (std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.begin();
+		cacheIter != mCaches.end(); cacheIter++)
+	{
+		struct productCacheRec &cache = cacheIter->second;
+
+		for (unsigned int index = 0; index < cache.products.size(); index++)
+		{
+			struct fisbProductRec &product = cache.products[index];
+
+			if (product.key.empty() == true)
+			{
+				continue;
+			}
+
+			RefreshProduct(cache, product);
+
+			if ((product.lastReceived + (time_t)cache.timeToLive) <= now)
+			{
+				RemoveProduct(cache, (int)index);
+
+				numExpired++;
+			}
+		}
+
+		for (unsigned int index = 0; index < cache.seen.size(); index++)
+		{
+			struct apduSeenRec &seen = cache.seen[index];
+
+			if ((seen.lastReceived != 0) &&
+				((seen.lastReceived + (time_t)cache.timeToLive) <= now))
+			{
+				cache.hashIndex.Remove(seen.apduHash);
+
+				seen.lastReceived = 0;
+
+				cache.seenFreeList.push_back((int)index);
+			}
+		}
+	}
+	return(numExpired);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// forget every product, the time to live settings stay
+///////////////////////////////////////////////////////////////////////////////
+void FisbDecoder::Clear()
+{
+	for (std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.begin();
+		cacheIter != mCaches.end(); cacheIter++)
+	{
+		struct productCacheRec &cache = cacheIter->second;
+
+		cache.products.clear();
+		cache.freeList.clear();
+		cache.keyIndex.Clear();
+
+		cache.seen.clear();
+		cache.seenFreeList.clear();
+		cache.hashIndex.Clear();
+		cache.numProducts = 0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FisbDecoder::SetTimeToLive(int productId, unsigned int seconds)
+{
+	GetCache(productId).timeToLive = seconds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int FisbDecoder::GetTimeToLive(int productId)
+{
+	return(GetCache(productId).timeToLive);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the product ids that have products cached, returns how many
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::GetProductIds(std::vector<int> &productIds)
+{
+	int numIds = 0;
+
+	for (std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.begin();
+		cacheIter != mCaches.end(); cacheIter++)
+	{
+		if (cacheIter->second.numProducts > 0)
+		{
+			productIds.push_back(cacheIter->first);
+
+			numIds++;
+		}
+	}
+	return(numIds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append the products cached for productId.  with changeVersion only the
+// ones that changed since *changeVersion are appended and *changeVersion
+// is moved up for next time.  returns the number appended
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::GetProducts(int productId, std::vector<struct fisbProductRec> &products,
+	unsigned long long *changeVersion)
+{
+	int numProducts = 0;
+	std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.find(productId);
+
+	if (cacheIter != mCaches.end())
+	{
+		struct productCacheRec &cache = cacheIter->second;
+
+		for (unsigned int index = 0; index < cache.products.size(); index++)
+		{
+			struct fisbProductRec &product = cache.products[index];
+
+			if ((product.key.empty() == false) &&
+				((changeVersion == NULL) || (product.changeVersion > *changeVersion)))
+			{
+				RefreshProduct(cache, product);
+
+				products.push_back(product);
+
+				numProducts++;
+			}
+		}
+	}
+
+	if (changeVersion != NULL)
+	{
+		*changeVersion = mChangeVersion;
+	}
+	return(numProducts);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns -1 if there is no product with that key
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::FindProduct(int productId, const std::string &key,
+	struct fisbProductRec &product)
+{
+	int status = -1;
+	std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.find(productId);
+
+	if (cacheIter != mCaches.end())
+	{
+		struct productCacheRec &cache = cacheIter->second;
+		int productIndex = cache.keyIndex.Find(MakeProductKey(key));
+
+		if ((productIndex >= 0) && (cache.products[productIndex].key == key))
+		{
+			RefreshProduct(cache, cache.products[productIndex]);
+
+			product = cache.products[productIndex];
+
+			status = 0;
+		}
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int FisbDecoder::GetNumProducts()
+{
+	unsigned int numProducts = 0;
+
+	for (std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.begin();
+		cacheIter != mCaches.end(); cacheIter++)
+	{
+		numProducts += cacheIter->second.numProducts;
+	}
+	return(numProducts);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int FisbDecoder::GetNumApdus()
+{
+	return(mNumApdus);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// APDUs that were already in their product's cache
+///////////////////////////////////////////////////////////////////////////////
+unsigned int FisbDecoder::GetNumDuplicates()
+{
+	return(mNumDuplicates);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// segmented APDUs, counted but not put back together
+///////////////////////////////////////////////////////////////////////////////
+unsigned int FisbDecoder::GetNumSegmented()
+{
+	return(mNumSegmented);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// APDUs too short for their header or whose product didn't decode
+///////////////////////////////////////////////////////////////////////////////
+unsigned int FisbDecoder::GetNumErrors()
+{
+	return(mNumErrors);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// apduBuf is the start of the APDU, apdu.data is left pointing into it just
+// past the header.  returns -1 if apduLen is too short for the header
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeApduHeader(const unsigned char *apduBuf, unsigned int apduLen,
+	struct fisbApduRec &apdu)
+{
+	int status = -1;
+	unsigned int headerLen = 0;
+
+	memset(&apdu, 0, sizeof(apdu));
+
+	if ((apduBuf == NULL) || (apduLen < 4))
+	{
+		return(status);
+	}
+
+	apdu.aFlag = (uint8_t)fisbApduLayout::aFlag::Get(apduBuf);
+	apdu.gFlag = (uint8_t)fisbApduLayout::gFlag::Get(apduBuf);
+	apdu.pFlag = (uint8_t)fisbApduLayout::pFlag::Get(apduBuf);
+	apdu.productId = (uint16_t)fisbApduLayout::productId::Get(apduBuf);
+	apdu.sFlag = (uint8_t)fisbApduLayout::sFlag::Get(apduBuf);
+	apdu.timeOption = (uint8_t)fisbApduLayout::timeOption::Get(apduBuf);
+
+	switch (apdu.timeOption)
+	{
+	case 0:
+		headerLen = 4;
+		break;
+
+	case 1:
+	case 2:
+		headerLen = 5;
+		break;
+
+	default:
+		headerLen = 6;
+		break;
+	}
+
+	if (apduLen < headerLen)
+	{
+		return(status);
+	}
+
+	if (apdu.timeOption <= 1)
+	{
+		apdu.hours = (uint8_t)fisbApduLayout::hours::Get(apduBuf);
+		apdu.minutes = (uint8_t)fisbApduLayout::minutes::Get(apduBuf);
+
+		if (apdu.timeOption == 1)
+		{
+			apdu.seconds = (uint8_t)fisbApduLayout::seconds::Get(apduBuf);
+		}
+	}
+	else
+	{
+		apdu.month = (uint8_t)fisbApduLayout::dateMonth::Get(apduBuf);
+		apdu.day = (uint8_t)fisbApduLayout::dateDay::Get(apduBuf);
+		apdu.hours = (uint8_t)fisbApduLayout::dateHours::Get(apduBuf);
+		apdu.minutes = (uint8_t)fisbApduLayout::dateMinutes::Get(apduBuf);
+
+		if (apdu.timeOption == 3)
+		{
+			apdu.seconds = (uint8_t)fisbApduLayout::dateSeconds::Get(apduBuf);
+		}
+	}
+
+	apdu.data = &apduBuf[headerLen];
+	apdu.dataLen = (uint16_t)(apduLen - headerLen);
+
+	status = 0;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DLAC text into plain text, stops at the end of text character.  record
+// separators are kept for the caller to split on
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeDlacText(const unsigned char *dataBuf, unsigned int dataLen,
+	std::string &text)
+{
+	int status = -1;
+	bool inTab = false;
+
+	text.clear();
+
+	if (dataBuf == NULL)
+	{
+		return(status);
+	}
+
+	unsigned int numChars = (dataLen * 8) / 6;
+
+	for (unsigned int charIndex = 0; charIndex < numChars; charIndex++)
+	{
+		unsigned int bitOffset = charIndex * 6;
+		unsigned int byteOffset = bitOffset / 8;
+
+		// every character is inside the 2 bytes from where it starts
+
+		unsigned int dataWord = dataBuf[byteOffset] << 8;
+
+		if ((byteOffset + 1) < dataLen)
+		{
+			dataWord |= dataBuf[byteOffset + 1];
+		}
+
+		unsigned int dlacChar = (dataWord >> (10 - (bitOffset % 8))) & 0x3f;
+
+		if (inTab == true)
+		{
+			text.append(dlacChar, ' ');
+
+			inTab = false;
+		}
+		else if (dlac_alphabet[dlacChar] == '\t')
+		{
+			inTab = true;
+		}
+		else if (dlac_alphabet[dlacChar] == FISB_DLAC_END)
+		{
+			break;
+		}
+		else if (dlac_alphabet[dlacChar] != FISB_DLAC_IGNORED)
+		{
+			text.push_back(dlac_alphabet[dlacChar]);
+		}
+	}
+
+	status = 0;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a run length encoded NEXRAD block into FISB_NEXRAD_BINS intensities, 0 to
+// 7.  returns -1 for an empty block list or if the runs go past the end of
+// the block
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeNexradBlock(const struct fisbApduRec &apdu, std::vector<uint8_t> &bins,
+	unsigned int &blockNumber)
+{
+	int status = -1;
+
+	if ((apdu.data == NULL) || (apdu.dataLen < 3) ||
+		(fisbNexradLayout::runLength::Get(apdu.data) == 0))
+	{
+		return(status);
+	}
+
+	blockNumber = fisbNexradLayout::blockNumber::Get(apdu.data);
+
+	bins.assign(FISB_NEXRAD_BINS, 0);
+
+	unsigned int binIndex = 0;
+
+	status = 0;
+
+	for (unsigned int dataIndex = 3; dataIndex < apdu.dataLen; dataIndex++)
+	{
+		unsigned int runLength = (apdu.data[dataIndex] >> 3) + 1;
+		uint8_t intensity = apdu.data[dataIndex] & 0x07;
+
+		if ((binIndex + runLength) > FISB_NEXRAD_BINS)
+		{
+			status = -1;
+			break;
+		}
+
+		memset(&bins[binIndex], intensity, runLength);
+
+		binIndex += runLength;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the product name for a product id, "Unknown" for ids not in the table
+///////////////////////////////////////////////////////////////////////////////
+const char *FisbDecoder::GetProductName(int productId)
+{
+	std::map<int, std::string>::const_iterator nameIter = mProductNameMap.find(productId);
+
+	if (nameIter != mProductNameMap.end())
+	{
+		return(nameIter->second.c_str());
+	}
+	return("Unknown");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned long long FisbDecoder::HashApdu(const unsigned char *apduBuf, unsigned int apduLen)
+{
+	return(Fnv1aHash(apduBuf, apduLen));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+struct FisbDecoder::productCacheRec &FisbDecoder::GetCache(int productId)
+{
+	std::map<int, struct productCacheRec>::iterator cacheIter = mCaches.find(productId);
+
+	if (cacheIter == mCaches.end())
+	{
+		struct productCacheRec &cache = mCaches[productId];
+
+		cache.numProducts = 0;
+		cache.timeToLive = FISB_DEFAULT_TIME_TO_LIVE;
+
+		if ((productId == FISB_PRODUCT_NEXRAD_REGIONAL) || (productId == FISB_PRODUCT_NEXRAD_CONUS))
+		{
+			cache.timeToLive = FISB_NEXRAD_TIME_TO_LIVE;
+		}
+		return(cache);
+	}
+	return(cacheIter->second);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one product per report, keyed on the report type and location so a new
+// METAR for an airport replaces the last one.  an amended TAF replaces the
+// TAF.  PIREPs are keyed on their time as well since there can be several
+// for a location
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeTextProduct(struct productCacheRec &cache, const struct fisbApduRec &apdu,
+	unsigned long long apduHash, time_t now)
+{
+	int status = -1;
+	std::string text;
+	std::string key;
+
+	if (DecodeDlacText(apdu.data, apdu.dataLen, text) != 0)
+	{
+		return(status);
+	}
+
+	size_t recordStart = 0;
+
+	while (recordStart < text.size())
+	{
+		size_t recordEnd = text.find((char)FISB_DLAC_RECORD_SEPARATOR, recordStart);
+
+		if (recordEnd == std::string::npos)
+		{
+			recordEnd = text.size();
+		}
+
+		std::string record(text, recordStart, recordEnd - recordStart);
+
+		size_t lastChar = record.find_last_not_of(" \n");
+
+		record.erase((lastChar == std::string::npos) ? 0 : (lastChar + 1));
+
+		if (record.empty() == false)
+		{
+			GetLeadingWords(record, (record.compare(0, 6, "PIREP ") == 0) ? 3 : 2, key);
+
+			size_t typeEnd = key.find_first_of(". ");
+
+			if ((typeEnd != std::string::npos) && (key[typeEnd] == '.'))
+			{
+				key.erase(typeEnd, key.find(' ', typeEnd) - typeEnd);
+			}
+
+			struct fisbProductRec *productPtr = StoreProduct(cache, apdu, key,
+				fisbProductText, apduHash, now);
+
+			productPtr->text.swap(record);
+		}
+
+		recordStart = recordEnd + 1;
+	}
+
+	status = 0;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// each block is its own product, keyed on the hemisphere, block number and
+// scale.  an empty block list becomes a product of all zero bins for each
+// block in it so a block that cleared replaces what was there
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeNexradProduct(struct productCacheRec &cache, const struct fisbApduRec &apdu,
+	unsigned long long apduHash, time_t now)
+{
+	int status = -1;
+	std::vector<uint8_t> bins;
+	std::vector<unsigned int> blockNumbers;
+	unsigned int blockNumber;
+
+	if (apdu.dataLen < 4)
+	{
+		return(status);
+	}
+
+	if (fisbNexradLayout::runLength::Get(apdu.data) != 0)
+	{
+		if (DecodeNexradBlock(apdu, bins, blockNumber) != 0)
+		{
+			return(status);
+		}
+		blockNumbers.push_back(blockNumber);
+	}
+	else
+	{
+		// the bitmap counts from 3 blocks before the one in the header, its
+		// first byte shares the length's byte so only has the top 4 bits
+
+		blockNumber = fisbNexradLayout::blockNumber::Get(apdu.data);
+
+		unsigned int mapLength = fisbNexradLayout::emptyMapLength::Get(apdu.data);
+		unsigned int rowStart = blockNumber - (blockNumber % FISB_NEXRAD_BLOCKS_PER_ROW);
+		unsigned int rowBlock = blockNumber % FISB_NEXRAD_BLOCKS_PER_ROW;
+
+		if ((3 + mapLength) > apdu.dataLen)
+		{
+			return(status);
+		}
+
+		blockNumbers.push_back(blockNumber);
+
+		for (unsigned int mapIndex = 0; mapIndex < mapLength; mapIndex++)
+		{
+			unsigned int mapBits = (mapIndex == 0) ?
+				(fisbNexradLayout::emptyMapBits::Get(apdu.data) << 4) : apdu.data[3 + mapIndex];
+
+			for (unsigned int bitIndex = 0; bitIndex < 8; bitIndex++)
+			{
+				if ((mapBits & (1 << bitIndex)) != 0)
+				{
+					blockNumbers.push_back(rowStart + ((rowBlock + (mapIndex * 8) + bitIndex +
+						FISB_NEXRAD_BLOCKS_PER_ROW - 3) % FISB_NEXRAD_BLOCKS_PER_ROW));
+				}
+			}
+		}
+		bins.assign(FISB_NEXRAD_BINS, 0);
+	}
+
+	std::string key;
+
+	for (unsigned int index = 0; index < blockNumbers.size(); index++)
+	{
+		key.assign((fisbNexradLayout::southern::Get(apdu.data) != 0) ? "S" : "N");
+		key.append(std::to_string(blockNumbers[index]));
+		key.push_back('/');
+		key.append(std::to_string(fisbNexradLayout::scaleFactor::Get(apdu.data)));
+
+		struct fisbProductRec *productPtr = StoreProduct(cache, apdu, key,
+			fisbProductNexrad, apduHash, now);
+
+		productPtr->data = bins;
+	}
+
+	status = 0;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// products without a decoder are kept as they came, keyed on the APDU hash
+// so every different one is kept until it expires
+///////////////////////////////////////////////////////////////////////////////
+int FisbDecoder::DecodeOtherProduct(struct productCacheRec &cache, const struct fisbApduRec &apdu,
+	unsigned long long apduHash, time_t now)
+{
+	int status = -1;
+	char key[20];
+
+	snprintf(key, sizeof(key), "%016llx", apduHash);
+
+	struct fisbProductRec *productPtr = StoreProduct(cache, apdu, key, fisbProductOther,
+		apduHash, now);
+
+	productPtr->data.assign(apdu.data, apdu.data + apdu.dataLen);
+
+	status = 0;
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the product for key, replacing whatever had that key before.  the caller
+// fills in text or data
+///////////////////////////////////////////////////////////////////////////////
+struct fisbProductRec *FisbDecoder::StoreProduct(struct productCacheRec &cache,
+	const struct fisbApduRec &apdu, const std::string &key, unsigned char kind,
+	unsigned long long apduHash, time_t now)
+{
+	unsigned long long productKey = MakeProductKey(key);
+	int productIndex = cache.keyIndex.Find(productKey);
+
+	if ((productIndex >= 0) && (cache.products[productIndex].key != key))
+	{
+		// two keys with the same hash, the older product keeps its place
+		// until it expires but can't be found by key any more
+
+		productIndex = -1;
+	}
+
+	if (productIndex < 0)
+	{
+		if (cache.freeList.empty() == false)
+		{
+			productIndex = cache.freeList.back();
+			cache.freeList.pop_back();
+		}
+		else
+		{
+			productIndex = (int)cache.products.size();
+			cache.products.push_back(fisbProductRec());
+		}
+
+		cache.products[productIndex].key = key;
+		cache.products[productIndex].firstReceived = now;
+
+		cache.keyIndex.Insert(productKey, productIndex);
+
+		cache.numProducts++;
+	}
+
+	struct fisbProductRec &product = cache.products[productIndex];
+
+	product.productId = apdu.productId;
+	product.kind = kind;
+	product.month = apdu.month;
+	product.day = apdu.day;
+	product.hours = apdu.hours;
+	product.minutes = apdu.minutes;
+	product.seconds = apdu.seconds;
+
+	product.text.clear();
+	product.data.clear();
+
+	product.apduHash = apduHash;
+	product.changeVersion = ++mChangeVersion;
+	product.lastReceived = now;
+
+	return(&product);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the place goes on the free list, an empty key marks it unused
+///////////////////////////////////////////////////////////////////////////////
+void FisbDecoder::RemoveProduct(struct productCacheRec &cache, int productIndex)
+{
+	struct fisbProductRec &product = cache.products[productIndex];
+	unsigned long long productKey = MakeProductKey(product.key);
+
+	if (cache.keyIndex.Find(productKey) == productIndex)
+	{
+		cache.keyIndex.Remove(productKey);
+	}
+
+	product.key.clear();
+	product.text.clear();
+	product.data.clear();
+
+	cache.freeList.push_back(productIndex);
+	cache.numProducts--;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a product was last heard when the APDU it came from was
+///////////////////////////////////////////////////////////////////////////////
+void FisbDecoder::RefreshProduct(struct productCacheRec &cache, struct fisbProductRec &product)
+{
+	int seenIndex = cache.hashIndex.Find(product.apduHash);
+
+	if ((seenIndex >= 0) && (cache.seen[seenIndex].lastReceived > product.lastReceived))
+	{
+		product.lastReceived = cache.seen[seenIndex].lastReceived;
+	}
+}
@@ -0,0 +1,208 @@
+//
+// FisbDecoder.h: FIS-B product decoding and caches
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _FISB_DECODER_H_
+#define _FISB_DECODER_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TrafficIndex.h"
+#include "UplinkData.h"
+
+// FIS-B products the decoders know, everything else is kept as it came
+
+#define FISB_PRODUCT_NEXRAD_REGIONAL 63
+#define FISB_PRODUCT_NEXRAD_CONUS 64
+#define FISB_PRODUCT_TEXT 413
+
+#define FISB_NEXRAD_BINS 128
+
+// how long a product is kept after it was last broadcast.  ground stations
+// repeat text products every few minutes and NEXRAD every couple of minutes
+
+#define FISB_DEFAULT_TIME_TO_LIVE 3600
+#define FISB_NEXRAD_TIME_TO_LIVE 900
+
+enum fisbProductKinds
+{
+	fisbProductText,
+	fisbProductNexrad,
+	fisbProductOther,
+	numFisbProductKinds
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// the header of one APDU, data points into the information frame it was
+// decoded from.  month and day are 0 unless the time option carries them,
+// seconds is 0 unless it carries those
+///////////////////////////////////////////////////////////////////////////////
+struct fisbApduRec
+{
+	uint16_t productId;
+	uint8_t aFlag;
+	uint8_t gFlag;
+	uint8_t pFlag;
+	uint8_t sFlag;
+	uint8_t timeOption;
+	uint8_t month;
+	uint8_t day;
+	uint8_t hours;
+	uint8_t minutes;
+	uint8_t seconds;
+	uint16_t dataLen;
+	const unsigned char *data;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// one cached product.  key tells products of the same id apart, the report
+// type and location for text ("METAR KSEA") and the block for NEXRAD.
+// text products keep their text, NEXRAD blocks their bins and anything
+// else the APDU data as it came
+///////////////////////////////////////////////////////////////////////////////
+struct fisbProductRec
+{
+	uint16_t productId;
+	uint8_t kind;            // fisbProductKinds
+	uint8_t month;           // product time from the APDU header
+	uint8_t day;
+	uint8_t hours;
+	uint8_t minutes;
+	uint8_t seconds;
+
+	std::string key;
+	std::string text;
+	std::vector<uint8_t> data;
+
+	unsigned long long apduHash;
+	unsigned long long changeVersion;
+
+	time_t firstReceived;
+	time_t lastReceived;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// FisbDecoder turns the APDUs in decoded uplinks into FIS-B products.  each
+// product id has a cache of its own holding the latest product for each key.
+//
+// ground stations rebroadcast every product many times, so before anything
+// is decoded the APDU is hashed (FNV-1a) and looked up in the hashes of the
+// APDUs the product id has already had.  a repeat only notes when it was
+// heard, only an APDU that hasn't been seen is decoded.  a product lives as
+// long as the APDU it came from keeps being heard, an older APDU still
+// being repeated never overwrites a newer product with the same key.
+//
+// products go through a switch on the product id: 413 is DLAC text split
+// into one product per report, 63 and 64 are NEXRAD global blocks with the
+// run length encoding undone, anything else is kept as it came.  segmented
+// APDUs aren't put back together and are only counted.
+//
+// call Decode with the uplinks from AdsbWrapper or UplinkDecoder::Poll and
+// read the caches from the same thread.  changeVersion works like it does
+// for the traffic table, pass the last value back to GetProducts to get
+// only what changed since
+///////////////////////////////////////////////////////////////////////////////
+class FisbDecoder
+{
+public:
+	FisbDecoder();
+
+	int Decode(const struct uplinkDataRec &uplinkData, time_t now);
+	int DecodeApdu(const unsigned char *apduBuf, unsigned int apduLen, time_t now);
+
+	int ExpireProducts(time_t now);
+	void Clear();
+
+	void SetTimeToLive(int productId, unsigned int seconds);
+	unsigned int GetTimeToLive(int productId);
+
+	int GetProductIds(std::vector<int> &productIds);
+	int GetProducts(int productId, std::vector<struct fisbProductRec> &products,
+		unsigned long long *changeVersion = NULL);
+	int FindProduct(int productId, const std::string &key, struct fisbProductRec &product);
+
+	unsigned int GetNumProducts();
+	unsigned int GetNumApdus();
+	unsigned int GetNumDuplicates();
+	unsigned int GetNumSegmented();
+	unsigned int GetNumErrors();
+
+	static int DecodeApduHeader(const unsigned char *apduBuf, unsigned int apduLen,
+		struct fisbApduRec &apdu);
+	static int DecodeDlacText(const unsigned char *dataBuf, unsigned int dataLen,
+		std::string &text);
+	static int DecodeNexradBlock(const struct fisbApduRec &apdu, std::vector<uint8_t> &bins,
+		unsigned int &blockNumber);
+
+	static const char *GetProductName(int productId);
+	static unsigned long long HashApdu(const unsigned char *apduBuf, unsigned int apduLen);
+
+private:
+	struct apduSeenRec
+	{
+		unsigned long long apduHash;
+		time_t lastReceived;
+	};
+
+	// one per product id, products are found by key and APDUs by their
+	// hash.  removed entries leave their place on a free list so the
+	// indexes never need renumbering
+
+	struct productCacheRec
+	{
+		std::vector<struct fisbProductRec> products;
+		std::vector<int> freeList;
+		TrafficIndex keyIndex;
+
+		std::vector<struct apduSeenRec> seen;
+		std::vector<int> seenFreeList;
+		TrafficIndex hashIndex;
+
+		unsigned int numProducts;
+		unsigned int timeToLive;
+	};
+
+	struct productCacheRec &GetCache(int productId);
+
+	int DecodeTextProduct(struct productCacheRec &cache, const struct fisbApduRec &apdu,
+		unsigned long long apduHash, time_t now);
+	int DecodeNexradProduct(struct productCacheRec &cache, const struct fisbApduRec &apdu,
+		unsigned long long apduHash, time_t now);
+	int DecodeOtherProduct(struct productCacheRec &cache, const struct fisbApduRec &apdu,
+		unsigned long long apduHash, time_t now);
+
+	struct fisbProductRec *StoreProduct(struct productCacheRec &cache,
+		const struct fisbApduRec &apdu, const std::string &key, unsigned char kind,
+		unsigned long long apduHash, time_t now);
+	void RemoveProduct(struct productCacheRec &cache, int productIndex);
+	void RefreshProduct(struct productCacheRec &cache, struct fisbProductRec &product);
+
+	static std::map<int, std::string> mProductNameMap;
+
+	std::map<int, struct productCacheRec> mCaches;
+
+	unsigned long long mChangeVersion;
+
+	unsigned int mNumApdus;
+	unsigned int mNumDuplicates;
+	unsigned int mNumSegmented;
+	unsigned int mNumErrors;
+};
+
+#endif // _FISB_DECODER_H_
@@ -0,0 +1,208 @@
+//
+// Gdl90Crc.cpp: GDL90 frame check sequence and length checks
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include "Gdl90Crc.h"
+#include "Gdl90Defs.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// slicing-by-8 tables, table[0] is the usual byte at a time table and
+// table[n] advances a byte through n more zero bytes so eight message bytes
+// can be folded in with eight independent lookups
+///////////////////////////////////////////////////////////////////////////////
+struct crcSliceTableRec
+{
+	unsigned short table[8][256];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static constexpr struct crcSliceTableRec MakeCrcSliceTable()
+{
+	struct crcSliceTableRec crcTable = {};
+
+	for (unsigned int index = 0; index < 256; index++)
+	{
+		unsigned short crc = (unsigned short)(index << 8);
+
+		for (int bitCtr = 0; bitCtr < 8; bitCtr++)
+		{
+			crc = (unsigned short)((crc << 1) ^ ((crc & 0x8000) ? GDL90_CRC_POLY : 0));
+		}
+		crcTable.table[0][index] = crc;
+	}
+
+	for (int slice = 1; slice < 8; slice++)
+	{
+		for (unsigned int index = 0; index < 256; index++)
+		{
+			unsigned short prevCrc = crcTable.table[slice - 1][index];
+
+			crcTable.table[slice][index] = (unsigned short)((prevCrc << 8) ^
+				crcTable.table[0][prevCrc >> 8]);
+		}
+	}
+
+	return(crcTable);
+}
+
+static constexpr struct crcSliceTableRec sCrcTable = MakeCrcSliceTable();
+
+static_assert(sCrcTable.table[0][1] == GDL90_CRC_POLY, "crc table generation");
+static_assert(sCrcTable.table[0][255] == 0x1EF0, "crc table generation");
+
+///////////////////////////////////////////////////////////////////////////////
+// the ICD computes crc = table[crc >> 8] ^ (crc << 8) ^ byte, which leaves
+// the message polynomial mod the generator.  that is the usual shift in crc
+// of everything but the last two bytes with those two bytes xor'ed on, which
+// lets the bulk of the message go through the sliced tables
+///////////////////////////////////////////////////////////////////////////////
+unsigned short Gdl90CrcCompute(const unsigned char *block, unsigned int length)
+{
+	unsigned short crc = 0;
+
+	if ((block == 0) || (length == 0))
+	{
+		return(0);
+	}
+
+	if (length < 2)
+	{
+		return(block[0]);
+	}
+
+	unsigned int bodyLen = length - 2;
+
+	while (bodyLen >= 8)
+	{
+		crc ^= (unsigned short)((block[0] << 8) | block[1]);
+
+		crc = sCrcTable.table[7][crc >> 8] ^ sCrcTable.table[6][crc & 0xFF] ^
+			sCrcTable.table[5][block[2]] ^ sCrcTable.table[4][block[3]] ^
+			sCrcTable.table[3][block[4]] ^ sCrcTable.table[2][block[5]] ^
+			sCrcTable.table[1][block[6]] ^ sCrcTable.table[0][block[7]];
+
+		block += 8;
+		bodyLen -= 8;
+	}
+
+	while (bodyLen > 0)
+	{
+		crc = (unsigned short)((crc << 8) ^ sCrcTable.table[0][(crc >> 8) ^ *block]);
+
+		block++;
+		bodyLen--;
+	}
+
+	return((unsigned short)(crc ^ ((block[0] << 8) | block[1])));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90CrcCheck(const unsigned char *frameBuf, unsigned int frameSize)
+{
+	int status = -1;
+
+	if ((frameBuf != 0) && (frameSize >= GDL90_MIN_FRAME_SIZE))
+	{
+		unsigned short msgCrc = (unsigned short)(frameBuf[frameSize - 3] +
+			(frameBuf[frameSize - 2] << 8));
+
+		if (Gdl90CrcCompute(&frameBuf[1], frameSize - 4) == msgCrc)
+		{
+			status = 0;
+		}
+	}
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90MinFrameSize(unsigned char msgId)
+{
+	unsigned int msgLength = 1;
+
+	switch (msgId)
+	{
+	case GDL90_ID_HEARTBEAT:
+		msgLength = GDL90_ID_HEARTBEAT_LENGTH;
+		break;
+
+	case GDL90_ID_INIT:
+		msgLength = GDL90_ID_INIT_LENGTH;
+		break;
+
+	case GDL90_ID_UPLINK_DATA:
+		msgLength = GDL90_ID_UPLINK_DATA_LENGTH;
+		break;
+
+	case GDL90_ID_HEIGHT_AGL:
+		msgLength = GDL90_ID_HEIGHT_AGL_LENGTH;
+		break;
+
+	case GDL90_ID_OWNSHIP:
+		msgLength = GDL90_ID_OWNSHIP_LENGTH;
+		break;
+
+	case GDL90_ID_OWNSHIP_ALTITUDE:
+		msgLength = GDL90_ID_OWNSHIP_ALTITUDE_LENGTH;
+		break;
+
+	case GDL90_ID_TRAFFIC:
+		msgLength = GDL90_ID_TRAFFIC_LENGTH;
+		break;
+
+	case GDL90_ID_BASIC_REPORT:
+		msgLength = GDL90_ID_BASIC_REPORT_LENGTH;
+		break;
+
+	case GDL90_ID_LONG_REPORT:
+		msgLength = GDL90_ID_LONG_REPORT_LENGTH;
+		break;
+
+	case GDL90_ID_STRATUX_HEARTBEAT0:
+		msgLength = GDL90_ID_STRATUX_HEARTBEAT_LENGTH;
+		break;
+
+	case GDL90_ID_STRATUX_AHRS:
+		msgLength = GDL90_ID_STRATUX_AHRS_LENGTH;
+		break;
+
+	case 0x53:  // stratux status message
+		msgLength = GDL90_ID_STRATUX_STATUS_LENGTH;
+		break;
+
+	case FOREFRONT_AHRS:
+		msgLength = GDL90_ID_FOREFRONT_LENGTH;
+		break;
+
+	default:
+		break;
+	}
+
+	return(msgLength + GDL90_FRAME_OVERHEAD);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90LengthCheck(const unsigned char *frameBuf, unsigned int frameSize)
+{
+	int status = -1;
+
+	if ((frameBuf != 0) && (frameSize >= GDL90_MIN_FRAME_SIZE) &&
+		(frameSize >= Gdl90MinFrameSize(frameBuf[1])))
+	{
+		status = 0;
+	}
+
+	return(status);
+}
@@ -0,0 +1,49 @@
+//
+// Gdl90Crc.h: GDL90 frame check sequence and length checks
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _GDL90_CRC_H_
+#define _GDL90_CRC_H_
+
+// CRC-16-CCITT, polynomial x^16 + x^12 + x^5 + 1, as given in the GDL90 ICD
+
+#define GDL90_CRC_POLY 0x1021
+
+// smallest frame that can carry a message, the flag byte positions, the
+// message id and the two crc bytes
+
+#define GDL90_MIN_FRAME_SIZE 5
+
+// computes the crc over block the same way the ICD sample code does
+
+unsigned short Gdl90CrcCompute(const unsigned char *block, unsigned int length);
+
+// checks the crc of an unstuffed frame laid out the way DecodeFrame expects,
+// frameBuf[1] holds the message id and the crc is sent lsb first in front of
+// the closing flag position.  returns 0 if the crc matches
+
+int Gdl90CrcCheck(const unsigned char *frameBuf, unsigned int frameSize);
+
+// smallest unstuffed frame, flag positions and crc included, that carries
+// every field the decoders read for msgId
+
+unsigned int Gdl90MinFrameSize(unsigned char msgId);
+
+// returns 0 if the frame is long enough for its message id, the crc check
+// passing says nothing about a frame that was cut short before it was sent
+
+int Gdl90LengthCheck(const unsigned char *frameBuf, unsigned int frameSize);
+
+#endif // _GDL90_CRC_H_
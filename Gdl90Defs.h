@@ -0,0 +1,93 @@
+//
+// Gdl90Defs.h: GDL90 message identifiers and sizes
+//
+// Copyright (c) 2019 Bruce Clay
+
+// Portions of thei code was adapted from dump1090 and dump978
+// Copyright (c) 2017 Oliver Jowett <oliver@mutability.co.uk>
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _GDL90_DEFS_H_
+#define _GDL90_DEFS_H_
+
+#define GDL90_FLAGBYTE 0x7E
+#define GDL90_ESCAPEBYTE 0x7D
+
+#define GDL90_ID_HEARTBEAT 0x00
+#define GDL90_ID_HEARTBEAT_SIZE 0x09
+
+#define GDL90_ID_INIT 0x02
+#define GDL90_ID_INIT_SIZE 0x03
+
+#define GDL90_ID_UPLINK_DATA 0x07
+#define GDL90_ID_UPLINK_DATA_SIZE 0x01B6 /* 438 bytes */
+
+#define GDL90_ID_HEIGHT_AGL 0x09
+
+#define GDL90_ID_OWNSHIP 0x0A  // decimal 10
+#define GDL90_ID_OWNSHIP_SIZE 0x1E /* 30 bytes */  // spec states 28 bytes
+
+#define GDL90_ID_OWNSHIP_ALTITUDE 0x0B  // decimal 11
+
+#define GDL90_ID_BASIC_REPORT 0x1E // Basic UAT report
+#define GDL90_ID_LONG_REPORT 0x1F // Long report
+
+// a UAT report is the 3 byte time of reception and the payload, basic
+// payloads carry the state vector, long ones add mode status and the
+// auxiliary state vector
+
+#define GDL90_UAT_BASIC_PAYLOAD_SIZE 18
+#define GDL90_UAT_LONG_PAYLOAD_SIZE 34
+
+#define GDL90_ID_TRAFFIC 0x14  // decimal 20
+#define GDL90_ID_TRAFFIC_SIZE 0x1E /* 30 bytes */ // spec states 28 bytes
+
+#define GDL90_ID_BASIC_REPORT 0x1E
+#define GDL90_ID_LONG_REPORT 0x1F
+
+#define GDL90_ID_STRATUX_HEARTBEAT0 0xCC
+#define GDL90_ID_STRATUX_HEARTBEAT1 0x5358
+
+#define GDL90_ID_STRATUX_AHRS 0x4C
+#define GDL90_ID_STRATUX_AHRS_SIZE 0x1A /* 26 bytes */
+
+#define GDL90_ID_GPS_TIME 0x65 // 101 decimal
+#define FOREFRONT_AHRS 0x65 // 101 decimal
+
+// message lengths from the ICD counting the message id but not the crc,
+// the vendor messages are as long as the fields we read out of them
+
+#define GDL90_ID_HEARTBEAT_LENGTH 7
+#define GDL90_ID_INIT_LENGTH 3
+#define GDL90_ID_UPLINK_DATA_LENGTH 436
+#define GDL90_ID_HEIGHT_AGL_LENGTH 3
+#define GDL90_ID_OWNSHIP_LENGTH 28
+#define GDL90_ID_OWNSHIP_ALTITUDE_LENGTH 5
+#define GDL90_ID_TRAFFIC_LENGTH 28
+#define GDL90_ID_BASIC_REPORT_LENGTH (1 + 3 + GDL90_UAT_BASIC_PAYLOAD_SIZE)
+#define GDL90_ID_LONG_REPORT_LENGTH (1 + 3 + GDL90_UAT_LONG_PAYLOAD_SIZE)
+#define GDL90_ID_STRATUX_HEARTBEAT_LENGTH 3
+#define GDL90_ID_STRATUX_AHRS_LENGTH 24
+#define GDL90_ID_STRATUX_STATUS_LENGTH 29
+#define GDL90_ID_FOREFRONT_LENGTH 12
+
+// an unstuffed frame adds the two flag byte positions and the two crc bytes
+
+#define GDL90_FRAME_OVERHEAD 4
+
+// largest frame we will accept after the flag bytes have been stripped and
+// the control-escapes removed, uplink is the largest message at 438 bytes
+
+#define GDL90_MAX_FRAME_SIZE 0x0200 /* 512 bytes */
+
+#endif // _GDL90_DEFS_H_
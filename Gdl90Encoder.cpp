@@ -0,0 +1,235 @@
+//
+// Gdl90Encoder.cpp: builds GDL90 frames for re-broadcast
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include <math.h>
+
+#include "Gdl90Crc.h"
+#include "Gdl90Encoder.h"
+
+// 24 bit two's complement fractions of 180 degrees
+
+#define GDL90_ENCODER_LAT_LON_SCALE (8388608.0 / 180.0)
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> static T Clamp(T value, T minValue, T maxValue)
+{
+	return((value < minValue) ? minValue : ((value > maxValue) ? maxValue : value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void PutLatLon(unsigned char *msgBuf, double location)
+{
+	long rawLocation = lround(location * GDL90_ENCODER_LAT_LON_SCALE);
+
+	rawLocation = Clamp(rawLocation, -0x800000L, 0x7fffffL);
+
+	msgBuf[0] = (unsigned char)(rawLocation >> 16);
+	msgBuf[1] = (unsigned char)(rawLocation >> 8);
+	msgBuf[2] = (unsigned char)rawLocation;
+}
+
+Gdl90Encoder::Gdl90Encoder()
+{
+	mDataBuf = NULL;
+	mBufSize = 0;
+	mSize = 0;
+
+	mNumFrames = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Gdl90Encoder::SetBuffer(unsigned char *dataBuf, unsigned int bufSize)
+{
+	mDataBuf = dataBuf;
+	mBufSize = (dataBuf != NULL) ? bufSize : 0;
+	mSize = 0;
+
+	mNumFrames = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90Encoder::AddHeartbeat(const struct heartbeatRecordRec &heartbeat)
+{
+	unsigned char msgBuf[GDL90_ENCODER_HEARTBEAT_SIZE];
+
+	EncodeHeartbeat(heartbeat, msgBuf);
+
+	return(AddMessage(msgBuf, sizeof(msgBuf)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90Encoder::AddOwnship(const struct trafficReportRec &report)
+{
+	unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+
+	EncodeReport(GDL90_ID_OWNSHIP, report, msgBuf);
+
+	return(AddMessage(msgBuf, sizeof(msgBuf)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90Encoder::AddTraffic(const struct trafficReportRec &report)
+{
+	unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+
+	EncodeReport(GDL90_ID_TRAFFIC, report, msgBuf);
+
+	return(AddMessage(msgBuf, sizeof(msgBuf)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bytes of whole frames in the buffer
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Encoder::GetSize()
+{
+	return(mSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Encoder::GetNumFrames()
+{
+	return(mNumFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the 7 byte heartbeat message, timestamp bit 16 goes in the top bit of
+// status byte 2
+///////////////////////////////////////////////////////////////////////////////
+void Gdl90Encoder::EncodeHeartbeat(const struct heartbeatRecordRec &heartbeat,
+	unsigned char *msgBuf)
+{
+	msgBuf[0] = GDL90_ID_HEARTBEAT;
+	msgBuf[1] = heartbeat.statusByte1;
+	msgBuf[2] = (unsigned char)((heartbeat.statusByte2 & 0x7f) |
+		((heartbeat.timestamp >> 9) & 0x80));
+	msgBuf[3] = (unsigned char)heartbeat.timestamp;
+	msgBuf[4] = (unsigned char)(heartbeat.timestamp >> 8);
+	msgBuf[5] = (unsigned char)(heartbeat.msgCounts >> 8);
+	msgBuf[6] = (unsigned char)heartbeat.msgCounts;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the 28 byte ownship or traffic report, the reverse of
+// AdsbWrapper::DecodeTrafficReport
+///////////////////////////////////////////////////////////////////////////////
+void Gdl90Encoder::EncodeReport(unsigned char msgId, const struct trafficReportRec &report,
+	unsigned char *msgBuf)
+{
+	msgBuf[0] = msgId;
+	msgBuf[1] = (unsigned char)(((report.alertStatus & 0xf) << 4) | (report.addressType & 0xf));
+	msgBuf[2] = (unsigned char)(report.participantAddr >> 16);
+	msgBuf[3] = (unsigned char)(report.participantAddr >> 8);
+	msgBuf[4] = (unsigned char)report.participantAddr;
+
+	PutLatLon(&msgBuf[5], report.latitude);
+	PutLatLon(&msgBuf[8], report.longitude);
+
+	// 25 foot steps from -1000.  0xfff means no altitude, the decoder turns
+	// it into 101375 ft so that goes back out as 0xfff
+
+	int rawAltitude = Clamp((report.altitude + 1000 + 12) / 25, 0, 0xfff);
+
+	msgBuf[11] = (unsigned char)(rawAltitude >> 4);
+	msgBuf[12] = (unsigned char)(((rawAltitude & 0xf) << 4) | (report.miscIndicators & 0xf));
+	msgBuf[13] = (unsigned char)(((report.integrityCode & 0xf) << 4) | (report.accuracyCode & 0xf));
+
+	// knots, 0xffe is 4094 or more and 0xfff no velocity.  the decoder turns
+	// them into 4095 and 4094, send those back as the codes they came from.
+	// vertical is 12 bit two's complement in 64 fpm steps, 0x1fe and 0xe02
+	// are off the scale
+
+	int rawHorzVelocity = Clamp(report.horzVelocity, 0, 0xffd);
+
+	if (report.horzVelocity == 4094)
+	{
+		rawHorzVelocity = 0xfff;
+	}
+	else if (report.horzVelocity >= 4095)
+	{
+		rawHorzVelocity = 0xffe;
+	}
+	int vertSteps = (int)lround(report.vertVelocity / 64.0);
+	int rawVertVelocity = Clamp(vertSteps, -0x1fe, 0x1fe) & 0xfff;
+
+	msgBuf[14] = (unsigned char)(rawHorzVelocity >> 4);
+	msgBuf[15] = (unsigned char)(((rawHorzVelocity & 0xf) << 4) | (rawVertVelocity >> 8));
+	msgBuf[16] = (unsigned char)rawVertVelocity;
+
+	double trackHeading = fmod((double)report.trackHeading, 360.0);
+
+	if (trackHeading < 0.0)
+	{
+		trackHeading += 360.0;
+	}
+
+	msgBuf[17] = (unsigned char)(lround(trackHeading * 256.0 / 360.0) & 0xff);
+	msgBuf[18] = report.emitterCategory;
+
+	// the callsign goes out space padded
+
+	for (int index = 0; index < TRAFFIC_REPORT_CALLSIGN_SIZE; index++)
+	{
+		msgBuf[19 + index] = (index < (int)TrafficReportCallsignLength(report)) ?
+			(unsigned char)report.callsign[index] : ' ';
+	}
+
+	msgBuf[27] = (unsigned char)((report.emergencyPriorityCode & 0xf) << 4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frame msgBuf into frameBuf: flag, the message and its crc lsb first with
+// flag and escape bytes escaped, flag.  frameBuf needs
+// GDL90_ENCODER_MAX_FRAME_SIZE(msgSize), returns the frame length
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Encoder::StuffFrame(const unsigned char *msgBuf, unsigned int msgSize,
+	unsigned char *frameBuf)
+{
+	unsigned short crc = Gdl90CrcCompute(msgBuf, msgSize);
+	unsigned char crcBuf[2] = { (unsigned char)crc, (unsigned char)(crc >> 8) };
+	unsigned int frameLen = 0;
+
+	frameBuf[frameLen++] = GDL90_FLAGBYTE;
+
+	for (unsigned int index = 0; index < (msgSize + 2); index++)
+	{
+		unsigned char dataByte = (index < msgSize) ? msgBuf[index] : crcBuf[index - msgSize];
+
+		if ((dataByte == GDL90_FLAGBYTE) || (dataByte == GDL90_ESCAPEBYTE))
+		{
+			frameBuf[frameLen++] = GDL90_ESCAPEBYTE;
+			dataByte ^= 0x20;
+		}
+		frameBuf[frameLen++] = dataByte;
+	}
+
+	frameBuf[frameLen++] = GDL90_FLAGBYTE;
+
+	return(frameLen);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90Encoder::AddMessage(const unsigned char *msgBuf, unsigned int msgSize)
+{
+	if (GDL90_ENCODER_MAX_FRAME_SIZE(msgSize) > (mBufSize - mSize))
+	{
+		return(-1);
+	}
+
+	mSize += StuffFrame(msgBuf, msgSize, &mDataBuf[mSize]);
+	mNumFrames++;
+
+	return(0);
+}
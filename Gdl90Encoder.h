@@ -0,0 +1,79 @@
+//
+// Gdl90Encoder.h: builds GDL90 frames for re-broadcast
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _GDL90_ENCODER_H_
+#define _GDL90_ENCODER_H_
+
+#include "Gdl90Defs.h"
+#include "TrafficRecord.h"
+#include "TrafficReport.h"
+
+// an ownship or traffic report is 28 bytes with the message id, heartbeat
+// is 7, each frame adds the crc and two flag bytes and stuffing can double
+// everything between the flags
+
+#define GDL90_ENCODER_REPORT_SIZE 28
+#define GDL90_ENCODER_HEARTBEAT_SIZE 7
+#define GDL90_ENCODER_MAX_FRAME_SIZE(msgSize) ((2 * ((msgSize) + 2)) + 2)
+
+///////////////////////////////////////////////////////////////////////////////
+// Gdl90Encoder is the other half of the decoder, it turns heartbeats and
+// ownship and traffic reports back into complete GDL90 frames, flag bytes,
+// 0x7D control-escapes and crc included.
+//
+// frames go one after the other into a buffer the caller owns so a whole
+// burst, a heartbeat, the ownship report and every target, can be built in
+// one pass and handed to the socket in one send.  a frame is only started
+// when there is room for it however badly it stuffs, so the buffer never
+// holds part of a frame and an Add that doesn't fit returns -1.
+//
+// values outside what a field can carry are clamped to the nearest thing it
+// can say.  the no altitude and no velocity values the decoder produces go
+// back out as the codes they were decoded from, unknown track isn't
+// representable in trafficReportRec so it is never sent
+///////////////////////////////////////////////////////////////////////////////
+class Gdl90Encoder
+{
+public:
+	Gdl90Encoder();
+
+	void SetBuffer(unsigned char *dataBuf, unsigned int bufSize);
+
+	int AddHeartbeat(const struct heartbeatRecordRec &heartbeat);
+	int AddOwnship(const struct trafficReportRec &report);
+	int AddTraffic(const struct trafficReportRec &report);
+
+	unsigned int GetSize();
+	unsigned int GetNumFrames();
+
+	static void EncodeHeartbeat(const struct heartbeatRecordRec &heartbeat,
+		unsigned char *msgBuf);
+	static void EncodeReport(unsigned char msgId, const struct trafficReportRec &report,
+		unsigned char *msgBuf);
+	static unsigned int StuffFrame(const unsigned char *msgBuf, unsigned int msgSize,
+		unsigned char *frameBuf);
+
+private:
+	int AddMessage(const unsigned char *msgBuf, unsigned int msgSize);
+
+	unsigned char *mDataBuf;
+	unsigned int mBufSize;
+	unsigned int mSize;
+
+	unsigned int mNumFrames;
+};
+
+#endif // _GDL90_ENCODER_H_
@@ -0,0 +1,411 @@
+//
+// Gdl90Fields.h: compile time bit field layouts for GDL90 and UAT messages
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _GDL90_FIELDS_H_
+#define _GDL90_FIELDS_H_
+
+#include <stdint.h>
+#include <ratio>
+#include <type_traits>
+
+///////////////////////////////////////////////////////////////////////////////
+// Gdl90Field describes one field of a message layout the way the GDL90 ICD
+// and DO-282B tables do: where it starts counting bits from the most
+// significant bit of the first byte, how wide it is, whether it is two's
+// complement and what one count is worth.
+//
+// all of it is a compile time constant so Get is the few bytes the field
+// spans loaded big endian and one constant shift and mask, with no branches
+// or table lookups.  Get is constexpr as well, which lets the layouts below
+// be checked against the example messages in the specs with static_assert.
+//
+// Gdl90FieldsFit checks that the fields of a layout don't overlap and stay
+// inside the message
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned int NumBytes> constexpr uint64_t Gdl90LoadBits(const unsigned char *dataBuf)
+{
+	// spelled out rather than a loop so it is straight line code at any
+	// optimization level
+
+	if constexpr (NumBytes == 0)
+	{
+		return(0);
+	}
+	else
+	{
+		return((Gdl90LoadBits<NumBytes - 1>(dataBuf) << 8) | dataBuf[NumBytes - 1]);
+	}
+}
+
+template <unsigned int BitOffset, unsigned int Width, bool IsSigned = false,
+	typename Scale = std::ratio<1> >
+struct Gdl90Field
+{
+	static_assert((Width > 0) && (Width <= 32), "a field is 1 to 32 bits wide");
+	static_assert((IsSigned == false) || (Width > 1), "a signed field needs a sign and a value");
+
+	static constexpr unsigned int bitOffset = BitOffset;
+	static constexpr unsigned int width = Width;
+	static constexpr bool isSigned = IsSigned;
+	static constexpr double scale = (double)Scale::num / (double)Scale::den;
+
+	// at most 5 bytes for a 32 bit field that doesn't start on a byte
+
+	static constexpr unsigned int byteOffset = BitOffset / 8;
+	static constexpr unsigned int numBytes = ((BitOffset % 8) + Width + 7) / 8;
+	static constexpr unsigned int shift = (numBytes * 8) - (BitOffset % 8) - Width;
+	static constexpr uint64_t mask = (1ull << Width) - 1;
+
+	typedef typename std::conditional<IsSigned, int32_t, uint32_t>::type valueType;
+
+	static constexpr valueType Get(const unsigned char *msgBuf)
+	{
+		uint64_t rawValue = (Gdl90LoadBits<numBytes>(&msgBuf[byteOffset]) >> shift) & mask;
+
+		if ((IsSigned == true) && ((rawValue >> (Width - 1)) != 0))
+		{
+			return((valueType)((int64_t)rawValue - (int64_t)(mask + 1)));
+		}
+		return((valueType)rawValue);
+	}
+
+	static constexpr double GetValue(const unsigned char *msgBuf)
+	{
+		return((double)Get(msgBuf) * scale);
+	}
+};
+
+template <typename... Fields> constexpr bool Gdl90FieldsFit(unsigned int msgBits)
+{
+	const unsigned int firstBit[] = { Fields::bitOffset... };
+	const unsigned int endBit[] = { (Fields::bitOffset + Fields::width)... };
+	const unsigned int numFields = sizeof...(Fields);
+
+	for (unsigned int index = 0; index < numFields; index++)
+	{
+		if (endBit[index] > msgBits)
+		{
+			return(false);
+		}
+
+		for (unsigned int other = index + 1; other < numFields; other++)
+		{
+			if ((firstBit[index] < endBit[other]) && (firstBit[other] < endBit[index]))
+			{
+				return(false);
+			}
+		}
+	}
+	return(true);
+}
+
+// latitude and longitude counts, 180 / 2^23 degrees
+
+typedef std::ratio<180, 8388608> gdl90LatLongScale;
+
+///////////////////////////////////////////////////////////////////////////////
+// GDL90 traffic and ownship report, ICD section 3.5.1, from the message id.
+// the callsign is 8 plain characters at byte 19
+///////////////////////////////////////////////////////////////////////////////
+struct gdl90TrafficLayout
+{
+	typedef Gdl90Field<0, 8> messageId;
+	typedef Gdl90Field<8, 4> alertStatus;
+	typedef Gdl90Field<12, 4> addressType;
+	typedef Gdl90Field<16, 24> participantAddr;
+	typedef Gdl90Field<40, 24, true, gdl90LatLongScale> latitude;
+	typedef Gdl90Field<64, 24, true, gdl90LatLongScale> longitude;
+	typedef Gdl90Field<88, 12> altitude;         // 25 ft steps from -1000 ft
+	typedef Gdl90Field<100, 4> miscIndicators;
+	typedef Gdl90Field<104, 4> integrityCode;
+	typedef Gdl90Field<108, 4> accuracyCode;
+	typedef Gdl90Field<112, 12> horzVelocity;    // knots
+	typedef Gdl90Field<124, 12, true> vertVelocity;  // 64 fpm steps
+	typedef Gdl90Field<136, 8, false, std::ratio<360, 256> > trackHeading;
+	typedef Gdl90Field<144, 8> emitterCategory;
+	typedef Gdl90Field<216, 4> emergencyPriorityCode;
+
+	static constexpr unsigned int callsignOffset = 19;
+	static constexpr unsigned int msgBits = 28 * 8;
+};
+
+static_assert(Gdl90FieldsFit<gdl90TrafficLayout::messageId, gdl90TrafficLayout::alertStatus,
+	gdl90TrafficLayout::addressType, gdl90TrafficLayout::participantAddr,
+	gdl90TrafficLayout::latitude, gdl90TrafficLayout::longitude,
+	gdl90TrafficLayout::altitude, gdl90TrafficLayout::miscIndicators,
+	gdl90TrafficLayout::integrityCode, gdl90TrafficLayout::accuracyCode,
+	gdl90TrafficLayout::horzVelocity, gdl90TrafficLayout::vertVelocity,
+	gdl90TrafficLayout::trackHeading, gdl90TrafficLayout::emitterCategory,
+	Gdl90Field<gdl90TrafficLayout::callsignOffset * 8, 32>,
+	Gdl90Field<gdl90TrafficLayout::callsignOffset * 8 + 32, 32>,
+	gdl90TrafficLayout::emergencyPriorityCode>(gdl90TrafficLayout::msgBits),
+	"GDL90 traffic report fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// UAT payload header, DO-282B table 2-10, from payload byte 0
+///////////////////////////////////////////////////////////////////////////////
+struct uatHeaderLayout
+{
+	typedef Gdl90Field<0, 5> payloadTypeCode;
+	typedef Gdl90Field<5, 3> addressQualifier;
+	typedef Gdl90Field<8, 24> participantAddr;
+
+	static constexpr unsigned int msgBits = 4 * 8;
+};
+
+static_assert(Gdl90FieldsFit<uatHeaderLayout::payloadTypeCode, uatHeaderLayout::addressQualifier,
+	uatHeaderLayout::participantAddr>(uatHeaderLayout::msgBits),
+	"UAT header fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// UAT state vector, from payload byte 4.  the velocities are sign and
+// magnitude, the magnitude is the speed plus one and 0 means no speed.  on
+// the ground the north velocity is the ground speed and the east velocity
+// is the track type and track
+///////////////////////////////////////////////////////////////////////////////
+struct uatStateVectorLayout
+{
+	typedef Gdl90Field<0, 23, false, gdl90LatLongScale> latitude;    // 0 to 180, south above 90
+	typedef Gdl90Field<23, 24, false, gdl90LatLongScale> longitude;  // 0 to 360, west above 180
+	typedef Gdl90Field<47, 1> altitudeType;        // 1 for geometric
+	typedef Gdl90Field<48, 12> altitude;           // 25 ft steps from -1000 ft plus one
+	typedef Gdl90Field<60, 4> integrityCode;
+	typedef Gdl90Field<64, 2> airGroundState;      // subsonic, supersonic, ground
+	typedef Gdl90Field<67, 1> northSign;
+	typedef Gdl90Field<68, 10> northVelocity;
+	typedef Gdl90Field<78, 1> eastSign;
+	typedef Gdl90Field<79, 10> eastVelocity;
+	typedef Gdl90Field<89, 1> vertSource;          // 1 for barometric
+	typedef Gdl90Field<90, 1> vertSign;
+	typedef Gdl90Field<91, 9> vertVelocity;        // 64 fpm steps
+
+	typedef Gdl90Field<68, 10> groundSpeed;
+	typedef Gdl90Field<78, 2> trackType;
+	typedef Gdl90Field<80, 9, false, std::ratio<360, 512> > groundTrack;
+
+	static constexpr unsigned int msgBits = 13 * 8;
+};
+
+static_assert(Gdl90FieldsFit<uatStateVectorLayout::latitude, uatStateVectorLayout::longitude,
+	uatStateVectorLayout::altitudeType, uatStateVectorLayout::altitude,
+	uatStateVectorLayout::integrityCode, uatStateVectorLayout::airGroundState,
+	uatStateVectorLayout::northSign, uatStateVectorLayout::northVelocity,
+	uatStateVectorLayout::eastSign, uatStateVectorLayout::eastVelocity,
+	uatStateVectorLayout::vertSource, uatStateVectorLayout::vertSign,
+	uatStateVectorLayout::vertVelocity>(uatStateVectorLayout::msgBits),
+	"UAT airborne state vector fields overlap");
+
+static_assert(Gdl90FieldsFit<uatStateVectorLayout::latitude, uatStateVectorLayout::longitude,
+	uatStateVectorLayout::altitudeType, uatStateVectorLayout::altitude,
+	uatStateVectorLayout::integrityCode, uatStateVectorLayout::airGroundState,
+	uatStateVectorLayout::groundSpeed, uatStateVectorLayout::trackType,
+	uatStateVectorLayout::groundTrack>(uatStateVectorLayout::msgBits),
+	"UAT ground state vector fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// UAT mode status, from payload byte 17.  the callsign is three 16 bit
+// words of base 40 characters, the first one starts with the emitter
+// category
+///////////////////////////////////////////////////////////////////////////////
+struct uatModeStatusLayout
+{
+	typedef Gdl90Field<0, 16> callsignWord0;
+	typedef Gdl90Field<16, 16> callsignWord1;
+	typedef Gdl90Field<32, 16> callsignWord2;
+	typedef Gdl90Field<48, 3> emergencyPriorityCode;
+	typedef Gdl90Field<51, 3> mopsVersion;
+	typedef Gdl90Field<54, 2> sil;
+	typedef Gdl90Field<56, 6> transmitMso;
+	typedef Gdl90Field<64, 4> accuracyCode;        // NACp
+	typedef Gdl90Field<68, 3> nacv;
+	typedef Gdl90Field<71, 1> nicBaro;
+	typedef Gdl90Field<72, 2> capabilityCodes;
+	typedef Gdl90Field<74, 3> operationalModes;
+	typedef Gdl90Field<77, 1> trueMagnetic;
+	typedef Gdl90Field<78, 1> callsignId;          // 0 for a squawk code
+
+	static constexpr unsigned int msgBits = 12 * 8;
+};
+
+static_assert(Gdl90FieldsFit<uatModeStatusLayout::callsignWord0, uatModeStatusLayout::callsignWord1,
+	uatModeStatusLayout::callsignWord2, uatModeStatusLayout::emergencyPriorityCode,
+	uatModeStatusLayout::mopsVersion, uatModeStatusLayout::sil,
+	uatModeStatusLayout::transmitMso, uatModeStatusLayout::accuracyCode,
+	uatModeStatusLayout::nacv, uatModeStatusLayout::nicBaro,
+	uatModeStatusLayout::capabilityCodes, uatModeStatusLayout::operationalModes,
+	uatModeStatusLayout::trueMagnetic, uatModeStatusLayout::callsignId>(uatModeStatusLayout::msgBits),
+	"UAT mode status fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// UAT auxiliary state vector, from payload byte 29
+///////////////////////////////////////////////////////////////////////////////
+struct uatAuxStateVectorLayout
+{
+	typedef Gdl90Field<0, 12> altitude;            // the other altitude type
+
+	static constexpr unsigned int msgBits = 5 * 8;
+};
+
+static_assert(Gdl90FieldsFit<uatAuxStateVectorLayout::altitude>(uatAuxStateVectorLayout::msgBits),
+	"UAT auxiliary state vector fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// 1090ES airborne position, the 56 bit ME field of type codes 9 to 18
+///////////////////////////////////////////////////////////////////////////////
+struct esAirPositionLayout
+{
+	typedef Gdl90Field<0, 5> typeCode;
+	typedef Gdl90Field<5, 2> survStatus;
+	typedef Gdl90Field<7, 1> nicSupplement;
+	typedef Gdl90Field<8, 12> altitude;            // Q bit is 0x10
+	typedef Gdl90Field<20, 1> timeFlag;
+	typedef Gdl90Field<21, 1> cprOdd;
+	typedef Gdl90Field<22, 17> latCpr;
+	typedef Gdl90Field<39, 17> lonCpr;
+
+	static constexpr unsigned int msgBits = 7 * 8;
+};
+
+static_assert(Gdl90FieldsFit<esAirPositionLayout::typeCode, esAirPositionLayout::survStatus,
+	esAirPositionLayout::nicSupplement, esAirPositionLayout::altitude,
+	esAirPositionLayout::timeFlag, esAirPositionLayout::cprOdd,
+	esAirPositionLayout::latCpr, esAirPositionLayout::lonCpr>(esAirPositionLayout::msgBits),
+	"1090ES airborne position fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// uplink information frame header, DO-282B section 2.2.3.2.4.3, from the
+// start of the frame.  the data follows the 2 byte header
+///////////////////////////////////////////////////////////////////////////////
+struct uplinkInfoFrameLayout
+{
+	typedef Gdl90Field<0, 9> length;
+	typedef Gdl90Field<12, 4> frameType;
+
+	static constexpr unsigned int msgBits = 2 * 8;
+};
+
+static_assert(Gdl90FieldsFit<uplinkInfoFrameLayout::length,
+	uplinkInfoFrameLayout::frameType>(uplinkInfoFrameLayout::msgBits),
+	"uplink information frame fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// FIS-B APDU header, DO-358 section 2.2.2, from the start of the APDU.  the
+// time option says which time fields follow and so where the header ends:
+// 0 hours minutes, 1 adds seconds, 2 is month day hours minutes and 3 adds
+// seconds to that
+///////////////////////////////////////////////////////////////////////////////
+struct fisbApduLayout
+{
+	typedef Gdl90Field<0, 1> aFlag;
+	typedef Gdl90Field<1, 1> gFlag;
+	typedef Gdl90Field<2, 1> pFlag;
+	typedef Gdl90Field<3, 11> productId;
+	typedef Gdl90Field<14, 1> sFlag;               // segmented
+	typedef Gdl90Field<15, 2> timeOption;
+
+	typedef Gdl90Field<17, 5> hours;
+	typedef Gdl90Field<22, 6> minutes;
+	typedef Gdl90Field<28, 6> seconds;
+
+	typedef Gdl90Field<17, 4> dateMonth;
+	typedef Gdl90Field<21, 5> dateDay;
+	typedef Gdl90Field<26, 5> dateHours;
+	typedef Gdl90Field<31, 6> dateMinutes;
+	typedef Gdl90Field<37, 6> dateSeconds;
+
+	static constexpr unsigned int msgBits = 6 * 8;
+};
+
+static_assert(Gdl90FieldsFit<fisbApduLayout::aFlag, fisbApduLayout::gFlag,
+	fisbApduLayout::pFlag, fisbApduLayout::productId, fisbApduLayout::sFlag,
+	fisbApduLayout::timeOption, fisbApduLayout::hours, fisbApduLayout::minutes,
+	fisbApduLayout::seconds>(fisbApduLayout::msgBits),
+	"FIS-B APDU header fields overlap");
+
+static_assert(Gdl90FieldsFit<fisbApduLayout::aFlag, fisbApduLayout::gFlag,
+	fisbApduLayout::pFlag, fisbApduLayout::productId, fisbApduLayout::sFlag,
+	fisbApduLayout::timeOption, fisbApduLayout::dateMonth, fisbApduLayout::dateDay,
+	fisbApduLayout::dateHours, fisbApduLayout::dateMinutes,
+	fisbApduLayout::dateSeconds>(fisbApduLayout::msgBits),
+	"FIS-B APDU dated header fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// FIS-B global block NEXRAD (products 63 and 64), the block header at the
+// start of the APDU data.  run length encoded blocks carry 128 bins of 3
+// bit intensity after it, the others a count and bitmap of empty blocks
+///////////////////////////////////////////////////////////////////////////////
+struct fisbNexradLayout
+{
+	typedef Gdl90Field<0, 1> runLength;
+	typedef Gdl90Field<1, 1> southern;
+	typedef Gdl90Field<2, 2> scaleFactor;
+	typedef Gdl90Field<4, 20> blockNumber;
+
+	typedef Gdl90Field<24, 4> emptyMapBits;        // first bits of the bitmap
+	typedef Gdl90Field<28, 4> emptyMapLength;      // bytes of bitmap
+
+	static constexpr unsigned int msgBits = 4 * 8;
+};
+
+static_assert(Gdl90FieldsFit<fisbNexradLayout::runLength, fisbNexradLayout::southern,
+	fisbNexradLayout::scaleFactor, fisbNexradLayout::blockNumber,
+	fisbNexradLayout::emptyMapBits, fisbNexradLayout::emptyMapLength>(fisbNexradLayout::msgBits),
+	"FIS-B NEXRAD block header fields overlap");
+
+///////////////////////////////////////////////////////////////////////////////
+// the layouts against example messages.  the traffic report is the example
+// in the GDL90 ICD section 3.5.4, N825V at 44.90708 -122.99488, 5000 ft,
+// 123 kt, 64 fpm up and 45 degrees.  the airborne position is the ME field
+// of 8D40621D58C382D690C8AC2863A7 from "The 1090MHz Riddle", 38000 ft with
+// CPR 93000 51372
+///////////////////////////////////////////////////////////////////////////////
+static constexpr unsigned char gdl90TrafficExample[] =
+{
+	0x14, 0x00, 0xab, 0x45, 0x49, 0x1f, 0xef, 0x15, 0xa8, 0x89, 0x78, 0x0f, 0x09, 0xa9,
+	0x07, 0xb0, 0x01, 0x20, 0x01, 0x4e, 0x38, 0x32, 0x35, 0x56, 0x20, 0x20, 0x20, 0x00
+};
+
+static_assert(gdl90TrafficLayout::messageId::Get(gdl90TrafficExample) == 0x14, "traffic message id");
+static_assert(gdl90TrafficLayout::alertStatus::Get(gdl90TrafficExample) == 0, "traffic alert status");
+static_assert(gdl90TrafficLayout::addressType::Get(gdl90TrafficExample) == 0, "traffic address type");
+static_assert(gdl90TrafficLayout::participantAddr::Get(gdl90TrafficExample) == 0xab4549, "traffic address");
+static_assert(gdl90TrafficLayout::latitude::Get(gdl90TrafficExample) == 0x1fef15, "traffic latitude");
+static_assert(gdl90TrafficLayout::longitude::Get(gdl90TrafficExample) == 0xa88978 - 0x1000000, "traffic longitude");
+static_assert(gdl90TrafficLayout::altitude::Get(gdl90TrafficExample) * 25 - 1000 == 5000, "traffic altitude");
+static_assert(gdl90TrafficLayout::miscIndicators::Get(gdl90TrafficExample) == 9, "traffic misc indicators");
+static_assert(gdl90TrafficLayout::integrityCode::Get(gdl90TrafficExample) == 10, "traffic NIC");
+static_assert(gdl90TrafficLayout::accuracyCode::Get(gdl90TrafficExample) == 9, "traffic NACp");
+static_assert(gdl90TrafficLayout::horzVelocity::Get(gdl90TrafficExample) == 123, "traffic horizontal velocity");
+static_assert(gdl90TrafficLayout::vertVelocity::Get(gdl90TrafficExample) == 1, "traffic vertical velocity");
+static_assert(gdl90TrafficLayout::trackHeading::GetValue(gdl90TrafficExample) == 45.0, "traffic track");
+static_assert(gdl90TrafficLayout::emitterCategory::Get(gdl90TrafficExample) == 1, "traffic emitter category");
+static_assert(gdl90TrafficLayout::emergencyPriorityCode::Get(gdl90TrafficExample) == 0, "traffic emergency code");
+
+static constexpr unsigned char gdl90DescentExample[] = { 0x0e, 0x00 };
+
+static_assert(Gdl90Field<4, 12, true>::Get(gdl90DescentExample) == -512, "12 bit two's complement");
+
+static constexpr unsigned char esAirPositionExample[] = { 0x58, 0xc3, 0x82, 0xd6, 0x90, 0xc8, 0xac };
+
+static_assert(esAirPositionLayout::typeCode::Get(esAirPositionExample) == 11, "ES type code");
+static_assert(esAirPositionLayout::survStatus::Get(esAirPositionExample) == 0, "ES surveillance status");
+static_assert(esAirPositionLayout::altitude::Get(esAirPositionExample) == 0xc38, "ES altitude");
+static_assert(esAirPositionLayout::timeFlag::Get(esAirPositionExample) == 0, "ES time flag");
+static_assert(esAirPositionLayout::cprOdd::Get(esAirPositionExample) == 0, "ES CPR format");
+static_assert(esAirPositionLayout::latCpr::Get(esAirPositionExample) == 93000, "ES CPR latitude");
+static_assert(esAirPositionLayout::lonCpr::Get(esAirPositionExample) == 51372, "ES CPR longitude");
+
+#endif // _GDL90_FIELDS_H_
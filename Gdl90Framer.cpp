@@ -0,0 +1,205 @@
+//
+// Gdl90Framer.cpp: incremental GDL90 byte stream framer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include <string.h>
+
+#include "Gdl90Framer.h"
+#include "Gdl90Unstuff.h"
+
+Gdl90Framer::Gdl90Framer()
+{
+	mFrameCallback = NULL;
+	mCallbackContext = NULL;
+
+	mNumFrames = 0;
+	mNumDiscardedBytes = 0;
+	mNumDroppedFrames = 0;
+
+	Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Gdl90Framer::SetFrameCallback(FrameCallback callback, void *context)
+{
+	mFrameCallback = callback;
+	mCallbackContext = context;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// drop any partial frame and wait for the next flag byte
+///////////////////////////////////////////////////////////////////////////////
+void Gdl90Framer::Reset()
+{
+	mFrameLen = 0;
+
+	mInFrame = false;
+	mEscapePending = false;
+	mOverrun = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns the number of complete frames handed to the callback
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90Framer::Feed(const unsigned char *dataBuf, unsigned int dataLen)
+{
+	int numFrames = 0;
+	unsigned int srcIndex = 0;
+
+	if (dataBuf == NULL)
+	{
+		return(0);
+	}
+
+	while (srcIndex < dataLen)
+	{
+		if ((mInFrame == false) || (mOverrun == true))
+		{
+			// garbage between frames or the rest of an oversized frame,
+			// skip straight to the next flag byte
+
+			const unsigned char *flagPtr = (const unsigned char *)memchr(
+				&dataBuf[srcIndex], GDL90_FLAGBYTE, dataLen - srcIndex);
+
+			if (flagPtr == NULL)
+			{
+				mNumDiscardedBytes += dataLen - srcIndex;
+
+				break;
+			}
+
+			mNumDiscardedBytes += (unsigned int)(flagPtr - &dataBuf[srcIndex]);
+
+			srcIndex = (unsigned int)(flagPtr - dataBuf);
+		}
+		else if (mEscapePending == false)
+		{
+			// copy everything up to the next flag or escape in one go
+
+			unsigned int runLen = Gdl90FindSpecial(&dataBuf[srcIndex], dataLen - srcIndex);
+
+			if (runLen > 0)
+			{
+				// leave room for the closing flag position
+
+				if ((mFrameLen + runLen) < GDL90_MAX_FRAME_SIZE)
+				{
+					memcpy(&mFrameBuf[mFrameLen], &dataBuf[srcIndex], runLen);
+
+					mFrameLen += runLen;
+				}
+				else
+				{
+					mOverrun = true;
+
+					mNumDiscardedBytes += mFrameLen + runLen;
+				}
+
+				srcIndex += runLen;
+
+				continue;
+			}
+		}
+
+		unsigned char dataByte = dataBuf[srcIndex];
+
+		srcIndex++;
+
+		if (dataByte == GDL90_FLAGBYTE)
+		{
+			// a flag byte closes the current frame and opens the next one,
+			// back to back flags just give us an empty frame to ignore
+
+			if ((mInFrame == true) && (mFrameLen > 1))
+			{
+				if ((mOverrun == true) || (mEscapePending == true))
+				{
+					mNumDroppedFrames++;
+				}
+				else
+				{
+					EmitFrame();
+
+					numFrames++;
+				}
+			}
+
+			mInFrame = true;
+			mEscapePending = false;
+			mOverrun = false;
+
+			mFrameBuf[0] = 0;
+			mFrameLen = 1;
+		}
+		else if (dataByte == GDL90_ESCAPEBYTE)
+		{
+			mEscapePending = true;
+		}
+		else
+		{
+			if (mEscapePending == true)
+			{
+				dataByte ^= 0x20;
+
+				mEscapePending = false;
+			}
+
+			if (mFrameLen < (GDL90_MAX_FRAME_SIZE - 1))
+			{
+				mFrameBuf[mFrameLen] = dataByte;
+				mFrameLen++;
+			}
+			else
+			{
+				mOverrun = true;
+
+				mNumDiscardedBytes += mFrameLen;
+			}
+		}
+	}
+
+	return(numFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Gdl90Framer::EmitFrame()
+{
+	mFrameBuf[mFrameLen] = 0;
+
+	mNumFrames++;
+
+	if (mFrameCallback != NULL)
+	{
+		mFrameCallback(mCallbackContext, mFrameBuf, mFrameLen + 1);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Framer::GetNumFrames()
+{
+	return(mNumFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Framer::GetNumDiscardedBytes()
+{
+	return(mNumDiscardedBytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Framer::GetNumDroppedFrames()
+{
+	return(mNumDroppedFrames);
+}
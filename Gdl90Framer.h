@@ -0,0 +1,77 @@
+//
+// Gdl90Framer.h: incremental GDL90 byte stream framer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _GDL90_FRAMER_H_
+#define _GDL90_FRAMER_H_
+
+#include "Gdl90Defs.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Gdl90Framer accepts the raw bytes from a UDP datagram or serial read in
+// whatever size chunks they arrive, finds the 0x7E flag bytes, removes the
+// 0x7D control-escapes and hands each complete frame to the frame callback.
+//
+// Frames are built in place in a fixed buffer so no memory is allocated per
+// frame.  The frame handed to the callback uses the same layout that
+// DecodeMessage works with after unstuffing:
+//
+//   frameBuf[0]              flag byte position (set to 0)
+//   frameBuf[1]              message id
+//   frameBuf[frameSize - 3]  crc lsb
+//   frameBuf[frameSize - 2]  crc msb
+//   frameBuf[frameSize - 1]  flag byte position (set to 0)
+//
+// Bytes seen before the first flag byte, frames that overrun the buffer and
+// frames ending in a dangling escape are dropped and counted; the framer
+// resynchronizes on the next flag byte.
+///////////////////////////////////////////////////////////////////////////////
+class Gdl90Framer
+{
+public:
+	typedef void (*FrameCallback)(void *context, unsigned char *frameBuf,
+		unsigned int frameSize);
+
+	Gdl90Framer();
+
+	void SetFrameCallback(FrameCallback callback, void *context);
+
+	int Feed(const unsigned char *dataBuf, unsigned int dataLen);
+
+	void Reset();
+
+	unsigned int GetNumFrames();
+	unsigned int GetNumDiscardedBytes();
+	unsigned int GetNumDroppedFrames();
+
+private:
+	void EmitFrame();
+
+	FrameCallback mFrameCallback;
+	void *mCallbackContext;
+
+	unsigned char mFrameBuf[GDL90_MAX_FRAME_SIZE];
+	unsigned int mFrameLen;
+
+	bool mInFrame;
+	bool mEscapePending;
+	bool mOverrun;
+
+	unsigned int mNumFrames;
+	unsigned int mNumDiscardedBytes;
+	unsigned int mNumDroppedFrames;
+};
+
+#endif // _GDL90_FRAMER_H_
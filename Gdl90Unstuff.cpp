@@ -0,0 +1,445 @@
+//
+// Gdl90Unstuff.cpp: GDL90 flag/escape scanning and unstuffing kernels
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include <string.h>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GDL90_UNSTUFF_X86
+#define GDL90_TARGET_SSE2 __attribute__((target("sse2")))
+#define GDL90_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define GDL90_UNSTUFF_X86
+#define GDL90_TARGET_SSE2
+#define GDL90_TARGET_AVX2
+#endif
+
+#include "Gdl90Unstuff.h"
+
+typedef unsigned int (*UnstuffFunc)(unsigned char *dstBuf,
+	const unsigned char *srcBuf, unsigned int srcLen);
+typedef unsigned int (*FindSpecialFunc)(const unsigned char *dataBuf,
+	unsigned int dataLen);
+
+struct unstuffKernelRec
+{
+	int kernelKind;
+	UnstuffFunc unstuffFunc;
+	FindSpecialFunc findSpecialFunc;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int UnstuffScalar(unsigned char *dstBuf,
+	const unsigned char *srcBuf, unsigned int srcLen)
+{
+	unsigned int srcIndex = 0;
+	unsigned int dstIndex = 0;
+
+	// nothing has to move until the first escape, so when unstuffing in
+	// place just skip ahead to it
+
+	if (dstBuf == srcBuf)
+	{
+		while ((srcIndex < srcLen) && (srcBuf[srcIndex] != GDL90_ESCAPEBYTE))
+		{
+			srcIndex++;
+		}
+		dstIndex = srcIndex;
+	}
+
+	while (srcIndex < srcLen)
+	{
+		unsigned char dataByte = srcBuf[srcIndex];
+
+		srcIndex++;
+
+		if (dataByte == GDL90_ESCAPEBYTE)
+		{
+			if (srcIndex >= srcLen)
+			{
+				break;
+			}
+			dataByte = srcBuf[srcIndex] ^ 0x20;
+
+			srcIndex++;
+		}
+
+		dstBuf[dstIndex] = dataByte;
+		dstIndex++;
+	}
+
+	return(dstIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int FindSpecialScalar(const unsigned char *dataBuf,
+	unsigned int dataLen)
+{
+	unsigned int dataIndex = 0;
+
+	while ((dataIndex < dataLen) && (dataBuf[dataIndex] != GDL90_FLAGBYTE) &&
+		(dataBuf[dataIndex] != GDL90_ESCAPEBYTE))
+	{
+		dataIndex++;
+	}
+
+	return(dataIndex);
+}
+
+#if defined(GDL90_UNSTUFF_X86)
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int CountTrailingZeros(unsigned int bitMask)
+{
+#if defined(_MSC_VER)
+	unsigned long bitIndex;
+
+	_BitScanForward(&bitIndex, bitMask);
+
+	return(bitIndex);
+#else
+	return(__builtin_ctz(bitMask));
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a block with no escape is copied with one store, that store can only reach
+// source bytes that have already been loaded because the destination never
+// runs ahead of the source.  when a block does hold an escape only the run
+// in front of it is moved and the next block is loaded just past it
+///////////////////////////////////////////////////////////////////////////////
+GDL90_TARGET_SSE2
+static unsigned int UnstuffSse2(unsigned char *dstBuf,
+	const unsigned char *srcBuf, unsigned int srcLen)
+{
+	const __m128i escapeVec = _mm_set1_epi8((char)GDL90_ESCAPEBYTE);
+	unsigned int srcIndex = 0;
+	unsigned int dstIndex = 0;
+
+	while ((srcIndex + 16) <= srcLen)
+	{
+		__m128i dataVec = _mm_loadu_si128((const __m128i *)&srcBuf[srcIndex]);
+		unsigned int escapeMask = _mm_movemask_epi8(_mm_cmpeq_epi8(dataVec, escapeVec));
+
+		if (escapeMask == 0)
+		{
+			if (&dstBuf[dstIndex] != &srcBuf[srcIndex])
+			{
+				_mm_storeu_si128((__m128i *)&dstBuf[dstIndex], dataVec);
+			}
+			srcIndex += 16;
+			dstIndex += 16;
+		}
+		else
+		{
+			unsigned int runLen = CountTrailingZeros(escapeMask);
+
+			if ((srcIndex + runLen + 1) >= srcLen)
+			{
+				break;
+			}
+
+			if (&dstBuf[dstIndex] != &srcBuf[srcIndex])
+			{
+				memmove(&dstBuf[dstIndex], &srcBuf[srcIndex], runLen);
+			}
+			dstBuf[dstIndex + runLen] = srcBuf[srcIndex + runLen + 1] ^ 0x20;
+
+			srcIndex += runLen + 2;
+			dstIndex += runLen + 1;
+		}
+	}
+
+	return(dstIndex + UnstuffScalar(&dstBuf[dstIndex], &srcBuf[srcIndex],
+		srcLen - srcIndex));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GDL90_TARGET_SSE2
+static unsigned int FindSpecialSse2(const unsigned char *dataBuf,
+	unsigned int dataLen)
+{
+	const __m128i flagVec = _mm_set1_epi8((char)GDL90_FLAGBYTE);
+	const __m128i escapeVec = _mm_set1_epi8((char)GDL90_ESCAPEBYTE);
+	unsigned int dataIndex = 0;
+
+	while ((dataIndex + 16) <= dataLen)
+	{
+		__m128i dataVec = _mm_loadu_si128((const __m128i *)&dataBuf[dataIndex]);
+		unsigned int specialMask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_cmpeq_epi8(dataVec, flagVec), _mm_cmpeq_epi8(dataVec, escapeVec)));
+
+		if (specialMask != 0)
+		{
+			return(dataIndex + CountTrailingZeros(specialMask));
+		}
+		dataIndex += 16;
+	}
+
+	return(dataIndex + FindSpecialScalar(&dataBuf[dataIndex], dataLen - dataIndex));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GDL90_TARGET_AVX2
+static unsigned int UnstuffAvx2(unsigned char *dstBuf,
+	const unsigned char *srcBuf, unsigned int srcLen)
+{
+	const __m256i escapeVec = _mm256_set1_epi8((char)GDL90_ESCAPEBYTE);
+	unsigned int srcIndex = 0;
+	unsigned int dstIndex = 0;
+
+	while ((srcIndex + 32) <= srcLen)
+	{
+		__m256i dataVec = _mm256_loadu_si256((const __m256i *)&srcBuf[srcIndex]);
+		unsigned int escapeMask = (unsigned int)_mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(dataVec, escapeVec));
+
+		if (escapeMask == 0)
+		{
+			if (&dstBuf[dstIndex] != &srcBuf[srcIndex])
+			{
+				_mm256_storeu_si256((__m256i *)&dstBuf[dstIndex], dataVec);
+			}
+			srcIndex += 32;
+			dstIndex += 32;
+		}
+		else
+		{
+			unsigned int runLen = CountTrailingZeros(escapeMask);
+
+			if ((srcIndex + runLen + 1) >= srcLen)
+			{
+				break;
+			}
+
+			if (&dstBuf[dstIndex] != &srcBuf[srcIndex])
+			{
+				memmove(&dstBuf[dstIndex], &srcBuf[srcIndex], runLen);
+			}
+			dstBuf[dstIndex + runLen] = srcBuf[srcIndex + runLen + 1] ^ 0x20;
+
+			srcIndex += runLen + 2;
+			dstIndex += runLen + 1;
+		}
+	}
+
+	// finish the last partial block 16 bytes at a time
+
+	return(dstIndex + UnstuffSse2(&dstBuf[dstIndex], &srcBuf[srcIndex],
+		srcLen - srcIndex));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GDL90_TARGET_AVX2
+static unsigned int FindSpecialAvx2(const unsigned char *dataBuf,
+	unsigned int dataLen)
+{
+	const __m256i flagVec = _mm256_set1_epi8((char)GDL90_FLAGBYTE);
+	const __m256i escapeVec = _mm256_set1_epi8((char)GDL90_ESCAPEBYTE);
+	unsigned int dataIndex = 0;
+
+	while ((dataIndex + 32) <= dataLen)
+	{
+		__m256i dataVec = _mm256_loadu_si256((const __m256i *)&dataBuf[dataIndex]);
+		unsigned int specialMask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_cmpeq_epi8(dataVec, flagVec), _mm256_cmpeq_epi8(dataVec, escapeVec)));
+
+		if (specialMask != 0)
+		{
+			return(dataIndex + CountTrailingZeros(specialMask));
+		}
+		dataIndex += 32;
+	}
+
+	return(dataIndex + FindSpecialSse2(&dataBuf[dataIndex], dataLen - dataIndex));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static bool CpuHasSse2()
+{
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+
+	__cpuid(cpuInfo, 1);
+
+	return((cpuInfo[3] & (1 << 26)) != 0);
+#else
+	__builtin_cpu_init();
+
+	return(__builtin_cpu_supports("sse2") != 0);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static bool CpuHasAvx2()
+{
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+
+	__cpuid(cpuInfo, 0);
+
+	if (cpuInfo[0] < 7)
+	{
+		return(false);
+	}
+
+	// the os has to save the ymm registers as well
+
+	__cpuid(cpuInfo, 1);
+
+	if (((cpuInfo[2] & (1 << 27)) == 0) || ((cpuInfo[2] & (1 << 28)) == 0) ||
+		((_xgetbv(0) & 0x06) != 0x06))
+	{
+		return(false);
+	}
+
+	__cpuidex(cpuInfo, 7, 0);
+
+	return((cpuInfo[1] & (1 << 5)) != 0);
+#else
+	__builtin_cpu_init();
+
+	return(__builtin_cpu_supports("avx2") != 0);
+#endif
+}
+
+#endif // GDL90_UNSTUFF_X86
+
+///////////////////////////////////////////////////////////////////////////////
+static int SelectUnstuffKernel()
+{
+	int kernelKind = unstuffKernelScalar;
+
+#if defined(GDL90_UNSTUFF_X86)
+	if (CpuHasAvx2() == true)
+	{
+		kernelKind = unstuffKernelAvx2;
+	}
+	else if (CpuHasSse2() == true)
+	{
+		kernelKind = unstuffKernelSse2;
+	}
+#endif
+
+	return(kernelKind);
+}
+
+static const struct unstuffKernelRec sScalarKernel =
+{
+	unstuffKernelScalar, UnstuffScalar, FindSpecialScalar
+};
+
+#if defined(GDL90_UNSTUFF_X86)
+static const struct unstuffKernelRec sSse2Kernel =
+{
+	unstuffKernelSse2, UnstuffSse2, FindSpecialSse2
+};
+
+static const struct unstuffKernelRec sAvx2Kernel =
+{
+	unstuffKernelAvx2, UnstuffAvx2, FindSpecialAvx2
+};
+#endif
+
+// decoding threads load this while Gdl90SetUnstuffKernel may be storing it,
+// the records are constants so a relaxed load always sees a whole kernel
+static std::atomic<const struct unstuffKernelRec *> sUnstuffKernel(&sScalarKernel);
+
+///////////////////////////////////////////////////////////////////////////////
+// returns -1 if the requested kernel can't run on this cpu
+///////////////////////////////////////////////////////////////////////////////
+static int ApplyUnstuffKernel(int kernelKind)
+{
+	const struct unstuffKernelRec *unstuffKernel = NULL;
+
+	switch (kernelKind)
+	{
+	case unstuffKernelScalar:
+		unstuffKernel = &sScalarKernel;
+		break;
+
+#if defined(GDL90_UNSTUFF_X86)
+	case unstuffKernelSse2:
+		if (CpuHasSse2() == true)
+		{
+			unstuffKernel = &sSse2Kernel;
+		}
+		break;
+
+	case unstuffKernelAvx2:
+		if (CpuHasAvx2() == true)
+		{
+			unstuffKernel = &sAvx2Kernel;
+		}
+		break;
+#endif
+
+	default:
+		break;
+	}
+
+	int status = -1;
+
+	if (unstuffKernel != NULL)
+	{
+		sUnstuffKernel.store(unstuffKernel, std::memory_order_relaxed);
+		status = 0;
+	}
+
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static const struct unstuffKernelRec *GetUnstuffKernel()
+{
+	static bool kernelSelected = (ApplyUnstuffKernel(SelectUnstuffKernel()) == 0);
+
+	(void)kernelSelected;
+
+	return(sUnstuffKernel.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90Unstuff(unsigned char *dstBuf, const unsigned char *srcBuf,
+	unsigned int srcLen)
+{
+	return(GetUnstuffKernel()->unstuffFunc(dstBuf, srcBuf, srcLen));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int Gdl90FindSpecial(const unsigned char *dataBuf, unsigned int dataLen)
+{
+	return(GetUnstuffKernel()->findSpecialFunc(dataBuf, dataLen));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90GetUnstuffKernel()
+{
+	return(GetUnstuffKernel()->kernelKind);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns -1 if the requested kernel can't run on this cpu
+///////////////////////////////////////////////////////////////////////////////
+int Gdl90SetUnstuffKernel(int kernelKind)
+{
+	GetUnstuffKernel();
+
+	return(ApplyUnstuffKernel(kernelKind));
+}
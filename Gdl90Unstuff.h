@@ -0,0 +1,49 @@
+//
+// Gdl90Unstuff.h: GDL90 flag/escape scanning and unstuffing kernels
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _GDL90_UNSTUFF_H_
+#define _GDL90_UNSTUFF_H_
+
+#include "Gdl90Defs.h"
+
+// the kernel is picked once at run time from what the cpu supports,
+// SetUnstuffKernel lets a benchmark or a test force one of them.  it may be
+// called while other threads are decoding, they switch kernels on their
+// next frame
+
+enum gdl90UnstuffKernelKinds
+{
+	unstuffKernelScalar,
+	unstuffKernelSse2,
+	unstuffKernelAvx2
+};
+
+// remove the 0x7D control-escapes from the frame body in srcBuf and write the
+// result to dstBuf, dstBuf may be the same buffer as srcBuf.  a trailing
+// escape with nothing after it is dropped.  returns the unstuffed length
+
+unsigned int Gdl90Unstuff(unsigned char *dstBuf, const unsigned char *srcBuf,
+	unsigned int srcLen);
+
+// returns the index of the first flag or escape byte in dataBuf, or dataLen
+// if there is neither
+
+unsigned int Gdl90FindSpecial(const unsigned char *dataBuf, unsigned int dataLen);
+
+int Gdl90GetUnstuffKernel();
+int Gdl90SetUnstuffKernel(int kernelKind);
+
+#endif // _GDL90_UNSTUFF_H_
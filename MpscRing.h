@@ -0,0 +1,152 @@
+//
+// MpscRing.h: lock-free multi producer single consumer ring
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _MPSC_RING_H_
+#define _MPSC_RING_H_
+
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#define MPSC_RING_CACHE_LINE 64
+
+///////////////////////////////////////////////////////////////////////////////
+// MpscRing passes fixed size records from any number of producer threads to
+// exactly one consumer thread without locks.  every slot carries a sequence
+// number that says whose turn it is: producers claim a slot by moving mTail
+// on with a compare and swap, fill it, then bump the slot's sequence to hand
+// it to the consumer, who bumps it again once the record is copied out to
+// hand it back to the producers a lap later.
+//
+// the capacity is rounded up to a power of two.  Push and Pop never block,
+// they return false when the ring is full or empty
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> class MpscRing
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"MpscRing records are copied with plain assignment");
+
+public:
+	MpscRing(unsigned int capacity = 1024) :
+		mSlots(RoundUp(capacity))
+	{
+		mMask = (unsigned int)mSlots.size() - 1;
+
+		for (unsigned int index = 0; index <= mMask; index++)
+		{
+			mSlots[index].sequence.store(index, std::memory_order_relaxed);
+		}
+
+		mHead = 0;
+		mTail.store(0, std::memory_order_relaxed);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// any thread
+	///////////////////////////////////////////////////////////////////////////
+	bool Push(const T &record)
+	{
+		unsigned int tail = mTail.load(std::memory_order_relaxed);
+		struct slotRec *slotPtr;
+
+		while (true)
+		{
+			slotPtr = &mSlots[tail & mMask];
+
+			int lag = (int)(slotPtr->sequence.load(std::memory_order_acquire) - tail);
+
+			if (lag == 0)
+			{
+				if (mTail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed) == true)
+				{
+					break;
+				}
+			}
+			else if (lag < 0)
+			{
+				// the consumer hasn't freed this slot from the last lap
+
+				return(false);
+			}
+			else
+			{
+				tail = mTail.load(std::memory_order_relaxed);
+			}
+		}
+
+		slotPtr->record = record;
+		slotPtr->sequence.store(tail + 1, std::memory_order_release);
+
+		return(true);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// consumer side
+	///////////////////////////////////////////////////////////////////////////
+	bool Pop(T &record)
+	{
+		struct slotRec *slotPtr = &mSlots[mHead & mMask];
+
+		if (slotPtr->sequence.load(std::memory_order_acquire) != (mHead + 1))
+		{
+			return(false);
+		}
+
+		record = slotPtr->record;
+		slotPtr->sequence.store(mHead + mMask + 1, std::memory_order_release);
+
+		mHead++;
+
+		return(true);
+	}
+
+	unsigned int GetCapacity()
+	{
+		return(mMask + 1);
+	}
+
+private:
+	struct slotRec
+	{
+		std::atomic<unsigned int> sequence;
+		T record;
+	};
+
+	static unsigned int RoundUp(unsigned int capacity)
+	{
+		unsigned int size = 2;
+
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		return(size);
+	}
+
+	std::vector<struct slotRec> mSlots;
+	unsigned int mMask;
+
+	// consumer owned
+
+	alignas(MPSC_RING_CACHE_LINE) unsigned int mHead;
+
+	// shared by the producers
+
+	alignas(MPSC_RING_CACHE_LINE) std::atomic<unsigned int> mTail;
+};
+
+#endif // _MPSC_RING_H_
@@ -0,0 +1,138 @@
+//
+// SpscRing.h: lock-free single producer single consumer ring
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#define SPSC_RING_CACHE_LINE 64
+
+///////////////////////////////////////////////////////////////////////////////
+// SpscRing passes fixed size records from exactly one producer thread to
+// exactly one consumer thread without locks.  the producer only writes
+// mTail and the consumer only writes mHead, each on its own cache line, and
+// each side keeps a cached copy of the other side's index so it only touches
+// the shared line when the ring looks full or empty.
+//
+// the capacity is rounded up to a power of two.  Push and Pop never block,
+// they return false when the ring is full or empty
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> class SpscRing
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"SpscRing records are copied with plain assignment");
+
+public:
+	SpscRing(unsigned int capacity = 1024)
+	{
+		unsigned int size = 2;
+
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+
+		mRecords.resize(size);
+		mMask = size - 1;
+
+		mHead.store(0, std::memory_order_relaxed);
+		mTail.store(0, std::memory_order_relaxed);
+
+		mCachedHead = 0;
+		mCachedTail = 0;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// producer side
+	///////////////////////////////////////////////////////////////////////////
+	bool Push(const T &record)
+	{
+		unsigned int tail = mTail.load(std::memory_order_relaxed);
+
+		if ((tail - mCachedHead) > mMask)
+		{
+			mCachedHead = mHead.load(std::memory_order_acquire);
+
+			if ((tail - mCachedHead) > mMask)
+			{
+				return(false);
+			}
+		}
+
+		mRecords[tail & mMask] = record;
+
+		mTail.store(tail + 1, std::memory_order_release);
+
+		return(true);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// consumer side
+	///////////////////////////////////////////////////////////////////////////
+	bool Pop(T &record)
+	{
+		unsigned int head = mHead.load(std::memory_order_relaxed);
+
+		if (head == mCachedTail)
+		{
+			mCachedTail = mTail.load(std::memory_order_acquire);
+
+			if (head == mCachedTail)
+			{
+				return(false);
+			}
+		}
+
+		record = mRecords[head & mMask];
+
+		mHead.store(head + 1, std::memory_order_release);
+
+		return(true);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// only a hint when called from a third thread
+	///////////////////////////////////////////////////////////////////////////
+	bool IsEmpty()
+	{
+		return(mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire));
+	}
+
+	unsigned int GetCapacity()
+	{
+		return(mMask + 1);
+	}
+
+private:
+	std::vector<T> mRecords;
+	unsigned int mMask;
+
+	// consumer owned
+
+	alignas(SPSC_RING_CACHE_LINE) std::atomic<unsigned int> mHead;
+	unsigned int mCachedTail;
+
+	// producer owned
+
+	alignas(SPSC_RING_CACHE_LINE) std::atomic<unsigned int> mTail;
+	unsigned int mCachedHead;
+};
+
+#endif // _SPSC_RING_H_
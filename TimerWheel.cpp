@@ -0,0 +1,190 @@
+//
+// TimerWheel.cpp: hashed timing wheel for target expiry
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(unsigned int numBuckets)
+{
+	if (numBuckets == 0)
+	{
+		numBuckets = 1;
+	}
+
+	mBucketHead.assign(numBuckets, -1);
+
+	mCurrentTime = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// schedule or reschedule slotId to expire once now reaches deadline
+///////////////////////////////////////////////////////////////////////////////
+void TimerWheel::Schedule(int slotId, time_t deadline)
+{
+	if (slotId < 0)
+	{
+		return;
+	}
+
+	if (slotId >= (int)mBucket.size())
+	{
+		mNext.resize(slotId + 1, -1);
+		mPrev.resize(slotId + 1, -1);
+		mBucket.resize(slotId + 1, -1);
+		mDeadline.resize(slotId + 1, 0);
+	}
+
+	Unlink(slotId);
+
+	// anything already due goes in the next bucket to be looked at
+
+	time_t bucketTime = deadline;
+
+	if (bucketTime <= mCurrentTime)
+	{
+		bucketTime = mCurrentTime + 1;
+	}
+
+	int bucket = (int)(bucketTime % (time_t)mBucketHead.size());
+
+	mDeadline[slotId] = deadline;
+	mBucket[slotId] = bucket;
+
+	mPrev[slotId] = -1;
+	mNext[slotId] = mBucketHead[bucket];
+
+	if (mBucketHead[bucket] >= 0)
+	{
+		mPrev[mBucketHead[bucket]] = slotId;
+	}
+	mBucketHead[bucket] = slotId;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TimerWheel::Cancel(int slotId)
+{
+	if ((slotId >= 0) && (slotId < (int)mBucket.size()))
+	{
+		Unlink(slotId);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TimerWheel::Clear()
+{
+	mBucketHead.assign(mBucketHead.size(), -1);
+
+	mNext.clear();
+	mPrev.clear();
+	mBucket.clear();
+	mDeadline.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// make room for slot ids below numSlots so Schedule never allocates
+///////////////////////////////////////////////////////////////////////////////
+void TimerWheel::Reserve(unsigned int numSlots)
+{
+	mNext.reserve(numSlots);
+	mPrev.reserve(numSlots);
+	mBucket.reserve(numSlots);
+	mDeadline.reserve(numSlots);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// move the wheel up to now and append every slot id whose deadline has
+// passed to expiredSlots, returns the number of slots that expired.  calling
+// it more than once a second costs nothing
+///////////////////////////////////////////////////////////////////////////////
+int TimerWheel::Advance(time_t now, std::vector<int> &expiredSlots)
+{
+	int numExpired = 0;
+
+	// the first time through look at every bucket in case anything was
+	// scheduled before the wheel knew what time it was
+
+	if (mCurrentTime == 0)
+	{
+		mCurrentTime = now - (time_t)mBucketHead.size();
+	}
+
+	if (now <= mCurrentTime)
+	{
+		return(0);
+	}
+
+	// after a long gap every bucket only needs to be looked at once
+
+	time_t numTicks = now - mCurrentTime;
+
+	if (numTicks > (time_t)mBucketHead.size())
+	{
+		numTicks = (time_t)mBucketHead.size();
+	}
+
+	for (time_t tick = 1; tick <= numTicks; tick++)
+	{
+		int bucket = (int)((mCurrentTime + tick) % (time_t)mBucketHead.size());
+		int slotId = mBucketHead[bucket];
+
+		while (slotId >= 0)
+		{
+			int nextSlotId = mNext[slotId];
+
+			if (mDeadline[slotId] <= now)
+			{
+				Unlink(slotId);
+
+				expiredSlots.push_back(slotId);
+
+				numExpired++;
+			}
+			slotId = nextSlotId;
+		}
+	}
+
+	mCurrentTime = now;
+
+	return(numExpired);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TimerWheel::Unlink(int slotId)
+{
+	int bucket = mBucket[slotId];
+
+	if (bucket < 0)
+	{
+		return;
+	}
+
+	if (mPrev[slotId] >= 0)
+	{
+		mNext[mPrev[slotId]] = mNext[slotId];
+	}
+	else
+	{
+		mBucketHead[bucket] = mNext[slotId];
+	}
+
+	if (mNext[slotId] >= 0)
+	{
+		mPrev[mNext[slotId]] = mPrev[slotId];
+	}
+
+	mNext[slotId] = -1;
+	mPrev[slotId] = -1;
+	mBucket[slotId] = -1;
+}
@@ -0,0 +1,59 @@
+//
+// TimerWheel.h: hashed timing wheel for target expiry
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <time.h>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// TimerWheel tracks one deadline per traffic store slot id with a one second
+// resolution.  each bucket of the wheel holds an intrusive doubly linked list
+// of slot ids so scheduling, rescheduling and cancelling are O(1).
+//
+// deadlines further out than the wheel is long simply stay in their bucket
+// and are skipped until the wheel comes round to them again, so the wheel
+// only needs to be as long as the usual time to live
+///////////////////////////////////////////////////////////////////////////////
+class TimerWheel
+{
+public:
+	TimerWheel(unsigned int numBuckets = 128);
+
+	void Schedule(int slotId, time_t deadline);
+	void Cancel(int slotId);
+	void Clear();
+	void Reserve(unsigned int numSlots);
+
+	int Advance(time_t now, std::vector<int> &expiredSlots);
+
+private:
+	void Unlink(int slotId);
+
+	std::vector<int> mBucketHead;
+
+	// per slot id, mBucket is -1 when the slot isn't scheduled
+
+	std::vector<int> mNext;
+	std::vector<int> mPrev;
+	std::vector<int> mBucket;
+	std::vector<time_t> mDeadline;
+
+	time_t mCurrentTime;
+};
+
+#endif // _TIMER_WHEEL_H_
@@ -0,0 +1,222 @@
+//
+// TrafficFeed.cpp: traffic change subscriptions
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include "TrafficFeed.h"
+
+TrafficFeed::subscriberRec::subscriberRec(unsigned int queueSize) :
+	queue(queueSize)
+{
+	callback = NULL;
+	context = NULL;
+
+	kindMask = 0;
+	fieldMask = 0;
+
+	numDropped.store(0);
+}
+
+TrafficFeed::TrafficFeed()
+{
+	for (unsigned int index = 0; index < TRAFFIC_FEED_MAX_SUBSCRIBERS; index++)
+	{
+		mSubscribers[index] = NULL;
+	}
+
+	mKindMask = 0;
+}
+
+TrafficFeed::~TrafficFeed()
+{
+	for (unsigned int index = 0; index < TRAFFIC_FEED_MAX_SUBSCRIBERS; index++)
+	{
+		delete mSubscribers[index];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// call callback for every wanted change, returns the subscriber id
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFeed::Subscribe(ChangeCallback callback, void *context,
+	unsigned int kindMask, unsigned int fieldMask)
+{
+	if (callback == NULL)
+	{
+		return(-1);
+	}
+
+	// a callback subscriber never uses its queue
+
+	struct subscriberRec *subscriberPtr = new subscriberRec(2);
+
+	subscriberPtr->callback = callback;
+	subscriberPtr->context = context;
+	subscriberPtr->kindMask = kindMask;
+	subscriberPtr->fieldMask = fieldMask;
+
+	return(AddSubscriber(subscriberPtr));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// queue up to queueSize wanted changes for Read, returns the subscriber id
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFeed::Subscribe(unsigned int queueSize, unsigned int kindMask,
+	unsigned int fieldMask)
+{
+	struct subscriberRec *subscriberPtr = new subscriberRec(queueSize);
+
+	subscriberPtr->kindMask = kindMask;
+	subscriberPtr->fieldMask = fieldMask;
+
+	return(AddSubscriber(subscriberPtr));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the queue subscriber's thread must be done reading first
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFeed::Unsubscribe(int subscriberId)
+{
+	if ((subscriberId < 0) || (subscriberId >= TRAFFIC_FEED_MAX_SUBSCRIBERS) ||
+		(mSubscribers[subscriberId] == NULL))
+	{
+		return(-1);
+	}
+
+	delete mSubscribers[subscriberId];
+	mSubscribers[subscriberId] = NULL;
+
+	mKindMask = 0;
+
+	for (unsigned int index = 0; index < TRAFFIC_FEED_MAX_SUBSCRIBERS; index++)
+	{
+		if (mSubscribers[index] != NULL)
+		{
+			mKindMask |= mSubscribers[index]->kindMask;
+		}
+	}
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lets the caller skip building a change nobody wants
+///////////////////////////////////////////////////////////////////////////////
+bool TrafficFeed::IsWanted(unsigned int kind)
+{
+	return((mKindMask & (1u << kind)) != 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficFeed::Publish(const struct trafficChangeRec &change)
+{
+	unsigned int kindBit = (1u << change.kind);
+
+	for (unsigned int index = 0; index < TRAFFIC_FEED_MAX_SUBSCRIBERS; index++)
+	{
+		struct subscriberRec *subscriberPtr = mSubscribers[index];
+
+		if ((subscriberPtr == NULL) || ((subscriberPtr->kindMask & kindBit) == 0))
+		{
+			continue;
+		}
+
+		if ((change.kind == trafficChangeUpdated) &&
+			((subscriberPtr->fieldMask & change.changedFields) == 0))
+		{
+			continue;
+		}
+
+		if (subscriberPtr->callback != NULL)
+		{
+			subscriberPtr->callback(subscriberPtr->context, change);
+		}
+		else if (subscriberPtr->queue.Push(change) == false)
+		{
+			subscriberPtr->numDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append up to maxChanges queued changes, 0 for all of them, oldest first.
+// returns the number appended or -1 if subscriberId isn't a queue
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFeed::Read(int subscriberId, std::vector<struct trafficChangeRec> &changes,
+	unsigned int maxChanges)
+{
+	struct trafficChangeRec change;
+	unsigned int numChanges = 0;
+
+	if ((subscriberId < 0) || (subscriberId >= TRAFFIC_FEED_MAX_SUBSCRIBERS) ||
+		(mSubscribers[subscriberId] == NULL) || (mSubscribers[subscriberId]->callback != NULL))
+	{
+		return(-1);
+	}
+
+	struct subscriberRec *subscriberPtr = mSubscribers[subscriberId];
+
+	while (((maxChanges == 0) || (numChanges < maxChanges)) &&
+		(subscriberPtr->queue.Pop(change) == true))
+	{
+		changes.push_back(change);
+
+		numChanges++;
+	}
+	return((int)numChanges);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// changes lost because the subscriber's queue was full
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficFeed::GetNumDropped(int subscriberId)
+{
+	unsigned int numDropped = 0;
+
+	if ((subscriberId >= 0) && (subscriberId < TRAFFIC_FEED_MAX_SUBSCRIBERS) &&
+		(mSubscribers[subscriberId] != NULL))
+	{
+		numDropped = mSubscribers[subscriberId]->numDropped.load(std::memory_order_relaxed);
+	}
+	return(numDropped);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// -1 when every subscriber id is taken
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFeed::AddSubscriber(struct subscriberRec *subscriberPtr)
+{
+	int subscriberId = -1;
+
+	for (unsigned int index = 0; index < TRAFFIC_FEED_MAX_SUBSCRIBERS; index++)
+	{
+		if (mSubscribers[index] == NULL)
+		{
+			subscriberId = index;
+			break;
+		}
+	}
+
+	if (subscriberId < 0)
+	{
+		delete subscriberPtr;
+
+		return(-1);
+	}
+
+	mSubscribers[subscriberId] = subscriberPtr;
+	mKindMask |= subscriberPtr->kindMask;
+
+	return(subscriberId);
+}
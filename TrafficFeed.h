@@ -0,0 +1,149 @@
+//
+// TrafficFeed.h: traffic change subscriptions
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _TRAFFIC_FEED_H_
+#define _TRAFFIC_FEED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "SpscRing.h"
+#include "TrafficReport.h"
+
+#define TRAFFIC_FEED_MAX_SUBSCRIBERS 16
+#define TRAFFIC_FEED_DEFAULT_QUEUE_SIZE 1024
+
+enum trafficChangeKinds
+{
+	trafficChangeAdded,
+	trafficChangeUpdated,
+	trafficChangeExpired,
+	numTrafficChangeKinds
+};
+
+// subscribe to kinds with a mask of (1 << trafficChangeKinds)
+
+#define TRAFFIC_CHANGE_ADDED (1 << trafficChangeAdded)
+#define TRAFFIC_CHANGE_UPDATED (1 << trafficChangeUpdated)
+#define TRAFFIC_CHANGE_EXPIRED (1 << trafficChangeExpired)
+#define TRAFFIC_CHANGE_ALL (TRAFFIC_CHANGE_ADDED | TRAFFIC_CHANGE_UPDATED | \
+	TRAFFIC_CHANGE_EXPIRED)
+
+// the report fields that differ from the target's previous report
+
+#define TRAFFIC_FIELD_POSITION 0x0001
+#define TRAFFIC_FIELD_ALTITUDE 0x0002
+#define TRAFFIC_FIELD_HORZ_VELOCITY 0x0004
+#define TRAFFIC_FIELD_VERT_VELOCITY 0x0008
+#define TRAFFIC_FIELD_TRACK_HEADING 0x0010
+#define TRAFFIC_FIELD_CALLSIGN 0x0020
+#define TRAFFIC_FIELD_ALERT_STATUS 0x0040
+#define TRAFFIC_FIELD_MISC_INDICATORS 0x0080
+#define TRAFFIC_FIELD_INTEGRITY_CODE 0x0100
+#define TRAFFIC_FIELD_ACCURACY_CODE 0x0200
+#define TRAFFIC_FIELD_EMITTER_CATEGORY 0x0400
+#define TRAFFIC_FIELD_EMERGENCY_CODE 0x0800
+#define TRAFFIC_FIELD_ALL 0x0fff
+
+///////////////////////////////////////////////////////////////////////////////
+// one change to the traffic table.  an added or expired target has every
+// field bit set, an update only has the bits for the fields that changed.
+// report holds the target as it stands after the change, or as it was last
+// seen when it expired
+///////////////////////////////////////////////////////////////////////////////
+struct trafficChangeRec
+{
+	struct trafficReportRec report;
+
+	int32_t slotId;
+	uint16_t changedFields;  // TRAFFIC_FIELD_ bits
+	uint8_t kind;            // trafficChangeKinds
+	uint8_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<trafficChangeRec>::value,
+	"trafficChangeRec must stay trivially copyable");
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficFeed hands the adds, updates and expiries made to the traffic table
+// to whoever subscribed to them so they can work from the deltas instead of
+// rescanning every target.
+//
+// a callback subscriber is called on the decoding thread while the change is
+// made, it must not call back into the AdsbWrapper that is decoding.  a
+// queue subscriber gets its own bounded SpscRing that one other thread reads
+// with Read, changes that find the queue full are dropped and counted.
+//
+// each subscriber picks the kinds of change it wants and, for updates, the
+// fields it cares about, an update touching none of them isn't delivered.
+// Subscribe and Unsubscribe are decoding thread only
+///////////////////////////////////////////////////////////////////////////////
+class TrafficFeed
+{
+public:
+	typedef void (*ChangeCallback)(void *context, const struct trafficChangeRec &change);
+
+	TrafficFeed();
+	~TrafficFeed();
+
+	int Subscribe(ChangeCallback callback, void *context,
+		unsigned int kindMask = TRAFFIC_CHANGE_ALL,
+		unsigned int fieldMask = TRAFFIC_FIELD_ALL);
+	int Subscribe(unsigned int queueSize = TRAFFIC_FEED_DEFAULT_QUEUE_SIZE,
+		unsigned int kindMask = TRAFFIC_CHANGE_ALL,
+		unsigned int fieldMask = TRAFFIC_FIELD_ALL);
+	int Unsubscribe(int subscriberId);
+
+	// decoding thread
+
+	bool IsWanted(unsigned int kind);
+	void Publish(const struct trafficChangeRec &change);
+
+	// the subscriber's thread
+
+	int Read(int subscriberId, std::vector<struct trafficChangeRec> &changes,
+		unsigned int maxChanges = 0);
+	unsigned int GetNumDropped(int subscriberId);
+
+private:
+	struct subscriberRec
+	{
+		subscriberRec(unsigned int queueSize);
+
+		ChangeCallback callback;
+		void *context;
+
+		unsigned int kindMask;
+		unsigned int fieldMask;
+
+		SpscRing<struct trafficChangeRec> queue;
+		std::atomic<unsigned int> numDropped;
+	};
+
+	int AddSubscriber(struct subscriberRec *subscriberPtr);
+
+	// fixed so a queue subscriber's thread can look itself up while the
+	// decoding thread subscribes someone else, a free id is NULL
+
+	struct subscriberRec *mSubscribers[TRAFFIC_FEED_MAX_SUBSCRIBERS];
+
+	unsigned int mKindMask;  // every kind some subscriber wants
+};
+
+#endif // _TRAFFIC_FEED_H_
@@ -0,0 +1,382 @@
+//
+// TrafficFusion.cpp: merge traffic from several receivers
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <string.h>
+#include <time.h>
+#include <chrono>
+
+#include "TrafficFusion.h"
+#include "Gdl90Crc.h"
+#include "TrafficIndex.h"
+
+TrafficFusion::sourceRec::sourceRec() :
+	reports(TRAFFIC_FUSION_RING_SIZE)
+{
+	numCrcErrors.store(0);
+	numShortFrames.store(0);
+	numDroppedReports.store(0);
+}
+
+TrafficFusion::TrafficFusion(AdsbWrapper &fused, unsigned int numSources) :
+	mFused(fused)
+{
+	if (numSources == 0)
+	{
+		numSources = 1;
+	}
+	else if (numSources > TRAFFIC_FUSION_MAX_SOURCES)
+	{
+		numSources = TRAFFIC_FUSION_MAX_SOURCES;
+	}
+
+	for (unsigned int sourceId = 0; sourceId < numSources; sourceId++)
+	{
+		struct sourceRec *sourcePtr = new sourceRec;
+
+		sourcePtr->framer.SetFrameCallback(SourceFrameCallback, sourcePtr);
+
+		mSources.push_back(sourcePtr);
+	}
+
+	mHoldTime = TRAFFIC_FUSION_DEFAULT_HOLD_TIME;
+	mSeenByWindow = TRAFFIC_FUSION_DEFAULT_SEEN_BY_WINDOW;
+
+	mNumRejectedReports = 0;
+}
+
+TrafficFusion::~TrafficFusion()
+{
+	for (unsigned int sourceId = 0; sourceId < mSources.size(); sourceId++)
+	{
+		delete mSources[sourceId];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// raw bytes from one receiver, called only from that source's thread.
+// returns the number of complete frames found
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFusion::Feed(unsigned int sourceId, unsigned int dataLen, const char *dataPtr)
+{
+	if (sourceId >= mSources.size())
+	{
+		return(-1);
+	}
+	return(mSources[sourceId]->framer.Feed((const unsigned char *)dataPtr, dataLen));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a report the source has already decoded, called only from that source's
+// thread.  returns -1 if the source's ring is full
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFusion::Submit(unsigned int sourceId, const struct trafficReportRec &report)
+{
+	int status = -1;
+
+	if ((sourceId < mSources.size()) && (QueueReport(mSources[sourceId], report) == true))
+	{
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// merge up to maxReports queued reports, 0 for all of them.  returns the
+// number merged
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFusion::Poll(unsigned int maxReports)
+{
+	unsigned int numReports = 0;
+	bool foundReport = true;
+	struct fusionReportRec fusionReport;
+
+	if (maxReports == 0)
+	{
+		maxReports = 0xffffffff;
+	}
+
+	mFused.ExpireTraffic(mFused.GetClockTime());
+
+	// a report at a time from each source so none of them gets ahead
+
+	while ((foundReport == true) && (numReports < maxReports))
+	{
+		foundReport = false;
+
+		for (unsigned int sourceId = 0; (sourceId < mSources.size()) && (numReports < maxReports); sourceId++)
+		{
+			if (mSources[sourceId]->reports.Pop(fusionReport) == true)
+			{
+				MergeReport(sourceId, fusionReport);
+
+				numReports++;
+				foundReport = true;
+			}
+		}
+	}
+
+	return((int)numReports);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficFusion::SetHoldTime(unsigned int milliseconds)
+{
+	mHoldTime = milliseconds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficFusion::SetSeenByWindow(unsigned int milliseconds)
+{
+	mSeenByWindow = milliseconds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bit n is set if source n reported the target within the seen by window
+///////////////////////////////////////////////////////////////////////////////
+uint32_t TrafficFusion::GetSeenBy(unsigned char addressType, unsigned int participantAddr)
+{
+	uint32_t seenBy = 0;
+	struct fusionTargetRec *targetPtr = FindTarget(addressType, participantAddr);
+
+	if (targetPtr != NULL)
+	{
+		int64_t now = GetNow();
+
+		for (unsigned int sourceId = 0; sourceId < mSources.size(); sourceId++)
+		{
+			if ((targetPtr->seenTime[sourceId] > 0) &&
+				((now - targetPtr->seenTime[sourceId]) <= mSeenByWindow))
+			{
+				seenBy |= (1u << sourceId);
+			}
+		}
+	}
+	return(seenBy);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the source the fused position came from or -1
+///////////////////////////////////////////////////////////////////////////////
+int TrafficFusion::GetBestSource(unsigned char addressType, unsigned int participantAddr)
+{
+	int sourceId = -1;
+	struct fusionTargetRec *targetPtr = FindTarget(addressType, participantAddr);
+
+	if (targetPtr != NULL)
+	{
+		sourceId = targetPtr->bestSource;
+	}
+	return(sourceId);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficFusion::GetNumSources()
+{
+	return((unsigned int)mSources.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reports that lost out to a better receiver or a newer report
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficFusion::GetNumRejectedReports()
+{
+	return(mNumRejectedReports);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficFusion::GetNumCrcErrors(unsigned int sourceId)
+{
+	unsigned int numCrcErrors = 0;
+
+	if (sourceId < mSources.size())
+	{
+		numCrcErrors = mSources[sourceId]->numCrcErrors.load(std::memory_order_relaxed);
+	}
+	return(numCrcErrors);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficFusion::GetNumShortFrames(unsigned int sourceId)
+{
+	unsigned int numShortFrames = 0;
+
+	if (sourceId < mSources.size())
+	{
+		numShortFrames = mSources[sourceId]->numShortFrames.load(std::memory_order_relaxed);
+	}
+	return(numShortFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reports lost because Poll fell behind and the source's ring was full
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficFusion::GetNumDroppedReports(unsigned int sourceId)
+{
+	unsigned int numDroppedReports = 0;
+
+	if (sourceId < mSources.size())
+	{
+		numDroppedReports = mSources[sourceId]->numDroppedReports.load(std::memory_order_relaxed);
+	}
+	return(numDroppedReports);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// runs on the source's thread
+///////////////////////////////////////////////////////////////////////////////
+void TrafficFusion::SourceFrameCallback(void *context, unsigned char *frameBuf,
+	unsigned int frameSize)
+{
+	struct sourceRec *sourcePtr = (struct sourceRec *)context;
+	struct trafficReportRec report;
+
+	if (Gdl90CrcCheck(frameBuf, frameSize) != 0)
+	{
+		sourcePtr->numCrcErrors.fetch_add(1, std::memory_order_relaxed);
+
+		return;
+	}
+
+	// a truncated report would carry garbage integrity and accuracy codes
+	// and could win the merge
+
+	if (Gdl90LengthCheck(frameBuf, frameSize) != 0)
+	{
+		sourcePtr->numShortFrames.fetch_add(1, std::memory_order_relaxed);
+
+		return;
+	}
+
+	if (AdsbWrapper::DecodeTrafficReport(frameSize, &frameBuf[1], report) == 0)
+	{
+		QueueReport(sourcePtr, report);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int64_t TrafficFusion::GetNow()
+{
+	return(std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TrafficFusion::QueueReport(struct sourceRec *sourcePtr,
+	const struct trafficReportRec &report)
+{
+	struct fusionReportRec fusionReport;
+
+	fusionReport.report = report;
+	fusionReport.receiveTime = GetNow();
+
+	if (sourcePtr->reports.Push(fusionReport) == false)
+	{
+		sourcePtr->numDroppedReports.fetch_add(1, std::memory_order_relaxed);
+
+		return(false);
+	}
+	return(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficFusion::MergeReport(unsigned int sourceId, const struct fusionReportRec &fusionReport)
+{
+	const struct trafficReportRec &report = fusionReport.report;
+	struct fusionTargetRec *targetPtr = FindTarget(report.addressType, report.participantAddr);
+	bool accept = true;
+
+	if (targetPtr != NULL)
+	{
+		bool sameSource = (targetPtr->bestSource == sourceId);
+		bool atLeastAsGood = (report.integrityCode > targetPtr->integrityCode) ||
+			((report.integrityCode == targetPtr->integrityCode) &&
+			(report.accuracyCode >= targetPtr->accuracyCode));
+		bool bestIsStale = ((fusionReport.receiveTime - targetPtr->acceptTime) > mHoldTime);
+
+		// Poll takes the sources in turn, a source that is behind would
+		// otherwise put an older position over a newer one
+
+		bool isOlder = (fusionReport.receiveTime < targetPtr->acceptTime);
+
+		accept = sameSource || ((isOlder == false) && (atLeastAsGood || bestIsStale));
+
+		targetPtr->seenTime[sourceId] = fusionReport.receiveTime;
+	}
+
+	if (accept == false)
+	{
+		mNumRejectedReports++;
+
+		return;
+	}
+
+	int dataIndex = mFused.StoreTrafficReport(report);
+	int slotId = mFused.GetSlotId(dataIndex);
+
+	if (slotId < 0)
+	{
+		return;
+	}
+
+	if (slotId >= (int)mTargets.size())
+	{
+		mTargets.resize(slotId + 1);
+	}
+
+	unsigned long long addressKey = TrafficIndex::MakeAddressKey(report.addressType,
+		report.participantAddr);
+
+	if ((targetPtr == NULL) || (targetPtr != &mTargets[slotId]))
+	{
+		// a new target, or one that expired and came back in another slot
+
+		memset(&mTargets[slotId], 0, sizeof(struct fusionTargetRec));
+
+		mTargets[slotId].addressKey = addressKey;
+	}
+
+	targetPtr = &mTargets[slotId];
+
+	targetPtr->acceptTime = fusionReport.receiveTime;
+	targetPtr->seenTime[sourceId] = fusionReport.receiveTime;
+	targetPtr->integrityCode = report.integrityCode;
+	targetPtr->accuracyCode = report.accuracyCode;
+	targetPtr->bestSource = (uint8_t)sourceId;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the fusion state for a target still in the fused table, or NULL
+///////////////////////////////////////////////////////////////////////////////
+struct TrafficFusion::fusionTargetRec *TrafficFusion::FindTarget(unsigned char addressType,
+	unsigned int participantAddr)
+{
+	int dataIndex = mFused.GetDataIndex(addressType, participantAddr);
+	int slotId = mFused.GetSlotId(dataIndex);
+
+	if ((slotId < 0) || (slotId >= (int)mTargets.size()))
+	{
+		return(NULL);
+	}
+
+	struct fusionTargetRec *targetPtr = &mTargets[slotId];
+
+	if (targetPtr->addressKey != TrafficIndex::MakeAddressKey(addressType, participantAddr))
+	{
+		return(NULL);
+	}
+	return(targetPtr);
+}
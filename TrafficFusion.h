@@ -0,0 +1,135 @@
+//
+// TrafficFusion.h: merge traffic from several receivers
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _TRAFFIC_FUSION_H_
+#define _TRAFFIC_FUSION_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "AdsbWrapper.h"
+#include "Gdl90Framer.h"
+#include "SpscRing.h"
+#include "TrafficReport.h"
+
+#define TRAFFIC_FUSION_MAX_SOURCES 32
+#define TRAFFIC_FUSION_RING_SIZE 4096
+
+// milliseconds a better quality receiver keeps a target before a lower
+// quality one can take over, and how long a receiver counts as seeing a
+// target after its last report
+
+#define TRAFFIC_FUSION_DEFAULT_HOLD_TIME 3000
+#define TRAFFIC_FUSION_DEFAULT_SEEN_BY_WINDOW 10000
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficFusion merges the ownship and traffic reports from several
+// receivers with overlapping coverage into one AdsbWrapper, one entry per
+// (address type, participant address).
+//
+// each receiver is a source with its own framer and its own SpscRing, Feed
+// or Submit for a source is called from that source's thread so every source
+// frames, checks and decodes in parallel.  the thread calling Poll merges the
+// queued reports and owns the fused AdsbWrapper.
+//
+// a report replaces the fused target when it comes from the receiver that
+// supplied the current position, or when it was received no earlier than
+// the current position and either its integrity and accuracy codes are at
+// least as good or the current receiver hasn't updated the target for the
+// hold time.  every report, used or not, marks the source as seeing
+// the target, see GetSeenBy.  other message types are not fused
+///////////////////////////////////////////////////////////////////////////////
+class TrafficFusion
+{
+public:
+	TrafficFusion(AdsbWrapper &fused, unsigned int numSources);
+	~TrafficFusion();
+
+	// source threads
+
+	int Feed(unsigned int sourceId, unsigned int dataLen, const char *dataPtr);
+	int Submit(unsigned int sourceId, const struct trafficReportRec &report);
+
+	// fusion thread
+
+	int Poll(unsigned int maxReports = 0);
+
+	void SetHoldTime(unsigned int milliseconds);
+	void SetSeenByWindow(unsigned int milliseconds);
+
+	uint32_t GetSeenBy(unsigned char addressType, unsigned int participantAddr);
+	int GetBestSource(unsigned char addressType, unsigned int participantAddr);
+
+	unsigned int GetNumSources();
+	unsigned int GetNumRejectedReports();
+	unsigned int GetNumCrcErrors(unsigned int sourceId);
+	unsigned int GetNumShortFrames(unsigned int sourceId);
+	unsigned int GetNumDroppedReports(unsigned int sourceId);
+
+private:
+	struct fusionReportRec
+	{
+		struct trafficReportRec report;
+		int64_t receiveTime;  // milliseconds, steady clock
+	};
+
+	struct sourceRec
+	{
+		sourceRec();
+
+		Gdl90Framer framer;
+		SpscRing<struct fusionReportRec> reports;
+
+		std::atomic<unsigned int> numCrcErrors;
+		std::atomic<unsigned int> numShortFrames;
+		std::atomic<unsigned int> numDroppedReports;
+	};
+
+	// per fused target, indexed by the fused AdsbWrapper's slot id
+
+	struct fusionTargetRec
+	{
+		unsigned long long addressKey;  // catches a slot id that was reused
+		int64_t acceptTime;
+		int64_t seenTime[TRAFFIC_FUSION_MAX_SOURCES];
+		uint8_t integrityCode;
+		uint8_t accuracyCode;
+		uint8_t bestSource;
+	};
+
+	static void SourceFrameCallback(void *context, unsigned char *frameBuf,
+		unsigned int frameSize);
+	static int64_t GetNow();
+	static bool QueueReport(struct sourceRec *sourcePtr,
+		const struct trafficReportRec &report);
+
+	void MergeReport(unsigned int sourceId, const struct fusionReportRec &fusionReport);
+	struct fusionTargetRec *FindTarget(unsigned char addressType, unsigned int participantAddr);
+
+	AdsbWrapper &mFused;
+
+	std::vector<struct sourceRec *> mSources;
+	std::vector<struct fusionTargetRec> mTargets;
+
+	unsigned int mHoldTime;
+	unsigned int mSeenByWindow;
+
+	unsigned int mNumRejectedReports;
+};
+
+#endif // _TRAFFIC_FUSION_H_
@@ -0,0 +1,466 @@
+//
+// TrafficGrid.cpp: lat/lon grid index for traffic targets
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <math.h>
+#include <algorithm>
+
+#include "TrafficGrid.h"
+
+#define TRAFFIC_GRID_PI 3.14159265358979323846
+#define TRAFFIC_GRID_DEG_TO_RAD (TRAFFIC_GRID_PI / 180.0)
+
+///////////////////////////////////////////////////////////////////////////////
+// longitudes are kept in [-180, 180)
+///////////////////////////////////////////////////////////////////////////////
+static double NormalizeLongitude(double longitude)
+{
+	if ((longitude < -180.0) || (longitude >= 180.0))
+	{
+		longitude = fmod(longitude + 180.0, 360.0);
+
+		if (longitude < 0.0)
+		{
+			longitude += 360.0;
+		}
+		longitude -= 180.0;
+	}
+	return(longitude);
+}
+
+TrafficGrid::TrafficGrid(double cellSize)
+{
+	if (cellSize <= 0.0)
+	{
+		cellSize = TRAFFIC_GRID_DEFAULT_CELL_SIZE;
+	}
+
+	mCellSize = cellSize;
+	mNumLatCells = (int)ceil(180.0 / cellSize);
+	mNumLonCells = (int)ceil(360.0 / cellSize);
+
+	mCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// add slotId to the grid or move it to its new position
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::Update(int slotId, double latitude, double longitude)
+{
+	if (slotId < 0)
+	{
+		return;
+	}
+
+	if (slotId >= (int)mCell.size())
+	{
+		mCell.resize(slotId + 1, -1);
+		mNext.resize(slotId + 1, -1);
+		mPrev.resize(slotId + 1, -1);
+		mLatitude.resize(slotId + 1, 0.0);
+		mLongitude.resize(slotId + 1, 0.0);
+	}
+
+	longitude = NormalizeLongitude(longitude);
+
+	long long cell = ((long long)GetLatitudeCell(latitude) * mNumLonCells) +
+		GetLongitudeCell(longitude);
+
+	if (mCell[slotId] != cell)
+	{
+		if (mCell[slotId] < 0)
+		{
+			mCount++;
+		}
+		else
+		{
+			Unlink(slotId);
+		}
+		Link(slotId, cell);
+	}
+
+	mLatitude[slotId] = latitude;
+	mLongitude[slotId] = longitude;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::Remove(int slotId)
+{
+	if ((slotId >= 0) && (slotId < (int)mCell.size()) && (mCell[slotId] >= 0))
+	{
+		Unlink(slotId);
+
+		mCount--;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::Clear()
+{
+	mCellHead.Clear();
+
+	mCell.clear();
+	mNext.clear();
+	mPrev.clear();
+	mLatitude.clear();
+	mLongitude.clear();
+
+	mCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// make room for slot ids below numSlots so Update never allocates
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::Reserve(unsigned int numSlots)
+{
+	mCellHead.Reserve(numSlots);
+
+	mCell.reserve(numSlots);
+	mNext.reserve(numSlots);
+	mPrev.reserve(numSlots);
+	mLatitude.reserve(numSlots);
+	mLongitude.reserve(numSlots);
+
+	mCandidates.reserve(numSlots);
+	mNearest.reserve(numSlots);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficGrid::GetCount()
+{
+	return(mCount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append the slot ids inside the box, returns the number appended
+///////////////////////////////////////////////////////////////////////////////
+int TrafficGrid::QueryBox(double minLatitude, double minLongitude,
+	double maxLatitude, double maxLongitude, std::vector<int> &slotIds)
+{
+	unsigned int startSize = (unsigned int)slotIds.size();
+
+	if ((minLatitude > maxLatitude) || (mCount == 0))
+	{
+		return(0);
+	}
+
+	int firstLonCell = 0;
+	int numLonCells = mNumLonCells;
+
+	if ((maxLongitude - minLongitude) >= 360.0)
+	{
+		minLongitude = -180.0;
+		maxLongitude = 180.0;
+	}
+	else
+	{
+		minLongitude = NormalizeLongitude(minLongitude);
+		maxLongitude = NormalizeLongitude(maxLongitude);
+
+		firstLonCell = GetLongitudeCell(minLongitude);
+
+		int lastLonCell = GetLongitudeCell(maxLongitude);
+
+		numLonCells = (((lastLonCell - firstLonCell) + mNumLonCells) % mNumLonCells) + 1;
+	}
+
+	int minLatCell = GetLatitudeCell(minLatitude);
+	int maxLatCell = GetLatitudeCell(maxLatitude);
+
+	double numCells = (double)((maxLatCell - minLatCell) + 1) * numLonCells;
+
+	if (numCells > mCount)
+	{
+		// mostly empty cells, cheaper to look at every target
+
+		for (int slotId = 0; slotId < (int)mCell.size(); slotId++)
+		{
+			if ((mCell[slotId] >= 0) &&
+				(InBox(slotId, minLatitude, minLongitude, maxLatitude, maxLongitude) == true))
+			{
+				slotIds.push_back(slotId);
+			}
+		}
+	}
+	else
+	{
+		for (int latCell = minLatCell; latCell <= maxLatCell; latCell++)
+		{
+			for (int lonIndex = 0; lonIndex < numLonCells; lonIndex++)
+			{
+				int lonCell = (firstLonCell + lonIndex) % mNumLonCells;
+
+				AddCellTargets(((long long)latCell * mNumLonCells) + lonCell,
+					minLatitude, minLongitude, maxLatitude, maxLongitude, slotIds);
+			}
+		}
+	}
+
+	return((int)(slotIds.size() - startSize));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append the slot ids within radiusNm, returns the number appended
+///////////////////////////////////////////////////////////////////////////////
+int TrafficGrid::QueryRadius(double latitude, double longitude, double radiusNm,
+	std::vector<int> &slotIds)
+{
+	unsigned int startSize = (unsigned int)slotIds.size();
+
+	if (radiusNm < 0.0)
+	{
+		return(0);
+	}
+
+	// bounding box of the circle, when it reaches a pole every longitude
+	// is in range
+
+	double angle = radiusNm / TRAFFIC_GRID_EARTH_RADIUS_NM;
+	double latitudeDelta = angle / TRAFFIC_GRID_DEG_TO_RAD;
+
+	double minLatitude = latitude - latitudeDelta;
+	double maxLatitude = latitude + latitudeDelta;
+	double minLongitude = -180.0;
+	double maxLongitude = 180.0;
+
+	if ((minLatitude > -90.0) && (maxLatitude < 90.0))
+	{
+		double longitudeDelta = asin(sin(angle) / cos(latitude * TRAFFIC_GRID_DEG_TO_RAD)) /
+			TRAFFIC_GRID_DEG_TO_RAD;
+
+		minLongitude = longitude - longitudeDelta;
+		maxLongitude = longitude + longitudeDelta;
+	}
+
+	QueryBox(minLatitude, minLongitude, maxLatitude, maxLongitude, slotIds);
+
+	// drop the corners of the box
+
+	unsigned int numKept = startSize;
+
+	for (unsigned int index = startSize; index < slotIds.size(); index++)
+	{
+		if (GetDistance(slotIds[index], latitude, longitude) <= radiusNm)
+		{
+			slotIds[numKept] = slotIds[index];
+			numKept++;
+		}
+	}
+	slotIds.resize(numKept);
+
+	return((int)(numKept - startSize));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append up to maxTargets slot ids nearest first, returns the number appended.
+// the search radius starts at about a cell and doubles until it holds enough
+// targets, anything outside the radius is further away than everything in it
+///////////////////////////////////////////////////////////////////////////////
+int TrafficGrid::QueryNearest(double latitude, double longitude, unsigned int maxTargets,
+	std::vector<int> &slotIds)
+{
+	if ((maxTargets == 0) || (mCount == 0))
+	{
+		return(0);
+	}
+
+	double radiusNm = mCellSize * 60.0;
+	double maxRadiusNm = TRAFFIC_GRID_PI * TRAFFIC_GRID_EARTH_RADIUS_NM;
+
+	while (true)
+	{
+		mCandidates.clear();
+
+		QueryRadius(latitude, longitude, radiusNm, mCandidates);
+
+		if ((mCandidates.size() >= maxTargets) || (radiusNm >= maxRadiusNm))
+		{
+			break;
+		}
+		radiusNm *= 2.0;
+	}
+
+	mNearest.clear();
+
+	for (unsigned int index = 0; index < mCandidates.size(); index++)
+	{
+		mNearest.push_back(std::make_pair(GetDistance(mCandidates[index], latitude, longitude),
+			mCandidates[index]));
+	}
+
+	unsigned int numNearest = std::min(maxTargets, (unsigned int)mNearest.size());
+
+	std::partial_sort(mNearest.begin(), mNearest.begin() + numNearest, mNearest.end());
+
+	for (unsigned int index = 0; index < numNearest; index++)
+	{
+		slotIds.push_back(mNearest[index].second);
+	}
+
+	return((int)numNearest);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// nautical miles from the target to the point, -1 if the slot isn't in the grid
+///////////////////////////////////////////////////////////////////////////////
+double TrafficGrid::GetDistance(int slotId, double latitude, double longitude)
+{
+	if ((slotId < 0) || (slotId >= (int)mCell.size()) || (mCell[slotId] < 0))
+	{
+		return(-1.0);
+	}
+	return(GetDistance(mLatitude[slotId], mLongitude[slotId], latitude, longitude));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// great circle distance in nautical miles using the haversine formula
+///////////////////////////////////////////////////////////////////////////////
+double TrafficGrid::GetDistance(double latitude1, double longitude1,
+	double latitude2, double longitude2)
+{
+	double sinHalfLat = sin((latitude2 - latitude1) * TRAFFIC_GRID_DEG_TO_RAD * 0.5);
+	double sinHalfLon = sin((longitude2 - longitude1) * TRAFFIC_GRID_DEG_TO_RAD * 0.5);
+
+	double a = (sinHalfLat * sinHalfLat) +
+		(cos(latitude1 * TRAFFIC_GRID_DEG_TO_RAD) * cos(latitude2 * TRAFFIC_GRID_DEG_TO_RAD) *
+		sinHalfLon * sinHalfLon);
+
+	if (a > 1.0)
+	{
+		a = 1.0;
+	}
+
+	return(2.0 * asin(sqrt(a)) * TRAFFIC_GRID_EARTH_RADIUS_NM);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficGrid::GetLatitudeCell(double latitude)
+{
+	int latCell = (int)floor((latitude + 90.0) / mCellSize);
+
+	if (latCell < 0)
+	{
+		latCell = 0;
+	}
+	else if (latCell >= mNumLatCells)
+	{
+		latCell = mNumLatCells - 1;
+	}
+	return(latCell);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// longitude must already be normalized
+///////////////////////////////////////////////////////////////////////////////
+int TrafficGrid::GetLongitudeCell(double longitude)
+{
+	int lonCell = (int)floor((longitude + 180.0) / mCellSize);
+
+	if (lonCell < 0)
+	{
+		lonCell = 0;
+	}
+	else if (lonCell >= mNumLonCells)
+	{
+		lonCell = mNumLonCells - 1;
+	}
+	return(lonCell);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::Link(int slotId, long long cell)
+{
+	int headSlotId = mCellHead.Find((unsigned long long)cell);
+
+	mPrev[slotId] = -1;
+	mNext[slotId] = headSlotId;
+
+	if (headSlotId >= 0)
+	{
+		mPrev[headSlotId] = slotId;
+	}
+
+	mCellHead.Insert((unsigned long long)cell, slotId);
+
+	mCell[slotId] = cell;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::Unlink(int slotId)
+{
+	long long cell = mCell[slotId];
+
+	if (mPrev[slotId] >= 0)
+	{
+		mNext[mPrev[slotId]] = mNext[slotId];
+	}
+	else if (mNext[slotId] >= 0)
+	{
+		mCellHead.Insert((unsigned long long)cell, mNext[slotId]);
+	}
+	else
+	{
+		// last one out, the cell goes away
+
+		mCellHead.Remove((unsigned long long)cell);
+	}
+
+	if (mNext[slotId] >= 0)
+	{
+		mPrev[mNext[slotId]] = mPrev[slotId];
+	}
+
+	mNext[slotId] = -1;
+	mPrev[slotId] = -1;
+	mCell[slotId] = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficGrid::AddCellTargets(long long cell, double minLatitude, double minLongitude,
+	double maxLatitude, double maxLongitude, std::vector<int> &slotIds)
+{
+	int slotId = mCellHead.Find((unsigned long long)cell);
+
+	while (slotId >= 0)
+	{
+		if (InBox(slotId, minLatitude, minLongitude, maxLatitude, maxLongitude) == true)
+		{
+			slotIds.push_back(slotId);
+		}
+		slotId = mNext[slotId];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the box longitudes are normalized, minLongitude > maxLongitude wraps
+///////////////////////////////////////////////////////////////////////////////
+bool TrafficGrid::InBox(int slotId, double minLatitude, double minLongitude,
+	double maxLatitude, double maxLongitude)
+{
+	double latitude = mLatitude[slotId];
+	double longitude = mLongitude[slotId];
+
+	if ((latitude < minLatitude) || (latitude > maxLatitude))
+	{
+		return(false);
+	}
+
+	if (minLongitude <= maxLongitude)
+	{
+		return((longitude >= minLongitude) && (longitude <= maxLongitude));
+	}
+	return((longitude >= minLongitude) || (longitude <= maxLongitude));
+}
@@ -0,0 +1,102 @@
+//
+// TrafficGrid.h: lat/lon grid index for traffic targets
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _TRAFFIC_GRID_H_
+#define _TRAFFIC_GRID_H_
+
+#include <utility>
+#include <vector>
+
+#include "TrafficIndex.h"
+
+#define TRAFFIC_GRID_DEFAULT_CELL_SIZE 0.5  // degrees
+#define TRAFFIC_GRID_EARTH_RADIUS_NM 3440.065
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficGrid buckets traffic store slot ids into fixed size lat/lon cells
+// so area queries only look at the targets in the cells they overlap.
+//
+// only occupied cells exist, a TrafficIndex maps the cell number to the
+// first slot id in the cell and the rest of the cell is an intrusive doubly
+// linked list through the slot ids, so moving a target from one cell to
+// another is O(1).  the grid keeps its own copy of each position so queries
+// can filter exactly without going back to the traffic store.
+//
+// queries append slot ids.  a box with minLongitude > maxLongitude crosses
+// the 180 degree meridian, radius queries are great circle distances in
+// nautical miles
+///////////////////////////////////////////////////////////////////////////////
+class TrafficGrid
+{
+public:
+	TrafficGrid(double cellSize = TRAFFIC_GRID_DEFAULT_CELL_SIZE);
+
+	void Update(int slotId, double latitude, double longitude);
+	void Remove(int slotId);
+	void Clear();
+	void Reserve(unsigned int numSlots);
+
+	unsigned int GetCount();
+
+	int QueryBox(double minLatitude, double minLongitude,
+		double maxLatitude, double maxLongitude, std::vector<int> &slotIds);
+	int QueryRadius(double latitude, double longitude, double radiusNm,
+		std::vector<int> &slotIds);
+	int QueryNearest(double latitude, double longitude, unsigned int maxTargets,
+		std::vector<int> &slotIds);
+
+	double GetDistance(int slotId, double latitude, double longitude);
+
+	static double GetDistance(double latitude1, double longitude1,
+		double latitude2, double longitude2);
+
+private:
+	int GetLatitudeCell(double latitude);
+	int GetLongitudeCell(double longitude);
+
+	void Link(int slotId, long long cell);
+	void Unlink(int slotId);
+
+	void AddCellTargets(long long cell, double minLatitude, double minLongitude,
+		double maxLatitude, double maxLongitude, std::vector<int> &slotIds);
+
+	bool InBox(int slotId, double minLatitude, double minLongitude,
+		double maxLatitude, double maxLongitude);
+
+	double mCellSize;
+	int mNumLatCells;
+	int mNumLonCells;
+
+	TrafficIndex mCellHead;
+
+	// per slot id, mCell is -1 when the slot isn't in the grid
+
+	std::vector<long long> mCell;
+	std::vector<int> mNext;
+	std::vector<int> mPrev;
+	std::vector<double> mLatitude;
+	std::vector<double> mLongitude;
+
+	unsigned int mCount;
+
+	// scratch for QueryNearest
+
+	std::vector<int> mCandidates;
+	std::vector<std::pair<double, int> > mNearest;
+};
+
+#endif // _TRAFFIC_GRID_H_
@@ -0,0 +1,223 @@
+//
+// TrafficIndex.cpp: open addressing hash index for traffic targets
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include "TrafficIndex.h"
+
+TrafficIndex::TrafficIndex(unsigned int initialCapacity)
+{
+	unsigned int capacity = 16;
+
+	mShift = 64 - 4;
+
+	while (capacity < initialCapacity)
+	{
+		capacity <<= 1;
+		mShift--;
+	}
+
+	mKeys.assign(capacity, 0);
+	mDataIndexes.assign(capacity, -1);
+
+	mMask = capacity - 1;
+	mCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fibonacci hashing, the top bits of the product are the best mixed
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficIndex::GetHomeSlot(unsigned long long key)
+{
+	return((unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> mShift));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns the data index for key or -1 if it isn't in the index
+///////////////////////////////////////////////////////////////////////////////
+int TrafficIndex::Find(unsigned long long key)
+{
+	unsigned int slot = GetHomeSlot(key);
+
+	while (mDataIndexes[slot] >= 0)
+	{
+		if (mKeys[slot] == key)
+		{
+			return(mDataIndexes[slot]);
+		}
+		slot = (slot + 1) & mMask;
+	}
+
+	return(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// adds key or replaces the data index already stored for it
+///////////////////////////////////////////////////////////////////////////////
+void TrafficIndex::Insert(unsigned long long key, int dataIndex)
+{
+	if (((mCount + 1) * 2) > (mMask + 1))
+	{
+		Grow();
+	}
+
+	unsigned int slot = GetHomeSlot(key);
+
+	while (mDataIndexes[slot] >= 0)
+	{
+		if (mKeys[slot] == key)
+		{
+			mDataIndexes[slot] = dataIndex;
+
+			return;
+		}
+		slot = (slot + 1) & mMask;
+	}
+
+	mKeys[slot] = key;
+	mDataIndexes[slot] = dataIndex;
+
+	mCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns the data index that was removed or -1 if key wasn't found
+///////////////////////////////////////////////////////////////////////////////
+int TrafficIndex::Remove(unsigned long long key)
+{
+	int dataIndex = -1;
+	unsigned int slot = GetHomeSlot(key);
+
+	while (mDataIndexes[slot] >= 0)
+	{
+		if (mKeys[slot] == key)
+		{
+			dataIndex = mDataIndexes[slot];
+			break;
+		}
+		slot = (slot + 1) & mMask;
+	}
+
+	if (dataIndex < 0)
+	{
+		return(dataIndex);
+	}
+
+	// pull back any entry further along the run that would no longer be
+	// reachable from its home slot once this slot is empty
+
+	unsigned int holeSlot = slot;
+	unsigned int nextSlot = (slot + 1) & mMask;
+
+	while (mDataIndexes[nextSlot] >= 0)
+	{
+		unsigned int homeSlot = GetHomeSlot(mKeys[nextSlot]);
+
+		if (((nextSlot - homeSlot) & mMask) >= ((nextSlot - holeSlot) & mMask))
+		{
+			mKeys[holeSlot] = mKeys[nextSlot];
+			mDataIndexes[holeSlot] = mDataIndexes[nextSlot];
+
+			holeSlot = nextSlot;
+		}
+		nextSlot = (nextSlot + 1) & mMask;
+	}
+
+	mDataIndexes[holeSlot] = -1;
+
+	mCount--;
+
+	return(dataIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficIndex::Clear()
+{
+	mDataIndexes.assign(mDataIndexes.size(), -1);
+
+	mCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// size the table up front so inserting up to numKeys keys never grows it
+///////////////////////////////////////////////////////////////////////////////
+void TrafficIndex::Reserve(unsigned int numKeys)
+{
+	while ((numKeys * 2) > (mMask + 1))
+	{
+		Grow();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficIndex::GetCount()
+{
+	return(mCount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficIndex::Grow()
+{
+	std::vector<unsigned long long> oldKeys;
+	std::vector<int> oldDataIndexes;
+
+	oldKeys.swap(mKeys);
+	oldDataIndexes.swap(mDataIndexes);
+
+	unsigned int capacity = (unsigned int)oldKeys.size() * 2;
+
+	mKeys.assign(capacity, 0);
+	mDataIndexes.assign(capacity, -1);
+
+	mMask = capacity - 1;
+	mShift--;
+	mCount = 0;
+
+	for (unsigned int slot = 0; slot < oldKeys.size(); slot++)
+	{
+		if (oldDataIndexes[slot] >= 0)
+		{
+			Insert(oldKeys[slot], oldDataIndexes[slot]);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned long long TrafficIndex::MakeAddressKey(unsigned char addressType,
+	unsigned int participantAddr)
+{
+	return(((unsigned long long)addressType << 24) | (participantAddr & 0x00FFFFFF));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GDL90 callsigns are 8 characters so the whole callsign fits in the key,
+// anything past 8 characters is ignored
+///////////////////////////////////////////////////////////////////////////////
+unsigned long long TrafficIndex::MakeCallsignKey(const char *callsign,
+	unsigned int length)
+{
+	unsigned long long key = 0;
+
+	if (length > 8)
+	{
+		length = 8;
+	}
+
+	for (unsigned int index = 0; index < length; index++)
+	{
+		key = (key << 8) | (unsigned char)callsign[index];
+	}
+
+	return(key);
+}
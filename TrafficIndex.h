@@ -0,0 +1,62 @@
+//
+// TrafficIndex.h: open addressing hash index for traffic targets
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _TRAFFIC_INDEX_H_
+#define _TRAFFIC_INDEX_H_
+
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficIndex maps a 64 bit key to a non-negative data index using linear
+// probing in a power of two table that is kept at most half full.  removal
+// shifts the rest of the probe run back so there are no tombstones and
+// lookups stay short no matter how many targets have come and gone.
+//
+// targets are keyed on (address type, participant address) with
+// MakeAddressKey, the up to 8 character callsign packs into a key of its own
+// with MakeCallsignKey
+///////////////////////////////////////////////////////////////////////////////
+class TrafficIndex
+{
+public:
+	TrafficIndex(unsigned int initialCapacity = 64);
+
+	int Find(unsigned long long key);
+	void Insert(unsigned long long key, int dataIndex);
+	int Remove(unsigned long long key);
+	void Clear();
+	void Reserve(unsigned int numKeys);
+
+	unsigned int GetCount();
+
+	static unsigned long long MakeAddressKey(unsigned char addressType,
+		unsigned int participantAddr);
+	static unsigned long long MakeCallsignKey(const char *callsign,
+		unsigned int length);
+
+private:
+	unsigned int GetHomeSlot(unsigned long long key);
+	void Grow();
+
+	std::vector<unsigned long long> mKeys;
+	std::vector<int> mDataIndexes;  // -1 marks an empty slot
+
+	unsigned int mMask;
+	unsigned int mShift;
+	unsigned int mCount;
+};
+
+#endif // _TRAFFIC_INDEX_H_
@@ -0,0 +1,178 @@
+//
+// TrafficRecord.h: binary record format for decoded traffic
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _TRAFFIC_RECORD_H_
+#define _TRAFFIC_RECORD_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "CaptureFile.h"
+#include "TrafficReport.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// decoded state goes out as a stream of fixed width little endian records so
+// a consumer on the other end of a pipe or socket can read numbers straight
+// back out without parsing text.  every record starts with the same header:
+//
+//   record header  8 bytes
+//     0   uint8     record type, trafficRecordKinds
+//     1   uint8     TRAFFIC_RECORD_VERSION it was written with
+//     2   uint16    record size including the header
+//     4   uint32    sequence number, one more than the record before it
+//
+//   stream header  TRAFFIC_RECORD_STREAM_HEADER_SIZE, first in a stream and
+//                  again when the writer starts over, forget every target
+//                  read before it
+//     8   char[8]   TRAFFIC_RECORD_MAGIC
+//
+//   heartbeat      TRAFFIC_RECORD_HEARTBEAT_SIZE
+//     8   uint32    timestamp, seconds since midnight UTC
+//     12  uint16    message counts
+//     14  uint8     status byte 1
+//     15  uint8     status byte 2
+//
+//   ahrs           TRAFFIC_RECORD_AHRS_SIZE
+//     8   float32   roll, degrees
+//     12  float32   pitch, degrees
+//     16  float32   heading, degrees
+//     20  uint16    indicated airspeed, knots
+//     22  uint16    true airspeed, knots
+//     24  uint8     message id it was decoded from
+//     25  uint8     sub message id
+//     26  uint8     1 if the heading is true rather than magnetic
+//     27  uint8[5]  reserved
+//
+//   traffic        TRAFFIC_RECORD_TRAFFIC_SIZE
+//     8   float64   latitude
+//     16  float64   longitude
+//     24  int64     last update
+//     32  uint32    participant address
+//     36  int32     altitude, feet
+//     40  int32     horizontal velocity, knots
+//     44  int32     vertical velocity, feet per minute
+//     48  float32   track or heading
+//     52  float32   range
+//     56  float32   bearing
+//     60  int32     slot id, -1 if not from a traffic store
+//     64  uint8     message id, address type, alert status, misc indicators,
+//                   integrity code, accuracy code, emitter category and
+//                   emergency priority code, one byte each
+//     72  char[8]   callsign, 0 padded
+//
+//   traffic removed  TRAFFIC_RECORD_REMOVED_SIZE
+//     8   uint32    participant address
+//     12  uint8     address type
+//     13  uint8[3]  reserved
+//
+// a later version only ever adds fields to the end of a record, so a reader
+// uses the size to step over what it doesn't know and over record types it
+// has never heard of
+///////////////////////////////////////////////////////////////////////////////
+
+#define TRAFFIC_RECORD_MAGIC "GDL90REC"
+#define TRAFFIC_RECORD_VERSION 1
+
+#define TRAFFIC_RECORD_HEADER_SIZE 8
+#define TRAFFIC_RECORD_STREAM_HEADER_SIZE 16
+#define TRAFFIC_RECORD_HEARTBEAT_SIZE 16
+#define TRAFFIC_RECORD_AHRS_SIZE 32
+#define TRAFFIC_RECORD_TRAFFIC_SIZE 80
+#define TRAFFIC_RECORD_REMOVED_SIZE 16
+
+#define TRAFFIC_RECORD_MAX_SIZE 0xffff
+
+enum trafficRecordKinds
+{
+	trafficRecordStreamHeader = 0,
+	trafficRecordHeartbeat = 1,
+	trafficRecordAhrs = 2,
+	trafficRecordTraffic = 3,
+	trafficRecordRemoved = 4
+};
+
+struct heartbeatRecordRec
+{
+	uint32_t timestamp;
+	uint16_t msgCounts;
+	uint8_t statusByte1;
+	uint8_t statusByte2;
+};
+
+struct ahrsRecordRec
+{
+	float roll;
+	float pitch;
+	float heading;
+	uint16_t indicatedAirspeed;
+	uint16_t trueAirspeed;
+	uint8_t msgId;
+	uint8_t subMsgId;
+	uint8_t headingIsTrue;
+};
+
+struct trafficRecordRec
+{
+	struct trafficReportRec report;
+
+	float range;
+	float bearing;
+	int32_t slotId;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+inline void TrafficRecordPutFloat(unsigned char *dataBuf, float value)
+{
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	CapturePutUint32(dataBuf, bits);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline void TrafficRecordPutDouble(unsigned char *dataBuf, double value)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	CapturePutUint64(dataBuf, bits);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline float TrafficRecordGetFloat(const unsigned char *dataBuf)
+{
+	uint32_t bits = CaptureGetUint32(dataBuf);
+	float value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return(value);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline double TrafficRecordGetDouble(const unsigned char *dataBuf)
+{
+	uint64_t bits = CaptureGetUint64(dataBuf);
+	double value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return(value);
+}
+
+#endif // _TRAFFIC_RECORD_H_
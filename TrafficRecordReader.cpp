@@ -0,0 +1,243 @@
+//
+// TrafficRecordReader.cpp: reads binary traffic records from a buffer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include "TrafficRecordReader.h"
+
+TrafficRecordReader::TrafficRecordReader()
+{
+	mDataBuf = NULL;
+	mDataLen = 0;
+	mConsumed = 0;
+
+	mRecordBuf = NULL;
+	mBroken = false;
+
+	mNextSequence = 0;
+	mHaveSequence = false;
+
+	mNumMissed = 0;
+	mNumErrors = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// dataBuf has to stay put until the records in it have been read
+///////////////////////////////////////////////////////////////////////////////
+void TrafficRecordReader::SetBuffer(const unsigned char *dataBuf, unsigned int dataLen)
+{
+	mDataBuf = dataBuf;
+	mDataLen = (dataBuf != NULL) ? dataLen : 0;
+	mConsumed = 0;
+
+	mRecordBuf = NULL;
+	mBroken = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// step to the next whole record and return its type, trafficRecordKinds or
+// something newer.  returns -1 when there is no whole record left
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordReader::Next()
+{
+	mRecordBuf = NULL;
+
+	if ((mBroken == true) || ((mDataLen - mConsumed) < TRAFFIC_RECORD_HEADER_SIZE))
+	{
+		return(-1);
+	}
+
+	const unsigned char *recordBuf = &mDataBuf[mConsumed];
+	unsigned int recordSize = CaptureGetUint16(&recordBuf[2]);
+
+	if (recordSize < TRAFFIC_RECORD_HEADER_SIZE)
+	{
+		mBroken = true;
+		mNumErrors++;
+
+		return(-1);
+	}
+
+	if (recordSize > (mDataLen - mConsumed))
+	{
+		return(-1);
+	}
+
+	mRecordBuf = recordBuf;
+	mConsumed += recordSize;
+
+	// a new stream starts its own count
+
+	unsigned int sequence = CaptureGetUint32(&recordBuf[4]);
+
+	if ((mHaveSequence == true) && (sequence != mNextSequence) &&
+		(recordBuf[0] != trafficRecordStreamHeader))
+	{
+		mNumMissed += sequence - mNextSequence;
+	}
+
+	mNextSequence = sequence + 1;
+	mHaveSequence = true;
+
+	return(recordBuf[0]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordReader::GetHeartbeat(struct heartbeatRecordRec &heartbeat)
+{
+	const unsigned char *recordBuf = GetRecord(trafficRecordHeartbeat,
+		TRAFFIC_RECORD_HEARTBEAT_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	heartbeat.timestamp = CaptureGetUint32(&recordBuf[8]);
+	heartbeat.msgCounts = CaptureGetUint16(&recordBuf[12]);
+	heartbeat.statusByte1 = recordBuf[14];
+	heartbeat.statusByte2 = recordBuf[15];
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordReader::GetAhrs(struct ahrsRecordRec &ahrs)
+{
+	const unsigned char *recordBuf = GetRecord(trafficRecordAhrs, TRAFFIC_RECORD_AHRS_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	ahrs.roll = TrafficRecordGetFloat(&recordBuf[8]);
+	ahrs.pitch = TrafficRecordGetFloat(&recordBuf[12]);
+	ahrs.heading = TrafficRecordGetFloat(&recordBuf[16]);
+	ahrs.indicatedAirspeed = CaptureGetUint16(&recordBuf[20]);
+	ahrs.trueAirspeed = CaptureGetUint16(&recordBuf[22]);
+	ahrs.msgId = recordBuf[24];
+	ahrs.subMsgId = recordBuf[25];
+	ahrs.headingIsTrue = recordBuf[26];
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordReader::GetTraffic(struct trafficRecordRec &traffic)
+{
+	struct trafficReportRec &report = traffic.report;
+	const unsigned char *recordBuf = GetRecord(trafficRecordTraffic, TRAFFIC_RECORD_TRAFFIC_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	report.latitude = TrafficRecordGetDouble(&recordBuf[8]);
+	report.longitude = TrafficRecordGetDouble(&recordBuf[16]);
+	report.lastUpdate = (int64_t)CaptureGetUint64(&recordBuf[24]);
+	report.participantAddr = CaptureGetUint32(&recordBuf[32]);
+	report.altitude = (int32_t)CaptureGetUint32(&recordBuf[36]);
+	report.horzVelocity = (int32_t)CaptureGetUint32(&recordBuf[40]);
+	report.vertVelocity = (int32_t)CaptureGetUint32(&recordBuf[44]);
+	report.trackHeading = TrafficRecordGetFloat(&recordBuf[48]);
+	traffic.range = TrafficRecordGetFloat(&recordBuf[52]);
+	traffic.bearing = TrafficRecordGetFloat(&recordBuf[56]);
+	traffic.slotId = (int32_t)CaptureGetUint32(&recordBuf[60]);
+
+	report.msgId = recordBuf[64];
+	report.addressType = recordBuf[65];
+	report.alertStatus = recordBuf[66];
+	report.miscIndicators = recordBuf[67];
+	report.integrityCode = recordBuf[68];
+	report.accuracyCode = recordBuf[69];
+	report.emitterCategory = recordBuf[70];
+	report.emergencyPriorityCode = recordBuf[71];
+
+	memcpy(report.callsign, &recordBuf[72], TRAFFIC_REPORT_CALLSIGN_SIZE);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordReader::GetRemoved(unsigned char &addressType, unsigned int &participantAddr)
+{
+	const unsigned char *recordBuf = GetRecord(trafficRecordRemoved, TRAFFIC_RECORD_REMOVED_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	participantAddr = CaptureGetUint32(&recordBuf[8]);
+	addressType = recordBuf[12];
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordReader::GetSequence()
+{
+	return((mRecordBuf != NULL) ? CaptureGetUint32(&mRecordBuf[4]) : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordReader::GetVersion()
+{
+	return((mRecordBuf != NULL) ? mRecordBuf[1] : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bytes of whole records read so far
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordReader::GetConsumed()
+{
+	return(mConsumed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// records that never arrived going by the sequence numbers
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordReader::GetNumMissed()
+{
+	return(mNumMissed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordReader::GetNumErrors()
+{
+	return(mNumErrors);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the current record if it is recordType and at least recordSize long, a
+// record too short for its type is counted as an error
+///////////////////////////////////////////////////////////////////////////////
+const unsigned char *TrafficRecordReader::GetRecord(unsigned char recordType,
+	unsigned int recordSize)
+{
+	if ((mRecordBuf == NULL) || (mRecordBuf[0] != recordType))
+	{
+		return(NULL);
+	}
+
+	if (CaptureGetUint16(&mRecordBuf[2]) < recordSize)
+	{
+		mNumErrors++;
+
+		return(NULL);
+	}
+	return(mRecordBuf);
+}
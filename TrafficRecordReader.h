@@ -0,0 +1,71 @@
+//
+// TrafficRecordReader.h: reads binary traffic records from a buffer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _TRAFFIC_RECORD_READER_H_
+#define _TRAFFIC_RECORD_READER_H_
+
+#include "TrafficRecord.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficRecordReader walks the records TrafficRecordWriter wrote, straight
+// out of the buffer they arrived in.  Next steps to the following whole
+// record and returns its type, then the matching Get decodes it.
+//
+// reading from a pipe or socket, whatever is past GetConsumed when Next runs
+// out is the front of a record still on its way, keep it and put the next
+// read after it.  a record with a size too small to be a record means the
+// stream can't be followed any more, Next returns -1 from then on until
+// SetBuffer is called with data that starts on a record
+///////////////////////////////////////////////////////////////////////////////
+class TrafficRecordReader
+{
+public:
+	TrafficRecordReader();
+
+	void SetBuffer(const unsigned char *dataBuf, unsigned int dataLen);
+
+	int Next();
+
+	int GetHeartbeat(struct heartbeatRecordRec &heartbeat);
+	int GetAhrs(struct ahrsRecordRec &ahrs);
+	int GetTraffic(struct trafficRecordRec &traffic);
+	int GetRemoved(unsigned char &addressType, unsigned int &participantAddr);
+
+	unsigned int GetSequence();
+	unsigned int GetVersion();
+	unsigned int GetConsumed();
+
+	unsigned int GetNumMissed();
+	unsigned int GetNumErrors();
+
+private:
+	const unsigned char *GetRecord(unsigned char recordType, unsigned int recordSize);
+
+	const unsigned char *mDataBuf;
+	unsigned int mDataLen;
+	unsigned int mConsumed;
+
+	const unsigned char *mRecordBuf;  // the record Next found, NULL before
+	bool mBroken;
+
+	unsigned int mNextSequence;
+	bool mHaveSequence;
+
+	unsigned int mNumMissed;
+	unsigned int mNumErrors;
+};
+
+#endif // _TRAFFIC_RECORD_READER_H_
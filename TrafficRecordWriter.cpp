@@ -0,0 +1,200 @@
+//
+// TrafficRecordWriter.cpp: writes binary traffic records into a buffer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include "TrafficRecordWriter.h"
+
+TrafficRecordWriter::TrafficRecordWriter()
+{
+	mDataBuf = NULL;
+	mBufSize = 0;
+	mSize = 0;
+
+	mSequence = 0;
+	mNumRecords = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficRecordWriter::SetBuffer(unsigned char *dataBuf, unsigned int bufSize)
+{
+	mDataBuf = dataBuf;
+	mBufSize = (dataBuf != NULL) ? bufSize : 0;
+	mSize = 0;
+
+	mNumRecords = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordWriter::WriteStreamHeader()
+{
+	unsigned char *recordBuf = StartRecord(trafficRecordStreamHeader,
+		TRAFFIC_RECORD_STREAM_HEADER_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	memcpy(&recordBuf[8], TRAFFIC_RECORD_MAGIC, 8);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordWriter::WriteHeartbeat(const struct heartbeatRecordRec &heartbeat)
+{
+	unsigned char *recordBuf = StartRecord(trafficRecordHeartbeat,
+		TRAFFIC_RECORD_HEARTBEAT_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	CapturePutUint32(&recordBuf[8], heartbeat.timestamp);
+	CapturePutUint16(&recordBuf[12], heartbeat.msgCounts);
+	recordBuf[14] = heartbeat.statusByte1;
+	recordBuf[15] = heartbeat.statusByte2;
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordWriter::WriteAhrs(const struct ahrsRecordRec &ahrs)
+{
+	unsigned char *recordBuf = StartRecord(trafficRecordAhrs, TRAFFIC_RECORD_AHRS_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	TrafficRecordPutFloat(&recordBuf[8], ahrs.roll);
+	TrafficRecordPutFloat(&recordBuf[12], ahrs.pitch);
+	TrafficRecordPutFloat(&recordBuf[16], ahrs.heading);
+	CapturePutUint16(&recordBuf[20], ahrs.indicatedAirspeed);
+	CapturePutUint16(&recordBuf[22], ahrs.trueAirspeed);
+	recordBuf[24] = ahrs.msgId;
+	recordBuf[25] = ahrs.subMsgId;
+	recordBuf[26] = ahrs.headingIsTrue;
+
+	memset(&recordBuf[27], 0, 5);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordWriter::WriteTraffic(const struct trafficRecordRec &traffic)
+{
+	const struct trafficReportRec &report = traffic.report;
+	unsigned char *recordBuf = StartRecord(trafficRecordTraffic, TRAFFIC_RECORD_TRAFFIC_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	TrafficRecordPutDouble(&recordBuf[8], report.latitude);
+	TrafficRecordPutDouble(&recordBuf[16], report.longitude);
+	CapturePutUint64(&recordBuf[24], (uint64_t)report.lastUpdate);
+	CapturePutUint32(&recordBuf[32], report.participantAddr);
+	CapturePutUint32(&recordBuf[36], (uint32_t)report.altitude);
+	CapturePutUint32(&recordBuf[40], (uint32_t)report.horzVelocity);
+	CapturePutUint32(&recordBuf[44], (uint32_t)report.vertVelocity);
+	TrafficRecordPutFloat(&recordBuf[48], report.trackHeading);
+	TrafficRecordPutFloat(&recordBuf[52], traffic.range);
+	TrafficRecordPutFloat(&recordBuf[56], traffic.bearing);
+	CapturePutUint32(&recordBuf[60], (uint32_t)traffic.slotId);
+
+	recordBuf[64] = report.msgId;
+	recordBuf[65] = report.addressType;
+	recordBuf[66] = report.alertStatus;
+	recordBuf[67] = report.miscIndicators;
+	recordBuf[68] = report.integrityCode;
+	recordBuf[69] = report.accuracyCode;
+	recordBuf[70] = report.emitterCategory;
+	recordBuf[71] = report.emergencyPriorityCode;
+
+	memcpy(&recordBuf[72], report.callsign, TRAFFIC_REPORT_CALLSIGN_SIZE);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the target has gone, expired or cleared
+///////////////////////////////////////////////////////////////////////////////
+int TrafficRecordWriter::WriteRemoved(unsigned char addressType, unsigned int participantAddr)
+{
+	unsigned char *recordBuf = StartRecord(trafficRecordRemoved, TRAFFIC_RECORD_REMOVED_SIZE);
+
+	if (recordBuf == NULL)
+	{
+		return(-1);
+	}
+
+	CapturePutUint32(&recordBuf[8], participantAddr);
+	recordBuf[12] = addressType;
+
+	memset(&recordBuf[13], 0, 3);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bytes of whole records in the buffer
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordWriter::GetSize()
+{
+	return(mSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordWriter::GetSpace()
+{
+	return(mBufSize - mSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// records written since SetBuffer
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficRecordWriter::GetNumRecords()
+{
+	return(mNumRecords);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// claim room for a record and fill in its header, NULL if it won't fit
+///////////////////////////////////////////////////////////////////////////////
+unsigned char *TrafficRecordWriter::StartRecord(unsigned char recordType,
+	unsigned int recordSize)
+{
+	if (recordSize > (mBufSize - mSize))
+	{
+		return(NULL);
+	}
+
+	unsigned char *recordBuf = &mDataBuf[mSize];
+
+	recordBuf[0] = recordType;
+	recordBuf[1] = TRAFFIC_RECORD_VERSION;
+	CapturePutUint16(&recordBuf[2], (uint16_t)recordSize);
+	CapturePutUint32(&recordBuf[4], mSequence);
+
+	mSize += recordSize;
+	mSequence++;
+	mNumRecords++;
+
+	return(recordBuf);
+}
@@ -0,0 +1,59 @@
+//
+// TrafficRecordWriter.h: writes binary traffic records into a buffer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _TRAFFIC_RECORD_WRITER_H_
+#define _TRAFFIC_RECORD_WRITER_H_
+
+#include "TrafficRecord.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficRecordWriter encodes records straight into a buffer the caller
+// owns, there is no staging copy and nothing is allocated.  a record that
+// doesn't fit isn't written at all and the write returns -1, so whatever is
+// in the buffer is always whole records ready to send.
+//
+// SetBuffer starts over at the front of a new (or the same) buffer, the
+// sequence numbers carry on so a reader can tell if a buffer went missing
+///////////////////////////////////////////////////////////////////////////////
+class TrafficRecordWriter
+{
+public:
+	TrafficRecordWriter();
+
+	void SetBuffer(unsigned char *dataBuf, unsigned int bufSize);
+
+	int WriteStreamHeader();
+	int WriteHeartbeat(const struct heartbeatRecordRec &heartbeat);
+	int WriteAhrs(const struct ahrsRecordRec &ahrs);
+	int WriteTraffic(const struct trafficRecordRec &traffic);
+	int WriteRemoved(unsigned char addressType, unsigned int participantAddr);
+
+	unsigned int GetSize();
+	unsigned int GetSpace();
+	unsigned int GetNumRecords();
+
+private:
+	unsigned char *StartRecord(unsigned char recordType, unsigned int recordSize);
+
+	unsigned char *mDataBuf;
+	unsigned int mBufSize;
+	unsigned int mSize;
+
+	unsigned int mSequence;
+	unsigned int mNumRecords;
+};
+
+#endif // _TRAFFIC_RECORD_WRITER_H_
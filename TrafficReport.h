@@ -0,0 +1,75 @@
+//
+// TrafficReport.h: plain decoded traffic report
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _TRAFFIC_REPORT_H_
+#define _TRAFFIC_REPORT_H_
+
+#include <stdint.h>
+#include <type_traits>
+
+#define TRAFFIC_REPORT_CALLSIGN_SIZE 8
+
+///////////////////////////////////////////////////////////////////////////////
+// trafficReportRec is one decoded GDL90 ownship or traffic report.  it holds
+// no pointers and owns no memory so it can be memcpy'd into a ring buffer or
+// shared memory and handed to another thread as is.
+//
+// the callsign is the 8 byte GDL90 field with the trailing space padding
+// replaced by 0, a full 8 character callsign has no terminator so use
+// TrafficReportCallsignLength rather than strlen
+///////////////////////////////////////////////////////////////////////////////
+struct trafficReportRec
+{
+	double latitude;
+	double longitude;
+	int64_t lastUpdate;
+
+	uint32_t participantAddr;
+	int32_t altitude;
+	int32_t horzVelocity;
+	int32_t vertVelocity;
+	float trackHeading;
+
+	uint8_t msgId;
+	uint8_t addressType;
+	uint8_t alertStatus;
+	uint8_t miscIndicators;
+	uint8_t integrityCode;
+	uint8_t accuracyCode;
+	uint8_t emitterCategory;
+	uint8_t emergencyPriorityCode;
+
+	char callsign[TRAFFIC_REPORT_CALLSIGN_SIZE];
+};
+
+static_assert(std::is_trivially_copyable<trafficReportRec>::value,
+	"trafficReportRec must stay trivially copyable");
+static_assert(sizeof(trafficReportRec) == 64, "trafficReportRec layout changed");
+
+///////////////////////////////////////////////////////////////////////////////
+inline unsigned int TrafficReportCallsignLength(const struct trafficReportRec &report)
+{
+	unsigned int length = 0;
+
+	while ((length < TRAFFIC_REPORT_CALLSIGN_SIZE) && (report.callsign[length] != 0))
+	{
+		length++;
+	}
+	return(length);
+}
+
+#endif // _TRAFFIC_REPORT_H_
@@ -0,0 +1,174 @@
+//
+// TrafficSnapshot.cpp: lock-free point in time copies of the traffic table
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <string.h>
+
+#include "TrafficSnapshot.h"
+
+#define TRAFFIC_SNAPSHOT_RECORD_WORDS (sizeof(struct trafficSnapshotRec) / sizeof(uint64_t))
+
+TrafficSnapshot::TrafficSnapshot(unsigned int capacity)
+{
+	for (int index = 0; index < 2; index++)
+	{
+		mBuffers[index].sequence.store(0);
+		mBuffers[index].numRecords.store(0);
+		mBuffers[index].version.store(0);
+	}
+
+	mCurrent.store(0);
+	mVersion.store(0);
+
+	mCapacity = 0;
+	mNumTruncated = 0;
+
+	SetCapacity(capacity);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// not safe while a reader is running, empties the snapshot
+///////////////////////////////////////////////////////////////////////////////
+void TrafficSnapshot::SetCapacity(unsigned int capacity)
+{
+	for (int index = 0; index < 2; index++)
+	{
+		std::vector<std::atomic<uint64_t> > words(capacity * TRAFFIC_SNAPSHOT_RECORD_WORDS);
+
+		mBuffers[index].words.swap(words);
+		mBuffers[index].numRecords.store(0);
+	}
+
+	mCapacity = capacity;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficSnapshot::GetCapacity()
+{
+	return(mCapacity);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// copy the records into the buffer readers aren't using and switch them over
+///////////////////////////////////////////////////////////////////////////////
+void TrafficSnapshot::Publish(const struct trafficSnapshotRec *records,
+	unsigned int numRecords)
+{
+	int bufferIndex = 1 - mCurrent.load(std::memory_order_relaxed);
+	struct bufferRec &buffer = mBuffers[bufferIndex];
+
+	if (numRecords > mCapacity)
+	{
+		mNumTruncated += numRecords - mCapacity;
+
+		numRecords = mCapacity;
+	}
+
+	uint32_t sequence = buffer.sequence.load(std::memory_order_relaxed);
+
+	buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint64_t version = mVersion.load(std::memory_order_relaxed) + 1;
+
+	buffer.numRecords.store(numRecords, std::memory_order_relaxed);
+	buffer.version.store(version, std::memory_order_relaxed);
+
+	unsigned int numWords = numRecords * TRAFFIC_SNAPSHOT_RECORD_WORDS;
+	uint64_t word;
+
+	for (unsigned int wordIndex = 0; wordIndex < numWords; wordIndex++)
+	{
+		memcpy(&word, (const uint64_t *)records + wordIndex, sizeof(word));
+
+		buffer.words[wordIndex].store(word, std::memory_order_relaxed);
+	}
+
+	buffer.sequence.store(sequence + 2, std::memory_order_release);
+
+	mVersion.store(version, std::memory_order_release);
+	mCurrent.store(bufferIndex, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// targets left out because there were more than the capacity
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficSnapshot::GetNumTruncated()
+{
+	return(mNumTruncated);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// replace records with the latest snapshot, returns the number of targets.
+// version, if given, is set to the publish count of the snapshot so a
+// reader can tell when nothing has changed
+///////////////////////////////////////////////////////////////////////////////
+int TrafficSnapshot::Read(std::vector<struct trafficSnapshotRec> &records, uint64_t *version)
+{
+	uint32_t numRecords = 0;
+	uint64_t snapshotVersion = 0;
+
+	while (true)
+	{
+		struct bufferRec &buffer = mBuffers[mCurrent.load(std::memory_order_acquire)];
+
+		uint32_t sequence = buffer.sequence.load(std::memory_order_acquire);
+
+		if ((sequence & 1) != 0)
+		{
+			continue;
+		}
+
+		numRecords = buffer.numRecords.load(std::memory_order_relaxed);
+		snapshotVersion = buffer.version.load(std::memory_order_relaxed);
+
+		if (numRecords > mCapacity)
+		{
+			continue;
+		}
+
+		records.resize(numRecords);
+
+		unsigned int numWords = numRecords * TRAFFIC_SNAPSHOT_RECORD_WORDS;
+		uint64_t *wordPtr = (uint64_t *)records.data();
+
+		for (unsigned int wordIndex = 0; wordIndex < numWords; wordIndex++)
+		{
+			uint64_t word = buffer.words[wordIndex].load(std::memory_order_relaxed);
+
+			memcpy(wordPtr + wordIndex, &word, sizeof(word));
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (buffer.sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			break;
+		}
+	}
+
+	if (version != NULL)
+	{
+		*version = snapshotVersion;
+	}
+	return((int)numRecords);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint64_t TrafficSnapshot::GetVersion()
+{
+	return(mVersion.load(std::memory_order_acquire));
+}
@@ -0,0 +1,99 @@
+//
+// TrafficSnapshot.h: lock-free point in time copies of the traffic table
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _TRAFFIC_SNAPSHOT_H_
+#define _TRAFFIC_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "TrafficReport.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// one target as of the last published snapshot
+///////////////////////////////////////////////////////////////////////////////
+struct trafficSnapshotRec
+{
+	struct trafficReportRec report;  // lastUpdate is when the target was stored
+
+	float range;
+	float bearing;
+	int32_t slotId;
+	uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<trafficSnapshotRec>::value,
+	"trafficSnapshotRec must stay trivially copyable");
+static_assert((sizeof(trafficSnapshotRec) % sizeof(uint64_t)) == 0,
+	"trafficSnapshotRec is copied a 64 bit word at a time");
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficSnapshot lets one writer thread publish a copy of the whole traffic
+// table that any number of reader threads can take a coherent copy of
+// without a lock and without ever holding up the writer.
+//
+// there are two buffers, each guarded by a sequence number.  the writer fills
+// the buffer readers aren't pointed at, bumping its sequence number to odd
+// while it writes and back to even when done, then points readers at it.  a
+// reader copies the current buffer out and keeps the copy only if the
+// sequence number was even and unchanged across the copy, otherwise it tries
+// again.  a retry only happens when the writer publishes twice during a
+// single read.
+//
+// the buffers are arrays of atomic 64 bit words so a torn read is harmless
+// and well defined.  SetCapacity must be called before any reader starts,
+// targets past the capacity are left out of the snapshot and counted
+///////////////////////////////////////////////////////////////////////////////
+class TrafficSnapshot
+{
+public:
+	TrafficSnapshot(unsigned int capacity = 0);
+
+	void SetCapacity(unsigned int capacity);
+	unsigned int GetCapacity();
+
+	// writer thread
+
+	void Publish(const struct trafficSnapshotRec *records, unsigned int numRecords);
+	unsigned int GetNumTruncated();
+
+	// any thread
+
+	int Read(std::vector<struct trafficSnapshotRec> &records, uint64_t *version = NULL);
+	uint64_t GetVersion();
+
+private:
+	struct bufferRec
+	{
+		std::atomic<uint32_t> sequence;
+		std::atomic<uint32_t> numRecords;
+		std::atomic<uint64_t> version;
+
+		std::vector<std::atomic<uint64_t> > words;
+	};
+
+	struct bufferRec mBuffers[2];
+
+	std::atomic<int> mCurrent;
+	std::atomic<uint64_t> mVersion;
+
+	unsigned int mCapacity;
+	unsigned int mNumTruncated;
+};
+
+#endif // _TRAFFIC_SNAPSHOT_H_
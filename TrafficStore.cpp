@@ -0,0 +1,414 @@
+//
+// TrafficStore.cpp: struct of arrays traffic table
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#include "TrafficStore.h"
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> static void MoveLast(std::vector<T> &column, unsigned int dataIndex)
+{
+	if (dataIndex != (column.size() - 1))
+	{
+		column[dataIndex] = column.back();
+	}
+	column.pop_back();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// blank callsigns are very common and would all collide, they aren't indexed
+///////////////////////////////////////////////////////////////////////////////
+static bool IsBlankCallsign(const char *callsign, unsigned int length)
+{
+	for (unsigned int index = 0; index < length; index++)
+	{
+		if (callsign[index] != ' ')
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static bool IsBlankCallsign(const std::string &callsign)
+{
+	return(IsBlankCallsign(callsign.c_str(), (unsigned int)callsign.size()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned long long MakeCallsignKey(const std::string &callsign)
+{
+	return(TrafficIndex::MakeCallsignKey(callsign.c_str(), (unsigned int)callsign.size()));
+}
+
+TrafficStore::TrafficStore()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// adds an empty target and returns its data index.  the address index is not
+// updated until SetAddressIndex so a caller keeping history can decide which
+// entry the address should find
+///////////////////////////////////////////////////////////////////////////////
+int TrafficStore::Insert(unsigned char addrType, unsigned int address)
+{
+	int slotId;
+	int dataIndex = (int)mDataToSlot.size();
+
+	if (mFreeSlots.empty() == false)
+	{
+		slotId = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		slotId = (int)mSlotToData.size();
+		mSlotToData.push_back(-1);
+	}
+
+	mSlotToData[slotId] = dataIndex;
+	mDataToSlot.push_back(slotId);
+
+	latitude.push_back(0.0);
+	longitude.push_back(0.0);
+	altitude.push_back(0);
+	horzVelocity.push_back(0);
+	vertVelocity.push_back(0);
+	trackHeading.push_back(0.0f);
+	lastUpdate.push_back(0);
+
+	msgId.push_back(0);
+	addressType.push_back(addrType);
+	participantAddr.push_back(address);
+	alertStatus.push_back(0);
+	miscIndicators.push_back(0);
+	integrityCode.push_back(0);
+	accuracyCode.push_back(0);
+	emitterCategory.push_back(0);
+	emergencyPriorityCode.push_back(0);
+
+	range.push_back(0.0f);
+	bearing.push_back(0.0f);
+
+	changeVersion.push_back(0);
+
+	struct trafficColdRec coldData;
+
+	coldData.address = 0;
+	coldData.typeAircraft = 0;
+	coldData.typeEngine = 0;
+
+	cold.push_back(coldData);
+
+	return(dataIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// removes the target by moving the last target into its place
+///////////////////////////////////////////////////////////////////////////////
+int TrafficStore::Remove(unsigned int dataIndex)
+{
+	int status = -1;
+
+	if (dataIndex < mDataToSlot.size())
+	{
+		UnindexTarget(dataIndex);
+
+		int slotId = mDataToSlot[dataIndex];
+		int lastSlotId = mDataToSlot.back();
+
+		mSlotToData[lastSlotId] = dataIndex;
+		mSlotToData[slotId] = -1;
+
+		mFreeSlots.push_back(slotId);
+
+		MoveLast(mDataToSlot, dataIndex);
+
+		MoveLast(latitude, dataIndex);
+		MoveLast(longitude, dataIndex);
+		MoveLast(altitude, dataIndex);
+		MoveLast(horzVelocity, dataIndex);
+		MoveLast(vertVelocity, dataIndex);
+		MoveLast(trackHeading, dataIndex);
+		MoveLast(lastUpdate, dataIndex);
+
+		MoveLast(msgId, dataIndex);
+		MoveLast(addressType, dataIndex);
+		MoveLast(participantAddr, dataIndex);
+		MoveLast(alertStatus, dataIndex);
+		MoveLast(miscIndicators, dataIndex);
+		MoveLast(integrityCode, dataIndex);
+		MoveLast(accuracyCode, dataIndex);
+		MoveLast(emitterCategory, dataIndex);
+		MoveLast(emergencyPriorityCode, dataIndex);
+
+		MoveLast(range, dataIndex);
+		MoveLast(bearing, dataIndex);
+
+		MoveLast(changeVersion, dataIndex);
+
+		MoveLast(cold, dataIndex);
+
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::Clear()
+{
+	mSlotToData.clear();
+	mDataToSlot.clear();
+	mFreeSlots.clear();
+
+	mAddressIndex.Clear();
+	mCallsignIndex.Clear();
+
+	latitude.clear();
+	longitude.clear();
+	altitude.clear();
+	horzVelocity.clear();
+	vertVelocity.clear();
+	trackHeading.clear();
+	lastUpdate.clear();
+
+	msgId.clear();
+	addressType.clear();
+	participantAddr.clear();
+	alertStatus.clear();
+	miscIndicators.clear();
+	integrityCode.clear();
+	accuracyCode.clear();
+	emitterCategory.clear();
+	emergencyPriorityCode.clear();
+
+	range.clear();
+	bearing.clear();
+
+	changeVersion.clear();
+
+	cold.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// preallocate room for capacity targets, going past it still works but
+// grows the columns
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::Reserve(unsigned int capacity)
+{
+	mSlotToData.reserve(capacity);
+	mDataToSlot.reserve(capacity);
+	mFreeSlots.reserve(capacity);
+
+	mAddressIndex.Reserve(capacity);
+	mCallsignIndex.Reserve(capacity);
+
+	latitude.reserve(capacity);
+	longitude.reserve(capacity);
+	altitude.reserve(capacity);
+	horzVelocity.reserve(capacity);
+	vertVelocity.reserve(capacity);
+	trackHeading.reserve(capacity);
+	lastUpdate.reserve(capacity);
+
+	msgId.reserve(capacity);
+	addressType.reserve(capacity);
+	participantAddr.reserve(capacity);
+	alertStatus.reserve(capacity);
+	miscIndicators.reserve(capacity);
+	integrityCode.reserve(capacity);
+	accuracyCode.reserve(capacity);
+	emitterCategory.reserve(capacity);
+	emergencyPriorityCode.reserve(capacity);
+
+	range.reserve(capacity);
+	bearing.reserve(capacity);
+
+	changeVersion.reserve(capacity);
+
+	cold.reserve(capacity);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficStore::GetCount()
+{
+	return((unsigned int)mDataToSlot.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficStore::GetSlotId(unsigned int dataIndex)
+{
+	if (dataIndex < mDataToSlot.size())
+	{
+		return(mDataToSlot[dataIndex]);
+	}
+	return(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns -1 once the target has been removed
+///////////////////////////////////////////////////////////////////////////////
+int TrafficStore::GetDataIndex(int slotId)
+{
+	if ((slotId >= 0) && (slotId < (int)mSlotToData.size()))
+	{
+		return(mSlotToData[slotId]);
+	}
+	return(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficStore::FindAddress(unsigned char addrType, unsigned int address)
+{
+	return(GetDataIndex(mAddressIndex.Find(TrafficIndex::MakeAddressKey(addrType, address))));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TrafficStore::FindCallsign(const std::string &callsign)
+{
+	int dataIndex = -1;
+
+	if (IsBlankCallsign(callsign) == false)
+	{
+		dataIndex = GetDataIndex(mCallsignIndex.Find(MakeCallsignKey(callsign)));
+
+		// only the first 8 characters are in the key
+
+		if ((dataIndex >= 0) && (cold[dataIndex].callsign != callsign))
+		{
+			dataIndex = -1;
+		}
+	}
+	return(dataIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// make this entry the one found for its address
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::SetAddressIndex(unsigned int dataIndex)
+{
+	if (dataIndex < mDataToSlot.size())
+	{
+		mAddressIndex.Insert(TrafficIndex::MakeAddressKey(addressType[dataIndex],
+			participantAddr[dataIndex]), mDataToSlot[dataIndex]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// make this entry the one found for its callsign
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::SetCallsignIndex(unsigned int dataIndex)
+{
+	if ((dataIndex < mDataToSlot.size()) && (IsBlankCallsign(cold[dataIndex].callsign) == false))
+	{
+		mCallsignIndex.Insert(MakeCallsignKey(cold[dataIndex].callsign), mDataToSlot[dataIndex]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the callsign index keeps pointing at the first target seen with a
+// callsign, the same one a front to back search of the table would find
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::SetCallsign(unsigned int dataIndex, const std::string &callsign)
+{
+	SetCallsign(dataIndex, callsign.c_str(), (unsigned int)callsign.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// callsign doesn't need to be terminated, an unchanged callsign costs a
+// compare and nothing else
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::SetCallsign(unsigned int dataIndex, const char *callsign,
+	unsigned int length)
+{
+	if ((dataIndex >= mDataToSlot.size()) ||
+		(cold[dataIndex].callsign.compare(0, std::string::npos, callsign, length) == 0))
+	{
+		return;
+	}
+
+	int slotId = mDataToSlot[dataIndex];
+	std::string &oldCallsign = cold[dataIndex].callsign;
+
+	if (IsBlankCallsign(oldCallsign) == false)
+	{
+		unsigned long long oldKey = MakeCallsignKey(oldCallsign);
+
+		if (mCallsignIndex.Find(oldKey) == slotId)
+		{
+			ReindexCallsign(oldKey, dataIndex);
+		}
+	}
+
+	if (IsBlankCallsign(callsign, length) == false)
+	{
+		unsigned long long newKey = TrafficIndex::MakeCallsignKey(callsign, length);
+
+		if (mCallsignIndex.Find(newKey) < 0)
+		{
+			mCallsignIndex.Insert(newKey, slotId);
+		}
+	}
+
+	oldCallsign.assign(callsign, length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// drop the index entries that point at this target
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::UnindexTarget(unsigned int dataIndex)
+{
+	int slotId = mDataToSlot[dataIndex];
+	unsigned long long addressKey = TrafficIndex::MakeAddressKey(addressType[dataIndex],
+		participantAddr[dataIndex]);
+
+	if (mAddressIndex.Find(addressKey) == slotId)
+	{
+		mAddressIndex.Remove(addressKey);
+	}
+
+	const std::string &callsign = cold[dataIndex].callsign;
+
+	if (IsBlankCallsign(callsign) == false)
+	{
+		unsigned long long callsignKey = MakeCallsignKey(callsign);
+
+		if (mCallsignIndex.Find(callsignKey) == slotId)
+		{
+			ReindexCallsign(callsignKey, dataIndex);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the target at skipIndex is giving up callsignKey, hand the key to the
+// first other target with the same callsign so it can still be found.  an
+// ADS-B and a TIS-B copy of one aircraft often share a callsign.  only runs
+// when the indexed target leaves, lookups stay a single probe
+///////////////////////////////////////////////////////////////////////////////
+void TrafficStore::ReindexCallsign(unsigned long long callsignKey, unsigned int skipIndex)
+{
+	mCallsignIndex.Remove(callsignKey);
+
+	for (unsigned int dataIndex = 0; dataIndex < mDataToSlot.size(); dataIndex++)
+	{
+		if ((dataIndex != skipIndex) && (IsBlankCallsign(cold[dataIndex].callsign) == false) &&
+			(MakeCallsignKey(cold[dataIndex].callsign) == callsignKey))
+		{
+			mCallsignIndex.Insert(callsignKey, mDataToSlot[dataIndex]);
+			break;
+		}
+	}
+}
@@ -0,0 +1,124 @@
+//
+// TrafficStore.h: struct of arrays traffic table
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+#ifndef _TRAFFIC_STORE_H_
+#define _TRAFFIC_STORE_H_
+
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "TrafficIndex.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// TrafficStore keeps one entry per target laid out as columns so a pass over
+// every target (serializing, range computation, expiry) walks contiguous
+// memory instead of chasing a pointer per target.
+//
+// columns are indexed by data index, 0 .. GetCount() - 1, which stays dense
+// because Remove moves the last target into the hole.  every target also
+// has a slot id that never changes while the target is in the store, use
+// GetDataIndex to turn a slot id back into the current data index.
+//
+// the address and callsign indexes map to slot ids so they don't have to be
+// touched when a target moves.
+//
+// Reserve sizes every column, the slot maps and both indexes for a number of
+// targets.  removed targets hand their slot id back to a free list and Clear
+// keeps the memory, so once the table has held that many targets inserting
+// and removing only reuses storage that is already there
+///////////////////////////////////////////////////////////////////////////////
+class TrafficStore
+{
+public:
+	// rarely touched per target data, kept out of the numeric columns
+
+	struct trafficColdRec
+	{
+		std::string callsign;
+
+		int address;
+		std::string nNumber;
+		std::string name;
+		int typeAircraft;
+		int typeEngine;
+	};
+
+	TrafficStore();
+
+	int Insert(unsigned char addressType, unsigned int participantAddr);
+	int Remove(unsigned int dataIndex);
+	void Clear();
+	void Reserve(unsigned int capacity);
+
+	unsigned int GetCount();
+
+	int GetSlotId(unsigned int dataIndex);
+	int GetDataIndex(int slotId);
+
+	int FindAddress(unsigned char addressType, unsigned int participantAddr);
+	int FindCallsign(const std::string &callsign);
+
+	void SetAddressIndex(unsigned int dataIndex);
+	void SetCallsignIndex(unsigned int dataIndex);
+	void SetCallsign(unsigned int dataIndex, const std::string &callsign);
+	void SetCallsign(unsigned int dataIndex, const char *callsign, unsigned int length);
+
+	// hot columns
+
+	std::vector<double> latitude;
+	std::vector<double> longitude;
+	std::vector<int> altitude;
+	std::vector<int> horzVelocity;
+	std::vector<int> vertVelocity;
+	std::vector<float> trackHeading;
+	std::vector<time_t> lastUpdate;
+
+	// report fields, msgId is the id of the frame that last updated it
+
+	std::vector<unsigned char> msgId;
+	std::vector<unsigned char> addressType;
+	std::vector<unsigned int> participantAddr;
+	std::vector<unsigned char> alertStatus;
+	std::vector<unsigned char> miscIndicators;
+	std::vector<unsigned char> integrityCode;
+	std::vector<unsigned char> accuracyCode;
+	std::vector<unsigned char> emitterCategory;
+	std::vector<unsigned char> emergencyPriorityCode;
+
+	std::vector<float> range;
+	std::vector<float> bearing;
+
+	// the owner's change counter when the target last changed, lets a
+	// reader pick out what changed since it last looked
+
+	std::vector<unsigned long long> changeVersion;
+
+	std::vector<struct trafficColdRec> cold;
+
+private:
+	void UnindexTarget(unsigned int dataIndex);
+	void ReindexCallsign(unsigned long long callsignKey, unsigned int skipIndex);
+
+	std::vector<int> mSlotToData;    // -1 for a free slot
+	std::vector<int> mDataToSlot;
+	std::vector<int> mFreeSlots;
+
+	TrafficIndex mAddressIndex;
+	TrafficIndex mCallsignIndex;
+};
+
+#endif // _TRAFFIC_STORE_H_
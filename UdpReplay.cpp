@@ -0,0 +1,245 @@
+//
+// UdpReplay.cpp: paced GDL90 UDP sender for replaying captures
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+
+#include "UdpReplay.h"
+
+UdpReplay::UdpReplay()
+{
+	mSocketFd = -1;
+
+	mNumSendCalls = 0;
+}
+
+UdpReplay::~UdpReplay()
+{
+	Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int UdpReplay::Open(const char *destAddr, unsigned short port)
+{
+	struct sockaddr_in addr;
+
+	Close();
+
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+
+	if (inet_pton(AF_INET, destAddr, &addr.sin_addr) != 1)
+	{
+		return(-1);
+	}
+
+	mSocketFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+	if (mSocketFd < 0)
+	{
+		return(-1);
+	}
+
+	// connected so the batches don't need an address per datagram
+
+	if (connect(mSocketFd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		Close();
+
+		return(-1);
+	}
+
+	mIovecs.resize(UDP_REPLAY_BATCH_SIZE);
+	mMessages.resize(UDP_REPLAY_BATCH_SIZE);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void UdpReplay::Close()
+{
+	if (mSocketFd >= 0)
+	{
+		close(mSocketFd);
+		mSocketFd = -1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// send every frame in the capture numRepeats times at framesPerSecond, 0 for
+// no pacing.  blocks until done and returns the number of frames sent or -1
+// if the socket failed
+///////////////////////////////////////////////////////////////////////////////
+int UdpReplay::Replay(unsigned int dataLen, const char *dataPtr, unsigned int framesPerSecond,
+	unsigned int numRepeats)
+{
+	std::vector<struct iovec> frames;
+	const unsigned char *dataBuf = (const unsigned char *)dataPtr;
+	unsigned int index = 0;
+
+	if (mSocketFd < 0)
+	{
+		return(-1);
+	}
+
+	// split the capture once, a frame that shares its closing flag with the
+	// next frame's opening flag is still found
+
+	while (index < dataLen)
+	{
+		if (dataBuf[index] != GDL90_FLAGBYTE)
+		{
+			index++;
+			continue;
+		}
+
+		unsigned int endIndex = index + 1;
+
+		while ((endIndex < dataLen) && (dataBuf[endIndex] != GDL90_FLAGBYTE))
+		{
+			endIndex++;
+		}
+
+		if (endIndex >= dataLen)
+		{
+			break;
+		}
+
+		if (endIndex > (index + 1))
+		{
+			struct iovec frame;
+
+			frame.iov_base = (void *)&dataBuf[index];
+			frame.iov_len = endIndex - index + 1;
+
+			frames.push_back(frame);
+		}
+
+		index = endIndex;
+
+		if (((index + 1) < dataLen) && (dataBuf[index + 1] == GDL90_FLAGBYTE))
+		{
+			index++;
+		}
+	}
+
+	if (frames.empty() == true)
+	{
+		return(0);
+	}
+
+	unsigned int batchSize = UDP_REPLAY_BATCH_SIZE;
+
+	if (framesPerSecond > 0)
+	{
+		batchSize = framesPerSecond / 1000;
+
+		if (batchSize < 1)
+		{
+			batchSize = 1;
+		}
+		else if (batchSize > UDP_REPLAY_BATCH_SIZE)
+		{
+			batchSize = UDP_REPLAY_BATCH_SIZE;
+		}
+	}
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	unsigned long long numSent = 0;
+	unsigned long long numFrames = (unsigned long long)frames.size() * numRepeats;
+
+	while (numSent < numFrames)
+	{
+		unsigned int numBatch = 0;
+
+		while ((numBatch < batchSize) && ((numSent + numBatch) < numFrames))
+		{
+			mIovecs[numBatch] = frames[(numSent + numBatch) % frames.size()];
+			numBatch++;
+		}
+
+		if (framesPerSecond > 0)
+		{
+			std::this_thread::sleep_until(startTime + std::chrono::microseconds(
+				(numSent * 1000000ULL) / framesPerSecond));
+		}
+
+		int numBatchSent = SendBatch(numBatch);
+
+		if (numBatchSent < 0)
+		{
+			return(-1);
+		}
+		numSent += numBatchSent;
+	}
+
+	return((int)numSent);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UdpReplay::GetNumSendCalls()
+{
+	return(mNumSendCalls);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// returns how many of the first numFrames iovecs went out, a full socket
+// buffer sends fewer
+///////////////////////////////////////////////////////////////////////////////
+int UdpReplay::SendBatch(unsigned int numFrames)
+{
+	for (unsigned int index = 0; index < numFrames; index++)
+	{
+		memset(&mMessages[index].msg_hdr, 0, sizeof(struct msghdr));
+
+		mMessages[index].msg_hdr.msg_iov = &mIovecs[index];
+		mMessages[index].msg_hdr.msg_iovlen = 1;
+	}
+
+	int numMessages = sendmmsg(mSocketFd, &mMessages[0], numFrames, 0);
+
+	mNumSendCalls++;
+
+	if (numMessages < 0)
+	{
+		if ((errno == EINTR) || (errno == ENOBUFS) || (errno == EAGAIN))
+		{
+			return(0);
+		}
+
+		// loopback reports a receiver that isn't listening yet on the next
+		// send, that's not worth stopping a replay for
+
+		if (errno == ECONNREFUSED)
+		{
+			return((int)numFrames);
+		}
+		return(-1);
+	}
+	return(numMessages);
+}
+
+#endif // __linux__
@@ -0,0 +1,70 @@
+//
+// UdpReplay.h: paced GDL90 UDP sender for replaying captures
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _UDP_REPLAY_H_
+#define _UDP_REPLAY_H_
+
+#ifdef __linux__
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+#include "Gdl90Defs.h"
+#include "UdpSource.h"
+
+#define UDP_REPLAY_BATCH_SIZE 64
+
+///////////////////////////////////////////////////////////////////////////////
+// UdpReplay sends captured GDL90 frames to a UdpSource, normally on
+// loopback, at a fixed rate.  the capture is the raw byte stream as it came
+// off the wire, each frame from its opening to its closing flag byte goes
+// out as one datagram the way receivers send them.
+//
+// datagrams go out with sendmmsg in batches sized so a batch is about a
+// millisecond of traffic, a rate of 0 sends as fast as the socket takes them
+//
+// Linux only
+///////////////////////////////////////////////////////////////////////////////
+class UdpReplay
+{
+public:
+	UdpReplay();
+	~UdpReplay();
+
+	int Open(const char *destAddr = "127.0.0.1", unsigned short port = UDP_SOURCE_DEFAULT_PORT);
+	void Close();
+
+	int Replay(unsigned int dataLen, const char *dataPtr, unsigned int framesPerSecond,
+		unsigned int numRepeats = 1);
+
+	unsigned int GetNumSendCalls();
+
+private:
+	int SendBatch(unsigned int numFrames);
+
+	int mSocketFd;
+
+	std::vector<struct iovec> mIovecs;
+	std::vector<struct mmsghdr> mMessages;
+
+	unsigned int mNumSendCalls;
+};
+
+#endif // __linux__
+
+#endif // _UDP_REPLAY_H_
@@ -0,0 +1,271 @@
+//
+// UdpSource.cpp: batched non-blocking GDL90 UDP receiver
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "UdpSource.h"
+
+UdpSource::UdpSource()
+{
+	mSocketFd = -1;
+	mEpollFd = -1;
+
+	mDatagramCallback = NULL;
+	mCallbackContext = NULL;
+
+	mWrapper = NULL;
+	mFilterData = true;
+
+	mNumDatagrams = 0;
+	mNumReceiveCalls = 0;
+	mNumTruncatedDatagrams = 0;
+}
+
+UdpSource::~UdpSource()
+{
+	Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bind to port on bindAddr, every interface when bindAddr is NULL
+///////////////////////////////////////////////////////////////////////////////
+int UdpSource::Open(unsigned short port, const char *bindAddr)
+{
+	struct sockaddr_in addr;
+	struct epoll_event event;
+	int receiveBufferSize = UDP_SOURCE_RECEIVE_BUFFER_SIZE;
+	int reuseAddr = 1;
+
+	Close();
+
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+	if ((bindAddr != NULL) && (inet_pton(AF_INET, bindAddr, &addr.sin_addr) != 1))
+	{
+		return(-1);
+	}
+
+	mSocketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (mSocketFd < 0)
+	{
+		return(-1);
+	}
+
+	// a bigger socket buffer rides out the gaps between calls to Poll, it
+	// isn't an error if the system caps it
+
+	setsockopt(mSocketFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
+	setsockopt(mSocketFd, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+	if (bind(mSocketFd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		Close();
+
+		return(-1);
+	}
+
+	mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+
+	memset(&event, 0, sizeof(event));
+
+	event.events = EPOLLIN;
+	event.data.fd = mSocketFd;
+
+	if ((mEpollFd < 0) || (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mSocketFd, &event) != 0))
+	{
+		Close();
+
+		return(-1);
+	}
+
+	mBuffers.resize(UDP_SOURCE_BATCH_SIZE * UDP_SOURCE_DATAGRAM_SIZE);
+	mIovecs.resize(UDP_SOURCE_BATCH_SIZE);
+	mMessages.resize(UDP_SOURCE_BATCH_SIZE);
+
+	for (unsigned int index = 0; index < UDP_SOURCE_BATCH_SIZE; index++)
+	{
+		mIovecs[index].iov_base = &mBuffers[index * UDP_SOURCE_DATAGRAM_SIZE];
+		mIovecs[index].iov_len = UDP_SOURCE_DATAGRAM_SIZE;
+	}
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void UdpSource::Close()
+{
+	if (mEpollFd >= 0)
+	{
+		close(mEpollFd);
+		mEpollFd = -1;
+	}
+
+	if (mSocketFd >= 0)
+	{
+		close(mSocketFd);
+		mSocketFd = -1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// dataBuf is only valid during the callback
+///////////////////////////////////////////////////////////////////////////////
+void UdpSource::SetDatagramCallback(DatagramCallback callback, void *context)
+{
+	mDatagramCallback = callback;
+	mCallbackContext = context;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode every datagram with wrapper, replaces the datagram callback
+///////////////////////////////////////////////////////////////////////////////
+void UdpSource::SetWrapper(AdsbWrapper *wrapper, bool filterData)
+{
+	mWrapper = wrapper;
+	mFilterData = filterData;
+
+	SetDatagramCallback(WrapperCallback, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait up to timeoutMs for data, -1 waits forever and 0 doesn't wait, then
+// read what has arrived.  returns the number of datagrams handled or -1 if
+// the source isn't open or the socket failed
+///////////////////////////////////////////////////////////////////////////////
+int UdpSource::Poll(int timeoutMs)
+{
+	struct epoll_event event;
+	int numHandled = 0;
+
+	if (mEpollFd < 0)
+	{
+		return(-1);
+	}
+
+	int numEvents = epoll_wait(mEpollFd, &event, 1, timeoutMs);
+
+	if (numEvents <= 0)
+	{
+		return(((numEvents < 0) && (errno != EINTR)) ? -1 : 0);
+	}
+
+	for (unsigned int batch = 0; batch < UDP_SOURCE_MAX_BATCHES_PER_POLL; batch++)
+	{
+		// recvmmsg overwrites the lengths and flags, the buffers stay put
+
+		for (unsigned int index = 0; index < UDP_SOURCE_BATCH_SIZE; index++)
+		{
+			memset(&mMessages[index].msg_hdr, 0, sizeof(struct msghdr));
+
+			mMessages[index].msg_hdr.msg_iov = &mIovecs[index];
+			mMessages[index].msg_hdr.msg_iovlen = 1;
+		}
+
+		int numMessages = recvmmsg(mSocketFd, &mMessages[0], UDP_SOURCE_BATCH_SIZE,
+			MSG_DONTWAIT, NULL);
+
+		mNumReceiveCalls++;
+
+		if (numMessages < 0)
+		{
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+			{
+				break;
+			}
+			return(-1);
+		}
+
+		for (int index = 0; index < numMessages; index++)
+		{
+			mNumDatagrams++;
+
+			if ((mMessages[index].msg_hdr.msg_flags & MSG_TRUNC) != 0)
+			{
+				mNumTruncatedDatagrams++;
+
+				continue;
+			}
+
+			if (mDatagramCallback != NULL)
+			{
+				mDatagramCallback(mCallbackContext, (char *)mIovecs[index].iov_base,
+					mMessages[index].msg_len);
+			}
+			numHandled++;
+		}
+
+		// a short batch means the socket is empty
+
+		if (numMessages < UDP_SOURCE_BATCH_SIZE)
+		{
+			break;
+		}
+	}
+
+	return(numHandled);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readable whenever a datagram is waiting, -1 when the source isn't open
+///////////////////////////////////////////////////////////////////////////////
+int UdpSource::GetEpollFd()
+{
+	return(mEpollFd);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UdpSource::GetNumDatagrams()
+{
+	return(mNumDatagrams);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UdpSource::GetNumReceiveCalls()
+{
+	return(mNumReceiveCalls);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UdpSource::GetNumTruncatedDatagrams()
+{
+	return(mNumTruncatedDatagrams);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void UdpSource::WrapperCallback(void *context, char *dataBuf, unsigned int dataLen)
+{
+	UdpSource *sourcePtr = (UdpSource *)context;
+
+	if (sourcePtr->mWrapper != NULL)
+	{
+		sourcePtr->mWrapper->DecodeMessage(dataLen, dataBuf, sourcePtr->mFilterData);
+	}
+}
+
+#endif // __linux__
@@ -0,0 +1,102 @@
+//
+// UdpSource.h: batched non-blocking GDL90 UDP receiver
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _UDP_SOURCE_H_
+#define _UDP_SOURCE_H_
+
+#ifdef __linux__
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+#include "AdsbWrapper.h"
+
+#define UDP_SOURCE_DEFAULT_PORT 4000
+
+// datagrams read per recvmmsg call and the most recvmmsg calls one Poll makes
+// before handing control back to the caller
+
+#define UDP_SOURCE_BATCH_SIZE 64
+#define UDP_SOURCE_MAX_BATCHES_PER_POLL 16
+
+// bigger than any GDL90 datagram, a longer one is dropped and counted
+
+#define UDP_SOURCE_DATAGRAM_SIZE 2048
+
+#define UDP_SOURCE_RECEIVE_BUFFER_SIZE (1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////
+// UdpSource reads GDL90 datagrams without a Qt event loop.  the socket is
+// non-blocking and registered with its own epoll instance, Poll waits on it
+// and then drains the socket with recvmmsg, UDP_SOURCE_BATCH_SIZE datagrams
+// per system call, into receive buffers allocated once in Open.
+//
+// each datagram goes to the datagram callback, or straight to
+// AdsbWrapper::DecodeMessage after SetWrapper.  GetEpollFd lets an
+// application that already has an epoll or poll loop wait on the source
+// alongside its other descriptors and call Poll with a zero timeout.
+//
+// Linux only
+///////////////////////////////////////////////////////////////////////////////
+class UdpSource
+{
+public:
+	typedef void (*DatagramCallback)(void *context, char *dataBuf,
+		unsigned int dataLen);
+
+	UdpSource();
+	~UdpSource();
+
+	int Open(unsigned short port = UDP_SOURCE_DEFAULT_PORT, const char *bindAddr = NULL);
+	void Close();
+
+	void SetDatagramCallback(DatagramCallback callback, void *context);
+	void SetWrapper(AdsbWrapper *wrapper, bool filterData = true);
+
+	int Poll(int timeoutMs);
+
+	int GetEpollFd();
+
+	unsigned int GetNumDatagrams();
+	unsigned int GetNumReceiveCalls();
+	unsigned int GetNumTruncatedDatagrams();
+
+private:
+	static void WrapperCallback(void *context, char *dataBuf, unsigned int dataLen);
+
+	int mSocketFd;
+	int mEpollFd;
+
+	DatagramCallback mDatagramCallback;
+	void *mCallbackContext;
+
+	AdsbWrapper *mWrapper;
+	bool mFilterData;
+
+	std::vector<char> mBuffers;
+	std::vector<struct iovec> mIovecs;
+	std::vector<struct mmsghdr> mMessages;
+
+	unsigned int mNumDatagrams;
+	unsigned int mNumReceiveCalls;
+	unsigned int mNumTruncatedDatagrams;
+};
+
+#endif // __linux__
+
+#endif // _UDP_SOURCE_H_
@@ -0,0 +1,86 @@
+//
+// UplinkData.h: decoded GDL90 uplink (FIS-B) message
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _UPLINK_DATA_H_
+#define _UPLINK_DATA_H_
+
+#include <stdint.h>
+#include <type_traits>
+
+// the UAT ground uplink carries an 8 byte header and 424 bytes of
+// application data, split into information frames
+
+#define UPLINK_HEADER_SIZE 8
+#define UPLINK_APP_DATA_SIZE 424
+#define UPLINK_MAX_INFO_FRAMES 108
+
+// an unstuffed GDL90 uplink frame is the flag position, message id, 3 byte
+// time of reception and the uat header ahead of the application data, then
+// the crc and the closing flag position
+
+#define UPLINK_FRAME_APP_DATA_OFFSET (1 + 1 + 3 + UPLINK_HEADER_SIZE)
+#define UPLINK_FRAME_OVERHEAD (UPLINK_FRAME_APP_DATA_OFFSET + 2 + 1)
+
+// information frame types, only APDUs carry FIS-B products
+
+#define UPLINK_INFO_FRAME_APDU 0
+#define UPLINK_INFO_FRAME_TISB_ADSR 14
+#define UPLINK_INFO_FRAME_RESERVED 15
+
+///////////////////////////////////////////////////////////////////////////////
+// one information frame, data starts at appData[offset] past the 2 byte
+// frame header
+///////////////////////////////////////////////////////////////////////////////
+struct uplinkInfoFrameRec
+{
+	uint16_t offset;
+	uint16_t length;
+	uint8_t type;
+	uint8_t reserved;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// uplinkDataRec is one decoded GDL90 uplink message, the ground station's
+// header plus the application data split into information frames.  like
+// trafficReportRec it owns no memory so a worker thread can hand it back
+// through a ring buffer
+///////////////////////////////////////////////////////////////////////////////
+struct uplinkDataRec
+{
+	double latitude;      // of the ground station
+	double longitude;
+
+	uint32_t timeOfReception;  // GDL90 units of 80 ns, 0xffffff if not valid
+	uint32_t sequence;         // set by UplinkDecoder, in the order submitted
+
+	uint8_t positionValid;
+	uint8_t utcCoupled;
+	uint8_t appDataValid;
+	uint8_t slotId;
+	uint8_t tisbSiteId;
+	uint8_t numInfoFrames;
+	uint16_t appDataLen;
+
+	struct uplinkInfoFrameRec infoFrames[UPLINK_MAX_INFO_FRAMES];
+
+	uint8_t appData[UPLINK_APP_DATA_SIZE];
+};
+
+static_assert(std::is_trivially_copyable<uplinkDataRec>::value,
+	"uplinkDataRec must stay trivially copyable");
+
+#endif // _UPLINK_DATA_H_
@@ -0,0 +1,427 @@
+//
+// UplinkDecoder.cpp: work stealing pool for uplink (FIS-B) decoding
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#include <string.h>
+#include <chrono>
+
+#include "UplinkDecoder.h"
+
+// empty polls before an idle worker starts sleeping between polls
+
+#define UPLINK_DECODER_SPIN_LIMIT 64
+#define UPLINK_DECODER_IDLE_SLEEP_US 200
+
+UplinkDecoder::workerRec::workerRec() :
+	results(UPLINK_DECODER_RESULT_RING_SIZE)
+{
+	queue.resize(UPLINK_DECODER_QUEUE_SIZE);
+	queueHead = 0;
+	queueCount.store(0);
+	finished.store(false);
+}
+
+UplinkDecoder::UplinkDecoder(unsigned int numWorkers)
+{
+	if (numWorkers == 0)
+	{
+		numWorkers = 1;
+	}
+	else if (numWorkers > UPLINK_DECODER_MAX_WORKERS)
+	{
+		numWorkers = UPLINK_DECODER_MAX_WORKERS;
+	}
+
+	for (unsigned int index = 0; index < numWorkers; index++)
+	{
+		mWorkers.push_back(new workerRec);
+	}
+
+	mRunning.store(false);
+
+	mNextWorker = 0;
+	mNextSequence = 0;
+
+	mNumDroppedFrames = 0;
+	mNumDecodeErrors.store(0);
+	mNumStolenFrames.store(0);
+}
+
+UplinkDecoder::~UplinkDecoder()
+{
+	Stop();
+
+	for (unsigned int index = 0; index < mWorkers.size(); index++)
+	{
+		delete mWorkers[index];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start the worker threads, returns -1 if they are already running
+///////////////////////////////////////////////////////////////////////////////
+int UplinkDecoder::Start()
+{
+	int status = -1;
+
+	if (mRunning.load() == false)
+	{
+		mRunning.store(true);
+
+		for (unsigned int index = 0; index < mWorkers.size(); index++)
+		{
+			mWorkers[index]->finished.store(false);
+			mWorkers[index]->thread = std::thread(&UplinkDecoder::WorkerLoop, this,
+				mWorkers[index]);
+		}
+		status = 0;
+	}
+	return(status);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the workers finish what is already queued before they exit, call Poll
+// afterwards for the last of the results
+///////////////////////////////////////////////////////////////////////////////
+void UplinkDecoder::Stop()
+{
+	struct uplinkDataRec uplinkData;
+
+	if (mRunning.load() == false)
+	{
+		return;
+	}
+
+	mRunning.store(false);
+
+	// a worker can steal from any queue, so keep making room on every
+	// result ring until they have all run out of work
+
+	bool allFinished = false;
+
+	while (allFinished == false)
+	{
+		allFinished = true;
+
+		for (unsigned int index = 0; index < mWorkers.size(); index++)
+		{
+			while (mWorkers[index]->results.Pop(uplinkData) == true)
+			{
+				mStopResults.push_back(uplinkData);
+			}
+
+			if (mWorkers[index]->finished.load(std::memory_order_acquire) == false)
+			{
+				allFinished = false;
+			}
+		}
+
+		if (allFinished == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for (unsigned int index = 0; index < mWorkers.size(); index++)
+	{
+		mWorkers[index]->thread.join();
+
+		while (mWorkers[index]->results.Pop(uplinkData) == true)
+		{
+			mStopResults.push_back(uplinkData);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// route wrapper's uplink frames here, set before wrapper starts decoding
+///////////////////////////////////////////////////////////////////////////////
+void UplinkDecoder::Attach(AdsbWrapper &wrapper)
+{
+	wrapper.SetUplinkCallback(UplinkCallback, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wrapper goes back to decoding uplinks inline
+///////////////////////////////////////////////////////////////////////////////
+void UplinkDecoder::Detach(AdsbWrapper &wrapper)
+{
+	wrapper.SetUplinkCallback(NULL, NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// queue an unstuffed uplink frame, laid out the way Gdl90Framer hands it
+// over.  never blocks, returns -1 if every worker's queue is full and the
+// frame was dropped
+///////////////////////////////////////////////////////////////////////////////
+int UplinkDecoder::Submit(unsigned int frameSize, const unsigned char *frameBuf)
+{
+	if ((frameSize < 2) || (frameSize > GDL90_MAX_FRAME_SIZE))
+	{
+		mNumDroppedFrames++;
+
+		return(-1);
+	}
+
+	for (unsigned int tries = 0; tries < mWorkers.size(); tries++)
+	{
+		struct workerRec *workerPtr = mWorkers[mNextWorker];
+
+		mNextWorker = (mNextWorker + 1) % mWorkers.size();
+
+		if (PushJob(workerPtr, frameSize, frameBuf) == true)
+		{
+			return(0);
+		}
+	}
+
+	mNumDroppedFrames++;
+
+	return(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// append up to maxResults decoded uplinks, 0 for all of them.  returns the
+// number appended
+///////////////////////////////////////////////////////////////////////////////
+int UplinkDecoder::Poll(std::vector<struct uplinkDataRec> &results, unsigned int maxResults)
+{
+	struct uplinkDataRec uplinkData;
+	unsigned int numResults = 0;
+	bool foundResult = true;
+
+	if (maxResults == 0)
+	{
+		maxResults = 0xffffffff;
+	}
+
+	while ((mStopResults.empty() == false) && (numResults < maxResults))
+	{
+		results.push_back(mStopResults.front());
+		mStopResults.erase(mStopResults.begin());
+
+		numResults++;
+	}
+
+	while ((foundResult == true) && (numResults < maxResults))
+	{
+		foundResult = false;
+
+		for (unsigned int index = 0; (index < mWorkers.size()) && (numResults < maxResults); index++)
+		{
+			if (mWorkers[index]->results.Pop(uplinkData) == true)
+			{
+				results.push_back(uplinkData);
+
+				numResults++;
+				foundResult = true;
+			}
+		}
+	}
+	return((int)numResults);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UplinkDecoder::GetNumWorkers()
+{
+	return((unsigned int)mWorkers.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames lost because every worker's queue was full
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UplinkDecoder::GetNumDroppedFrames()
+{
+	return(mNumDroppedFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// uplinks that weren't uplinks or whose information frames overran
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UplinkDecoder::GetNumDecodeErrors()
+{
+	return(mNumDecodeErrors.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames a worker took from another worker's queue
+///////////////////////////////////////////////////////////////////////////////
+unsigned int UplinkDecoder::GetNumStolenFrames()
+{
+	return(mNumStolenFrames.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// runs inside the wrapper's DecodeFrame
+///////////////////////////////////////////////////////////////////////////////
+void UplinkDecoder::UplinkCallback(void *context, const unsigned char *frameBuf,
+	unsigned int frameSize)
+{
+	UplinkDecoder *decoderPtr = (UplinkDecoder *)context;
+
+	decoderPtr->Submit(frameSize, frameBuf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool UplinkDecoder::PushJob(struct workerRec *workerPtr, unsigned int frameSize,
+	const unsigned char *frameBuf)
+{
+	std::lock_guard<std::mutex> lock(workerPtr->queueMutex);
+
+	unsigned int queueCount = workerPtr->queueCount.load(std::memory_order_relaxed);
+
+	if (queueCount == workerPtr->queue.size())
+	{
+		return(false);
+	}
+
+	struct uplinkJobRec &job = workerPtr->queue[(workerPtr->queueHead + queueCount) %
+		workerPtr->queue.size()];
+
+	job.sequence = mNextSequence++;
+	job.frameSize = (uint16_t)frameSize;
+	memcpy(job.frameBuf, frameBuf, frameSize);
+
+	workerPtr->queueCount.store(queueCount + 1, std::memory_order_relaxed);
+
+	return(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// take the oldest job off the worker's queue, the owner and thieves both
+// use this
+///////////////////////////////////////////////////////////////////////////////
+bool UplinkDecoder::PopJob(struct workerRec *workerPtr, struct uplinkJobRec &job)
+{
+	// an empty queue is the common case, skip the lock for it
+
+	if (workerPtr->queueCount.load(std::memory_order_relaxed) == 0)
+	{
+		return(false);
+	}
+
+	std::lock_guard<std::mutex> lock(workerPtr->queueMutex);
+
+	unsigned int queueCount = workerPtr->queueCount.load(std::memory_order_relaxed);
+
+	if (queueCount == 0)
+	{
+		return(false);
+	}
+
+	const struct uplinkJobRec &queuedJob = workerPtr->queue[workerPtr->queueHead];
+
+	job.sequence = queuedJob.sequence;
+	job.frameSize = queuedJob.frameSize;
+	memcpy(job.frameBuf, queuedJob.frameBuf, queuedJob.frameSize);
+
+	workerPtr->queueHead = (workerPtr->queueHead + 1) % workerPtr->queue.size();
+	workerPtr->queueCount.store(queueCount - 1, std::memory_order_relaxed);
+
+	return(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// take a job from whichever other worker has the most queued
+///////////////////////////////////////////////////////////////////////////////
+bool UplinkDecoder::StealJob(struct workerRec *thiefPtr, struct uplinkJobRec &job)
+{
+	struct workerRec *victimPtr = NULL;
+	unsigned int victimCount = 0;
+
+	for (unsigned int index = 0; index < mWorkers.size(); index++)
+	{
+		unsigned int queueCount = mWorkers[index]->queueCount.load(std::memory_order_relaxed);
+
+		if ((mWorkers[index] != thiefPtr) && (queueCount > victimCount))
+		{
+			victimPtr = mWorkers[index];
+			victimCount = queueCount;
+		}
+	}
+
+	if ((victimPtr != NULL) && (PopJob(victimPtr, job) == true))
+	{
+		mNumStolenFrames.fetch_add(1, std::memory_order_relaxed);
+
+		return(true);
+	}
+	return(false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void UplinkDecoder::WorkerLoop(struct workerRec *workerPtr)
+{
+	struct uplinkJobRec job;
+	struct uplinkDataRec uplinkData;
+	unsigned int numIdlePolls = 0;
+
+	while (true)
+	{
+		bool foundJob = (PopJob(workerPtr, job) == true) || (StealJob(workerPtr, job) == true);
+
+		if ((foundJob == false) && (mRunning.load(std::memory_order_acquire) == false))
+		{
+			// a job Submit queued just before Stop may not have shown up in
+			// the look above, it has once Stop's store is seen.  every
+			// worker drains its own queue here so nothing is left behind
+
+			foundJob = (PopJob(workerPtr, job) == true) || (StealJob(workerPtr, job) == true);
+
+			if (foundJob == false)
+			{
+				workerPtr->finished.store(true, std::memory_order_release);
+				break;
+			}
+		}
+
+		if (foundJob == false)
+		{
+			if (numIdlePolls < UPLINK_DECODER_SPIN_LIMIT)
+			{
+				numIdlePolls++;
+
+				std::this_thread::yield();
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(UPLINK_DECODER_IDLE_SLEEP_US));
+			}
+			continue;
+		}
+
+		numIdlePolls = 0;
+
+		if (AdsbWrapper::DecodeUplinkData(job.frameSize, &job.frameBuf[1], uplinkData) != 0)
+		{
+			mNumDecodeErrors.fetch_add(1, std::memory_order_relaxed);
+
+			// frames before an overrun are still worth having
+
+			if (uplinkData.numInfoFrames == 0)
+			{
+				continue;
+			}
+		}
+
+		uplinkData.sequence = job.sequence;
+
+		while (workerPtr->results.Push(uplinkData) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
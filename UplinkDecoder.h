@@ -0,0 +1,124 @@
+//
+// UplinkDecoder.h: work stealing pool for uplink (FIS-B) decoding
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+
+
+#ifndef _UPLINK_DECODER_H_
+#define _UPLINK_DECODER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AdsbWrapper.h"
+#include "Gdl90Defs.h"
+#include "SpscRing.h"
+#include "UplinkData.h"
+
+#define UPLINK_DECODER_MAX_WORKERS 64
+#define UPLINK_DECODER_QUEUE_SIZE 64
+#define UPLINK_DECODER_RESULT_RING_SIZE 64
+
+///////////////////////////////////////////////////////////////////////////////
+// UplinkDecoder takes uplink frames off the thread decoding traffic and
+// decodes them on a pool of worker threads, so a burst of uplinks never
+// delays an ownship or traffic report.
+//
+// Attach sets the wrapper's uplink callback, from then on DecodeMessage and
+// friends copy each uplink frame into a worker's queue and carry on, CRC
+// already checked.  Submit does the same for a caller that frames uplinks
+// itself.  frames are dealt out round robin, a worker that runs out of its
+// own work takes the oldest frame from the busiest looking other worker, so
+// one slow uplink doesn't leave the rest queued behind it.  the job queues
+// are small fixed rings, each behind its own mutex that is only ever held
+// for a copy.
+//
+// each worker hands its decoded uplinkDataRec back through its own
+// SpscRing, Poll drains them all and is the completion queue.  results from
+// different workers can come back out of order, sequence numbers them in
+// the order they were submitted.  Submit and Poll are the decoding thread's
+///////////////////////////////////////////////////////////////////////////////
+class UplinkDecoder
+{
+public:
+	UplinkDecoder(unsigned int numWorkers);
+	~UplinkDecoder();
+
+	int Start();
+	void Stop();
+
+	void Attach(AdsbWrapper &wrapper);
+	void Detach(AdsbWrapper &wrapper);
+
+	int Submit(unsigned int frameSize, const unsigned char *frameBuf);
+	int Poll(std::vector<struct uplinkDataRec> &results, unsigned int maxResults = 0);
+
+	unsigned int GetNumWorkers();
+	unsigned int GetNumDroppedFrames();
+	unsigned int GetNumDecodeErrors();
+	unsigned int GetNumStolenFrames();
+
+private:
+	struct uplinkJobRec
+	{
+		uint32_t sequence;
+		uint16_t frameSize;
+		unsigned char frameBuf[GDL90_MAX_FRAME_SIZE];
+	};
+
+	struct workerRec
+	{
+		workerRec();
+
+		std::mutex queueMutex;
+		std::vector<struct uplinkJobRec> queue;
+		unsigned int queueHead;
+		std::atomic<unsigned int> queueCount;
+
+		SpscRing<struct uplinkDataRec> results;
+
+		std::thread thread;
+		std::atomic<bool> finished;
+	};
+
+	static void UplinkCallback(void *context, const unsigned char *frameBuf,
+		unsigned int frameSize);
+
+	bool PushJob(struct workerRec *workerPtr, unsigned int frameSize,
+		const unsigned char *frameBuf);
+	bool PopJob(struct workerRec *workerPtr, struct uplinkJobRec &job);
+	bool StealJob(struct workerRec *thiefPtr, struct uplinkJobRec &job);
+
+	void WorkerLoop(struct workerRec *workerPtr);
+
+	std::vector<struct workerRec *> mWorkers;
+
+	std::atomic<bool> mRunning;
+
+	// results Stop had to take off full rings, Poll hands them out first
+
+	std::vector<struct uplinkDataRec> mStopResults;
+
+	unsigned int mNextWorker;
+	uint32_t mNextSequence;
+
+	unsigned int mNumDroppedFrames;
+	std::atomic<unsigned int> mNumDecodeErrors;
+	std::atomic<unsigned int> mNumStolenFrames;
+};
+
+#endif // _UPLINK_DECODER_H_
@@ -0,0 +1,201 @@
+//
+// CaptureReplayBenchmark.cpp: how much faster than real time a capture replays
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it optimized with the library sources and Qt Core, then run it.  it
+// records a capture of a busy receiver under BENCH_CAPTURE_DIR, replays it at
+// speed 0 into a callback that only reads the records and into an
+// AdsbWrapper, checks every target came through, exiting 1 if not, and
+// prints records per second and the multiple of real time each way
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#include "../AdsbWrapper.h"
+#include "../CaptureRecorder.h"
+#include "../CaptureReplayer.h"
+#include "../Gdl90Encoder.h"
+
+#define BENCH_CAPTURE_DIR "/tmp"
+#define BENCH_START_TIME 1500000000000000LL   // microseconds since 1970
+#define BENCH_NUM_TARGETS 1000
+#define BENCH_NUM_RECORDS 200000
+#define BENCH_RECORD_SPACING 5000             // microseconds, 200 frames a second
+#define BENCH_MIN_SECONDS 1.0
+
+///////////////////////////////////////////////////////////////////////////////
+// what the read only replay saw
+///////////////////////////////////////////////////////////////////////////////
+struct benchCountsRec
+{
+	unsigned long long numBytes;
+	unsigned int numRecords;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetSeconds()
+{
+	return(std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one traffic frame per record, every target reporting in turn
+///////////////////////////////////////////////////////////////////////////////
+static int RecordCapture(const std::string &path)
+{
+	unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+	unsigned char frameBuf[GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE)];
+	struct trafficReportRec report;
+	CaptureRecorder recorder;
+
+	if (recorder.Open(path.c_str()) != 0)
+	{
+		return(-1);
+	}
+
+	for (unsigned int index = 0; index < BENCH_NUM_RECORDS; index++)
+	{
+		unsigned int target = index % BENCH_NUM_TARGETS;
+
+		memset(&report, 0, sizeof(report));
+
+		report.participantAddr = 0xf10000 + target;
+		report.latitude = 30.0 + ((target % 100) * 0.1);
+		report.longitude = -120.0 + ((target / 100) * 0.1) + ((index / BENCH_NUM_TARGETS) * 0.0001);
+		report.altitude = 1000 + ((target * 50) % 30000);
+		report.horzVelocity = 100 + (target % 400);
+		report.integrityCode = 8;
+		report.accuracyCode = 9;
+
+		snprintf(report.callsign, sizeof(report.callsign), "N%u", 30000 + target);
+
+		Gdl90Encoder::EncodeReport(GDL90_ID_TRAFFIC, report, msgBuf);
+
+		unsigned int frameLen = Gdl90Encoder::StuffFrame(msgBuf, sizeof(msgBuf), frameBuf);
+
+		recorder.Record(frameLen, (const char *)frameBuf,
+			BENCH_START_TIME + ((int64_t)index * BENCH_RECORD_SPACING));
+	}
+
+	return(recorder.Close());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void CountRecord(void *context, const char *dataPtr, unsigned int dataLen,
+	int64_t timestamp, unsigned char sourceId)
+{
+	struct benchCountsRec *countsPtr = (struct benchCountsRec *)context;
+
+	(void)dataPtr;
+	(void)timestamp;
+	(void)sourceId;
+
+	countsPtr->numBytes += dataLen;
+	countsPtr->numRecords++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// seconds per whole replay, replaying until at least BENCH_MIN_SECONDS
+// have gone by.  with wrapper NULL the records are only read
+///////////////////////////////////////////////////////////////////////////////
+static double TimeReplay(CaptureReplayer &replayer, AdsbWrapper *wrapper,
+	struct benchCountsRec &counts)
+{
+	unsigned int numPasses = 0;
+	double startTime = GetSeconds();
+	double elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		counts.numBytes = 0;
+		counts.numRecords = 0;
+
+		replayer.Rewind();
+
+		if (wrapper == NULL)
+		{
+			replayer.Replay(CountRecord, &counts);
+		}
+		else
+		{
+			counts.numRecords = replayer.Replay(*wrapper);
+		}
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	return(elapsed / numPasses);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	std::string path = std::string(BENCH_CAPTURE_DIR) + "/CaptureReplayBenchmark.cap";
+	struct benchCountsRec counts;
+	CaptureReplayer replayer;
+	AdsbWrapper wrapper;
+	int status = 0;
+
+	if ((RecordCapture(path) != 0) || (replayer.Open(path.c_str()) != 0))
+	{
+		printf("FAIL: couldn't record %s\n", path.c_str());
+
+		return(1);
+	}
+
+	double captureSeconds = (replayer.GetEndTime() - replayer.GetStartTime()) / 1e6;
+
+	replayer.SetSpeed(0.0);
+	wrapper.SetTrafficCapacity(BENCH_NUM_TARGETS);
+
+	double readSeconds = TimeReplay(replayer, NULL, counts);
+	double captureBytes = (double)counts.numBytes;
+
+	if (counts.numRecords != BENCH_NUM_RECORDS)
+	{
+		printf("FAIL: read %u of %u records\n", counts.numRecords, BENCH_NUM_RECORDS);
+
+		status = 1;
+	}
+
+	double decodeSeconds = TimeReplay(replayer, &wrapper, counts);
+
+	if ((counts.numRecords != BENCH_NUM_RECORDS) ||
+		(wrapper.GetNumTrafficReports() != BENCH_NUM_TARGETS))
+	{
+		printf("FAIL: replayed %u of %u records, %d of %u targets\n", counts.numRecords,
+			BENCH_NUM_RECORDS, wrapper.GetNumTrafficReports(), BENCH_NUM_TARGETS);
+
+		status = 1;
+	}
+
+	printf("%u records, %.0f seconds of capture, %u targets\n", BENCH_NUM_RECORDS,
+		captureSeconds, BENCH_NUM_TARGETS);
+	printf("read only        %10.0f records/s %8.1f MB/s %10.0fx real time\n",
+		BENCH_NUM_RECORDS / readSeconds, captureBytes / (readSeconds * 1e6),
+		captureSeconds / readSeconds);
+	printf("into AdsbWrapper %10.0f records/s %8.1f MB/s %10.0fx real time\n",
+		BENCH_NUM_RECORDS / decodeSeconds, captureBytes / (decodeSeconds * 1e6),
+		captureSeconds / decodeSeconds);
+
+	replayer.Close();
+	remove(path.c_str());
+
+	return(status);
+}
@@ -0,0 +1,371 @@
+//
+// CaptureTest.cpp: captures recorded, replayed, sought and cut short
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it writes
+// its captures under TEST_CAPTURE_DIR and removes them, prints every check
+// that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../CaptureRecorder.h"
+#include "../CaptureReplayer.h"
+#include "../CaptureWriter.h"
+#include "../Gdl90Encoder.h"
+
+#define TEST_CAPTURE_DIR "/tmp"
+#define TEST_START_TIME 1500000000000000LL   // microseconds since 1970
+#define TEST_RECORD_SPACING 100000           // microseconds between records
+#define TEST_NUM_TARGETS 20
+#define TEST_NUM_RECORDS 300                 // 30 seconds, 30 index entries
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, long long value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%lld)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a record as it went in
+///////////////////////////////////////////////////////////////////////////////
+struct testRecordRec
+{
+	std::vector<unsigned char> data;
+	int64_t timestamp;
+	unsigned char sourceId;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// one traffic frame per record, the targets reporting in turn from two
+// receivers
+///////////////////////////////////////////////////////////////////////////////
+static void MakeRecords(std::vector<struct testRecordRec> &records)
+{
+	unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+	unsigned char frameBuf[GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE)];
+	struct trafficReportRec report;
+
+	records.resize(TEST_NUM_RECORDS);
+
+	for (unsigned int index = 0; index < TEST_NUM_RECORDS; index++)
+	{
+		memset(&report, 0, sizeof(report));
+
+		report.participantAddr = 0xf00000 + (index % TEST_NUM_TARGETS);
+		report.latitude = 47.0 + ((index % TEST_NUM_TARGETS) * 0.01);
+		report.longitude = -122.0;
+		report.altitude = 2000 + ((index / TEST_NUM_TARGETS) * 100);
+
+		Gdl90Encoder::EncodeReport(GDL90_ID_TRAFFIC, report, msgBuf);
+
+		unsigned int frameLen = Gdl90Encoder::StuffFrame(msgBuf, sizeof(msgBuf), frameBuf);
+
+		records[index].data.assign(frameBuf, frameBuf + frameLen);
+		records[index].timestamp = TEST_START_TIME + ((int64_t)index * TEST_RECORD_SPACING);
+		records[index].sourceId = (unsigned char)(index & 1);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static std::string GetCapturePath(const char *name)
+{
+	return(std::string(TEST_CAPTURE_DIR) + "/CaptureTest_" + name + ".cap");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RecordCapture(const std::string &path, const std::vector<struct testRecordRec> &records)
+{
+	CaptureRecorder recorder;
+
+	if (recorder.Open(path.c_str()) != 0)
+	{
+		return(-1);
+	}
+
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		recorder.Record((unsigned int)records[index].data.size(),
+			(const char *)records[index].data.data(), records[index].timestamp,
+			records[index].sourceId);
+	}
+
+	return(recorder.Close());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the records from where the replayer is to the end match records from
+// firstRecord to numRecords
+///////////////////////////////////////////////////////////////////////////////
+static void CheckRecords(CaptureReplayer &replayer, const std::vector<struct testRecordRec> &records,
+	unsigned int firstRecord, unsigned int numRecords, const char *what)
+{
+	const char *dataPtr;
+	unsigned int dataLen;
+	int64_t timestamp;
+	unsigned char sourceId;
+	unsigned int index = firstRecord;
+
+	while (replayer.Next(dataPtr, dataLen, timestamp, sourceId) == 0)
+	{
+		bool same = (index < numRecords) && (dataLen == records[index].data.size()) &&
+			(memcmp(dataPtr, records[index].data.data(), dataLen) == 0) &&
+			(timestamp == records[index].timestamp) && (sourceId == records[index].sourceId);
+
+		Check(same, what, index);
+
+		index++;
+	}
+
+	Check(index == numRecords, what, index);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Seek to before the start, onto every record, between records and past
+// the end, the next record must be the first at or after the time
+///////////////////////////////////////////////////////////////////////////////
+static void CheckSeek(CaptureReplayer &replayer, const std::vector<struct testRecordRec> &records,
+	unsigned int numRecords, const char *what)
+{
+	const char *dataPtr;
+	unsigned int dataLen;
+	int64_t timestamp;
+	unsigned char sourceId;
+
+	Check((replayer.Seek(TEST_START_TIME - 5000000) == 0) &&
+		(replayer.Next(dataPtr, dataLen, timestamp, sourceId) == 0) &&
+		(timestamp == TEST_START_TIME), what, -1);
+
+	for (unsigned int index = 0; index < numRecords; index++)
+	{
+		Check((replayer.Seek(records[index].timestamp) == 0) &&
+			(replayer.Next(dataPtr, dataLen, timestamp, sourceId) == 0) &&
+			(timestamp == records[index].timestamp), what, index);
+
+		if ((index + 1) < numRecords)
+		{
+			Check((replayer.Seek(records[index].timestamp + 1) == 0) &&
+				(replayer.Next(dataPtr, dataLen, timestamp, sourceId) == 0) &&
+				(timestamp == records[index + 1].timestamp), what, index);
+		}
+	}
+
+	Check(replayer.Seek(records[numRecords - 1].timestamp + 1) == -1, what, numRecords);
+
+	// a seek leaves the replayer ready to carry on from there
+
+	Check(replayer.Seek(records[numRecords / 2].timestamp) == 0, what, numRecords / 2);
+
+	CheckRecords(replayer, records, numRecords / 2, numRecords, what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a closed capture comes back record for record with its index
+///////////////////////////////////////////////////////////////////////////////
+static void TestRoundTrip(const std::vector<struct testRecordRec> &records)
+{
+	std::string path = GetCapturePath("closed");
+	CaptureReplayer replayer;
+
+	Check(RecordCapture(path, records) == 0, "capture recorded", 0);
+	Check(replayer.Open(path.c_str()) == 0, "capture opened", 0);
+	Check(replayer.HasIndex() == true, "index written", 0);
+	Check(replayer.GetStartTime() == TEST_START_TIME, "start time", replayer.GetStartTime());
+	Check(replayer.GetEndTime() == records.back().timestamp, "end time", replayer.GetEndTime());
+
+	CheckRecords(replayer, records, 0, TEST_NUM_RECORDS, "record read back");
+	CheckSeek(replayer, records, TEST_NUM_RECORDS, "seek with the index");
+
+	// replayed into a wrapper as fast as it goes, on the capture's clock
+
+	AdsbWrapper wrapper;
+
+	replayer.SetSpeed(0.0);
+	replayer.Rewind();
+
+	Check(replayer.Replay(wrapper) == TEST_NUM_RECORDS, "records replayed", 0);
+	Check(wrapper.GetNumTrafficReports() == TEST_NUM_TARGETS, "targets replayed",
+		wrapper.GetNumTrafficReports());
+	Check(wrapper.GetClockTime() == (time_t)(records.back().timestamp / 1000000),
+		"wrapper on the capture clock", (long long)wrapper.GetClockTime());
+
+	// one receiver's records only
+
+	AdsbWrapper oneSource;
+
+	replayer.Rewind();
+
+	Check(replayer.Replay(oneSource, true, 0, 1) == TEST_NUM_RECORDS, "records offered", 0);
+	Check(oneSource.GetNumTrafficReports() == TEST_NUM_TARGETS / 2, "one receiver's targets",
+		oneSource.GetNumTrafficReports());
+
+	replayer.Close();
+	remove(path.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a capture cut off part way through a record, in its header or in its
+// data, has no index and ends at the last whole record
+///////////////////////////////////////////////////////////////////////////////
+static void TestTruncated(const std::vector<struct testRecordRec> &records)
+{
+	std::string closedPath = GetCapturePath("whole");
+	std::string truncatedPath = GetCapturePath("truncated");
+	std::vector<unsigned char> fileData;
+
+	Check(RecordCapture(closedPath, records) == 0, "capture recorded", 0);
+
+	FILE *file = fopen(closedPath.c_str(), "rb");
+
+	Check(file != NULL, "capture read", 0);
+
+	if (file == NULL)
+	{
+		return;
+	}
+
+	unsigned char readBuf[4096];
+	size_t numRead;
+
+	while ((numRead = fread(readBuf, 1, sizeof(readBuf), file)) > 0)
+	{
+		fileData.insert(fileData.end(), readBuf, readBuf + numRead);
+	}
+	fclose(file);
+
+	// where each record starts
+
+	std::vector<size_t> recordOffsets;
+	size_t offset = CAPTURE_FILE_HEADER_SIZE;
+
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		recordOffsets.push_back(offset);
+
+		offset += CAPTURE_RECORD_HEADER_SIZE + records[index].data.size();
+	}
+
+	static const unsigned int cutRecords[] = { 1, 137, TEST_NUM_RECORDS - 1 };
+	static const unsigned int cutInto[] = { 5, CAPTURE_RECORD_HEADER_SIZE + 3 };
+
+	for (size_t cutIndex = 0; cutIndex < sizeof(cutRecords) / sizeof(cutRecords[0]); cutIndex++)
+	{
+		for (size_t intoIndex = 0; intoIndex < sizeof(cutInto) / sizeof(cutInto[0]); intoIndex++)
+		{
+			unsigned int numWhole = cutRecords[cutIndex];
+			size_t fileSize = recordOffsets[numWhole] + cutInto[intoIndex];
+			CaptureReplayer replayer;
+
+			file = fopen(truncatedPath.c_str(), "wb");
+
+			Check((file != NULL) && (fwrite(fileData.data(), 1, fileSize, file) == fileSize),
+				"truncated capture written", (long long)fileSize);
+
+			if (file != NULL)
+			{
+				fclose(file);
+			}
+
+			Check(replayer.Open(truncatedPath.c_str()) == 0, "truncated capture opened", numWhole);
+			Check(replayer.HasIndex() == false, "index rebuilt", numWhole);
+			Check(replayer.GetEndTime() == records[numWhole - 1].timestamp, "last whole record",
+				numWhole);
+
+			CheckRecords(replayer, records, 0, numWhole, "truncated record read back");
+			CheckSeek(replayer, records, numWhole, "seek with a rebuilt index");
+		}
+	}
+
+	remove(closedPath.c_str());
+	remove(truncatedPath.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// what the decoding threads hand CaptureWriter reaches the segment file
+///////////////////////////////////////////////////////////////////////////////
+static void TestWriter(const std::vector<struct testRecordRec> &records)
+{
+	std::string prefix = std::string(TEST_CAPTURE_DIR) + "/CaptureTest_writer";
+	std::string path = prefix + "_000000.cap";
+	CaptureWriter writer;
+	CaptureReplayer replayer;
+
+	Check(writer.Start(prefix.c_str()) == 0, "writer started", 0);
+
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		writer.Write((unsigned int)records[index].data.size(),
+			(const char *)records[index].data.data(), records[index].sourceId);
+	}
+
+	writer.Stop();
+
+	Check(writer.GetNumWritten() == TEST_NUM_RECORDS, "records written", writer.GetNumWritten());
+	Check(writer.GetNumDropped() == 0, "nothing dropped", writer.GetNumDropped());
+	Check(writer.GetNumSegments() == 1, "one segment", writer.GetNumSegments());
+	Check(replayer.Open(path.c_str()) == 0, "segment opened", 0);
+	Check(replayer.HasIndex() == true, "segment closed", 0);
+
+	const char *dataPtr;
+	unsigned int dataLen;
+	int64_t timestamp;
+	unsigned char sourceId;
+	int64_t lastTimestamp = 0;
+	unsigned int index = 0;
+
+	while (replayer.Next(dataPtr, dataLen, timestamp, sourceId) == 0)
+	{
+		Check((index < records.size()) && (dataLen == records[index].data.size()) &&
+			(memcmp(dataPtr, records[index].data.data(), dataLen) == 0) &&
+			(sourceId == records[index].sourceId) && (timestamp >= lastTimestamp),
+			"segment record", index);
+
+		lastTimestamp = timestamp;
+		index++;
+	}
+
+	Check(index == TEST_NUM_RECORDS, "segment records", index);
+
+	replayer.Close();
+	remove(path.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	std::vector<struct testRecordRec> records;
+
+	MakeRecords(records);
+
+	TestRoundTrip(records);
+	TestTruncated(records);
+	TestWriter(records);
+
+	if (sNumFailures == 0)
+	{
+		printf("CaptureTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
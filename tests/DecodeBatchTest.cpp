@@ -0,0 +1,195 @@
+//
+// DecodeBatchTest.cpp: DecodeBatch results point at the right targets
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../Gdl90Encoder.h"
+
+#define TEST_BUF_SIZE 4096
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void AddTraffic(Gdl90Encoder &encoder, unsigned int participantAddr)
+{
+	struct trafficReportRec report;
+
+	memset(&report, 0, sizeof(report));
+
+	report.participantAddr = participantAddr;
+	report.latitude = 47.5;
+	report.longitude = -122.3;
+	report.altitude = 4500;
+
+	encoder.AddTraffic(report);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a UAT basic report, time of reception and state vector all 0
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int AddUatBasic(unsigned char *dataBuf, unsigned char addressQualifier,
+	unsigned int participantAddr)
+{
+	unsigned char msgBuf[GDL90_ID_BASIC_REPORT_LENGTH];
+
+	memset(msgBuf, 0, sizeof(msgBuf));
+
+	msgBuf[0] = GDL90_ID_BASIC_REPORT;
+	msgBuf[4] = addressQualifier & 0x7;
+	msgBuf[5] = (unsigned char)(participantAddr >> 16);
+	msgBuf[6] = (unsigned char)(participantAddr >> 8);
+	msgBuf[7] = (unsigned char)participantAddr;
+
+	return(Gdl90Encoder::StuffFrame(msgBuf, sizeof(msgBuf), dataBuf));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// with filterData off and a history of two, the first two targets are
+// pushed out by the last two in the same batch and their slots reused
+///////////////////////////////////////////////////////////////////////////////
+static void TestReusedSlots()
+{
+	static const unsigned int participantAddrs[] = { 0xa00001, 0xa00002, 0xa00003, 0xa00004 };
+
+	unsigned char dataBuf[TEST_BUF_SIZE];
+	std::vector<struct decodeResultRec> results;
+	Gdl90Encoder encoder;
+	AdsbWrapper wrapper;
+
+	wrapper.SetHistoryLimit(2);
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+
+	for (int index = 0; index < 4; index++)
+	{
+		AddTraffic(encoder, participantAddrs[index]);
+	}
+
+	Check(wrapper.DecodeBatch(encoder.GetSize(), (const char *)dataBuf, results, false) == 4,
+		"results", (int)results.size());
+	Check(wrapper.GetNumTrafficReports() == 2, "history kept", wrapper.GetNumTrafficReports());
+
+	for (size_t resultIndex = 0; resultIndex < results.size(); resultIndex++)
+	{
+		struct decodeResultRec &result = results[resultIndex];
+		int dataIndex = wrapper.GetDataIndex(0, participantAddrs[result.frameIndex]);
+
+		Check(result.status == 0, "decoded", (int)result.frameIndex);
+
+		if (result.frameIndex < 2)
+		{
+			Check(result.dataIndex == -1, "evicted target has no data index", result.dataIndex);
+		}
+		else
+		{
+			Check((dataIndex >= 0) && (result.dataIndex == dataIndex), "kept target's data index",
+				result.dataIndex);
+		}
+	}
+
+	Check(wrapper.GetLastDataIndex() == wrapper.GetDataIndex(0, participantAddrs[3]),
+		"last data index", wrapper.GetLastDataIndex());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// UAT reports are stored too and say where
+///////////////////////////////////////////////////////////////////////////////
+static void TestUatResults()
+{
+	unsigned char dataBuf[TEST_BUF_SIZE];
+	std::vector<struct decodeResultRec> results;
+	Gdl90Encoder encoder;
+	AdsbWrapper wrapper;
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+
+	AddTraffic(encoder, 0xb00001);
+
+	unsigned int dataLen = encoder.GetSize();
+
+	dataLen += AddUatBasic(&dataBuf[dataLen], 2, 0xb00002);
+	dataLen += AddUatBasic(&dataBuf[dataLen], 0, 0xb00003);
+
+	Check(wrapper.DecodeBatch(dataLen, (const char *)dataBuf, results) == 3, "results",
+		(int)results.size());
+	Check(wrapper.GetNumTrafficReports() == 3, "targets", wrapper.GetNumTrafficReports());
+
+	for (size_t resultIndex = 0; resultIndex < results.size(); resultIndex++)
+	{
+		struct decodeResultRec &result = results[resultIndex];
+		int dataIndex = -1;
+
+		switch (result.frameIndex)
+		{
+		case 0:
+			dataIndex = wrapper.GetDataIndex(0, 0xb00001);
+			break;
+
+		case 1:
+			dataIndex = wrapper.GetDataIndex(2, 0xb00002);
+			break;
+
+		case 2:
+			dataIndex = wrapper.GetDataIndex(0, 0xb00003);
+			break;
+
+		default:
+			break;
+		}
+
+		Check(result.status == 0, "decoded", (int)result.frameIndex);
+		Check((dataIndex >= 0) && (result.dataIndex == dataIndex), "data index",
+			(int)result.frameIndex);
+	}
+
+	// the last message type is the last frame, the last target the last
+	// traffic report
+
+	Check(wrapper.GetLastMsgType() == GDL90_ID_BASIC_REPORT, "last message type",
+		wrapper.GetLastMsgType());
+	Check(wrapper.GetLastDataIndex() == wrapper.GetDataIndex(0, 0xb00001), "last data index",
+		wrapper.GetLastDataIndex());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestReusedSlots();
+	TestUatResults();
+
+	if (sNumFailures == 0)
+	{
+		printf("DecodeBatchTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
@@ -0,0 +1,215 @@
+//
+// DecodePipelineBenchmark.cpp: DecodePipeline throughput from 1 to 8 workers
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it optimized with the library sources and Qt Core, then run it on a
+// machine with at least as many cores as workers.  it feeds the same stream
+// of traffic reports through DecodeBatch on one thread and through the
+// pipeline with every worker count from 1 to 8, checks every frame was stored,
+// exiting 1 if not, and prints the frames decoded per second each way
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../DecodePipeline.h"
+#include "../Gdl90Encoder.h"
+
+#define BENCH_NUM_TARGETS 2000
+#define BENCH_NUM_REPORTS 50      // per target in the stream
+#define BENCH_NUM_PASSES 10       // times the stream is fed per run
+#define BENCH_FEED_SIZE 4096      // bytes per Feed, about what a socket read gives
+#define BENCH_MAX_WORKERS 8
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetSeconds()
+{
+	return(std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// every target reporting in turn, the way a busy receiver's stream looks
+///////////////////////////////////////////////////////////////////////////////
+static void MakeStream(std::vector<unsigned char> &streamData)
+{
+	struct trafficReportRec report;
+	Gdl90Encoder encoder;
+
+	streamData.resize(BENCH_NUM_TARGETS * BENCH_NUM_REPORTS *
+		GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE));
+
+	encoder.SetBuffer(streamData.data(), (unsigned int)streamData.size());
+
+	for (unsigned int sequence = 0; sequence < BENCH_NUM_REPORTS; sequence++)
+	{
+		for (unsigned int target = 0; target < BENCH_NUM_TARGETS; target++)
+		{
+			memset(&report, 0, sizeof(report));
+
+			report.addressType = (unsigned char)(target & 3);
+			report.participantAddr = 0xd00000 + target;
+			report.latitude = 30.0 + ((target % 100) * 0.1) + (sequence * 0.001);
+			report.longitude = -120.0 + ((target / 100) * 0.1);
+			report.altitude = 1000 + ((target * 50) % 30000) + (sequence * 25);
+			report.horzVelocity = 100 + (target % 400);
+			report.trackHeading = (float)((target * 7) % 360);
+			report.integrityCode = 8;
+			report.accuracyCode = 9;
+
+			snprintf(report.callsign, sizeof(report.callsign), "N%u", 20000 + target);
+
+			encoder.AddTraffic(report);
+		}
+	}
+
+	streamData.resize(encoder.GetSize());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void FeedStream(DecodePipeline *pipelinePtr, const std::vector<unsigned char> *streamPtr)
+{
+	for (unsigned int pass = 0; pass < BENCH_NUM_PASSES; pass++)
+	{
+		for (size_t dataIndex = 0; dataIndex < streamPtr->size(); dataIndex += BENCH_FEED_SIZE)
+		{
+			size_t dataLen = std::min((size_t)BENCH_FEED_SIZE, streamPtr->size() - dataIndex);
+
+			pipelinePtr->Feed((unsigned int)dataLen, (const char *)&(*streamPtr)[dataIndex]);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames per second through DecodeBatch, -1 if any frame went missing
+///////////////////////////////////////////////////////////////////////////////
+static double RunBatch(const std::vector<unsigned char> &streamData, unsigned int numFrames)
+{
+	std::vector<struct decodeResultRec> results;
+	AdsbWrapper wrapper;
+	unsigned int numResults = 0;
+
+	wrapper.SetTrafficCapacity(BENCH_NUM_TARGETS);
+
+	double startTime = GetSeconds();
+
+	for (unsigned int pass = 0; pass < BENCH_NUM_PASSES; pass++)
+	{
+		for (size_t dataIndex = 0; dataIndex < streamData.size(); dataIndex += BENCH_FEED_SIZE)
+		{
+			size_t dataLen = std::min((size_t)BENCH_FEED_SIZE, streamData.size() - dataIndex);
+
+			numResults += wrapper.DecodeBatch((unsigned int)dataLen,
+				(const char *)&streamData[dataIndex], results);
+		}
+	}
+
+	double elapsed = GetSeconds() - startTime;
+
+	if ((numResults != numFrames) || (wrapper.GetNumTrafficReports() != BENCH_NUM_TARGETS))
+	{
+		printf("FAIL: DecodeBatch stored %u of %u frames\n", numResults, numFrames);
+
+		return(-1.0);
+	}
+	return(numFrames / elapsed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames per second through the pipeline, fed from its own thread and
+// polled from this one, -1 if any frame went missing
+///////////////////////////////////////////////////////////////////////////////
+static double RunPipeline(const std::vector<unsigned char> &streamData, unsigned int numFrames,
+	unsigned int numWorkers)
+{
+	AdsbWrapper wrapper;
+	DecodePipeline pipeline(wrapper, numWorkers);
+	unsigned int numResults = 0;
+
+	wrapper.SetTrafficCapacity(BENCH_NUM_TARGETS);
+
+	pipeline.Start(true, true);
+
+	double startTime = GetSeconds();
+
+	std::thread feedThread(FeedStream, &pipeline, &streamData);
+
+	while (numResults < numFrames)
+	{
+		int numPolled = pipeline.Poll();
+
+		if (numPolled == 0)
+		{
+			std::this_thread::yield();
+		}
+		numResults += numPolled;
+	}
+
+	double elapsed = GetSeconds() - startTime;
+
+	feedThread.join();
+	pipeline.Stop();
+
+	if ((pipeline.GetNumDroppedFrames() != 0) || (pipeline.GetNumCrcErrors() != 0) ||
+		(pipeline.Poll() != 0) || (wrapper.GetNumTrafficReports() != BENCH_NUM_TARGETS))
+	{
+		printf("FAIL: %u workers stored %u of %u frames, %u dropped\n", numWorkers, numResults,
+			numFrames, pipeline.GetNumDroppedFrames());
+
+		return(-1.0);
+	}
+	return(numFrames / elapsed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	std::vector<unsigned char> streamData;
+
+	MakeStream(streamData);
+
+	unsigned int numFrames = BENCH_NUM_TARGETS * BENCH_NUM_REPORTS * BENCH_NUM_PASSES;
+
+	printf("%u frames, %u targets, %u hardware threads\n", numFrames, BENCH_NUM_TARGETS,
+		std::thread::hardware_concurrency());
+
+	double batchRate = RunBatch(streamData, numFrames);
+
+	if (batchRate < 0.0)
+	{
+		return(1);
+	}
+
+	printf("DecodeBatch          %10.0f frames/s\n", batchRate);
+
+	for (unsigned int numWorkers = 1; numWorkers <= BENCH_MAX_WORKERS; numWorkers++)
+	{
+		double pipelineRate = RunPipeline(streamData, numFrames, numWorkers);
+
+		if (pipelineRate < 0.0)
+		{
+			return(1);
+		}
+
+		printf("pipeline, %u worker%s %10.0f frames/s, %.2fx\n", numWorkers,
+			(numWorkers == 1) ? " " : "s", pipelineRate, pipelineRate / batchRate);
+	}
+
+	return(0);
+}
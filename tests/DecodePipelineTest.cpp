@@ -0,0 +1,176 @@
+//
+// DecodePipelineTest.cpp: every target's reports come out of the workers in
+// the order they were fed
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../DecodePipeline.h"
+#include "../Gdl90Encoder.h"
+
+#define TEST_NUM_TARGETS 13     // not a multiple of any worker count
+#define TEST_NUM_REPORTS 200    // per target
+#define TEST_CHUNK_REPORTS 40   // fed between polls
+#define TEST_DECODE_WAIT_MS 2   // for the workers to get through a chunk
+#define TEST_BUF_SIZE (TEST_CHUNK_REPORTS * GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE))
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// every altitude each target was stored with, in the order it was stored
+///////////////////////////////////////////////////////////////////////////////
+static void RecordChange(void *context, const struct trafficChangeRec &change)
+{
+	std::map<unsigned int, std::vector<int> > *altitudesPtr =
+		(std::map<unsigned int, std::vector<int> > *)context;
+
+	(*altitudesPtr)[change.report.participantAddr].push_back(change.report.altitude);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// report number sequence of target number target, each report climbs 25 feet
+///////////////////////////////////////////////////////////////////////////////
+static void AddReport(Gdl90Encoder &encoder, unsigned int target, unsigned int sequence)
+{
+	struct trafficReportRec report;
+
+	memset(&report, 0, sizeof(report));
+
+	report.participantAddr = 0xc00000 + target;
+	report.latitude = 47.0 + (target * 0.1);
+	report.longitude = -122.0;
+	report.altitude = 1000 + (sequence * 25);
+
+	encoder.AddTraffic(report);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the targets' reports interleaved across several workers and fed in
+// chunks.  the workers are given time to decode each chunk, then only a few
+// results are polled so some workers' results wait much longer than
+// others'.  every target must still see every one of its reports in order
+///////////////////////////////////////////////////////////////////////////////
+static void TestOrderPerTarget(unsigned int numWorkers)
+{
+	std::map<unsigned int, std::vector<int> > altitudes;
+	unsigned char dataBuf[TEST_BUF_SIZE];
+	Gdl90Encoder encoder;
+	AdsbWrapper wrapper;
+	DecodePipeline pipeline(wrapper, numWorkers);
+
+	wrapper.SubscribeTrafficChanges(RecordChange, &altitudes,
+		TRAFFIC_CHANGE_ADDED | TRAFFIC_CHANGE_UPDATED);
+
+	Check(pipeline.Start() == 0, "started", (int)numWorkers);
+
+	unsigned int numFed = 0;
+	unsigned int numChunks = 0;
+
+	for (unsigned int sequence = 0; sequence < TEST_NUM_REPORTS; sequence++)
+	{
+		for (unsigned int target = 0; target < TEST_NUM_TARGETS; target++)
+		{
+			if (numFed == 0)
+			{
+				encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+			}
+
+			AddReport(encoder, target, sequence);
+
+			numFed++;
+
+			if (numFed == TEST_CHUNK_REPORTS)
+			{
+				pipeline.Feed(encoder.GetSize(), (const char *)dataBuf);
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(TEST_DECODE_WAIT_MS));
+
+				pipeline.Poll(1 + (numChunks % 7));
+
+				numFed = 0;
+				numChunks++;
+			}
+		}
+	}
+
+	if (numFed > 0)
+	{
+		pipeline.Feed(encoder.GetSize(), (const char *)dataBuf);
+	}
+
+	// the rest a few at a time too
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(TEST_DECODE_WAIT_MS * 10));
+
+	while (pipeline.Poll(3) > 0)
+	{
+	}
+
+	pipeline.Stop();
+	pipeline.Poll();
+
+	Check(pipeline.GetNumDroppedFrames() == 0, "nothing dropped", pipeline.GetNumDroppedFrames());
+	Check(pipeline.GetNumCrcErrors() == 0, "no crc errors", pipeline.GetNumCrcErrors());
+	Check(wrapper.GetNumTrafficReports() == TEST_NUM_TARGETS, "targets",
+		wrapper.GetNumTrafficReports());
+	Check(altitudes.size() == TEST_NUM_TARGETS, "targets changed", (int)altitudes.size());
+
+	for (unsigned int target = 0; target < TEST_NUM_TARGETS; target++)
+	{
+		std::vector<int> &stored = altitudes[0xc00000 + target];
+		bool inOrder = (stored.size() == TEST_NUM_REPORTS);
+
+		for (unsigned int sequence = 0; (inOrder == true) && (sequence < stored.size()); sequence++)
+		{
+			inOrder = (stored[sequence] == (int)(1000 + (sequence * 25)));
+		}
+
+		Check(inOrder, "reports in the order fed", (int)target);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestOrderPerTarget(1);
+	TestOrderPerTarget(4);
+	TestOrderPerTarget(8);
+
+	if (sNumFailures == 0)
+	{
+		printf("DecodePipelineTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
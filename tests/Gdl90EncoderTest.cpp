@@ -0,0 +1,384 @@
+//
+// Gdl90EncoderTest.cpp: encode and decode round trip for Gdl90Encoder
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../Gdl90Crc.h"
+#include "../Gdl90Encoder.h"
+#include "../Gdl90Framer.h"
+
+#define TEST_BUF_SIZE 4096
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int index)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, index);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames as the framer hands them over, one after the other
+///////////////////////////////////////////////////////////////////////////////
+struct frameListRec
+{
+	std::vector<unsigned char> data;
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> sizes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static void FrameCallback(void *context, unsigned char *frameBuf, unsigned int frameSize)
+{
+	struct frameListRec *frameList = (struct frameListRec *)context;
+
+	frameList->offsets.push_back((unsigned int)frameList->data.size());
+	frameList->sizes.push_back(frameSize);
+	frameList->data.insert(frameList->data.end(), frameBuf, frameBuf + frameSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a report the decoder could have produced, latitude, longitude and track
+// are given as the raw field values so they come back exactly
+///////////////////////////////////////////////////////////////////////////////
+static struct trafficReportRec MakeReport(unsigned char msgId, unsigned int participantAddr,
+	int rawLatitude, int rawLongitude, int altitude, int horzVelocity, int vertVelocity,
+	int rawTrack, const char *callsign)
+{
+	struct trafficReportRec report;
+
+	memset(&report, 0, sizeof(report));
+
+	report.msgId = msgId;
+	report.addressType = 0;
+	report.alertStatus = 1;
+	report.participantAddr = participantAddr;
+	report.latitude = rawLatitude * 180.0 / 8388608.0;
+	report.longitude = rawLongitude * 180.0 / 8388608.0;
+	report.altitude = altitude;
+	report.miscIndicators = 0x9;
+	report.integrityCode = 8;
+	report.accuracyCode = 9;
+	report.horzVelocity = horzVelocity;
+	report.vertVelocity = vertVelocity;
+	report.trackHeading = (float)(rawTrack * 360.0 / 256.0);
+	report.emitterCategory = 1;
+	report.emergencyPriorityCode = 0;
+
+	strncpy(report.callsign, callsign, TRAFFIC_REPORT_CALLSIGN_SIZE);
+
+	return(report);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static bool SameReport(const struct trafficReportRec &report1,
+	const struct trafficReportRec &report2)
+{
+	return((report1.msgId == report2.msgId) &&
+		(report1.addressType == report2.addressType) &&
+		(report1.alertStatus == report2.alertStatus) &&
+		(report1.participantAddr == report2.participantAddr) &&
+		(report1.latitude == report2.latitude) &&
+		(report1.longitude == report2.longitude) &&
+		(report1.altitude == report2.altitude) &&
+		(report1.miscIndicators == report2.miscIndicators) &&
+		(report1.integrityCode == report2.integrityCode) &&
+		(report1.accuracyCode == report2.accuracyCode) &&
+		(report1.horzVelocity == report2.horzVelocity) &&
+		(report1.vertVelocity == report2.vertVelocity) &&
+		(report1.trackHeading == report2.trackHeading) &&
+		(report1.emitterCategory == report2.emitterCategory) &&
+		(report1.emergencyPriorityCode == report2.emergencyPriorityCode) &&
+		(memcmp(report1.callsign, report2.callsign, TRAFFIC_REPORT_CALLSIGN_SIZE) == 0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// timestamp bit 16 rides in status byte 2 and the message counts are picked
+// to need escaping
+///////////////////////////////////////////////////////////////////////////////
+static void TestHeartbeat()
+{
+	unsigned char dataBuf[TEST_BUF_SIZE];
+	struct heartbeatRecordRec heartbeat;
+	struct heartbeatRecordRec decoded;
+	Gdl90Encoder encoder;
+	AdsbWrapper wrapper;
+
+	heartbeat.timestamp = 0x1abcd;
+	heartbeat.msgCounts = 0x7e7d;
+	heartbeat.statusByte1 = 0x81;
+	heartbeat.statusByte2 = 0x41;
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+
+	Check(encoder.AddHeartbeat(heartbeat) == 0, "heartbeat fits", 0);
+
+	wrapper.DecodeStream(encoder.GetSize(), (const char *)dataBuf);
+	wrapper.GetLatestHeartbeat(decoded);
+
+	Check(wrapper.GetNumCrcErrors() == 0, "heartbeat crc", 0);
+	Check(decoded.timestamp == heartbeat.timestamp, "heartbeat timestamp", 0);
+	Check(decoded.msgCounts == heartbeat.msgCounts, "heartbeat message counts", 0);
+	Check(decoded.statusByte1 == heartbeat.statusByte1, "heartbeat status byte 1", 0);
+	Check((decoded.statusByte2 & 0x7f) == heartbeat.statusByte2,
+		"heartbeat status byte 2", 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ownship and traffic reports, including the sentinels the decoder produces
+// and fields full of flag and escape bytes, come back from the decoder as
+// they went in
+///////////////////////////////////////////////////////////////////////////////
+static void TestReports()
+{
+	unsigned char dataBuf[TEST_BUF_SIZE];
+	struct trafficReportRec decoded;
+	struct frameListRec frameList;
+	Gdl90Encoder encoder;
+	Gdl90Framer framer;
+	AdsbWrapper wrapper;
+
+	std::vector<struct trafficReportRec> reports;
+
+	reports.push_back(MakeReport(GDL90_ID_OWNSHIP, 0xa1b2c3, 0x1a2b3c, -0x3c2b1a,
+		5500, 120, -640, 0x40, "N123AB"));
+
+	// flag and escape bytes in the address, position, altitude, velocity,
+	// track and callsign
+
+	reports.push_back(MakeReport(GDL90_ID_TRAFFIC, 0x7e7d7e, 0x7e7d7e, 0x7d7e7d,
+		(0x7e7 * 25) - 1000, 0x7d7, 0x7e * 64, 0x7e, "~}~}"));
+
+	// no velocity, no altitude and no vertical velocity
+
+	reports.push_back(MakeReport(GDL90_ID_TRAFFIC, 0x123456, -0x100000, 0x200000,
+		101375, 4094, 0, 0, "NOVEL"));
+
+	// 4094 kt or more, the bottom of the altitude scale and the ends of the
+	// vertical scale
+
+	reports.push_back(MakeReport(GDL90_ID_TRAFFIC, 0x654321, 0x7fffff, -0x800000,
+		-1000, 4095, 509 * 64, 0xff, "FAST1"));
+	reports.push_back(MakeReport(GDL90_ID_TRAFFIC, 0x654322, 0, 0,
+		101350, 4093, -509 * 64, 0x80, "FAST2"));
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+
+	for (size_t index = 0; index < reports.size(); index++)
+	{
+		int status = (reports[index].msgId == GDL90_ID_OWNSHIP) ?
+			encoder.AddOwnship(reports[index]) : encoder.AddTraffic(reports[index]);
+
+		Check(status == 0, "report fits", (int)index);
+	}
+
+	Check(memchr(dataBuf, GDL90_ESCAPEBYTE, encoder.GetSize()) != NULL, "escapes sent", 0);
+
+	framer.SetFrameCallback(FrameCallback, &frameList);
+	framer.Feed(dataBuf, encoder.GetSize());
+
+	Check(frameList.sizes.size() == reports.size(), "frame count", (int)frameList.sizes.size());
+
+	for (size_t index = 0; (index < frameList.sizes.size()) && (index < reports.size()); index++)
+	{
+		unsigned char *frameBuf = &frameList.data[frameList.offsets[index]];
+		unsigned int frameSize = frameList.sizes[index];
+
+		Check(frameSize == GDL90_ENCODER_REPORT_SIZE + GDL90_FRAME_OVERHEAD, "frame size", (int)index);
+		Check(Gdl90CrcCheck(frameBuf, frameSize) == 0, "report crc", (int)index);
+		Check(AdsbWrapper::DecodeTrafficReport(frameSize, &frameBuf[1], decoded) == 0,
+			"report decodes", (int)index);
+		Check(SameReport(decoded, reports[index]) == true, "report round trip", (int)index);
+	}
+
+	// and the whole burst through the wrapper
+
+	wrapper.DecodeStream(encoder.GetSize(), (const char *)dataBuf);
+
+	Check(wrapper.GetNumCrcErrors() == 0, "burst crc", 0);
+	Check(wrapper.GetNumShortFrames() == 0, "burst short frames", 0);
+	Check(wrapper.GetNumTrafficReports() == (int)reports.size(), "burst targets",
+		wrapper.GetNumTrafficReports());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the velocity and altitude codes the decoder keeps go back out unchanged
+///////////////////////////////////////////////////////////////////////////////
+static void TestWireCodes()
+{
+	struct codeTestRec
+	{
+		int rawAltitude;
+		int rawHorzVelocity;
+		int rawVertVelocity;
+	};
+
+	static const struct codeTestRec codeTests[] =
+	{
+		{ 0xfff, 0xfff, 0x000 },  // no altitude, no velocity
+		{ 0xffe, 0xffe, 0x1fd },  // 4094 kt or more
+		{ 0x000, 0xffd, 0xe03 },
+		{ 0x028, 0x000, 0x001 },
+		{ 0x7e7, 0x7d7, 0xfff },
+	};
+
+	for (int index = 0; index < (int)(sizeof(codeTests) / sizeof(codeTests[0])); index++)
+	{
+		unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+		unsigned char encodedBuf[GDL90_ENCODER_REPORT_SIZE];
+		struct trafficReportRec decoded;
+
+		memset(msgBuf, 0, sizeof(msgBuf));
+		memset(&msgBuf[19], ' ', TRAFFIC_REPORT_CALLSIGN_SIZE);
+
+		msgBuf[0] = GDL90_ID_TRAFFIC;
+		msgBuf[11] = (unsigned char)(codeTests[index].rawAltitude >> 4);
+		msgBuf[12] = (unsigned char)((codeTests[index].rawAltitude & 0xf) << 4);
+		msgBuf[14] = (unsigned char)(codeTests[index].rawHorzVelocity >> 4);
+		msgBuf[15] = (unsigned char)(((codeTests[index].rawHorzVelocity & 0xf) << 4) |
+			(codeTests[index].rawVertVelocity >> 8));
+		msgBuf[16] = (unsigned char)codeTests[index].rawVertVelocity;
+
+		Check(AdsbWrapper::DecodeTrafficReport(sizeof(msgBuf) + GDL90_FRAME_OVERHEAD, msgBuf,
+			decoded) == 0, "code decodes", index);
+
+		Gdl90Encoder::EncodeReport(GDL90_ID_TRAFFIC, decoded, encodedBuf);
+
+		Check(memcmp(&msgBuf[11], &encodedBuf[11], 2) == 0, "altitude code", index);
+		Check(memcmp(&msgBuf[14], &encodedBuf[14], 3) == 0, "velocity codes", index);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// frames of each id in a burst, and traffic frames for participantAddr
+///////////////////////////////////////////////////////////////////////////////
+static void CountBurstFrames(const unsigned char *dataBuf, unsigned int dataLen,
+	unsigned int participantAddr, int &numOwnship, int &numTraffic, int &numTrafficAddr)
+{
+	struct trafficReportRec decoded;
+	struct frameListRec frameList;
+	Gdl90Framer framer;
+
+	numOwnship = 0;
+	numTraffic = 0;
+	numTrafficAddr = 0;
+
+	framer.SetFrameCallback(FrameCallback, &frameList);
+	framer.Feed(dataBuf, dataLen);
+
+	for (size_t index = 0; index < frameList.sizes.size(); index++)
+	{
+		unsigned char *frameBuf = &frameList.data[frameList.offsets[index]];
+
+		if (frameBuf[1] == GDL90_ID_OWNSHIP)
+		{
+			numOwnship++;
+		}
+		else if (frameBuf[1] == GDL90_ID_TRAFFIC)
+		{
+			numTraffic++;
+
+			if ((AdsbWrapper::DecodeTrafficReport(frameList.sizes[index], &frameBuf[1],
+				decoded) == 0) && (decoded.participantAddr == participantAddr))
+			{
+				numTrafficAddr++;
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the receiver's own ownship frames never go back out as traffic
+///////////////////////////////////////////////////////////////////////////////
+static void TestTrafficBurst()
+{
+	unsigned char dataBuf[TEST_BUF_SIZE];
+	Gdl90Encoder encoder;
+	AdsbWrapper wrapper;
+	int numOwnship;
+	int numTraffic;
+	int numTrafficAddr;
+
+	struct trafficReportRec receiverOwnship = MakeReport(GDL90_ID_OWNSHIP, 0xa1b2c3,
+		0x1a2b3c, -0x3c2b1a, 5500, 120, 0, 0x40, "N123AB");
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+	encoder.AddOwnship(receiverOwnship);
+	encoder.AddTraffic(MakeReport(GDL90_ID_TRAFFIC, 0x100001, 0x1a0000, -0x3c0000,
+		3000, 100, 0, 0x20, "N1"));
+	encoder.AddTraffic(MakeReport(GDL90_ID_TRAFFIC, 0x100002, 0x1b0000, -0x3d0000,
+		4000, 110, 0, 0x30, "N2"));
+
+	wrapper.DecodeStream(encoder.GetSize(), (const char *)dataBuf);
+
+	Check(wrapper.GetNumTrafficReports() == 3, "burst source targets",
+		wrapper.GetNumTrafficReports());
+
+	// no ownship passed in, the receiver's goes out as ownship
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+
+	Check(wrapper.EncodeTrafficBurst(encoder) == 4, "burst frames", 0);
+
+	CountBurstFrames(dataBuf, encoder.GetSize(), receiverOwnship.participantAddr,
+		numOwnship, numTraffic, numTrafficAddr);
+
+	Check(numOwnship == 1, "receiver ownship sent as ownship", numOwnship);
+	Check(numTraffic == 2, "burst traffic", numTraffic);
+	Check(numTrafficAddr == 0, "receiver ownship not sent as traffic", numTrafficAddr);
+
+	// an ownship from elsewhere replaces it
+
+	struct trafficReportRec otherOwnship = MakeReport(GDL90_ID_OWNSHIP, 0xc0ffee,
+		0x1a2b3c, -0x3c2b1a, 5600, 120, 0, 0x40, "N456CD");
+
+	encoder.SetBuffer(dataBuf, sizeof(dataBuf));
+
+	Check(wrapper.EncodeTrafficBurst(encoder, &otherOwnship) == 4, "burst frames with ownship", 0);
+
+	CountBurstFrames(dataBuf, encoder.GetSize(), receiverOwnship.participantAddr,
+		numOwnship, numTraffic, numTrafficAddr);
+
+	Check(numOwnship == 1, "one ownship", numOwnship);
+	Check(numTraffic == 2, "burst traffic with ownship", numTraffic);
+	Check(numTrafficAddr == 0, "receiver ownship left out", numTrafficAddr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestHeartbeat();
+	TestReports();
+	TestWireCodes();
+	TestTrafficBurst();
+
+	if (sNumFailures == 0)
+	{
+		printf("Gdl90EncoderTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
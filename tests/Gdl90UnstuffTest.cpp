@@ -0,0 +1,208 @@
+//
+// Gdl90UnstuffTest.cpp: every unstuff kernel gives the scalar answer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../Gdl90Unstuff.h"
+
+// past two AVX2 blocks, so a special byte lands either side of every 16 and
+// 32 byte boundary
+#define TEST_MAX_LEN 72
+#define TEST_BUF_SIZE (TEST_MAX_LEN + 8)
+
+static int sNumFailures = 0;
+
+static const char *sKernelNames[] = { "scalar", "sse2", "avx2" };
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the answers, written the plainest way there is
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int ReferenceUnstuff(unsigned char *dstBuf, const unsigned char *srcBuf,
+	unsigned int srcLen)
+{
+	unsigned int dstIndex = 0;
+
+	for (unsigned int srcIndex = 0; srcIndex < srcLen; srcIndex++)
+	{
+		if (srcBuf[srcIndex] == GDL90_ESCAPEBYTE)
+		{
+			srcIndex++;
+
+			if (srcIndex < srcLen)
+			{
+				dstBuf[dstIndex++] = srcBuf[srcIndex] ^ 0x20;
+			}
+		}
+		else
+		{
+			dstBuf[dstIndex++] = srcBuf[srcIndex];
+		}
+	}
+
+	return(dstIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int ReferenceFindSpecial(const unsigned char *dataBuf, unsigned int dataLen)
+{
+	for (unsigned int dataIndex = 0; dataIndex < dataLen; dataIndex++)
+	{
+		if ((dataBuf[dataIndex] == GDL90_FLAGBYTE) || (dataBuf[dataIndex] == GDL90_ESCAPEBYTE))
+		{
+			return(dataIndex);
+		}
+	}
+
+	return(dataLen);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// body bytes that are never special, with the escaped values mixed in
+///////////////////////////////////////////////////////////////////////////////
+static void FillBody(unsigned char *dataBuf, unsigned int dataLen)
+{
+	for (unsigned int dataIndex = 0; dataIndex < dataLen; dataIndex++)
+	{
+		unsigned char dataByte = (unsigned char)((dataIndex * 37) + 11);
+
+		if ((dataByte == GDL90_FLAGBYTE) || (dataByte == GDL90_ESCAPEBYTE))
+		{
+			dataByte = 0x5e;
+		}
+		dataBuf[dataIndex] = dataByte;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one body through the current kernel, copied and in place, at an aligned
+// and a misaligned start
+///////////////////////////////////////////////////////////////////////////////
+static void CheckBody(const unsigned char *bodyBuf, unsigned int bodyLen, const char *what,
+	int position)
+{
+	unsigned char expectBuf[TEST_BUF_SIZE];
+	unsigned int expectLen = ReferenceUnstuff(expectBuf, bodyBuf, bodyLen);
+	unsigned int expectSpecial = ReferenceFindSpecial(bodyBuf, bodyLen);
+
+	for (unsigned int startOffset = 0; startOffset < 2; startOffset++)
+	{
+		unsigned char srcBuf[TEST_BUF_SIZE];
+		unsigned char dstBuf[TEST_BUF_SIZE];
+
+		memcpy(&srcBuf[startOffset], bodyBuf, bodyLen);
+		memset(dstBuf, 0, sizeof(dstBuf));
+
+		Check(Gdl90FindSpecial(&srcBuf[startOffset], bodyLen) == expectSpecial, what, position);
+
+		unsigned int dstLen = Gdl90Unstuff(&dstBuf[startOffset], &srcBuf[startOffset], bodyLen);
+
+		Check((dstLen == expectLen) &&
+			(memcmp(&dstBuf[startOffset], expectBuf, expectLen) == 0), what, position);
+
+		dstLen = Gdl90Unstuff(&srcBuf[startOffset], &srcBuf[startOffset], bodyLen);
+
+		Check((dstLen == expectLen) &&
+			(memcmp(&srcBuf[startOffset], expectBuf, expectLen) == 0), what, position);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a flag, an escape and two escapes in a row at every position of every
+// length, the escape at the end of a body being the trailing one
+///////////////////////////////////////////////////////////////////////////////
+static void TestKernel()
+{
+	unsigned char bodyBuf[TEST_BUF_SIZE];
+
+	for (unsigned int bodyLen = 0; bodyLen <= TEST_MAX_LEN; bodyLen++)
+	{
+		FillBody(bodyBuf, bodyLen);
+
+		CheckBody(bodyBuf, bodyLen, "plain body", (int)bodyLen);
+
+		for (unsigned int position = 0; position < bodyLen; position++)
+		{
+			FillBody(bodyBuf, bodyLen);
+			bodyBuf[position] = GDL90_FLAGBYTE;
+
+			CheckBody(bodyBuf, bodyLen, "flag", (int)position);
+
+			bodyBuf[position] = GDL90_ESCAPEBYTE;
+
+			CheckBody(bodyBuf, bodyLen, "escape", (int)position);
+
+			if ((position + 1) < bodyLen)
+			{
+				bodyBuf[position + 1] = GDL90_ESCAPEBYTE;
+
+				CheckBody(bodyBuf, bodyLen, "escaped escape", (int)position);
+			}
+		}
+
+		// every other byte an escape, the worst case
+
+		for (unsigned int position = 0; position < bodyLen; position += 2)
+		{
+			bodyBuf[position] = GDL90_ESCAPEBYTE;
+		}
+
+		CheckBody(bodyBuf, bodyLen, "escapes throughout", (int)bodyLen);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	int selectedKernel = Gdl90GetUnstuffKernel();
+
+	for (int kernelKind = unstuffKernelScalar; kernelKind <= unstuffKernelAvx2; kernelKind++)
+	{
+		if (Gdl90SetUnstuffKernel(kernelKind) != 0)
+		{
+			printf("%s kernel not supported here, skipped\n", sKernelNames[kernelKind]);
+			continue;
+		}
+
+		int numFailures = sNumFailures;
+
+		TestKernel();
+
+		Check(sNumFailures == numFailures, sKernelNames[kernelKind], sNumFailures - numFailures);
+	}
+
+	Gdl90SetUnstuffKernel(selectedKernel);
+
+	if (sNumFailures == 0)
+	{
+		printf("Gdl90UnstuffTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
@@ -0,0 +1,173 @@
+//
+// SerializeBenchmark.cpp: SerializeTrafficTable against SerializeTrafficData
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it optimized with the library sources and Qt Core, then run it,
+// optionally with the number of targets.  it checks the bulk serializer's
+// output matches SerializeTrafficData byte for byte, exiting 1 if not, then
+// prints the time to export the whole table both ways
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../Gdl90Encoder.h"
+
+#define BENCH_DEFAULT_TARGETS 1000
+#define BENCH_MIN_SECONDS 1.0
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetSeconds()
+{
+	return(std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// targets spread over every field's range, sent through the decoder so the
+// table holds what a live feed would give it
+///////////////////////////////////////////////////////////////////////////////
+static void LoadTargets(AdsbWrapper &wrapper, unsigned int numTargets)
+{
+	unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+	unsigned char frameBuf[GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE)];
+	struct trafficReportRec report;
+
+	for (unsigned int index = 0; index < numTargets; index++)
+	{
+		memset(&report, 0, sizeof(report));
+
+		report.addressType = (unsigned char)(index & 3);
+		report.participantAddr = 0xabc000 + index;
+		report.latitude = -80.0 + ((index * 0.37) - (160.0 * (int)((index * 0.37) / 160.0)));
+		report.longitude = -170.0 + ((index * 0.91) - (340.0 * (int)((index * 0.91) / 340.0)));
+		report.altitude = -1000 + ((index * 725) % 60000);
+		report.horzVelocity = (index * 13) % 700;
+		report.vertVelocity = (((int)(index % 100)) - 50) * 64;
+		report.trackHeading = (float)((index * 7.03) - (360.0 * (int)((index * 7.03) / 360.0)));
+		report.emitterCategory = (unsigned char)(index % 20);
+		report.integrityCode = 8;
+		report.accuracyCode = 9;
+
+		snprintf(report.callsign, sizeof(report.callsign), "N%u", (index * 97) % 100000);
+
+		Gdl90Encoder::EncodeReport(GDL90_ID_TRAFFIC, report, msgBuf);
+
+		unsigned int frameLen = Gdl90Encoder::StuffFrame(msgBuf, sizeof(msgBuf), frameBuf);
+
+		wrapper.DecodeMessage(frameLen, (char *)frameBuf, true);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the way a caller exports the table with SerializeTrafficData
+///////////////////////////////////////////////////////////////////////////////
+static void SerializeOneByOne(AdsbWrapper &wrapper, char delimiter, std::string &tableData)
+{
+	std::string serializedData;
+	int numTargets = wrapper.GetNumTrafficReports();
+
+	tableData.clear();
+
+	for (int dataIndex = 0; dataIndex < numTargets; dataIndex++)
+	{
+		wrapper.SerializeTrafficData(dataIndex, delimiter, serializedData);
+
+		tableData += serializedData;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	unsigned int numTargets = BENCH_DEFAULT_TARGETS;
+
+	if (argc > 1)
+	{
+		numTargets = (unsigned int)atoi(argv[1]);
+	}
+
+	AdsbWrapper wrapper;
+
+	wrapper.SetTrafficCapacity(numTargets);
+
+	LoadTargets(wrapper, numTargets);
+
+	struct serializeOptionsRec options;
+
+	AdsbWrapper::GetDefaultSerializeOptions(options);
+	options.delimiter = ',';
+
+	std::vector<char> dataBuf(wrapper.GetSerializeBufferSize(options));
+	std::string tableData;
+
+	// same bytes both ways or the timings mean nothing
+
+	SerializeOneByOne(wrapper, options.delimiter, tableData);
+
+	int numBytes = wrapper.SerializeTrafficTable(dataBuf.data(), (unsigned int)dataBuf.size(),
+		options);
+
+	if ((numBytes != (int)tableData.size()) ||
+		(memcmp(dataBuf.data(), tableData.data(), tableData.size()) != 0))
+	{
+		printf("FAIL: SerializeTrafficTable output differs from SerializeTrafficData\n");
+
+		return(1);
+	}
+
+	printf("%d targets, %d bytes per export, output identical\n",
+		wrapper.GetNumTrafficReports(), numBytes);
+
+	// time whole table exports, enough of them to last a second
+
+	unsigned int numExports = 0;
+	double startTime = GetSeconds();
+	double elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		SerializeOneByOne(wrapper, options.delimiter, tableData);
+
+		numExports++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	double dataMicros = (elapsed * 1e6) / numExports;
+
+	numExports = 0;
+	startTime = GetSeconds();
+	elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		wrapper.SerializeTrafficTable(dataBuf.data(), (unsigned int)dataBuf.size(), options);
+
+		numExports++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	double tableMicros = (elapsed * 1e6) / numExports;
+
+	printf("SerializeTrafficData   %10.1f us per export\n", dataMicros);
+	printf("SerializeTrafficTable  %10.1f us per export, %.1fx\n", tableMicros,
+		dataMicros / tableMicros);
+
+	return(0);
+}
@@ -0,0 +1,162 @@
+//
+// TrafficFusionTest.cpp: which report wins when receivers overlap
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../TrafficFusion.h"
+
+#define TEST_ADDRESS 0xa1b2c3
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static struct trafficReportRec MakeReport(double latitude, unsigned char integrityCode,
+	unsigned char accuracyCode)
+{
+	struct trafficReportRec report;
+
+	memset(&report, 0, sizeof(report));
+
+	report.msgId = GDL90_ID_TRAFFIC;
+	report.participantAddr = TEST_ADDRESS;
+	report.latitude = latitude;
+	report.longitude = -122.3;
+	report.altitude = 4500;
+	report.integrityCode = integrityCode;
+	report.accuracyCode = accuracyCode;
+
+	return(report);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetFusedLatitude(AdsbWrapper &fused)
+{
+	std::vector<struct trafficSnapshotRec> snapshot;
+	double latitude = 0.0;
+
+	fused.PublishTrafficSnapshot();
+	fused.ReadTrafficSnapshot(snapshot);
+
+	for (size_t index = 0; index < snapshot.size(); index++)
+	{
+		if (snapshot[index].report.participantAddr == TEST_ADDRESS)
+		{
+			latitude = snapshot[index].report.latitude;
+		}
+	}
+	return(latitude);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// receive times are milliseconds, make sure the next report is later
+///////////////////////////////////////////////////////////////////////////////
+static void NextMillisecond()
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// source 1 is behind, its older report of the same quality is polled after
+// source 0's newer one and must not move the target back
+///////////////////////////////////////////////////////////////////////////////
+static void TestOlderReportLoses()
+{
+	AdsbWrapper fused;
+	TrafficFusion fusion(fused, 2);
+
+	fusion.Submit(1, MakeReport(47.10, 8, 9));
+
+	NextMillisecond();
+
+	fusion.Submit(0, MakeReport(47.20, 8, 9));
+
+	Check(fusion.Poll() == 2, "both polled", 0);
+	Check(GetFusedLatitude(fused) == 47.20, "newer position kept", 0);
+	Check(fusion.GetBestSource(0, TEST_ADDRESS) == 0, "newer source kept",
+		fusion.GetBestSource(0, TEST_ADDRESS));
+	Check(fusion.GetNumRejectedReports() == 1, "older report rejected",
+		fusion.GetNumRejectedReports());
+	Check(fusion.GetSeenBy(0, TEST_ADDRESS) == 3, "both sources see it",
+		fusion.GetSeenBy(0, TEST_ADDRESS));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the receiver that supplied the position is always taken, and a newer
+// report that is at least as good takes over
+///////////////////////////////////////////////////////////////////////////////
+static void TestNewerReportWins()
+{
+	AdsbWrapper fused;
+	TrafficFusion fusion(fused, 2);
+
+	fusion.Submit(0, MakeReport(47.10, 8, 9));
+	fusion.Poll();
+
+	NextMillisecond();
+
+	fusion.Submit(1, MakeReport(47.20, 7, 9));
+	fusion.Poll();
+
+	Check(GetFusedLatitude(fused) == 47.10, "worse report loses", 0);
+
+	NextMillisecond();
+
+	fusion.Submit(1, MakeReport(47.30, 8, 10));
+	fusion.Poll();
+
+	Check(GetFusedLatitude(fused) == 47.30, "better newer report wins", 0);
+	Check(fusion.GetBestSource(0, TEST_ADDRESS) == 1, "best source moved",
+		fusion.GetBestSource(0, TEST_ADDRESS));
+
+	NextMillisecond();
+
+	fusion.Submit(1, MakeReport(47.40, 6, 6));
+	fusion.Poll();
+
+	Check(GetFusedLatitude(fused) == 47.40, "best source always taken", 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestOlderReportLoses();
+	TestNewerReportWins();
+
+	if (sNumFailures == 0)
+	{
+		printf("TrafficFusionTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
@@ -0,0 +1,274 @@
+//
+// TrafficGridBenchmark.cpp: TrafficGrid box and nearest query latency
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it optimized with the library sources, then run it.  with 1000 and
+// 10000 targets spread over the continental US it checks the grid's box and
+// nearest queries find what a scan of every target finds, exiting 1 if
+// not, then prints the time per query both ways
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "../TrafficGrid.h"
+
+#define BENCH_MIN_SECONDS 1.0
+#define BENCH_NUM_QUERIES 256
+#define BENCH_BOX_SIZE 2.0         // degrees on a side
+#define BENCH_NEAREST_TARGETS 10
+
+///////////////////////////////////////////////////////////////////////////////
+struct benchTargetRec
+{
+	double latitude;
+	double longitude;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+enum benchQueryKinds
+{
+	benchGridBox,
+	benchScanBox,
+	benchGridNearest,
+	benchScanNearest
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// everything a query needs, the result vectors are reused between queries
+///////////////////////////////////////////////////////////////////////////////
+struct benchStateRec
+{
+	TrafficGrid grid;
+
+	std::vector<struct benchTargetRec> targets;
+	std::vector<struct benchTargetRec> centers;
+	std::vector<std::pair<double, int> > nearest;
+	std::vector<int> slotIds;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetSeconds()
+{
+	return(std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the same positions every run
+///////////////////////////////////////////////////////////////////////////////
+static double NextRandom(unsigned int &seed)
+{
+	seed = (seed * 1103515245) + 12345;
+
+	return((double)((seed >> 8) & 0xffff) / 65536.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void MakePositions(std::vector<struct benchTargetRec> &positions, unsigned int count,
+	unsigned int seed)
+{
+	positions.resize(count);
+
+	for (unsigned int index = 0; index < count; index++)
+	{
+		positions[index].latitude = 25.0 + (NextRandom(seed) * 24.0);
+		positions[index].longitude = -124.0 + (NextRandom(seed) * 57.0);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// what the grid saves us from, every target looked at
+///////////////////////////////////////////////////////////////////////////////
+static void ScanBox(const std::vector<struct benchTargetRec> &targets,
+	const struct benchTargetRec &center, std::vector<int> &slotIds)
+{
+	double halfSize = BENCH_BOX_SIZE / 2.0;
+
+	for (unsigned int slotId = 0; slotId < targets.size(); slotId++)
+	{
+		if ((targets[slotId].latitude >= (center.latitude - halfSize)) &&
+			(targets[slotId].latitude <= (center.latitude + halfSize)) &&
+			(targets[slotId].longitude >= (center.longitude - halfSize)) &&
+			(targets[slotId].longitude <= (center.longitude + halfSize)))
+		{
+			slotIds.push_back((int)slotId);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void ScanNearest(const std::vector<struct benchTargetRec> &targets,
+	const struct benchTargetRec &center, std::vector<std::pair<double, int> > &nearest,
+	std::vector<int> &slotIds)
+{
+	nearest.clear();
+
+	for (unsigned int slotId = 0; slotId < targets.size(); slotId++)
+	{
+		nearest.push_back(std::make_pair(TrafficGrid::GetDistance(targets[slotId].latitude,
+			targets[slotId].longitude, center.latitude, center.longitude), (int)slotId));
+	}
+
+	unsigned int numNearest = std::min((unsigned int)BENCH_NEAREST_TARGETS,
+		(unsigned int)nearest.size());
+
+	std::partial_sort(nearest.begin(), nearest.begin() + numNearest, nearest.end());
+
+	for (unsigned int index = 0; index < numNearest; index++)
+	{
+		slotIds.push_back(nearest[index].second);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one query around center, the slot ids found are left in state.slotIds
+///////////////////////////////////////////////////////////////////////////////
+static void RunQuery(struct benchStateRec &state, int queryKind,
+	const struct benchTargetRec &center)
+{
+	double halfSize = BENCH_BOX_SIZE / 2.0;
+
+	state.slotIds.clear();
+
+	switch (queryKind)
+	{
+	case benchGridBox:
+		state.grid.QueryBox(center.latitude - halfSize, center.longitude - halfSize,
+			center.latitude + halfSize, center.longitude + halfSize, state.slotIds);
+		break;
+
+	case benchScanBox:
+		ScanBox(state.targets, center, state.slotIds);
+		break;
+
+	case benchGridNearest:
+		state.grid.QueryNearest(center.latitude, center.longitude, BENCH_NEAREST_TARGETS,
+			state.slotIds);
+		break;
+
+	case benchScanNearest:
+		ScanNearest(state.targets, center, state.nearest, state.slotIds);
+		break;
+
+	default:
+		break;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// microseconds per query, each pass runs every query once
+///////////////////////////////////////////////////////////////////////////////
+static double TimeQueries(struct benchStateRec &state, int queryKind)
+{
+	unsigned int numPasses = 0;
+	double startTime = GetSeconds();
+	double elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		for (unsigned int queryIndex = 0; queryIndex < state.centers.size(); queryIndex++)
+		{
+			RunQuery(state, queryKind, state.centers[queryIndex]);
+		}
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	return((elapsed * 1e6) / ((double)numPasses * state.centers.size()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RunBenchmark(unsigned int numTargets)
+{
+	struct benchStateRec state;
+	std::vector<int> gridIds;
+
+	MakePositions(state.targets, numTargets, 1);
+	MakePositions(state.centers, BENCH_NUM_QUERIES, 2);
+
+	state.grid.Reserve(numTargets);
+
+	for (unsigned int slotId = 0; slotId < numTargets; slotId++)
+	{
+		state.grid.Update((int)slotId, state.targets[slotId].latitude,
+			state.targets[slotId].longitude);
+	}
+
+	// same targets both ways or the timings mean nothing
+
+	unsigned int numInBoxes = 0;
+
+	for (unsigned int queryIndex = 0; queryIndex < BENCH_NUM_QUERIES; queryIndex++)
+	{
+		const struct benchTargetRec &center = state.centers[queryIndex];
+
+		RunQuery(state, benchGridBox, center);
+		gridIds = state.slotIds;
+		RunQuery(state, benchScanBox, center);
+
+		std::sort(gridIds.begin(), gridIds.end());
+
+		numInBoxes += (unsigned int)state.slotIds.size();
+
+		if (gridIds != state.slotIds)
+		{
+			printf("FAIL: box query %u differs from the scan\n", queryIndex);
+
+			return(1);
+		}
+
+		RunQuery(state, benchGridNearest, center);
+		gridIds = state.slotIds;
+		RunQuery(state, benchScanNearest, center);
+
+		if (gridIds != state.slotIds)
+		{
+			printf("FAIL: nearest query %u differs from the scan\n", queryIndex);
+
+			return(1);
+		}
+	}
+
+	double gridBox = TimeQueries(state, benchGridBox);
+	double scanBox = TimeQueries(state, benchScanBox);
+	double gridNearest = TimeQueries(state, benchGridNearest);
+	double scanNearest = TimeQueries(state, benchScanNearest);
+
+	printf("%u targets, %.1f in each %.0f degree box, results identical\n", numTargets,
+		(double)numInBoxes / BENCH_NUM_QUERIES, BENCH_BOX_SIZE);
+	printf("  box        grid %8.2f us   scan %8.2f us   %.1fx\n", gridBox, scanBox,
+		scanBox / gridBox);
+	printf("  nearest %-2d grid %8.2f us   scan %8.2f us   %.1fx\n", BENCH_NEAREST_TARGETS,
+		gridNearest, scanNearest, scanNearest / gridNearest);
+
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	int status = RunBenchmark(1000);
+
+	if (status == 0)
+	{
+		status = RunBenchmark(10000);
+	}
+
+	return(status);
+}
@@ -0,0 +1,183 @@
+//
+// TrafficGridTest.cpp: TrafficGrid box and nearest queries
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources, then run it.  it prints every check
+// that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include "../TrafficGrid.h"
+
+// slot ids from here up fill the far side of the world so the queries
+// walk cells instead of looking at every target
+#define TEST_FILLER_SLOT 100
+#define TEST_NUM_FILLERS 200
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the slot ids a box query finds, sorted
+///////////////////////////////////////////////////////////////////////////////
+static std::vector<int> QueryBox(TrafficGrid &grid, double minLatitude, double minLongitude,
+	double maxLatitude, double maxLongitude)
+{
+	std::vector<int> slotIds;
+
+	grid.QueryBox(minLatitude, minLongitude, maxLatitude, maxLongitude, slotIds);
+
+	std::sort(slotIds.begin(), slotIds.end());
+
+	return(slotIds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void AddFillers(TrafficGrid &grid)
+{
+	for (int index = 0; index < TEST_NUM_FILLERS; index++)
+	{
+		grid.Update(TEST_FILLER_SLOT + index, -40.0 + ((index % 20) * 0.1),
+			-60.0 + ((index / 20) * 0.1));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a box from 179.5 east to 179.5 west holds the targets either side of the
+// 180 degree meridian and nothing on the far side of the world
+///////////////////////////////////////////////////////////////////////////////
+static void TestBoxAcrossMeridian()
+{
+	TrafficGrid grid;
+	std::vector<int> expected;
+
+	grid.Update(0, 10.0, 179.8);
+	grid.Update(1, 10.0, -179.8);
+	grid.Update(2, 10.0, 179.0);
+	grid.Update(3, 10.0, -179.0);
+	grid.Update(4, 10.0, 0.0);
+	grid.Update(5, 11.5, 179.9);
+	grid.Update(6, 10.2, 540.0 - 0.3);
+
+	expected.push_back(0);
+	expected.push_back(1);
+	expected.push_back(6);
+
+	// few targets, every one is looked at
+
+	Check(QueryBox(grid, 9.5, 179.5, 10.5, -179.5) == expected, "box across 180, few targets",
+		(int)QueryBox(grid, 9.5, 179.5, 10.5, -179.5).size());
+
+	// many targets, the cells either side of 180 are walked
+
+	AddFillers(grid);
+
+	Check(QueryBox(grid, 9.5, 179.5, 10.5, -179.5) == expected, "box across 180",
+		(int)QueryBox(grid, 9.5, 179.5, 10.5, -179.5).size());
+	Check(QueryBox(grid, 9.5, 179.5, 10.5, 180.5) == expected, "box past 180",
+		(int)QueryBox(grid, 9.5, 179.5, 10.5, 180.5).size());
+	Check(QueryBox(grid, 9.5, -180.5, 10.5, -179.5) == expected, "box past -180",
+		(int)QueryBox(grid, 9.5, -180.5, 10.5, -179.5).size());
+
+	// the same box the other way round is everything but the meridian
+
+	std::vector<int> slotIds = QueryBox(grid, 9.5, -179.5, 10.5, 179.5);
+
+	Check((slotIds.size() == 3) && (slotIds[0] == 2) && (slotIds[1] == 3) && (slotIds[2] == 4),
+		"box away from 180", (int)slotIds.size());
+
+	Check(QueryBox(grid, -90.0, -180.0, 90.0, 180.0).size() == 7 + TEST_NUM_FILLERS,
+		"whole world", (int)QueryBox(grid, -90.0, -180.0, 90.0, 180.0).size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void CheckNearest(TrafficGrid &grid, double latitude, double longitude,
+	unsigned int maxTargets, const int *expected, unsigned int numExpected, const char *what)
+{
+	std::vector<int> slotIds;
+
+	int numFound = grid.QueryNearest(latitude, longitude, maxTargets, slotIds);
+
+	Check((numFound == (int)numExpected) && (slotIds.size() == numExpected), what, numFound);
+
+	for (unsigned int index = 0; (index < numExpected) && (index < slotIds.size()); index++)
+	{
+		Check(slotIds[index] == expected[index], what, (int)index);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// nothing within the first radius, the search has to widen several times
+// and still return the targets nearest first
+///////////////////////////////////////////////////////////////////////////////
+static void TestNearestGrowsRadius()
+{
+	static const int nearestThree[] = { 1, 2, 0 };
+	static const int nearestAll[] = { 1, 2, 0, 3, 4 };
+
+	TrafficGrid grid;
+
+	grid.Update(0, 0.0, 3.0);      // 180 nm
+	grid.Update(1, 0.0, 1.0);      // 60 nm
+	grid.Update(2, 0.0, -1.5);     // 90 nm
+	grid.Update(3, 0.0, 20.0);     // 1200 nm
+	grid.Update(4, 45.0, 100.0);   // the other side of the world
+
+	CheckNearest(grid, 0.0, 0.0, 1, nearestThree, 1, "nearest one");
+	CheckNearest(grid, 0.0, 0.0, 3, nearestThree, 3, "nearest three");
+	CheckNearest(grid, 0.0, 0.0, 10, nearestAll, 5, "more than there are");
+
+	// nearest across the 180 degree meridian
+
+	static const int nearestWest[] = { 0, 1, 2 };
+
+	TrafficGrid meridianGrid;
+
+	meridianGrid.Update(0, 0.0, -179.95);
+	meridianGrid.Update(1, 0.0, 179.0);
+	meridianGrid.Update(2, 0.0, -178.0);
+
+	CheckNearest(meridianGrid, 0.0, 179.9, 2, nearestWest, 2, "nearest across 180");
+	CheckNearest(meridianGrid, 0.0, 179.9, 3, nearestWest, 3, "all across 180");
+
+	std::vector<int> slotIds;
+
+	Check(TrafficGrid().QueryNearest(0.0, 0.0, 3, slotIds) == 0, "empty grid", 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestBoxAcrossMeridian();
+	TestNearestGrowsRadius();
+
+	if (sNumFailures == 0)
+	{
+		printf("TrafficGridTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
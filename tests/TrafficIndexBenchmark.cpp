@@ -0,0 +1,214 @@
+//
+// TrafficIndexBenchmark.cpp: indexed target lookups against a callsign scan
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it optimized with the library sources and Qt Core, then run it,
+// optionally with the number of targets.  it checks the address and
+// callsign indexes find the same target a front to back callsign scan of
+// the table does, exiting 1 if not, then prints the time to look every
+// target up each way
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../Gdl90Encoder.h"
+
+#define BENCH_DEFAULT_TARGETS 5000
+#define BENCH_MIN_SECONDS 1.0
+
+// lookup results go here so the timed loops aren't optimized away
+static volatile int sFound = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetSeconds()
+{
+	return(std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// targets with their own address and callsign, sent through the decoder
+///////////////////////////////////////////////////////////////////////////////
+static void LoadTargets(AdsbWrapper &wrapper, unsigned int numTargets)
+{
+	unsigned char msgBuf[GDL90_ENCODER_REPORT_SIZE];
+	unsigned char frameBuf[GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE)];
+	struct trafficReportRec report;
+
+	for (unsigned int index = 0; index < numTargets; index++)
+	{
+		memset(&report, 0, sizeof(report));
+
+		report.addressType = (unsigned char)(index & 3);
+		report.participantAddr = 0xabc000 + index;
+		report.latitude = 47.0 + ((index % 100) * 0.01);
+		report.longitude = -122.0 - ((index / 100) * 0.01);
+		report.altitude = 1000 + ((index * 25) % 20000);
+
+		snprintf(report.callsign, sizeof(report.callsign), "N%u", 10000 + index);
+
+		Gdl90Encoder::EncodeReport(GDL90_ID_TRAFFIC, report, msgBuf);
+
+		unsigned int frameLen = Gdl90Encoder::StuffFrame(msgBuf, sizeof(msgBuf), frameBuf);
+
+		wrapper.DecodeMessage(frameLen, (char *)frameBuf, true);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the lookup every report went through before the index, the list searched
+// front to back comparing callsigns
+///////////////////////////////////////////////////////////////////////////////
+static int ScanCallsigns(const std::vector<std::string> &callsigns, const std::string &callsign)
+{
+	for (size_t index = 0; index < callsigns.size(); index++)
+	{
+		if (callsigns[index] == callsign)
+		{
+			return((int)index);
+		}
+	}
+	return(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	unsigned int numTargets = BENCH_DEFAULT_TARGETS;
+
+	if (argc > 1)
+	{
+		numTargets = (unsigned int)atoi(argv[1]);
+	}
+
+	AdsbWrapper wrapper;
+
+	wrapper.SetTrafficCapacity(numTargets);
+
+	LoadTargets(wrapper, numTargets);
+
+	std::vector<struct trafficSnapshotRec> snapshot;
+
+	wrapper.PublishTrafficSnapshot();
+	wrapper.ReadTrafficSnapshot(snapshot);
+
+	if ((snapshot.size() != numTargets) || (wrapper.GetNumTrafficReports() != (int)numTargets))
+	{
+		printf("FAIL: %d targets stored, %u expected\n", wrapper.GetNumTrafficReports(),
+			numTargets);
+
+		return(1);
+	}
+
+	std::vector<std::string> callsigns(snapshot.size());
+
+	for (size_t index = 0; index < snapshot.size(); index++)
+	{
+		callsigns[index] = snapshot[index].report.callsign;
+	}
+
+	// same target every way or the timings mean nothing
+
+	for (size_t index = 0; index < snapshot.size(); index++)
+	{
+		const struct trafficReportRec &report = snapshot[index].report;
+		unsigned char addressType = 0;
+		unsigned int participantAddr = 0;
+
+		int scanIndex = ScanCallsigns(callsigns, callsigns[index]);
+		int dataIndex = wrapper.GetDataIndex(report.addressType, report.participantAddr);
+		int status = wrapper.GetParticipantAddress(callsigns[index], addressType, participantAddr);
+
+		if ((scanIndex != (int)index) || (dataIndex < 0) || (status != 0) ||
+			(addressType != report.addressType) || (participantAddr != report.participantAddr))
+		{
+			printf("FAIL: lookups disagree for %s\n", callsigns[index].c_str());
+
+			return(1);
+		}
+	}
+
+	printf("%u targets, every lookup finds the same target\n", numTargets);
+
+	// time looking up every target, enough passes to last a second
+
+	unsigned int numPasses = 0;
+	double startTime = GetSeconds();
+	double elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		for (size_t index = 0; index < callsigns.size(); index++)
+		{
+			sFound += ScanCallsigns(callsigns, callsigns[index]);
+		}
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	double scanNanos = (elapsed * 1e9) / ((double)numPasses * numTargets);
+
+	numPasses = 0;
+	startTime = GetSeconds();
+	elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		for (size_t index = 0; index < snapshot.size(); index++)
+		{
+			sFound += wrapper.GetDataIndex(snapshot[index].report.addressType,
+				snapshot[index].report.participantAddr);
+		}
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	double addressNanos = (elapsed * 1e9) / ((double)numPasses * numTargets);
+
+	numPasses = 0;
+	startTime = GetSeconds();
+	elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		for (size_t index = 0; index < callsigns.size(); index++)
+		{
+			unsigned char addressType;
+			unsigned int participantAddr;
+
+			sFound += wrapper.GetParticipantAddress(callsigns[index], addressType, participantAddr);
+		}
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	double callsignNanos = (elapsed * 1e9) / ((double)numPasses * numTargets);
+
+	printf("callsign scan          %10.1f ns per lookup\n", scanNanos);
+	printf("GetDataIndex           %10.1f ns per lookup, %.1fx\n", addressNanos,
+		scanNanos / addressNanos);
+	printf("GetParticipantAddress  %10.1f ns per lookup, %.1fx\n", callsignNanos,
+		scanNanos / callsignNanos);
+
+	return(0);
+}
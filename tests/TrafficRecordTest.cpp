@@ -0,0 +1,255 @@
+//
+// TrafficRecordTest.cpp: ExportRecords through TrafficRecordReader
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../TrafficRecordReader.h"
+#include "../TrafficRecordWriter.h"
+
+#define TEST_START_TIME 1000000
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, long long value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%lld)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// what a consumer applying changed only exports knows
+///////////////////////////////////////////////////////////////////////////////
+struct consumerRec
+{
+	std::map<unsigned long long, struct trafficRecordRec> targets;
+
+	unsigned long long changeVersion;
+
+	unsigned int numTraffic;
+	unsigned int numRemoved;
+	unsigned int numStreamHeaders;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned long long GetTargetKey(unsigned char addressType, unsigned int participantAddr)
+{
+	return(((unsigned long long)addressType << 32) | participantAddr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one changed only export, written and read back the way it would cross
+// a socket
+///////////////////////////////////////////////////////////////////////////////
+static void ExportAndRead(AdsbWrapper &wrapper, struct consumerRec &consumer)
+{
+	std::vector<unsigned char> dataBuf(wrapper.GetExportBufferSize());
+	TrafficRecordWriter writer;
+	TrafficRecordReader reader;
+
+	writer.SetBuffer(dataBuf.data(), (unsigned int)dataBuf.size());
+
+	int numRecords = wrapper.ExportRecords(writer, &consumer.changeVersion);
+
+	Check(numRecords > 0, "export fits", numRecords);
+
+	consumer.numTraffic = 0;
+	consumer.numRemoved = 0;
+	consumer.numStreamHeaders = 0;
+
+	reader.SetBuffer(dataBuf.data(), writer.GetSize());
+
+	int recordType;
+
+	while ((recordType = reader.Next()) >= 0)
+	{
+		struct trafficRecordRec traffic;
+		unsigned char addressType;
+		unsigned int participantAddr;
+
+		switch (recordType)
+		{
+		case trafficRecordStreamHeader:
+			consumer.targets.clear();
+			consumer.numStreamHeaders++;
+			break;
+
+		case trafficRecordTraffic:
+			Check(reader.GetTraffic(traffic) == 0, "traffic record", 0);
+			Check(traffic.report.msgId == GDL90_ID_TRAFFIC, "traffic message id",
+				traffic.report.msgId);
+
+			consumer.targets[GetTargetKey(traffic.report.addressType,
+				traffic.report.participantAddr)] = traffic;
+			consumer.numTraffic++;
+			break;
+
+		case trafficRecordRemoved:
+			Check(reader.GetRemoved(addressType, participantAddr) == 0, "removed record", 0);
+			Check(consumer.targets.erase(GetTargetKey(addressType, participantAddr)) == 1,
+				"removed target was known", participantAddr);
+			consumer.numRemoved++;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	Check(reader.GetConsumed() == writer.GetSize(), "whole buffer read", reader.GetConsumed());
+	Check(reader.GetNumErrors() == 0, "reader errors", reader.GetNumErrors());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void StoreTarget(AdsbWrapper &wrapper, unsigned int participantAddr, int altitude)
+{
+	struct trafficReportRec report;
+
+	memset(&report, 0, sizeof(report));
+
+	report.msgId = GDL90_ID_TRAFFIC;
+	report.addressType = 0;
+	report.participantAddr = participantAddr;
+	report.latitude = 47.5;
+	report.longitude = -122.3;
+	report.altitude = altitude;
+
+	wrapper.StoreTrafficReport(report);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// an expired target and a cleared table both reach the reader
+///////////////////////////////////////////////////////////////////////////////
+static void TestRemovals()
+{
+	struct consumerRec consumer;
+	AdsbWrapper wrapper;
+
+	consumer.changeVersion = 0;
+
+	wrapper.SetClockTime(TEST_START_TIME);
+
+	StoreTarget(wrapper, 0xa00001, 1000);
+	StoreTarget(wrapper, 0xa00002, 2000);
+	StoreTarget(wrapper, 0xa00003, 3000);
+
+	ExportAndRead(wrapper, consumer);
+
+	Check(consumer.numTraffic == 3, "first export", consumer.numTraffic);
+	Check(consumer.targets.size() == 3, "targets known", (long long)consumer.targets.size());
+
+	// the first target stops reporting and runs out of time to live
+
+	wrapper.SetClockTime(TEST_START_TIME + 30);
+
+	StoreTarget(wrapper, 0xa00002, 2100);
+	StoreTarget(wrapper, 0xa00003, 3100);
+
+	wrapper.SetClockTime(TEST_START_TIME + ADSB_DEFAULT_TIME_TO_LIVE + 10);
+
+	Check(wrapper.ExpireTraffic(wrapper.GetClockTime()) == 1, "one expired", 0);
+
+	ExportAndRead(wrapper, consumer);
+
+	Check(consumer.numRemoved == 1, "expiry exported", consumer.numRemoved);
+	Check(consumer.numTraffic == 2, "updates exported", consumer.numTraffic);
+	Check(consumer.targets.count(GetTargetKey(0, 0xa00001)) == 0, "expired target gone", 0);
+	Check(consumer.targets.size() == 2, "targets left", (long long)consumer.targets.size());
+
+	// nothing has changed since
+
+	ExportAndRead(wrapper, consumer);
+
+	Check((consumer.numRemoved == 0) && (consumer.numTraffic == 0), "nothing new",
+		consumer.numRemoved + consumer.numTraffic);
+
+	// a target that goes and comes back between exports is still there
+
+	wrapper.ClearTrafficDataList();
+
+	StoreTarget(wrapper, 0xa00003, 3200);
+
+	ExportAndRead(wrapper, consumer);
+
+	Check(consumer.numRemoved == 2, "clear exported", consumer.numRemoved);
+	Check(consumer.targets.size() == 1, "target came back", (long long)consumer.targets.size());
+	Check((consumer.targets.size() == 1) &&
+		(consumer.targets.begin()->second.report.altitude == 3200), "returned target", 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// more removals than the table holds, the export starts the stream over
+///////////////////////////////////////////////////////////////////////////////
+static void TestStartOver()
+{
+	struct consumerRec consumer;
+	AdsbWrapper wrapper;
+
+	consumer.changeVersion = 0;
+
+	wrapper.SetHistoryLimit(0);
+	wrapper.SetTrafficCapacity(4);
+
+	for (unsigned int index = 0; index < 10; index++)
+	{
+		StoreTarget(wrapper, 0xb00000 + index, 5000);
+	}
+
+	ExportAndRead(wrapper, consumer);
+
+	Check(consumer.targets.size() == 10, "targets known", (long long)consumer.targets.size());
+
+	wrapper.ClearTrafficDataList();
+
+	StoreTarget(wrapper, 0xb00100, 6000);
+
+	ExportAndRead(wrapper, consumer);
+
+	Check(consumer.numStreamHeaders == 1, "started over", consumer.numStreamHeaders);
+	Check(consumer.numRemoved == 0, "no removals after starting over", consumer.numRemoved);
+	Check(consumer.targets.size() == 1, "only the new target", (long long)consumer.targets.size());
+
+	// and carries on with changes from there
+
+	ExportAndRead(wrapper, consumer);
+
+	Check(consumer.numStreamHeaders == 0, "started over once", consumer.numStreamHeaders);
+	Check(consumer.targets.size() == 1, "still the new target", (long long)consumer.targets.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestRemovals();
+	TestStartOver();
+
+	if (sNumFailures == 0)
+	{
+		printf("TrafficRecordTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
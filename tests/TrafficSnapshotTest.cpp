@@ -0,0 +1,217 @@
+//
+// TrafficSnapshotTest.cpp: concurrent readers against a publishing writer
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../TrafficSnapshot.h"
+
+#define TEST_SNAPSHOT_CAPACITY 256
+#define TEST_NUM_PUBLISHES 200000
+#define TEST_NUM_READERS 4
+
+static std::atomic<int> sNumFailures(0);
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, long long value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%lld)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// publish number version holds this many records, all stamped with version
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int GetNumRecords(uint64_t version)
+{
+	return((unsigned int)(1 + (version % TEST_SNAPSHOT_CAPACITY)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void WriterLoop(TrafficSnapshot *snapshot, std::atomic<bool> *done)
+{
+	std::vector<struct trafficSnapshotRec> records(TEST_SNAPSHOT_CAPACITY);
+
+	for (uint64_t version = 1; version <= TEST_NUM_PUBLISHES; version++)
+	{
+		unsigned int numRecords = GetNumRecords(version);
+
+		for (unsigned int index = 0; index < numRecords; index++)
+		{
+			memset(&records[index], 0, sizeof(records[index]));
+
+			records[index].report.participantAddr = index;
+			records[index].report.altitude = (int32_t)version;
+			records[index].report.latitude = (double)version;
+			records[index].slotId = (int32_t)version;
+		}
+
+		snapshot->Publish(records.data(), numRecords);
+	}
+
+	done->store(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// every copy a reader gets has to be one whole publish, never a mix of two
+///////////////////////////////////////////////////////////////////////////////
+static void ReaderLoop(TrafficSnapshot *snapshot, std::atomic<bool> *done,
+	std::atomic<long long> *numReads)
+{
+	std::vector<struct trafficSnapshotRec> records;
+	uint64_t lastVersion = 0;
+	long long readCount = 0;
+
+	records.reserve(TEST_SNAPSHOT_CAPACITY);
+
+	while (done->load() == false)
+	{
+		uint64_t version = 0;
+		int numRecords = snapshot->Read(records, &version);
+
+		readCount++;
+
+		if (version == 0)
+		{
+			continue;
+		}
+
+		Check(version >= lastVersion, "version went backwards", (long long)version);
+		Check(numRecords == (int)GetNumRecords(version), "record count", numRecords);
+
+		for (int index = 0; index < numRecords; index++)
+		{
+			if ((records[index].report.participantAddr != (uint32_t)index) ||
+				(records[index].report.altitude != (int32_t)version) ||
+				(records[index].report.latitude != (double)version) ||
+				(records[index].slotId != (int32_t)version))
+			{
+				Check(false, "torn record", (long long)version);
+				break;
+			}
+		}
+
+		lastVersion = version;
+	}
+
+	numReads->fetch_add(readCount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void TestConcurrentReaders()
+{
+	TrafficSnapshot snapshot(TEST_SNAPSHOT_CAPACITY);
+	std::atomic<bool> done(false);
+	std::atomic<long long> numReads(0);
+	std::vector<std::thread> readers;
+
+	for (int index = 0; index < TEST_NUM_READERS; index++)
+	{
+		readers.push_back(std::thread(ReaderLoop, &snapshot, &done, &numReads));
+	}
+
+	std::thread writer(WriterLoop, &snapshot, &done);
+
+	writer.join();
+
+	for (size_t index = 0; index < readers.size(); index++)
+	{
+		readers[index].join();
+	}
+
+	Check(snapshot.GetVersion() == TEST_NUM_PUBLISHES, "publish count",
+		(long long)snapshot.GetVersion());
+	Check(snapshot.GetNumTruncated() == 0, "nothing truncated", snapshot.GetNumTruncated());
+	Check(numReads.load() > 0, "readers ran", numReads.load());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void StoreTargets(AdsbWrapper &wrapper, unsigned int numTargets)
+{
+	struct trafficReportRec report;
+
+	for (unsigned int index = 0; index < numTargets; index++)
+	{
+		memset(&report, 0, sizeof(report));
+
+		report.msgId = GDL90_ID_TRAFFIC;
+		report.participantAddr = 0x100000 + index;
+		report.altitude = 5000;
+
+		wrapper.StoreTrafficReport(report);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the wrapper's snapshot has room for the history limit even when the
+// traffic capacity is smaller, and says when targets were left out
+///////////////////////////////////////////////////////////////////////////////
+static void TestWrapperCapacity()
+{
+	std::vector<struct trafficSnapshotRec> records;
+
+	AdsbWrapper historyWrapper;
+
+	historyWrapper.SetTrafficCapacity(16);
+	historyWrapper.SetHistoryLimit(512);
+
+	StoreTargets(historyWrapper, 500);
+
+	historyWrapper.PublishTrafficSnapshot();
+
+	Check(historyWrapper.ReadTrafficSnapshot(records) == 500, "history sized snapshot",
+		(long long)records.size());
+	Check(historyWrapper.GetNumSnapshotTruncated() == 0, "history not truncated",
+		historyWrapper.GetNumSnapshotTruncated());
+
+	AdsbWrapper smallWrapper;
+
+	smallWrapper.SetHistoryLimit(0);
+	smallWrapper.SetTrafficCapacity(16);
+
+	StoreTargets(smallWrapper, 100);
+
+	smallWrapper.PublishTrafficSnapshot();
+
+	Check(smallWrapper.ReadTrafficSnapshot(records) == 16, "capacity sized snapshot",
+		(long long)records.size());
+	Check(smallWrapper.GetNumSnapshotTruncated() == 84, "truncation counted",
+		smallWrapper.GetNumSnapshotTruncated());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestConcurrentReaders();
+	TestWrapperCapacity();
+
+	if (sNumFailures == 0)
+	{
+		printf("TrafficSnapshotTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
@@ -0,0 +1,451 @@
+//
+// UatDecodeTest.cpp: known basic and long UAT payloads through DecodeUatReport
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  it prints
+// every check that fails and exits 1 if there were any
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../AdsbWrapper.h"
+
+#define TEST_POSITION_TOLERANCE 0.0001    // degrees, a few lsb of the 23 and 24 bit fields
+#define TEST_TRACK_TOLERANCE 0.01         // degrees
+
+// payload bit offsets, DO-282B.  the state vector starts at byte 4, mode
+// status at byte 17 and the auxiliary state vector at byte 29
+
+#define TEST_SV_BIT(bit) (32 + (bit))
+#define TEST_MS_BIT(bit) (136 + (bit))
+#define TEST_AUX_BIT(bit) (232 + (bit))
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a report as it comes out of the framer: flag, id, 3 bytes of time of
+// reception, the payload, crc and flag.  only the id and payload matter to
+// the decoder
+///////////////////////////////////////////////////////////////////////////////
+struct uatFrameRec
+{
+	unsigned char msgBuf[GDL90_ID_LONG_REPORT_LENGTH];
+	unsigned int msgLen;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static void InitFrame(struct uatFrameRec &frame, unsigned char msgId)
+{
+	memset(&frame, 0, sizeof(frame));
+
+	frame.msgBuf[0] = msgId;
+	frame.msgLen = (msgId == GDL90_ID_LONG_REPORT) ? GDL90_ID_LONG_REPORT_LENGTH :
+		GDL90_ID_BASIC_REPORT_LENGTH;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// value into width bits of the payload from bitOffset, most significant
+// bit first
+///////////////////////////////////////////////////////////////////////////////
+static void SetBits(struct uatFrameRec &frame, unsigned int bitOffset, unsigned int width,
+	unsigned int value)
+{
+	unsigned char *payload = &frame.msgBuf[4];
+
+	for (unsigned int bit = 0; bit < width; bit++)
+	{
+		unsigned int bitIndex = bitOffset + bit;
+		unsigned char mask = (unsigned char)(0x80 >> (bitIndex % 8));
+
+		if (((value >> (width - 1 - bit)) & 1) != 0)
+		{
+			payload[bitIndex / 8] |= mask;
+		}
+		else
+		{
+			payload[bitIndex / 8] &= (unsigned char)~mask;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void SetHeader(struct uatFrameRec &frame, unsigned int payloadTypeCode,
+	unsigned int addressQualifier, unsigned int participantAddr)
+{
+	SetBits(frame, 0, 5, payloadTypeCode);
+	SetBits(frame, 5, 3, addressQualifier);
+	SetBits(frame, 8, 24, participantAddr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the three 16 bit words of mode status, the emitter category and 8 base
+// 40 characters
+///////////////////////////////////////////////////////////////////////////////
+static void SetCallsignWords(struct uatFrameRec &frame, unsigned int word0, unsigned int word1,
+	unsigned int word2)
+{
+	SetBits(frame, TEST_MS_BIT(0), 16, word0);
+	SetBits(frame, TEST_MS_BIT(16), 16, word1);
+	SetBits(frame, TEST_MS_BIT(32), 16, word2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void InitExpected(struct trafficReportRec &expected, unsigned char msgId,
+	unsigned char addressType, unsigned int participantAddr)
+{
+	memset(&expected, 0, sizeof(expected));
+
+	expected.msgId = msgId;
+	expected.addressType = addressType;
+	expected.participantAddr = participantAddr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode frame and compare every field of the report and the present bits
+///////////////////////////////////////////////////////////////////////////////
+static void CheckDecode(const struct uatFrameRec &frame, const struct trafficReportRec &expected,
+	unsigned int expectedFields, int caseIndex)
+{
+	struct trafficReportRec decoded;
+	unsigned int presentFields = 0xffffffff;
+
+	Check(AdsbWrapper::DecodeUatReport(frame.msgLen + GDL90_FRAME_OVERHEAD, frame.msgBuf,
+		decoded, presentFields) == 0, "decodes", caseIndex);
+
+	Check(presentFields == expectedFields, "present fields", caseIndex);
+	Check(fabs(decoded.latitude - expected.latitude) < TEST_POSITION_TOLERANCE, "latitude",
+		caseIndex);
+	Check(fabs(decoded.longitude - expected.longitude) < TEST_POSITION_TOLERANCE, "longitude",
+		caseIndex);
+	Check(decoded.lastUpdate == 0, "lastUpdate", caseIndex);
+	Check(decoded.participantAddr == expected.participantAddr, "participantAddr", caseIndex);
+	Check(decoded.altitude == expected.altitude, "altitude", caseIndex);
+	Check(decoded.horzVelocity == expected.horzVelocity, "horzVelocity", caseIndex);
+	Check(decoded.vertVelocity == expected.vertVelocity, "vertVelocity", caseIndex);
+	Check(fabs(decoded.trackHeading - expected.trackHeading) < TEST_TRACK_TOLERANCE,
+		"trackHeading", caseIndex);
+	Check(decoded.msgId == expected.msgId, "msgId", caseIndex);
+	Check(decoded.addressType == expected.addressType, "addressType", caseIndex);
+	Check(decoded.alertStatus == 0, "alertStatus", caseIndex);
+	Check(decoded.miscIndicators == expected.miscIndicators, "miscIndicators", caseIndex);
+	Check(decoded.integrityCode == expected.integrityCode, "integrityCode", caseIndex);
+	Check(decoded.accuracyCode == expected.accuracyCode, "accuracyCode", caseIndex);
+	Check(decoded.emitterCategory == expected.emitterCategory, "emitterCategory", caseIndex);
+	Check(decoded.emergencyPriorityCode == expected.emergencyPriorityCode,
+		"emergencyPriorityCode", caseIndex);
+	Check(memcmp(decoded.callsign, expected.callsign, TRAFFIC_REPORT_CALLSIGN_SIZE) == 0,
+		"callsign", caseIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// basic ADS-B report, airborne subsonic, climbing north east and
+// descending at 1280 fpm
+///////////////////////////////////////////////////////////////////////////////
+static void TestBasicSubsonic()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec expected;
+
+	InitFrame(frame, GDL90_ID_BASIC_REPORT);
+	SetHeader(frame, 0, 0, 0xa1b2c3);
+
+	SetBits(frame, TEST_SV_BIT(0), 23, 0x200000);       // 45 N
+	SetBits(frame, TEST_SV_BIT(23), 24, 11079953);      // 237.75, 122.25 W
+	SetBits(frame, TEST_SV_BIT(47), 1, 0);              // barometric
+	SetBits(frame, TEST_SV_BIT(48), 12, 261);           // (5500 + 1000) / 25 + 1
+	SetBits(frame, TEST_SV_BIT(60), 4, 8);
+	SetBits(frame, TEST_SV_BIT(64), 2, 0);              // airborne subsonic
+	SetBits(frame, TEST_SV_BIT(67), 1, 0);              // north
+	SetBits(frame, TEST_SV_BIT(68), 10, 301);           // 300 kt
+	SetBits(frame, TEST_SV_BIT(78), 1, 1);              // west
+	SetBits(frame, TEST_SV_BIT(79), 10, 401);           // 400 kt
+	SetBits(frame, TEST_SV_BIT(89), 1, 1);              // barometric
+	SetBits(frame, TEST_SV_BIT(90), 1, 1);              // down
+	SetBits(frame, TEST_SV_BIT(91), 9, 21);             // 1280 / 64 + 1
+
+	InitExpected(expected, GDL90_ID_BASIC_REPORT, 0, 0xa1b2c3);
+
+	expected.latitude = 45.0;
+	expected.longitude = -122.25;
+	expected.altitude = 5500;
+	expected.integrityCode = 8;
+	expected.horzVelocity = 500;
+	expected.trackHeading = 306.87f;    // atan2(-400, 300)
+	expected.vertVelocity = -1280;
+	expected.miscIndicators = 0x09;     // airborne, true track
+
+	CheckDecode(frame, expected, TRAFFIC_FIELD_POSITION | TRAFFIC_FIELD_ALTITUDE |
+		TRAFFIC_FIELD_INTEGRITY_CODE | TRAFFIC_FIELD_HORZ_VELOCITY | TRAFFIC_FIELD_TRACK_HEADING |
+		TRAFFIC_FIELD_VERT_VELOCITY | TRAFFIC_FIELD_MISC_INDICATORS, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// basic TIS-B report, airborne supersonic in 4 kt steps, south and west,
+// no altitude and no vertical velocity
+///////////////////////////////////////////////////////////////////////////////
+static void TestBasicSupersonic()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec expected;
+
+	InitFrame(frame, GDL90_ID_BASIC_REPORT);
+	SetHeader(frame, 0, 2, 0x3c4d5e);
+
+	SetBits(frame, TEST_SV_BIT(0), 23, 6815744);        // 146.25, 33.75 S
+	SetBits(frame, TEST_SV_BIT(23), 24, 13491678);      // 289.5, 70.5 W
+	SetBits(frame, TEST_SV_BIT(48), 12, 0);             // no altitude
+	SetBits(frame, TEST_SV_BIT(60), 4, 7);
+	SetBits(frame, TEST_SV_BIT(64), 2, 1);              // airborne supersonic
+	SetBits(frame, TEST_SV_BIT(68), 10, 1);             // 0 kt north
+	SetBits(frame, TEST_SV_BIT(79), 10, 101);           // 100 * 4 kt east
+	SetBits(frame, TEST_SV_BIT(91), 9, 0);              // no vertical velocity
+
+	InitExpected(expected, GDL90_ID_BASIC_REPORT, 2, 0x3c4d5e);
+
+	expected.latitude = -33.75;
+	expected.longitude = -70.5;
+	expected.integrityCode = 7;
+	expected.horzVelocity = 400;
+	expected.trackHeading = 90.0f;
+	expected.miscIndicators = 0x09;
+
+	CheckDecode(frame, expected, TRAFFIC_FIELD_POSITION | TRAFFIC_FIELD_INTEGRITY_CODE |
+		TRAFFIC_FIELD_HORZ_VELOCITY | TRAFFIC_FIELD_TRACK_HEADING |
+		TRAFFIC_FIELD_MISC_INDICATORS, 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// basic surface vehicle report on the ground with ground speed and a true
+// track but no position
+///////////////////////////////////////////////////////////////////////////////
+static void TestBasicGround()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec expected;
+
+	InitFrame(frame, GDL90_ID_BASIC_REPORT);
+	SetHeader(frame, 0, 4, 0x000102);
+
+	SetBits(frame, TEST_SV_BIT(48), 12, 1);             // -1000 ft
+	SetBits(frame, TEST_SV_BIT(60), 4, 0);              // no nic and no position
+	SetBits(frame, TEST_SV_BIT(64), 2, 2);              // on the ground
+	SetBits(frame, TEST_SV_BIT(68), 10, 16);            // 15 kt
+	SetBits(frame, TEST_SV_BIT(78), 2, 1);              // true track
+	SetBits(frame, TEST_SV_BIT(80), 9, 192);            // 192 * 360 / 512
+
+	InitExpected(expected, GDL90_ID_BASIC_REPORT, 4, 0x000102);
+
+	expected.altitude = -1000;
+	expected.horzVelocity = 15;
+	expected.trackHeading = 135.0f;
+	expected.miscIndicators = 0x01;     // on the ground, true track
+
+	CheckDecode(frame, expected, TRAFFIC_FIELD_ALTITUDE | TRAFFIC_FIELD_INTEGRITY_CODE |
+		TRAFFIC_FIELD_HORZ_VELOCITY | TRAFFIC_FIELD_TRACK_HEADING |
+		TRAFFIC_FIELD_VERT_VELOCITY | TRAFFIC_FIELD_MISC_INDICATORS, 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// long payload type 1 with mode status and a geometric state vector
+// altitude, the auxiliary barometric altitude is the one kept
+///////////////////////////////////////////////////////////////////////////////
+static void TestLongModeStatus()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec expected;
+
+	InitFrame(frame, GDL90_ID_LONG_REPORT);
+	SetHeader(frame, 1, 0, 0xabcdef);
+
+	SetBits(frame, TEST_SV_BIT(0), 23, 0x200000);       // 45 N
+	SetBits(frame, TEST_SV_BIT(23), 24, 11079953);      // 122.25 W
+	SetBits(frame, TEST_SV_BIT(47), 1, 1);              // geometric
+	SetBits(frame, TEST_SV_BIT(48), 12, 442);           // 10025 ft
+	SetBits(frame, TEST_SV_BIT(60), 4, 10);
+	SetBits(frame, TEST_SV_BIT(64), 2, 0);
+	SetBits(frame, TEST_SV_BIT(68), 10, 1);             // stationary, so no track
+	SetBits(frame, TEST_SV_BIT(79), 10, 1);
+	SetBits(frame, TEST_SV_BIT(90), 1, 0);              // up
+	SetBits(frame, TEST_SV_BIT(91), 9, 9);              // 512 fpm
+
+	// emitter category 3, "UAL123" and two spaces
+
+	SetCallsignWords(frame, (3 * 1600) + (30 * 40) + 10, (21 * 1600) + (1 * 40) + 2,
+		(3 * 1600) + (36 * 40) + 36);
+	SetBits(frame, TEST_MS_BIT(48), 3, 2);              // emergency priority
+	SetBits(frame, TEST_MS_BIT(51), 3, 2);              // mops version, not kept
+	SetBits(frame, TEST_MS_BIT(64), 4, 9);              // NACp
+	SetBits(frame, TEST_MS_BIT(78), 1, 1);              // a callsign, not a squawk
+
+	SetBits(frame, TEST_AUX_BIT(0), 12, 437);           // 9900 ft barometric
+
+	InitExpected(expected, GDL90_ID_LONG_REPORT, 0, 0xabcdef);
+
+	expected.latitude = 45.0;
+	expected.longitude = -122.25;
+	expected.altitude = 9900;
+	expected.integrityCode = 10;
+	expected.horzVelocity = 0;
+	expected.vertVelocity = 512;
+	expected.miscIndicators = 0x08;     // airborne, no track
+	expected.emitterCategory = 3;
+	expected.emergencyPriorityCode = 2;
+	expected.accuracyCode = 9;
+
+	memcpy(expected.callsign, "UAL123", 6);
+
+	CheckDecode(frame, expected, TRAFFIC_FIELD_POSITION | TRAFFIC_FIELD_ALTITUDE |
+		TRAFFIC_FIELD_INTEGRITY_CODE | TRAFFIC_FIELD_HORZ_VELOCITY | TRAFFIC_FIELD_VERT_VELOCITY |
+		TRAFFIC_FIELD_MISC_INDICATORS | TRAFFIC_FIELD_CALLSIGN | TRAFFIC_FIELD_ACCURACY_CODE |
+		TRAFFIC_FIELD_EMITTER_CATEGORY | TRAFFIC_FIELD_EMERGENCY_CODE, 3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// long payload type 1 whose mode status holds a squawk code, everything
+// but the callsign is kept and the barometric altitude stays
+///////////////////////////////////////////////////////////////////////////////
+static void TestLongSquawk()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec expected;
+
+	InitFrame(frame, GDL90_ID_LONG_REPORT);
+	SetHeader(frame, 1, 1, 0x7a7a7a);
+
+	SetBits(frame, TEST_SV_BIT(0), 23, 6815744);        // 33.75 S
+	SetBits(frame, TEST_SV_BIT(23), 24, 13491678);      // 70.5 W
+	SetBits(frame, TEST_SV_BIT(47), 1, 0);              // barometric
+	SetBits(frame, TEST_SV_BIT(48), 12, 281);           // 6000 ft
+	SetBits(frame, TEST_SV_BIT(60), 4, 6);
+	SetBits(frame, TEST_SV_BIT(64), 2, 0);
+	SetBits(frame, TEST_SV_BIT(67), 1, 1);              // south
+	SetBits(frame, TEST_SV_BIT(68), 10, 101);           // 100 kt
+	SetBits(frame, TEST_SV_BIT(79), 10, 1);             // 0 kt east
+
+	SetCallsignWords(frame, (1 * 1600) + (1 * 40) + 2, (0 * 1600) + (0 * 40) + 36,
+		(36 * 1600) + (36 * 40) + 36);
+	SetBits(frame, TEST_MS_BIT(48), 3, 0);
+	SetBits(frame, TEST_MS_BIT(64), 4, 5);
+	SetBits(frame, TEST_MS_BIT(78), 1, 0);              // squawk
+
+	SetBits(frame, TEST_AUX_BIT(0), 12, 285);           // geometric, not kept
+
+	InitExpected(expected, GDL90_ID_LONG_REPORT, 1, 0x7a7a7a);
+
+	expected.latitude = -33.75;
+	expected.longitude = -70.5;
+	expected.altitude = 6000;
+	expected.integrityCode = 6;
+	expected.horzVelocity = 100;
+	expected.trackHeading = 180.0f;
+	expected.miscIndicators = 0x09;
+	expected.emitterCategory = 1;
+	expected.accuracyCode = 5;
+
+	CheckDecode(frame, expected, TRAFFIC_FIELD_POSITION | TRAFFIC_FIELD_ALTITUDE |
+		TRAFFIC_FIELD_INTEGRITY_CODE | TRAFFIC_FIELD_HORZ_VELOCITY | TRAFFIC_FIELD_TRACK_HEADING |
+		TRAFFIC_FIELD_MISC_INDICATORS | TRAFFIC_FIELD_ACCURACY_CODE |
+		TRAFFIC_FIELD_EMITTER_CATEGORY | TRAFFIC_FIELD_EMERGENCY_CODE, 4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// long payload type 2 has no mode status, the auxiliary altitude fills in
+// the missing state vector one
+///////////////////////////////////////////////////////////////////////////////
+static void TestLongAuxiliaryOnly()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec expected;
+
+	InitFrame(frame, GDL90_ID_LONG_REPORT);
+	SetHeader(frame, 2, 0, 0x123456);
+
+	SetBits(frame, TEST_SV_BIT(0), 23, 0x200000);
+	SetBits(frame, TEST_SV_BIT(23), 24, 11079953);
+	SetBits(frame, TEST_SV_BIT(48), 12, 0);             // no altitude
+	SetBits(frame, TEST_SV_BIT(60), 4, 9);
+	SetBits(frame, TEST_SV_BIT(64), 2, 3);              // reserved, no velocities
+
+	// would be a callsign if type 2 carried mode status
+
+	SetCallsignWords(frame, (3 * 1600) + (30 * 40) + 10, (21 * 1600) + (1 * 40) + 2,
+		(3 * 1600) + (36 * 40) + 36);
+	SetBits(frame, TEST_MS_BIT(64), 4, 9);
+	SetBits(frame, TEST_MS_BIT(78), 1, 1);
+
+	SetBits(frame, TEST_AUX_BIT(0), 12, 121);           // 2000 ft
+
+	InitExpected(expected, GDL90_ID_LONG_REPORT, 0, 0x123456);
+
+	expected.latitude = 45.0;
+	expected.longitude = -122.25;
+	expected.altitude = 2000;
+	expected.integrityCode = 9;
+
+	CheckDecode(frame, expected, TRAFFIC_FIELD_POSITION | TRAFFIC_FIELD_ALTITUDE |
+		TRAFFIC_FIELD_INTEGRITY_CODE, 5);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// anything but a basic or long report, or one too short, is turned away
+///////////////////////////////////////////////////////////////////////////////
+static void TestRejected()
+{
+	struct uatFrameRec frame;
+	struct trafficReportRec decoded;
+	unsigned int presentFields;
+
+	InitFrame(frame, GDL90_ID_BASIC_REPORT);
+	SetHeader(frame, 0, 0, 0xa1b2c3);
+
+	Check(AdsbWrapper::DecodeUatReport(frame.msgLen + GDL90_FRAME_OVERHEAD - 1, frame.msgBuf,
+		decoded, presentFields) != 0, "short report rejected", 0);
+
+	frame.msgBuf[0] = GDL90_ID_TRAFFIC;
+
+	Check(AdsbWrapper::DecodeUatReport(frame.msgLen + GDL90_FRAME_OVERHEAD, frame.msgBuf,
+		decoded, presentFields) != 0, "traffic id rejected", 1);
+	Check(presentFields == 0, "nothing present", 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestBasicSubsonic();
+	TestBasicSupersonic();
+	TestBasicGround();
+	TestLongModeStatus();
+	TestLongSquawk();
+	TestLongAuxiliaryOnly();
+	TestRejected();
+
+	if (sNumFailures == 0)
+	{
+		printf("UatDecodeTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
@@ -0,0 +1,185 @@
+//
+// UdpLoopbackTest.cpp: UdpReplay to UdpSource over loopback
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core on Linux, then run it.  it
+// needs a free UDP port on 127.0.0.1, prints every check that fails and
+// exits 1 if there were any
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../Gdl90Encoder.h"
+#include "../UdpReplay.h"
+#include "../UdpSource.h"
+
+#define TEST_FIRST_PORT 47400
+#define TEST_NUM_PORTS 20
+#define TEST_NUM_TARGETS 100
+#define TEST_NUM_REPORTS 5      // per target
+#define TEST_NUM_FRAMES (TEST_NUM_TARGETS * TEST_NUM_REPORTS)
+#define TEST_PACED_RATE 5000    // frames per second
+#define TEST_WAIT_POLLS 50      // of 20 ms each before giving up on a datagram
+
+static int sNumFailures = 0;
+
+#ifdef __linux__
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, int value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%d)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// every target reporting in turn, as the raw stream a receiver would send
+///////////////////////////////////////////////////////////////////////////////
+static void MakeStream(std::vector<unsigned char> &streamData)
+{
+	struct trafficReportRec report;
+	Gdl90Encoder encoder;
+
+	streamData.resize(TEST_NUM_FRAMES * GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE));
+
+	encoder.SetBuffer(streamData.data(), (unsigned int)streamData.size());
+
+	for (unsigned int sequence = 0; sequence < TEST_NUM_REPORTS; sequence++)
+	{
+		for (unsigned int target = 0; target < TEST_NUM_TARGETS; target++)
+		{
+			memset(&report, 0, sizeof(report));
+
+			report.participantAddr = 0xe00000 + target;
+			report.latitude = 47.0 + (target * 0.01);
+			report.longitude = -122.0 + (sequence * 0.001);
+			report.altitude = 3000 + (sequence * 100);
+
+			encoder.AddTraffic(report);
+		}
+	}
+
+	streamData.resize(encoder.GetSize());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the first free port from TEST_FIRST_PORT, or 0 if none
+///////////////////////////////////////////////////////////////////////////////
+static unsigned short OpenSource(UdpSource &source)
+{
+	for (unsigned short port = TEST_FIRST_PORT; port < TEST_FIRST_PORT + TEST_NUM_PORTS; port++)
+	{
+		if (source.Open(port, "127.0.0.1") == 0)
+		{
+			return(port);
+		}
+	}
+	return(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// every frame sent arrives as its own datagram and is decoded
+///////////////////////////////////////////////////////////////////////////////
+static void TestReplay(unsigned int framesPerSecond)
+{
+	std::vector<unsigned char> streamData;
+	AdsbWrapper wrapper;
+	UdpSource source;
+	UdpReplay replay;
+
+	MakeStream(streamData);
+
+	unsigned short port = OpenSource(source);
+
+	Check(port != 0, "source opened", TEST_FIRST_PORT);
+	Check(replay.Open("127.0.0.1", port) == 0, "replay opened", port);
+
+	source.SetWrapper(&wrapper);
+
+	if (port == 0)
+	{
+		return;
+	}
+
+	// the whole stream fits in the receive buffer, so send it all and
+	// read it afterwards
+
+	int numSent = replay.Replay((unsigned int)streamData.size(), (const char *)streamData.data(),
+		framesPerSecond);
+
+	Check(numSent == TEST_NUM_FRAMES, "frames sent", numSent);
+
+	unsigned int numWaits = 0;
+
+	while ((source.GetNumDatagrams() < TEST_NUM_FRAMES) && (numWaits < TEST_WAIT_POLLS))
+	{
+		if (source.Poll(20) == 0)
+		{
+			numWaits++;
+		}
+	}
+
+	Check(source.GetNumDatagrams() == TEST_NUM_FRAMES, "datagrams received",
+		(int)source.GetNumDatagrams());
+	Check(source.GetNumTruncatedDatagrams() == 0, "nothing truncated",
+		(int)source.GetNumTruncatedDatagrams());
+	Check(source.GetNumReceiveCalls() < TEST_NUM_FRAMES, "datagrams read in batches",
+		(int)source.GetNumReceiveCalls());
+	Check(wrapper.GetNumTrafficReports() == TEST_NUM_TARGETS, "targets decoded",
+		wrapper.GetNumTrafficReports());
+
+	// each target holds its last report
+
+	std::vector<struct trafficSnapshotRec> snapshot;
+	unsigned int numLatest = 0;
+
+	wrapper.PublishTrafficSnapshot();
+	wrapper.ReadTrafficSnapshot(snapshot);
+
+	for (size_t index = 0; index < snapshot.size(); index++)
+	{
+		if (snapshot[index].report.altitude == 3000 + ((TEST_NUM_REPORTS - 1) * 100))
+		{
+			numLatest++;
+		}
+	}
+
+	Check(numLatest == TEST_NUM_TARGETS, "last reports kept", (int)numLatest);
+}
+
+#endif // __linux__
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+#ifdef __linux__
+	TestReplay(0);
+	TestReplay(TEST_PACED_RATE);
+#else
+	printf("UdpSource and UdpReplay are Linux only, nothing tested\n");
+#endif
+
+	if (sNumFailures == 0)
+	{
+		printf("UdpLoopbackTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}
@@ -0,0 +1,211 @@
+//
+// UnstuffBenchmark.cpp: the SSE2 and AVX2 unstuff kernels against scalar
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it optimized with the library sources, then run it.  for traffic
+// report sized and uplink sized bodies, with escapes rare and common, it
+// checks every kernel the cpu runs gives the scalar output, exiting 1 if
+// not, then prints each kernel's unstuff and find special speed
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "../Gdl90Unstuff.h"
+
+#define BENCH_DATA_SIZE (256 * 1024)
+#define BENCH_MIN_SECONDS 1.0
+
+static const char *sKernelNames[] = { "scalar", "sse2", "avx2" };
+
+///////////////////////////////////////////////////////////////////////////////
+struct benchCaseRec
+{
+	const char *name;
+	unsigned int bodyLen;
+	unsigned int escapeEvery;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetSeconds()
+{
+	return(std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bodies back to back, an escape every escapeEvery bytes
+///////////////////////////////////////////////////////////////////////////////
+static void FillData(std::vector<unsigned char> &dataBuf, unsigned int escapeEvery)
+{
+	for (size_t dataIndex = 0; dataIndex < dataBuf.size(); dataIndex++)
+	{
+		unsigned char dataByte = (unsigned char)((dataIndex * 37) + 11);
+
+		if ((dataByte == GDL90_FLAGBYTE) || (dataByte == GDL90_ESCAPEBYTE))
+		{
+			dataByte = 0x5e;
+		}
+		dataBuf[dataIndex] = dataByte;
+	}
+
+	for (size_t dataIndex = escapeEvery - 1; dataIndex < dataBuf.size(); dataIndex += escapeEvery)
+	{
+		dataBuf[dataIndex] = GDL90_ESCAPEBYTE;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int UnstuffAll(const std::vector<unsigned char> &srcData,
+	std::vector<unsigned char> &dstData, unsigned int bodyLen)
+{
+	unsigned int dstLen = 0;
+
+	for (size_t srcIndex = 0; (srcIndex + bodyLen) <= srcData.size(); srcIndex += bodyLen)
+	{
+		dstLen += Gdl90Unstuff(&dstData[dstLen], &srcData[srcIndex], bodyLen);
+	}
+
+	return(dstLen);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// walk from special byte to special byte the way the framer does
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int FindAll(const std::vector<unsigned char> &srcData)
+{
+	unsigned int numSpecial = 0;
+	unsigned int dataIndex = 0;
+	unsigned int dataLen = (unsigned int)srcData.size();
+
+	while (dataIndex < dataLen)
+	{
+		dataIndex += Gdl90FindSpecial(&srcData[dataIndex], dataLen - dataIndex) + 1;
+
+		numSpecial++;
+	}
+
+	return(numSpecial);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double TimeUnstuff(const std::vector<unsigned char> &srcData,
+	std::vector<unsigned char> &dstData, unsigned int bodyLen)
+{
+	unsigned int numPasses = 0;
+	double startTime = GetSeconds();
+	double elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		UnstuffAll(srcData, dstData, bodyLen);
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	return(((double)srcData.size() * numPasses) / (elapsed * 1e6));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double TimeFind(const std::vector<unsigned char> &srcData)
+{
+	unsigned int numPasses = 0;
+	double startTime = GetSeconds();
+	double elapsed = 0.0;
+
+	while (elapsed < BENCH_MIN_SECONDS)
+	{
+		FindAll(srcData);
+
+		numPasses++;
+		elapsed = GetSeconds() - startTime;
+	}
+
+	return(((double)srcData.size() * numPasses) / (elapsed * 1e6));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	static const struct benchCaseRec benchCases[] =
+	{
+		{ "basic report, escapes rare", 22, 97 },
+		{ "basic report, escapes common", 22, 7 },
+		{ "uplink, escapes rare", 436, 97 },
+		{ "uplink, escapes common", 436, 7 }
+	};
+
+	int selectedKernel = Gdl90GetUnstuffKernel();
+	std::vector<unsigned char> srcData(BENCH_DATA_SIZE);
+	std::vector<unsigned char> expectData(BENCH_DATA_SIZE);
+	std::vector<unsigned char> dstData(BENCH_DATA_SIZE);
+	int status = 0;
+
+	for (size_t caseIndex = 0; caseIndex < sizeof(benchCases) / sizeof(benchCases[0]); caseIndex++)
+	{
+		const struct benchCaseRec &benchCase = benchCases[caseIndex];
+
+		FillData(srcData, benchCase.escapeEvery);
+
+		Gdl90SetUnstuffKernel(unstuffKernelScalar);
+
+		unsigned int expectLen = UnstuffAll(srcData, expectData, benchCase.bodyLen);
+		unsigned int expectSpecial = FindAll(srcData);
+		double scalarUnstuff = 0.0;
+		double scalarFind = 0.0;
+
+		printf("%s, %u byte bodies\n", benchCase.name, benchCase.bodyLen);
+
+		for (int kernelKind = unstuffKernelScalar; kernelKind <= unstuffKernelAvx2; kernelKind++)
+		{
+			if (Gdl90SetUnstuffKernel(kernelKind) != 0)
+			{
+				printf("  %-7s not supported here\n", sKernelNames[kernelKind]);
+				continue;
+			}
+
+			// same bytes as scalar or the timings mean nothing
+
+			if ((UnstuffAll(srcData, dstData, benchCase.bodyLen) != expectLen) ||
+				(memcmp(dstData.data(), expectData.data(), expectLen) != 0) ||
+				(FindAll(srcData) != expectSpecial))
+			{
+				printf("FAIL: %s output differs from scalar\n", sKernelNames[kernelKind]);
+
+				status = 1;
+				continue;
+			}
+
+			double unstuffRate = TimeUnstuff(srcData, dstData, benchCase.bodyLen);
+			double findRate = TimeFind(srcData);
+
+			if (kernelKind == unstuffKernelScalar)
+			{
+				scalarUnstuff = unstuffRate;
+				scalarFind = findRate;
+			}
+
+			printf("  %-7s unstuff %8.1f MB/s %5.1fx   find special %8.1f MB/s %5.1fx\n",
+				sKernelNames[kernelKind], unstuffRate, unstuffRate / scalarUnstuff,
+				findRate, findRate / scalarFind);
+		}
+	}
+
+	Gdl90SetUnstuffKernel(selectedKernel);
+
+	return(status);
+}
@@ -0,0 +1,222 @@
+//
+// WarmDecodeAllocTest.cpp: warm traffic decoding never touches the heap
+//
+// Copyright (c) 2019 Bruce Clay
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// build it with the library sources and Qt Core, then run it.  every
+// operator new is counted, the decode loops run once to warm up and then
+// again with the count checked.  exits 1 if anything allocated
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "../AdsbWrapper.h"
+#include "../Gdl90Encoder.h"
+
+#define TEST_NUM_TARGETS 500
+#define TEST_NUM_PASSES 20
+#define TEST_BUF_SIZE (TEST_NUM_TARGETS * GDL90_ENCODER_MAX_FRAME_SIZE(GDL90_ENCODER_REPORT_SIZE))
+
+static std::atomic<unsigned long long> sNumAllocations(0);
+
+static int sNumFailures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// the counting allocator, everything else goes to malloc as usual
+///////////////////////////////////////////////////////////////////////////////
+void *operator new(size_t size)
+{
+	sNumAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	void *memPtr = malloc((size > 0) ? size : 1);
+
+	if (memPtr == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return(memPtr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void *operator new[](size_t size)
+{
+	return(operator new(size));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void operator delete(void *memPtr) noexcept
+{
+	free(memPtr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void operator delete[](void *memPtr) noexcept
+{
+	free(memPtr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void operator delete(void *memPtr, size_t) noexcept
+{
+	free(memPtr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void operator delete[](void *memPtr, size_t) noexcept
+{
+	free(memPtr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void Check(bool passed, const char *what, unsigned long long value)
+{
+	if (passed == false)
+	{
+		printf("FAIL: %s (%llu)\n", what, value);
+
+		sNumFailures++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// one traffic frame per target, every pass moves the targets a little so
+// each report is a real update
+///////////////////////////////////////////////////////////////////////////////
+static void BuildBurst(std::vector<unsigned char> &dataBuf, std::vector<unsigned int> &frameEnds,
+	int pass)
+{
+	Gdl90Encoder encoder;
+	struct trafficReportRec report;
+
+	dataBuf.resize(TEST_BUF_SIZE);
+	frameEnds.clear();
+
+	encoder.SetBuffer(dataBuf.data(), (unsigned int)dataBuf.size());
+
+	for (unsigned int index = 0; index < TEST_NUM_TARGETS; index++)
+	{
+		memset(&report, 0, sizeof(report));
+
+		report.addressType = (unsigned char)(index % 3);
+		report.participantAddr = 0xa00000 + index;
+		report.latitude = 47.0 + (index * 0.001) + (pass * 0.0001);
+		report.longitude = -122.0 - (index * 0.001);
+		report.altitude = 3000 + (pass * 25);
+		report.horzVelocity = 120;
+		report.vertVelocity = 64 * (pass % 4);
+		report.trackHeading = (float)((index * 7) % 360);
+		report.integrityCode = 8;
+		report.accuracyCode = 9;
+
+		snprintf(report.callsign, sizeof(report.callsign), "N%05u", index % 400);
+
+		encoder.AddTraffic(report);
+
+		frameEnds.push_back(encoder.GetSize());
+	}
+
+	dataBuf.resize(encoder.GetSize());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the same bursts through DecodeStream, DecodeMessage and DecodeBatch
+///////////////////////////////////////////////////////////////////////////////
+static void DecodeBursts(AdsbWrapper &wrapper, std::vector<std::vector<unsigned char> > &bursts,
+	std::vector<std::vector<unsigned int> > &burstFrameEnds, std::vector<unsigned char> &msgBuf,
+	std::vector<struct decodeResultRec> &results, bool filterData)
+{
+	for (size_t burst = 0; burst < bursts.size(); burst++)
+	{
+		std::vector<unsigned char> &dataBuf = bursts[burst];
+		std::vector<unsigned int> &frameEnds = burstFrameEnds[burst];
+
+		wrapper.DecodeStream((unsigned int)dataBuf.size(), (const char *)dataBuf.data(), filterData);
+
+		// DecodeMessage unstuffs in place so it gets a copy of each frame
+
+		unsigned int frameStart = 0;
+
+		for (size_t frame = 0; frame < frameEnds.size(); frame++)
+		{
+			unsigned int frameSize = frameEnds[frame] - frameStart;
+
+			memcpy(msgBuf.data(), &dataBuf[frameStart], frameSize);
+
+			wrapper.DecodeMessage(frameSize, (char *)msgBuf.data(), filterData);
+
+			frameStart = frameEnds[frame];
+		}
+
+		wrapper.DecodeBatch((unsigned int)dataBuf.size(), (const char *)dataBuf.data(), results,
+			filterData);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void TestWarmDecode(bool filterData)
+{
+	std::vector<std::vector<unsigned char> > bursts(TEST_NUM_PASSES);
+	std::vector<std::vector<unsigned int> > burstFrameEnds(TEST_NUM_PASSES);
+	std::vector<unsigned char> msgBuf(GDL90_MAX_FRAME_SIZE * 2);
+	std::vector<struct decodeResultRec> results;
+
+	for (int pass = 0; pass < TEST_NUM_PASSES; pass++)
+	{
+		BuildBurst(bursts[pass], burstFrameEnds[pass], pass);
+	}
+
+	unsigned long long numStart = sNumAllocations.load();
+
+	AdsbWrapper wrapper;
+
+	wrapper.SetTrafficCapacity(2 * TEST_NUM_TARGETS);
+	wrapper.SetHistoryLimit(TEST_NUM_TARGETS);
+
+	// warm up, every target is added and every buffer reaches its size
+
+	DecodeBursts(wrapper, bursts, burstFrameEnds, msgBuf, results, filterData);
+
+	unsigned long long numBefore = sNumAllocations.load();
+
+	Check(numBefore > numStart, "counting allocator in use", numBefore - numStart);
+
+	DecodeBursts(wrapper, bursts, burstFrameEnds, msgBuf, results, filterData);
+
+	unsigned long long numAllocations = sNumAllocations.load() - numBefore;
+
+	Check(wrapper.GetNumCrcErrors() == 0, "crc errors", wrapper.GetNumCrcErrors());
+	Check(wrapper.GetNumTrafficReports() > 0, "targets stored", wrapper.GetNumTrafficReports());
+	Check(numAllocations == 0, filterData ? "allocations, filterData on" :
+		"allocations, filterData off", numAllocations);
+
+	printf("filterData %s: %d messages, %llu allocations\n", filterData ? "on" : "off",
+		3 * TEST_NUM_PASSES * TEST_NUM_TARGETS, numAllocations);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	TestWarmDecode(true);
+	TestWarmDecode(false);
+
+	if (sNumFailures == 0)
+	{
+		printf("WarmDecodeAllocTest passed\n");
+	}
+	return((sNumFailures == 0) ? 0 : 1);
+}